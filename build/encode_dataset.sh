@@ -0,0 +1,9 @@
+#! /bin/bash
+executable=../bin/encode_dataset
+set -x
+cd "${0%/*}"
+mkdir -p ../bin
+rm -f $executable
+gcc -std=gnu2x -Wall -Wextra -o $executable ../src/nerd_utils.c ../src/literal.c ../src/scene.c\
+ ../src/context.c ../src/sensor.c ../src/encode_dataset.c -lm\
+ -pthread -L../libs/pcg-c-0.94/src -lpcg_random -I../libs/pcg-c-0.94/include/
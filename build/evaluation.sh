@@ -5,7 +5,6 @@ cd "${0%/*}"
 mkdir -p ../bin
 rm -f $executable
 gcc -std=gnu2x -Wall -Wextra -o $executable ../src/nerd_utils.c ../src/literal.c ../src/scene.c\
- ../src/context.c ../src/rule.c ../src/rule_queue.c ../src/queue.c ../src/rule_hypergraph.c ../libs/prb.o\
- ../src/knowledge_base.c ../src/sensor.c ../src/nerd_helper.c ../src/metrics.c ../src/nerd.c\
- ../src/evaluation.c -lm -L../libs/pcg-c-0.94/src -lpcg_random -I../libs/pcg-c-0.94/include/\
- -I../libs/avl-2.0.3/
+ ../src/context.c ../src/rule.c ../src/rule_queue.c ../src/queue.c ../src/rule_hypergraph.c\
+ ../src/knowledge_base.c ../src/sensor.c ../src/nerd_helper.c ../src/inference_engine.c ../src/metrics.c ../src/nerd.c ../src/nerd_journal.c\
+ ../src/evaluation.c -pthread -lm -L../libs/pcg-c-0.94/src -lpcg_random -I../libs/pcg-c-0.94/include/
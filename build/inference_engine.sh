@@ -0,0 +1,14 @@
+#! /bin/bash
+executable=../bin/inference_engine
+set -x
+cd "${0%/*}"
+mkdir -p ../bin
+rm -f $executable
+gcc -g -std=c2x -Wall -Wextra -o $executable ../src/nerd_utils.c ../src/literal.c ../src/scene.c\
+ ../src/context.c ../src/rule.c ../src/rule_queue.c ../src/queue.c ../src/rule_hypergraph.c\
+ ../src/knowledge_base.c ../src/inference_engine.c ../test/inference_engine.c\
+ -lcheck -lm -pthread -L../libs/pcg-c-0.94/src -lpcg_random -I../libs/pcg-c-0.94/include/
+if $executable; then
+    printf "\n"
+    valgrind --leak-check=full $executable
+fi
@@ -0,0 +1,11 @@
+#! /bin/bash
+executable=../bin/materialize
+set -x
+cd "${0%/*}"
+mkdir -p ../bin
+rm -f $executable
+gcc -std=gnu2x -Wall -Wextra -o $executable ../src/nerd_utils.c ../src/literal.c ../src/scene.c\
+ ../src/context.c ../src/rule.c ../src/rule_queue.c ../src/queue.c ../src/rule_hypergraph.c\
+ ../src/knowledge_base.c\
+ ../src/sensor.c ../src/nerd_helper.c ../src/nerd.c ../src/nerd_journal.c ../src/materialize.c -lm\
+ -pthread -L../libs/pcg-c-0.94/src -lpcg_random -I../libs/pcg-c-0.94/include/
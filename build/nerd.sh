@@ -6,9 +6,9 @@ mkdir -p ../bin
 rm -f $executable
 gcc -std=c2x -g -Wall -Wextra -o $executable ../src/nerd_utils.c ../src/literal.c ../src/scene.c\
  ../src/context.c ../src/rule.c ../src/rule_queue.c ../src/queue.c ../src/rule_hypergraph.c\
- ../libs/prb.o ../src/knowledge_base.c ../src/sensor.c ../src/nerd_helper.c ../src/nerd.c\
- ../test/helper/rule_queue.c ../test/nerd.c -lcheck -lm -L../libs/pcg-c-0.94/src -lpcg_random\
- -I../libs/pcg-c-0.94/include/ -I../libs/avl-2.0.3/
+ ../src/knowledge_base.c ../src/sensor.c ../src/nerd_helper.c ../src/nerd.c\
+ ../test/helper/rule_queue.c ../test/nerd.c -lcheck -lm -pthread -L../libs/pcg-c-0.94/src -lpcg_random\
+ -I../libs/pcg-c-0.94/include/
 cd ../src/
 if $executable; then
     printf "\n"
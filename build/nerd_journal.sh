@@ -0,0 +1,17 @@
+#! /bin/bash
+executable=../bin/nerd_journal
+set -x
+cd "${0%/*}"
+mkdir -p ../bin
+rm -f $executable
+gcc -std=c2x -g -Wall -Wextra -o $executable ../src/nerd_utils.c ../src/literal.c ../src/scene.c\
+ ../src/context.c ../src/rule.c ../src/rule_queue.c ../src/queue.c ../src/rule_hypergraph.c\
+ ../src/knowledge_base.c\
+ ../src/sensor.c ../src/nerd_helper.c ../src/inference_engine.c ../src/nerd.c ../src/nerd_journal.c\
+ ../test/helper/rule_queue.c ../test/nerd_journal.c\
+ -lcheck -lm -pthread -L../libs/pcg-c-0.94/src -lpcg_random -I../libs/pcg-c-0.94/include/
+cd ../src/
+if $executable; then
+    printf "\n"
+    valgrind --leak-check=full $executable
+fi
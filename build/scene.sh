@@ -5,8 +5,7 @@ cd "${0%/*}"
 mkdir -p ../bin
 rm -f $executable
 gcc -g -std=c2x -Wall -Wextra -o $executable ../src/nerd_utils.c ../src/literal.c ../src/scene.c\
- ../test/scene.c -lcheck -L../libs/pcg-c-0.94/src -lpcg_random -I../libs/pcg-c-0.94/include/\
- -I../libs/avl-2.0.3/
+ ../test/scene.c -lcheck -pthread -L../libs/pcg-c-0.94/src -lpcg_random -I../libs/pcg-c-0.94/include/
 if $executable; then
     printf "\n"
     valgrind --leak-check=full $executable
@@ -0,0 +1,17 @@
+#! /bin/bash
+executable=../bin/snapshot_writer
+set -x
+cd "${0%/*}"
+mkdir -p ../bin
+rm -f $executable
+gcc -std=c2x -g -Wall -Wextra -o $executable ../src/nerd_utils.c ../src/literal.c ../src/scene.c\
+ ../src/context.c ../src/rule.c ../src/rule_queue.c ../src/queue.c ../src/rule_hypergraph.c\
+ ../src/knowledge_base.c\
+ ../src/sensor.c ../src/nerd_helper.c ../src/inference_engine.c ../src/nerd.c ../src/snapshot_writer.c\
+ ../test/snapshot_writer.c\
+ -lcheck -pthread -lm -L../libs/pcg-c-0.94/src -lpcg_random -I../libs/pcg-c-0.94/include/
+cd ../src/
+if $executable; then
+    printf "\n"
+    valgrind --leak-check=full $executable
+fi
@@ -1,43 +1,41 @@
 const prudens = require('./prudens');
 const parsers = require('./parsers');
 const fs = require('fs');
+const readline = require('readline');
 
-let filepath = ".temp";
-let constraints = "";
-let save_inferring_rules = false;
-
-
-switch (process.argv.length) {
-    case 5:
-        save_inferring_rules = process.argv[4] == "s=1";
-    case 4:
-        if (process.argv[3].indexOf("s=") != -1) {
-            save_inferring_rules = process.argv[3] == "s=1";
-        } else {
-            constraints = process.argv[3];
-        }
-    case 3:
-        filepath = process.argv[2];
-        break;
-    default:
-        break;
-}
+/*
+ * Long-lived worker, started once by nerd_helper.c. Requests are read line by
+ * line from stdin:
+ *   K <kb json>      replaces the cached knowledge base.
+ *   I <n> <s>        followed by n context json lines. For each context, a line
+ *                    with the inferred literals is written to stdout. If s is 1,
+ *                    the byte length of the inferring rules and the rules
+ *                    themselves follow.
+ * The worker exits when stdin is closed.
+ */
 
-try {
-    let data = fs.readFileSync(filepath, 'utf-8');
-    const passed_data = data.toString().trim().split("\n");
-    let kB = JSON.parse(passed_data[0]);
+let constraints = new Map();
+if (process.argv.length > 2) {
     try {
-        let constraints_data = fs.readFileSync(constraints, 'utf-8').toString().trim();
-        kB["constraints"] = parsers.parseConstraints(constraints_data);
+        const constraints_data = fs.readFileSync(process.argv[2], 'utf-8').toString().trim();
+        constraints = parsers.parseConstraints(constraints_data);
     } catch (err) {
-        kB["constraints"] = new Map();
+        constraints = new Map();
     }
+}
+
+let kB = {"type": "output", "kb": [], "code": "", "imports": "", "warnings": [], "customPriorities": [],
+    "constraints": constraints};
+let pending = 0;
+let save_inferring_rules = false;
+let contexts = [];
 
+function infer() {
     const inferring_rules = Array();
+    let output = "";
 
-    for (let i = 1; i < passed_data.length; ++i) {
-        const result = prudens.forwardChaining(kB, JSON.parse(passed_data[i])["context"]);
+    for (let i = 1; i <= contexts.length; ++i) {
+        const result = prudens.forwardChaining(kB, contexts[i - 1], prudens.linearPriorities, false);
 
         const inferred = new Set();
 
@@ -48,26 +46,43 @@ try {
                 inferred.add(`${key}`);
             }
         }
-        inferring_rules.push(`${i + 1}: ${parsers.graphToString(result.graph)}`);
-
-        try {
-            fs.appendFileSync(`${filepath}_1`, `${Array.from(inferred.values()).join(" ")}\n`);
-        } catch (err) {
-            return -1;
+        if (save_inferring_rules) {
+            inferring_rules.push(`${i + 1}: ${parsers.graphToString(result.graph)}`);
         }
-
+        output += `${Array.from(inferred.values()).join(" ")}\n`;
     }
 
     if (save_inferring_rules) {
-        fs.appendFileSync(`${filepath}_1`, `${inferring_rules.join("\n\n")}`);
+        const rules = inferring_rules.join("\n\n");
+        output += `${Buffer.byteLength(rules)}\n${rules}`;
     }
+    process.stdout.write(output);
+    contexts = [];
+}
 
-    try {
-        fs.renameSync(`${filepath}_1`, filepath);
-    } catch (err) {
-        return -1;
+readline.createInterface({input: process.stdin, terminal: false}).on('line', (line) => {
+    if (pending > 0) {
+        contexts.push(JSON.parse(line)["context"]);
+        if (--pending === 0) {
+            infer();
+        }
+        return;
     }
-} catch (err) {
-    console.log(`File '${filepath}' not found.`);
-    return -1;
-}
+
+    const request = line.split(" ", 3);
+    switch (request[0]) {
+        case "K":
+            kB = JSON.parse(line.substring(2));
+            kB["constraints"] = constraints;
+            break;
+        case "I":
+            pending = parseInt(request[1]);
+            save_inferring_rules = request[2] === "1";
+            if (pending === 0) {
+                infer();
+            }
+            break;
+        default:
+            break;
+    }
+});
@@ -0,0 +1,50 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "context.h"
+#include "sensor.h"
+
+int main(int argc, char *argv[]) {
+  if ((argc != 4) && (argc != 5)) {
+    printf("Dataset filepath, labels filepath and the filepath of the encoded "
+           "dataset (" SENSOR_ENCODED_EXTENSION ") are required, and optionally "
+           "if the dataset has a header (boolean). Default: true.\n");
+    return EXIT_FAILURE;
+  }
+
+  bool has_header = true;
+  if ((argc == 5) && (strcmp(argv[4], "true") != 0)) {
+    has_header = false;
+  }
+
+  char delimiter = ' ';
+  if (strstr(argv[1], ".csv")) {
+    delimiter = ',';
+  }
+
+  Sensor *dataset =
+      sensor_constructor_from_file(argv[1], delimiter, false, has_header);
+  if (!dataset) {
+    printf("Dataset '%s' is not valid.\n", argv[1]);
+    return EXIT_FAILURE;
+  }
+
+  // The labels are read as main reads them, using the dataset's delimiter.
+  Context *labels;
+  sensor_read_labels(argv[2], delimiter, &labels);
+  if (!labels) {
+    printf("Labels file cannot be accessed!\n");
+    sensor_destructor(&dataset);
+    return EXIT_FAILURE;
+  }
+
+  const int error_code = sensor_encode(dataset, labels, argv[3]);
+  context_destructor(&labels);
+  sensor_destructor(&dataset);
+  if (error_code != 0) {
+    printf("Could not write '%s'.\n", argv[3]);
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -1,5 +1,7 @@
 #include <ctype.h>
+#include <dirent.h>
 #include <errno.h>
+#include <glob.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -8,8 +10,10 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include "inference_engine.h"
 #include "metrics.h"
 #include "nerd_helper.h"
+#include "nerd_journal.h"
 #include "nerd_utils.h"
 
 #define BUFFER_SIZE 256
@@ -20,11 +24,411 @@
 #define TRAIN ".train_set"
 #define TEST ".test_set"
 
+/**
+ * @brief A snapshot of a Nerd to be evaluated.
+ */
+typedef struct Snapshot {
+  char *path;
+  size_t iteration, instance;
+} Snapshot;
+
+/**
+ * @brief Orders the Snapshots by their iteration and then by their instance.
+ */
+static int _compare_snapshots(const void *a, const void *b) {
+  const Snapshot *s1 = (const Snapshot *)a, *s2 = (const Snapshot *)b;
+  if (s1->iteration != s2->iteration) {
+    return (s1->iteration < s2->iteration) ? -1 : 1;
+  }
+  if (s1->instance != s2->instance) {
+    return (s1->instance < s2->instance) ? -1 : 1;
+  }
+  return 0;
+}
+
+/**
+ * @brief Finds the iteration and the instance of a snapshot from its name.
+ *
+ * @return true if the name has the format iteration_X-instance_Y.nd (or .ndb),
+ * false otherwise.
+ */
+static bool _snapshot_name_parse(const char *const name,
+                                 size_t *const iteration,
+                                 size_t *const instance) {
+  int length = 0;
+  if (sscanf(name, "iteration_%zu-instance_%zu%n", iteration, instance,
+             &length) != 2) {
+    return false;
+  }
+  return (strcmp(name + length, ".nd") == 0) ||
+         (strcmp(name + length, ".ndb") == 0);
+}
+
+/**
+ * @brief Gives the size of the directory part of the given path, including the
+ * last '/'.
+ */
+static size_t _directory_size(const char *const path) {
+  const char *last_slash = strrchr(path, '/');
+  return last_slash ? (size_t)(last_slash - path + 1) : 0;
+}
+
+/**
+ * @brief Joins the given directory (of the given size) with a file name.
+ *
+ * @return A new char *. Use free to deallocate.
+ */
+static char *_directory_join(const char *const directory,
+                             const size_t directory_size,
+                             const char *const name) {
+  char *path =
+      (char *)malloc((directory_size + strlen(name) + 1) * sizeof(char));
+  memcpy(path, directory, directory_size);
+  strcpy(path + directory_size, name);
+  return path;
+}
+
+/**
+ * @brief Appends a Snapshot to the given array.
+ *
+ * @return true if the Snapshot was appended, false if its name is not valid.
+ */
+static bool _add_snapshot(Snapshot **const snapshots, size_t *const total,
+                          const char *const directory,
+                          const size_t directory_size, const char *const name) {
+  Snapshot snapshot;
+  if (!_snapshot_name_parse(name, &(snapshot.iteration),
+                            &(snapshot.instance))) {
+    return false;
+  }
+  snapshot.path = _directory_join(directory, directory_size, name);
+  *snapshots = (Snapshot *)realloc(*snapshots, (*total + 1) * sizeof(Snapshot));
+  (*snapshots)[(*total)++] = snapshot;
+  return true;
+}
+
+/**
+ * @brief Appends the snapshots of the given directory that are in the range
+ * [first, last]. If the directory has a journal, its records are used, named as
+ * materialize names them. Otherwise, the .nd and .ndb files of the directory
+ * are used.
+ */
+static void _add_snapshots_in_range(Snapshot **const snapshots,
+                                    size_t *const total,
+                                    const char *const directory,
+                                    const size_t directory_size,
+                                    const Snapshot *const first,
+                                    const Snapshot *const last) {
+  char *path =
+      _directory_join(directory, directory_size, NERD_JOURNAL_FILE_NAME);
+  NerdJournalReader *reader = nerd_journal_reader_constructor(path);
+  Snapshot current;
+
+  if (reader) {
+    size_t max_iteration = 0, max_instance = 0;
+    while (nerd_journal_reader_next(reader) == 0) {
+      if (reader->iteration > max_iteration) {
+        max_iteration = reader->iteration;
+      }
+      if (reader->instance > max_instance) {
+        max_instance = reader->instance;
+      }
+    }
+    nerd_journal_reader_destructor(&reader);
+
+    const int iteration_width = snprintf(NULL, 0, "%zu", max_iteration),
+              instance_width = snprintf(NULL, 0, "%zu", max_instance);
+    char *name = (char *)calloc(
+        snprintf(NULL, 0, "iteration_%0*zu-instance_%0*zu.nd", iteration_width,
+                 max_iteration, instance_width, max_instance) +
+            1,
+        sizeof(char));
+
+    reader = nerd_journal_reader_constructor(path);
+    while (nerd_journal_reader_next(reader) == 0) {
+      current.iteration = reader->iteration;
+      current.instance = reader->instance;
+      if ((current.iteration == 0) ||
+          (_compare_snapshots(&current, first) < 0) ||
+          (_compare_snapshots(&current, last) > 0)) {
+        continue;
+      }
+      sprintf(name, "iteration_%0*zu-instance_%0*zu.nd", iteration_width,
+              current.iteration, instance_width, current.instance);
+      _add_snapshot(snapshots, total, directory, directory_size, name);
+    }
+    nerd_journal_reader_destructor(&reader);
+    free(name);
+    free(path);
+    return;
+  }
+  free(path);
+
+  path = _directory_join(directory, directory_size, directory_size ? "" : ".");
+  DIR *opened_directory = opendir(path);
+  free(path);
+  if (!opened_directory) {
+    return;
+  }
+
+  struct dirent *entry;
+  while ((entry = readdir(opened_directory))) {
+    if (_snapshot_name_parse(entry->d_name, &(current.iteration),
+                             &(current.instance)) &&
+        (_compare_snapshots(&current, first) >= 0) &&
+        (_compare_snapshots(&current, last) <= 0)) {
+      _add_snapshot(snapshots, total, directory, directory_size,
+                    entry->d_name);
+    }
+  }
+  closedir(opened_directory);
+}
+
+/**
+ * @brief Finds the snapshots to be evaluated. They can be given as a single
+ * snapshot, a comma separated list of snapshots, a glob pattern (e.g.
+ * dir/iteration_1-instance_*.nd) or a range of snapshots (e.g.
+ * dir/iteration_1-instance_01.nd..iteration_2-instance_50.nd), which includes
+ * every saved or journaled snapshot between the two. All the snapshots should
+ * be in the same directory.
+ *
+ * @param argument The snapshots as given by the user.
+ * @param snapshots A Snapshot ** (reference to a Snapshot *) to save the
+ * Snapshots, ordered by their iteration and instance.
+ * @param total A size_t * to save the number of Snapshots.
+ *
+ * @return 0 if at least one Snapshot was found, -1 if a snapshot has a bad name
+ * or no snapshot was found, and -2 if the snapshots are not in the same
+ * directory.
+ */
+static int _find_snapshots(const char *const argument,
+                           Snapshot **const snapshots, size_t *const total) {
+  *snapshots = NULL;
+  *total = 0;
+
+  const char *range = strstr(argument, "..iteration_");
+  size_t i;
+  if (range) {
+    char *first_path = (char *)calloc(range - argument + 1, sizeof(char));
+    memcpy(first_path, argument, range - argument);
+    const size_t directory_size = _directory_size(first_path);
+    Snapshot first, last;
+    if (_snapshot_name_parse(first_path + directory_size, &(first.iteration),
+                             &(first.instance)) &&
+        _snapshot_name_parse(range + 2, &(last.iteration), &(last.instance))) {
+      _add_snapshots_in_range(snapshots, total, first_path, directory_size,
+                              &first, &last);
+    }
+    free(first_path);
+  } else if (strpbrk(argument, "*?[")) {
+    glob_t matches;
+    if (glob(argument, 0, NULL, &matches) == 0) {
+      for (i = 0; i < matches.gl_pathc; ++i) {
+        const char *path = matches.gl_pathv[i];
+        const size_t directory_size = _directory_size(path);
+        _add_snapshot(snapshots, total, path, directory_size,
+                      path + directory_size);
+      }
+    }
+    globfree(&matches);
+  } else {
+    char *paths = strdup(argument), *path, *state = NULL;
+    for (path = strtok_r(paths, ",", &state); path;
+         path = strtok_r(NULL, ",", &state)) {
+      const size_t directory_size = _directory_size(path);
+      if (!_add_snapshot(snapshots, total, path, directory_size,
+                         path + directory_size)) {
+        free(paths);
+        goto failed;
+      }
+    }
+    free(paths);
+  }
+
+  if (*total == 0) {
+    return -1;
+  }
+
+  const size_t directory_size = _directory_size((*snapshots)[0].path);
+  for (i = 1; i < *total; ++i) {
+    if ((_directory_size((*snapshots)[i].path) != directory_size) ||
+        (strncmp((*snapshots)[i].path, (*snapshots)[0].path, directory_size) !=
+         0)) {
+      for (i = 0; i < *total; ++i) {
+        free((*snapshots)[i].path);
+      }
+      safe_free(*snapshots);
+      *total = 0;
+      return -2;
+    }
+  }
+
+  qsort(*snapshots, *total, sizeof(Snapshot), _compare_snapshots);
+  return 0;
+
+failed:
+  for (i = 0; i < *total; ++i) {
+    free((*snapshots)[i].path);
+  }
+  safe_free(*snapshots);
+  *total = 0;
+  return -1;
+}
+
+/**
+ * @brief Loads the Nerd of a Snapshot. If its file does not exist, the Nerd is
+ * replayed from the journal of its directory. The journal is only replayed
+ * forwards, so the Snapshots should be loaded in order.
+ *
+ * @param reader A NerdJournalReader ** (reference to a NerdJournalReader *) to
+ * be used across the Snapshots. It is constructed when it is first needed. Use
+ * nerd_journal_reader_destructor to deallocate.
+ *
+ * @return A new Nerd *, or NULL if the Snapshot cannot be loaded.
+ */
+static Nerd *_load_snapshot(const Snapshot *const snapshot,
+                            NerdJournalReader **const reader,
+                            const bool use_back_chaining) {
+  Nerd *nerd = nerd_constructor_from_file(snapshot->path, use_back_chaining);
+  if (nerd) {
+    return nerd;
+  }
+
+  Snapshot current = {NULL, 0, 0};
+  if (*reader) {
+    current.iteration = (*reader)->iteration;
+    current.instance = (*reader)->instance;
+  }
+  if (!(*reader) || (_compare_snapshots(&current, snapshot) > 0)) {
+    nerd_journal_reader_destructor(reader);
+    char *path =
+        _directory_join(snapshot->path, _directory_size(snapshot->path),
+                        NERD_JOURNAL_FILE_NAME);
+    *reader = nerd_journal_reader_constructor(path);
+    free(path);
+    if (!(*reader)) {
+      return NULL;
+    }
+    current.iteration = current.instance = 0;
+  }
+
+  while (_compare_snapshots(&current, snapshot) < 0) {
+    if (nerd_journal_reader_next(*reader) != 0) {
+      return NULL;
+    }
+    current.iteration = (*reader)->iteration;
+    current.instance = (*reader)->instance;
+  }
+
+  if (_compare_snapshots(&current, snapshot) == 0) {
+    return nerd_journal_reader_to_nerd(*reader, use_back_chaining);
+  }
+  return NULL;
+}
+
+/**
+ * @brief Evaluates the Nerd of a Snapshot over the training and the testing
+ * datasets, and saves the inferences and the inferring rules in the Snapshot's
+ * directory, inside the result directory. If the caches of the datasets are
+ * given, the datasets are inferred incrementally with them.
+ *
+ * @return true if the result files were created, false otherwise.
+ */
+static bool _evaluate_snapshot(
+    const Nerd *const nerd, const Snapshot *const snapshot,
+    const char *const result_directory,
+    int (*inference_engine_batch)(const KnowledgeBase *const, const size_t,
+                                  Scene **restrict, Scene ***const,
+                                  char **const),
+    NativeInferenceCache *const *const caches, Sensor *const *const datasets,
+    const Context *const labels, const bool partial_observation,
+    const unsigned int threads) {
+  const char *const snapshot_name =
+      snapshot->path + _directory_size(snapshot->path);
+  char *instance_directory = (char *)calloc(
+      (strlen(result_directory) + strlen(snapshot_name) + 1 + 1),
+      sizeof(char));
+  sprintf(instance_directory, "%s%s/", result_directory, snapshot_name);
+
+  if (mkdir(instance_directory, 0740) != 0) {
+    if (errno != EEXIST) {
+      free(instance_directory);
+      return false;
+    }
+  }
+
+  const char *const names[TOTAL_EVALUATIONS * 2] = {
+      "train.txt", "test.txt", "train_rules.txt", "test_rules.txt"};
+  FILE *files[TOTAL_EVALUATIONS * 2];
+  char *path;
+  unsigned int i, j, k;
+  umask(S_IROTH | S_IWOTH | S_IWGRP);
+  for (k = 0; k < TOTAL_EVALUATIONS * 2; ++k) {
+    path = _directory_join(instance_directory, strlen(instance_directory),
+                           names[k]);
+    files[k] = fopen(path, "wb");
+    free(path);
+    if (!files[k]) {
+      while (k > 0) {
+        fclose(files[--k]);
+      }
+      free(instance_directory);
+      return false;
+    }
+  }
+  free(instance_directory);
+
+  size_t total_observations;
+  Scene **result = NULL;
+  char *rules = NULL, *str;
+  int error;
+  for (k = 0; k < TOTAL_EVALUATIONS; ++k) {
+    if (caches) {
+      error = evaluate_labels_incremental(
+          nerd, caches[k], datasets[k], threads, labels, NULL, NULL,
+          &total_observations, NULL, &result, &rules, partial_observation,
+          NULL);
+    } else {
+      error = evaluate_labels(nerd, inference_engine_batch, datasets[k],
+                              threads, labels, NULL, NULL, &total_observations,
+                              NULL, &result, &rules, partial_observation);
+    }
+    if (error == 0) {
+      for (i = 0; i < total_observations; ++i) {
+        for (j = 0; j < result[i]->size; ++j) {
+          if (j != 0) {
+            fprintf(files[k], " ");
+          }
+          str = literal_to_string(result[i]->literals[j]);
+          fprintf(files[k], "%s", str);
+          safe_free(str);
+        }
+        fprintf(files[k], "\n");
+        scene_destructor(&(result[i]));
+      }
+    }
+    fprintf(files[TOTAL_EVALUATIONS + k], "%s\n", rules);
+
+    safe_free(rules);
+    safe_free(result);
+  }
+
+  for (k = 0; k < TOTAL_EVALUATIONS * 2; ++k) {
+    fclose(files[k]);
+  }
+  return true;
+}
+
 int main(int argc, char *argv[]) {
   if ((argc != 4) && (argc != 6)) {
-    printf("Nerd info filepath, nerd file (.nd) and labels file required, and "
+    printf("Nerd info filepath, nerd file (.nd or .ndb) and labels file "
+           "required, and "
            "optionally a"
-           "testing datset and if it has a header (boolean).\n");
+           "testing datset and if it has a header (boolean). Many nerd files "
+           "of the same directory can be evaluated at once, given as a comma "
+           "separated list, a glob pattern (e.g. 'dir/iteration_1-*.nd') or a "
+           "range (e.g. "
+           "dir/iteration_1-instance_01.nd..iteration_2-instance_50.nd).\n");
     return EXIT_FAILURE;
   }
 
@@ -64,7 +468,7 @@ int main(int argc, char *argv[]) {
   size_t state_seed, seq_seed;
   char training_delimiter = ' ';
   bool use_back_chaining = true, training_has_header = false, entire = false,
-       partial_observation = false;
+       partial_observation = false, use_native_inference = false;
   char *constraints_file = NULL, *dataset_value = NULL;
   float testing_ratio = 0.2;
 
@@ -137,6 +541,10 @@ int main(int argc, char *argv[]) {
             if (strcmp(true_value, "true") == 0) {
               entire = true;
             }
+          } else if (strcmp(option, "engine") == 0) {
+            if (strcmp(true_value, "native") == 0) {
+              use_native_inference = true;
+            }
           }
           break;
         case 'r':
@@ -181,58 +589,50 @@ int main(int argc, char *argv[]) {
   fclose(info_file);
   free(value_buffer);
 
-  Nerd *nerd = NULL;
-  unsigned int iteration_number, instance_number;
-  if (strstr(argv[2], ".nd")) {
-    nerd = nerd_constructor_from_file(argv[2], use_back_chaining);
-    if (!(nerd &&
-          (sscanf(strstr(argv[2], "iteration_"), "iteration_%u-instance_%u.nd",
-                  &iteration_number, &instance_number) == 2))) {
-      nerd_destructor(&nerd);
+  Snapshot *snapshots = NULL;
+  size_t total_snapshots = 0, k;
+  const int snapshots_error =
+      _find_snapshots(argv[2], &snapshots, &total_snapshots);
+  if (snapshots_error != 0) {
+    if (dataset) {
       fclose(dataset);
-      printf("Nerd file has a bad format.\n");
-      return EXIT_FAILURE;
     }
-  } else {
-    printf("Please provide a .nd file\n");
+    if (snapshots_error == -2) {
+      printf("The snapshots should be in the same directory.\n");
+    } else {
+      printf("Please provide a .nd or .ndb file, a list, a glob pattern or a "
+             "range of them.\n");
+    }
     return EXIT_FAILURE;
   }
 
-  FILE *labels_file;
-  Context *labels;
-  Literal *l;
-  if ((labels_file = fopen(argv[3], "rb"))) {
-    labels = context_constructor(true);
-    int c;
-    char buffer[BUFFER_SIZE];
-    memset(buffer, 0, BUFFER_SIZE);
-    char labels_delimiter = ' ';
-    if (strstr(argv[3], ".csv")) {
-      labels_delimiter = ',';
+  // The first snapshot is loaded beforehand, to fail before any evaluation.
+  NerdJournalReader *reader = NULL;
+  Nerd *nerd = _load_snapshot(&(snapshots[0]), &reader, use_back_chaining);
+  if (!nerd) {
+    nerd_journal_reader_destructor(&reader);
+    for (k = 0; k < total_snapshots; ++k) {
+      free(snapshots[k].path);
     }
-
-    while ((c = fgetc(labels_file)) != EOF) {
-      if ((c == labels_delimiter) || c == '\n') {
-        l = literal_constructor_from_string(buffer);
-        context_add_literal(labels, &l);
-        memset(buffer, 0, strlen(buffer));
-        i = 0;
-      } else {
-        buffer[i++] = c;
-      }
+    free(snapshots);
+    if (dataset) {
+      fclose(dataset);
     }
+    printf("Nerd file has a bad format.\n");
+    return EXIT_FAILURE;
+  }
+  const size_t iteration_number = snapshots[0].iteration;
 
-    fclose(labels_file);
-  } else {
+  // An encoded dataset keeps its labels, so it can be given as the labels file.
+  Context *labels;
+  sensor_read_labels(argv[3], strstr(argv[3], ".csv") ? ',' : ' ', &labels);
+  if (!labels) {
     printf("Labels file cannot be accessed!\n");
     return EXIT_FAILURE;
   }
 
-  char *last_slash = strrchr(argv[2], '/') + 1;
-
-  char *test_directory =
-      (char *)calloc(((last_slash - argv[2]) + 1), sizeof(char));
-  memcpy(test_directory, argv[2], last_slash - argv[2]);
+  char *test_directory = _directory_join(
+      snapshots[0].path, _directory_size(snapshots[0].path), "");
 
   char *result_directory = (char *)calloc(
       (strlen(test_directory) + strlen(RESULT_DIR) + 1), sizeof(char));
@@ -250,130 +650,119 @@ int main(int argc, char *argv[]) {
   pcg32_random_t seed;
   pcg32_srandom_r(&seed, state_seed, seq_seed);
 
-  prudensjs_settings_constructor(argv[0], result_directory, constraints_file,
-                                 strstr(argv[2], "iteration"));
+  int (*inference_engine_batch)(const KnowledgeBase *const, const size_t,
+                                Scene **restrict, Scene ***const,
+                                char **const) = NULL;
+  // Only the native inference can be used by many threads at once.
+  unsigned int threads = 1;
+  if (use_native_inference) {
+    native_settings_constructor(constraints_file);
+    inference_engine_batch = native_inference_batch;
+    const long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    if (processors > 1) {
+      threads = processors;
+    }
+  } else {
+    prudensjs_settings_constructor(argv[0], constraints_file);
+    inference_engine_batch = prudensjs_inference_batch;
+  }
 
   char *train_path = NULL, *test_path = NULL;
   if (entire) {
     train_path = dataset_value;
     test_path = testing_dataset_path;
   } else {
-    train_path = (char *)calloc(
-        snprintf(NULL, 0, "%s%s%u", result_directory, TRAIN, iteration_number) +
-            1,
-        sizeof(char));
-    sprintf(train_path, "%s%s%u", result_directory, TRAIN, iteration_number);
-
+    train_path = (char *)calloc(snprintf(NULL, 0, "%s%s%zu", result_directory,
+                                         TRAIN, iteration_number) +
+                                    1,
+                                sizeof(char));
+    sprintf(train_path, "%s%s%zu", result_directory, TRAIN, iteration_number);
+
+    Sensor *full_dataset = sensor_constructor_from_file(
+        dataset_value, training_delimiter, false, training_has_header);
+    sensor_save_index(full_dataset);
     if (testing_dataset_path) {
       test_path = testing_dataset_path;
 
-      train_test_split(dataset, training_has_header, testing_ratio, &seed,
-                       train_path, NULL, NULL, NULL);
+      train_test_split(full_dataset, testing_ratio, &seed, train_path, NULL,
+                       NULL, NULL);
     } else {
-      test_path = (char *)calloc(snprintf(NULL, 0, "%s%s%u", result_directory,
+      test_path = (char *)calloc(snprintf(NULL, 0, "%s%s%zu", result_directory,
                                           TEST, iteration_number) +
                                      1,
                                  sizeof(char));
-      sprintf(test_path, "%s%s%u", result_directory, TEST, iteration_number);
+      sprintf(test_path, "%s%s%zu", result_directory, TEST, iteration_number);
 
-      train_test_split(dataset, training_has_header, testing_ratio, &seed,
-                       train_path, test_path, NULL, NULL);
+      train_test_split(full_dataset, testing_ratio, &seed, train_path,
+                       test_path, NULL, NULL);
       testing_delimiter = training_delimiter;
       testing_has_header = training_has_header;
     }
+    sensor_destructor(&full_dataset);
 
     free(dataset_value);
   }
   fclose(dataset);
 
-  char *instance_directory = (char *)calloc(
-      (strlen(result_directory) + strlen(last_slash) + 1 + 1), sizeof(char));
-  sprintf(instance_directory, "%s%s/", result_directory, last_slash);
+  // The datasets are reused and parsed once, when many snapshots are evaluated.
+  const bool many_snapshots = total_snapshots > 1;
+  Sensor *datasets[TOTAL_EVALUATIONS] = {
+      sensor_constructor_from_file(train_path, training_delimiter,
+                                   many_snapshots, training_has_header),
+      sensor_constructor_from_file(test_path, testing_delimiter,
+                                   many_snapshots, testing_has_header)};
+  char *paths[TOTAL_EVALUATIONS] = {train_path, test_path};
+  // The native inference of consecutive snapshots is incremental, as they
+  // usually differ by a few Rules.
+  NativeInferenceCache *caches[TOTAL_EVALUATIONS] = {NULL, NULL};
+  if (many_snapshots) {
+    for (k = 0; k < TOTAL_EVALUATIONS; ++k) {
+      sensor_cache(datasets[k]);
+      if (use_native_inference) {
+        caches[k] = native_inference_cache_constructor();
+      }
+    }
+  }
 
-  if (mkdir(instance_directory, 0740) != 0) {
-    if (errno != EEXIST) {
-      free(result_directory);
-      free(instance_directory);
-      return EXIT_FAILURE;
+  int exit_code = EXIT_SUCCESS;
+  for (k = 0; k < total_snapshots; ++k) {
+    if (!nerd) {
+      nerd = _load_snapshot(&(snapshots[k]), &reader, use_back_chaining);
+    }
+    if (!nerd) {
+      printf("Snapshot '%s' cannot be loaded.\n", snapshots[k].path);
+      exit_code = EXIT_FAILURE;
+      break;
+    }
+    if (!_evaluate_snapshot(nerd, &(snapshots[k]), result_directory,
+                            inference_engine_batch,
+                            caches[0] ? caches : NULL, datasets, labels,
+                            partial_observation, threads)) {
+      exit_code = EXIT_FAILURE;
+      break;
     }
+    nerd_destructor(&nerd);
   }
   free(result_directory);
 
-  char *train_results_name = (char *)calloc(
-      strlen(instance_directory) + strlen("train.txt") + 1, sizeof(char));
-  sprintf(train_results_name, "%strain.txt", instance_directory);
-
-  char *test_results_name = (char *)calloc(
-      strlen(instance_directory) + strlen("test.txt") + 1, sizeof(char));
-  sprintf(test_results_name, "%stest.txt", instance_directory);
-
-  char *train_results_rules_name = (char *)calloc(
-      strlen(instance_directory) + strlen("train_rules.txt") + 1, sizeof(char));
-  sprintf(train_results_rules_name, "%strain_rules.txt", instance_directory);
-
-  char *test_results_rules_name = (char *)calloc(
-      strlen(instance_directory) + strlen("test_rules.txt") + 1, sizeof(char));
-  sprintf(test_results_rules_name, "%stest_rules.txt", instance_directory);
-
-  free(instance_directory);
-
-  umask(S_IROTH | S_IWOTH | S_IWGRP);
-  FILE *train_results = fopen(train_results_name, "wb"),
-       *test_results = fopen(test_results_name, "wb"),
-       *train_rules = fopen(train_results_rules_name, "wb"),
-       *test_rules = fopen(test_results_rules_name, "wb");
-  free(train_results_name);
-  free(test_results_name);
-  free(train_results_rules_name);
-  free(test_results_rules_name);
-
-  size_t total_observations;
-  Scene **result = NULL;
-  char *str;
-  unsigned int j, k;
-  Sensor *training_dataset = sensor_constructor_from_file(
-             train_path, training_delimiter, false, training_has_header),
-         *testing_dataset = sensor_constructor_from_file(
-             test_path, testing_delimiter, false, testing_has_header),
-         *datasets[TOTAL_EVALUATIONS] = {training_dataset, testing_dataset};
-  char *paths[TOTAL_EVALUATIONS] = {train_path, test_path};
-  FILE *files[TOTAL_EVALUATIONS] = {train_results, test_results};
-  FILE *rule_files[TOTAL_EVALUATIONS] = {train_rules, test_rules};
-
-  char *rules = NULL;
   for (k = 0; k < TOTAL_EVALUATIONS; ++k) {
-    if (evaluate_labels(nerd, prudensjs_inference_batch, datasets[k], labels,
-                        NULL, NULL, &total_observations, NULL, &result, &rules,
-                        partial_observation) == 0) {
-      for (i = 0; i < total_observations; ++i) {
-        for (j = 0; j < result[i]->size; ++j) {
-          if (j != 0) {
-            fprintf(files[k], " ");
-          }
-          str = literal_to_string(result[i]->literals[j]);
-          fprintf(files[k], "%s", str);
-          safe_free(str);
-        }
-        fprintf(files[k], "\n");
-        scene_destructor(&(result[i]));
-      }
-    }
-    fprintf(rule_files[k], "%s\n", rules);
-
-    safe_free(rules);
-    safe_free(result);
-    fclose(files[k]);
-    fclose(rule_files[k]);
+    native_inference_cache_destructor(&(caches[k]));
     sensor_destructor(&(datasets[k]));
     if ((paths[k] != dataset_value) && (paths[k] != testing_dataset_path)) {
       remove(paths[k]);
     }
     free(paths[k]);
   }
+  for (k = 0; k < total_snapshots; ++k) {
+    free(snapshots[k].path);
+  }
+  free(snapshots);
+  nerd_journal_reader_destructor(&reader);
 
   free(constraints_file);
   prudensjs_settings_destructor();
+  native_settings_destructor();
   context_destructor(&labels);
   nerd_destructor(&nerd);
-  return EXIT_SUCCESS;
+  return exit_code;
 }
@@ -206,22 +206,26 @@ int main(int argc, char *argv[]) {
         strlen(test_dir) + strlen(TRAINING_FILE) + 2, sizeof(char));
     sprintf(training_set_path, "%s.%s", test_dir, TRAINING_FILE);
 
+    Sensor *full_dataset = sensor_constructor_from_file(
+        dataset_value, training_delimiter, false, training_has_header);
+    sensor_save_index(full_dataset);
     if (testing_dataset_path) {
       testing_set_path = testing_dataset_path;
 
-      train_test_split(dataset, training_has_header, testing_ratio, &rng,
-                       training_set_path, NULL, NULL, NULL);
+      train_test_split(full_dataset, testing_ratio, &rng, training_set_path,
+                       NULL, NULL, NULL);
     } else {
       testing_set_path = (char *)calloc(
           strlen(test_dir) + strlen(TESTING_FILE) + 2, sizeof(char));
       sprintf(testing_set_path, "%s.%s", test_dir, TESTING_FILE);
 
-      train_test_split(dataset, training_has_header, testing_ratio, &rng,
-                       training_set_path, testing_set_path, NULL, NULL);
+      train_test_split(full_dataset, testing_ratio, &rng, training_set_path,
+                       testing_set_path, NULL, NULL);
 
       testing_delimiter = training_delimiter;
       testing_has_header = training_has_header;
     }
+    sensor_destructor(&full_dataset);
 
     free(dataset_value);
   }
@@ -0,0 +1,1098 @@
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "inference_engine.h"
+#include "nerd_utils.h"
+
+#define CONTEXT_RULE -1
+#define MAX_ARRAY_INDEX 4294967295UL
+
+typedef struct NativeSettings {
+  Literal **constraints;
+  size_t number_of_constraints;
+} NativeSettings;
+
+NativeSettings_ptr global_native_settings = NULL;
+
+/**
+ * @brief The inference graph of a single forward chaining run. It maps each
+ * inferred (or observed) Literal to the indices of the active Rules that
+ * support it, in the order that the keys were (re-)inserted.
+ */
+typedef struct InferenceGraph {
+  Literal **literals;
+  IntVector **rules;
+  size_t size;
+} InferenceGraph;
+
+/**
+ * @brief The cached inference of a single observation. Its InferenceGraph owns
+ * its Literals, and the facts are all the Literals that were facts during its
+ * forward chaining. generation is the update of the cache that the graph's Rule
+ * indices refer to.
+ */
+typedef struct CachedInference {
+  InferenceGraph graph;
+  Scene *facts;
+  size_t generation;
+} CachedInference;
+
+/**
+ * @brief The state of the incremental native inference. It keeps a copy of the
+ * previous and the current active Rules, the current index of each previous
+ * Rule (or -1 if it has been changed), and the changed Rules, i.e., the Rules
+ * that were removed, added or whose relative priority is not the same anymore.
+ */
+struct NativeInferenceCache {
+  RuleQueue *previous, *current;
+  int *indices;
+  const Rule **changed;
+  size_t total_changed, generation, size;
+  CachedInference *inferences;
+};
+
+/**
+ * @brief Checks whether the given string contains only whitespace characters.
+ *
+ * @param string The string to be checked.
+ *
+ * @return true if it is empty or contains only whitespace, false otherwise.
+ */
+static bool _is_blank(const char *string) {
+  while (*string) {
+    if (!isspace(*string)) {
+      return false;
+    }
+    ++string;
+  }
+  return true;
+}
+
+/**
+ * @brief Parses a single constraint of the form 'Name :: literal1 # literal2'
+ * and adds it to the global_native_settings.
+ *
+ * @param constraint The constraint string, without its terminating ';'.
+ */
+static void _native_settings_add_constraint(const char *const constraint) {
+  const char *predicates = strstr(constraint, "::");
+  if (!predicates) {
+    return;
+  }
+  predicates += 2;
+
+  const char *hash = strchr(predicates, '#');
+  if (!hash) {
+    return;
+  }
+  const char *end = strchr(hash + 1, '#');
+  if (!end) {
+    end = hash + strlen(hash);
+  }
+
+  char *left = strndup(predicates, hash - predicates),
+       *right = strndup(hash + 1, end - (hash + 1));
+  if (!(_is_blank(left) || _is_blank(right))) {
+    global_native_settings->constraints = (Literal **)realloc(
+        global_native_settings->constraints,
+        2 * (global_native_settings->number_of_constraints + 1) *
+            sizeof(Literal *));
+    global_native_settings
+        ->constraints[2 * global_native_settings->number_of_constraints] =
+        literal_constructor_from_string(left);
+    global_native_settings
+        ->constraints[2 * global_native_settings->number_of_constraints + 1] =
+        literal_constructor_from_string(right);
+    ++global_native_settings->number_of_constraints;
+  }
+  free(left);
+  free(right);
+}
+
+/**
+ * @brief Constructs the global_native_settings used by the native inference
+ * engine. If they already exist, they will be replaced.
+ *
+ * @param constraints_file The path of a file containing incompatibility
+ * constraints in the Prudens-JS format ('Name :: literal1 # literal2;'). Each
+ * constraint makes the two Literals conflict with each other. If NULL, no
+ * constraints will be used.
+ *
+ * @return 0 if no errors occured, or 2 if the constraints_file could not be
+ * opened (the settings will be constructed without any constraints).
+ */
+int native_settings_constructor(const char *const constraints_file) {
+  if (global_native_settings) {
+    native_settings_destructor();
+  }
+
+  global_native_settings = (NativeSettings *)malloc(sizeof(NativeSettings));
+  global_native_settings->constraints = NULL;
+  global_native_settings->number_of_constraints = 0;
+
+  if (!constraints_file) {
+    return 0;
+  }
+
+  FILE *file = fopen(constraints_file, "rb");
+  if (!file) {
+    return 2;
+  }
+
+  fseek(file, 0, SEEK_END);
+  long file_size = ftell(file);
+  rewind(file);
+
+  char *content = (char *)calloc(file_size + 1, sizeof(char));
+  size_t read = fread(content, sizeof(char), file_size, file);
+  content[read] = '\0';
+  fclose(file);
+
+  char *constraint = content, *end;
+  while ((end = strchr(constraint, ';'))) {
+    *end = '\0';
+    _native_settings_add_constraint(constraint);
+    constraint = end + 1;
+  }
+  _native_settings_add_constraint(constraint);
+
+  free(content);
+  return 0;
+}
+
+/**
+ * @brief Destructs the global_native_settings.
+ *
+ * @return 1 if the settings were not constructed, 0 otherwise.
+ */
+int native_settings_destructor() {
+  if (!global_native_settings) {
+    return 1;
+  }
+
+  size_t i;
+  for (i = 0; i < 2 * global_native_settings->number_of_constraints; ++i) {
+    literal_destructor(&(global_native_settings->constraints[i]));
+  }
+  safe_free(global_native_settings->constraints);
+  safe_free(global_native_settings);
+
+  return 0;
+}
+
+/**
+ * @brief Finds the index of the given Literal in the InferenceGraph.
+ *
+ * @return The index of the Literal, or -1 if it is not a key of the graph.
+ */
+static int _graph_index(const InferenceGraph *const graph,
+                        const Literal *const literal) {
+  unsigned int i;
+  for (i = 0; i < graph->size; ++i) {
+    if (literal_equals(graph->literals[i], literal) == 1) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+/**
+ * @brief Sets the Rules of the given Literal to only the given rule. If the
+ * Literal is not a key of the InferenceGraph, it is appended at its end.
+ */
+static void _graph_set(InferenceGraph *const graph, Literal *const literal,
+                       const int rule) {
+  int index = _graph_index(graph, literal);
+  if (index == -1) {
+    index = graph->size++;
+    graph->literals =
+        (Literal **)realloc(graph->literals, graph->size * sizeof(Literal *));
+    graph->rules =
+        (IntVector **)realloc(graph->rules, graph->size * sizeof(IntVector *));
+    graph->literals[index] = literal;
+  } else {
+    int_vector_destructor(&(graph->rules[index]));
+  }
+  graph->rules[index] = int_vector_constructor();
+  int_vector_push(graph->rules[index], rule);
+}
+
+/**
+ * @brief Removes the key at the given index from the InferenceGraph, keeping
+ * the order of the remaining keys.
+ */
+static void _graph_delete(InferenceGraph *const graph,
+                          const unsigned int index) {
+  int_vector_destructor(&(graph->rules[index]));
+  --graph->size;
+  memmove(graph->literals + index, graph->literals + index + 1,
+          (graph->size - index) * sizeof(Literal *));
+  memmove(graph->rules + index, graph->rules + index + 1,
+          (graph->size - index) * sizeof(IntVector *));
+}
+
+/**
+ * @brief Deallocates the content of the InferenceGraph. The Literals are only
+ * references and are not destructed.
+ */
+static void _graph_clear(InferenceGraph *const graph) {
+  unsigned int i;
+  for (i = 0; i < graph->size; ++i) {
+    int_vector_destructor(&(graph->rules[i]));
+  }
+  safe_free(graph->literals);
+  safe_free(graph->rules);
+  graph->size = 0;
+}
+
+/**
+ * @brief Checks whether the Literal would be treated as an array index by a
+ * JavaScript object, which places such keys before any other key.
+ *
+ * @param literal The Literal to be checked.
+ * @param value Where the numeric value of the Literal will be saved.
+ *
+ * @return true if it is an array index, false otherwise.
+ */
+static bool _is_array_index(const Literal *const literal,
+                            unsigned long *const value) {
+  const size_t length = strlen(literal->atom);
+  if (!literal->sign || (length == 0) || (length > 10) ||
+      ((length > 1) && (literal->atom[0] == '0'))) {
+    return false;
+  }
+
+  size_t i;
+  for (i = 0; i < length; ++i) {
+    if (!isdigit(literal->atom[i])) {
+      return false;
+    }
+  }
+  *value = strtoul(literal->atom, NULL, 10);
+  return *value < MAX_ARRAY_INDEX;
+}
+
+/**
+ * @brief Computes the order in which the keys of the InferenceGraph are
+ * reported, which is the key order of the equivalent Prudens-JS graph.
+ *
+ * @return An array of graph->size indices. Use free() to deallocate it.
+ */
+static size_t *_graph_key_order(const InferenceGraph *const graph) {
+  size_t *order = (size_t *)malloc(graph->size * sizeof(size_t)),
+         *values = (size_t *)malloc(graph->size * sizeof(size_t));
+  size_t total_indices = 0, total_others = 0, i, j;
+  unsigned long value;
+
+  for (i = 0; i < graph->size; ++i) {
+    if (_is_array_index(graph->literals[i], &value)) {
+      for (j = total_indices; (j > 0) && (values[j - 1] > value); --j) {
+        values[j] = values[j - 1];
+        order[j] = order[j - 1];
+      }
+      values[j] = value;
+      order[j] = i;
+      ++total_indices;
+    }
+  }
+
+  for (i = 0; i < graph->size; ++i) {
+    if (!_is_array_index(graph->literals[i], &value)) {
+      order[total_indices + total_others++] = i;
+    }
+  }
+
+  free(values);
+  return order;
+}
+
+/**
+ * @brief Checks whether a Literal is included in either of the two Scenes.
+ *
+ * @return The equal Literal found, or NULL if none of them includes it.
+ */
+static Literal *_facts_find(const Scene *const restrict previous_facts,
+                            const Scene *const restrict facts_to_be_added,
+                            const Literal *const literal) {
+  int index = scene_literal_index(previous_facts, literal);
+  if (index >= 0) {
+    return previous_facts->literals[index];
+  }
+
+  index = scene_literal_index(facts_to_be_added, literal);
+  if (index >= 0) {
+    return facts_to_be_added->literals[index];
+  }
+  return NULL;
+}
+
+/**
+ * @brief Adds the head of the Rule at the given active index to the
+ * InferenceGraph, resolving any conflicts with the Literals inferred so far.
+ * Rules with a lower active index (higher priority) win, and observed
+ * Literals always win.
+ *
+ * @return true if the graph has been changed, false otherwise.
+ */
+static bool _update_graph(const KnowledgeBase *const knowledge_base,
+                          const int rule_index, InferenceGraph *const graph,
+                          const Scene *const previous_facts,
+                          Scene *const facts_to_be_added,
+                          Scene *const facts_to_be_removed,
+                          bool *const deleted_rules) {
+  Literal *head = knowledge_base->active->rules[rule_index]->head;
+  bool inferred = false;
+
+  if (_facts_find(previous_facts, facts_to_be_added, head)) {
+    int index = _graph_index(graph, head);
+    if (index == -1) {
+      _graph_set(graph, head, rule_index);
+      inferred = true;
+    } else if (!deleted_rules[rule_index]) {
+      unsigned int i;
+      for (i = 0; i < graph->rules[index]->size; ++i) {
+        if (graph->rules[index]->items[i] == rule_index) {
+          break;
+        }
+      }
+      if (i == graph->rules[index]->size) {
+        int_vector_push(graph->rules[index], rule_index);
+        inferred = true;
+      }
+    }
+    return inferred;
+  }
+
+  Literal opposed_head = {
+      .atom = head->atom, .id = head->id, .sign = !head->sign};
+  size_t total_conflicts = 1, i;
+  const Literal **conflicts = (const Literal **)malloc(sizeof(Literal *));
+  conflicts[0] = &opposed_head;
+
+  if (global_native_settings) {
+    Literal **constraints = global_native_settings->constraints;
+    for (i = 0; i < global_native_settings->number_of_constraints; ++i) {
+      if (literal_equals(constraints[2 * i], head) == 1) {
+        conflicts = (const Literal **)realloc(
+            conflicts, (++total_conflicts) * sizeof(Literal *));
+        conflicts[total_conflicts - 1] = constraints[2 * i + 1];
+      }
+      if (literal_equals(constraints[2 * i + 1], head) == 1) {
+        conflicts = (const Literal **)realloc(
+            conflicts, (++total_conflicts) * sizeof(Literal *));
+        conflicts[total_conflicts - 1] = constraints[2 * i];
+      }
+    }
+  }
+
+  bool includes_conflict = false;
+  Literal *fact;
+  IntVector *remaining;
+  int index, rule;
+  unsigned int j;
+  for (i = 0; i < total_conflicts; ++i) {
+    if (!(fact = _facts_find(previous_facts, facts_to_be_added, conflicts[i]))) {
+      continue;
+    }
+    includes_conflict = true;
+
+    if ((index = _graph_index(graph, fact)) == -1) {
+      continue;
+    }
+
+    remaining = int_vector_constructor();
+    for (j = 0; j < graph->rules[index]->size; ++j) {
+      rule = graph->rules[index]->items[j];
+      if ((rule != CONTEXT_RULE) && (rule_index < rule)) {
+        deleted_rules[rule] = true;
+        inferred = true;
+      } else {
+        int_vector_push(remaining, rule);
+      }
+    }
+
+    if (remaining->size == 0) {
+      int_vector_destructor(&remaining);
+      _graph_delete(graph, index);
+      _graph_set(graph, head, rule_index);
+      scene_add_literal(facts_to_be_added, &head);
+      if ((index = scene_literal_index(facts_to_be_added, fact)) >= 0) {
+        scene_swap_remove_literal(facts_to_be_added, index, NULL);
+      }
+      scene_add_literal(facts_to_be_removed, &fact);
+    } else {
+      int_vector_destructor(&(graph->rules[index]));
+      graph->rules[index] = remaining;
+    }
+  }
+  free(conflicts);
+
+  if (!includes_conflict) {
+    scene_add_literal(facts_to_be_added, &head);
+    _graph_set(graph, head, rule_index);
+    inferred = true;
+  }
+
+  return inferred;
+}
+
+/**
+ * @brief Adds a copy of each Literal of the given Scene to the facts, unless
+ * the facts already include it.
+ */
+static void _add_facts(Scene *const facts, const Scene *const literals) {
+  Literal *copy;
+  unsigned int i;
+  for (i = 0; i < literals->size; ++i) {
+    if (scene_literal_index(facts, literals->literals[i]) < 0) {
+      literal_copy(&copy, literals->literals[i]);
+      scene_add_literal(facts, &copy);
+    }
+  }
+}
+
+/**
+ * @brief Runs forward chaining over the active Rules of the KnowledgeBase,
+ * using the same linear priorities as Prudens-JS.
+ *
+ * @param knowledge_base The KnowledgeBase whose active Rules will be used.
+ * @param observation The observed Literals.
+ * @param graph An empty InferenceGraph to save the result. Use _graph_clear to
+ * deallocate its content.
+ * @param facts A Scene that takes ownership, to save a copy of every Literal
+ * that was a fact at some point (observed or inferred). Only the active Rules
+ * whose body is a subset of them could have taken part in the inference. If
+ * NULL, they will not be saved.
+ */
+static void _forward_chaining(const KnowledgeBase *const knowledge_base,
+                              const Scene *const restrict observation,
+                              InferenceGraph *const graph, Scene *const facts) {
+  Scene *previous_facts = scene_constructor(false),
+        *facts_to_be_added = scene_constructor(false),
+        *facts_to_be_removed = scene_constructor(false);
+  Literal *literal;
+  unsigned int i;
+
+  for (i = 0; i < observation->size; ++i) {
+    literal = observation->literals[i];
+    scene_add_literal(previous_facts, &literal);
+    _graph_set(graph, literal, CONTEXT_RULE);
+  }
+  if (facts) {
+    _add_facts(facts, observation);
+  }
+
+  const size_t total_rules = knowledge_base->active->length;
+  bool *deleted_rules = (bool *)calloc(total_rules + 1, sizeof(bool));
+  bool inferred;
+  int index;
+
+  do {
+    inferred = false;
+    for (i = total_rules; i > 0; --i) {
+      if (deleted_rules[i - 1] ||
+          (rule_applicable(knowledge_base->active->rules[i - 1],
+                           previous_facts) != 1)) {
+        continue;
+      }
+      if (_update_graph(knowledge_base, i - 1, graph, previous_facts,
+                        facts_to_be_added, facts_to_be_removed,
+                        deleted_rules)) {
+        inferred = true;
+      }
+    }
+
+    for (i = 0; i < facts_to_be_removed->size; ++i) {
+      if ((index = scene_literal_index(previous_facts,
+                                       facts_to_be_removed->literals[i])) >=
+          0) {
+        scene_swap_remove_literal(previous_facts, index, NULL);
+      }
+    }
+    for (i = 0; i < facts_to_be_added->size; ++i) {
+      literal = facts_to_be_added->literals[i];
+      scene_add_literal(previous_facts, &literal);
+    }
+    if (facts) {
+      _add_facts(facts, facts_to_be_added);
+    }
+  } while (inferred);
+
+  free(deleted_rules);
+  scene_destructor(&previous_facts);
+  scene_destructor(&facts_to_be_added);
+  scene_destructor(&facts_to_be_removed);
+}
+
+/**
+ * @brief Appends a string to a dynamically allocated string.
+ */
+static void _append(char **const string, size_t *const length,
+                    const char *const to_append) {
+  const size_t to_append_length = strlen(to_append);
+  *string = (char *)realloc(*string, *length + to_append_length + 1);
+  memcpy(*string + *length, to_append, to_append_length + 1);
+  *length += to_append_length;
+}
+
+/**
+ * @brief Converts the InferenceGraph to the same string format that
+ * Prudens-JS uses to report the inferring rules of an observation.
+ *
+ * @return The string format of the graph. Use free() to deallocate it.
+ */
+static char *_graph_to_string(const KnowledgeBase *const knowledge_base,
+                              const InferenceGraph *const graph) {
+  if (graph->size == 0) {
+    return strdup("{}");
+  }
+
+  size_t *order = _graph_key_order(graph), length = 0, i;
+  char *result = NULL, *str, rule_name[50];
+  unsigned int j, k;
+  bool first;
+  const Rule *rule;
+
+  _append(&result, &length, "{\n");
+  for (i = 0; i < graph->size; ++i) {
+    str = literal_to_string(graph->literals[order[i]]);
+    _append(&result, &length, str);
+    _append(&result, &length, ": [");
+    free(str);
+
+    first = true;
+    for (j = 0; j < graph->rules[order[i]]->size; ++j) {
+      if (graph->rules[order[i]]->items[j] == CONTEXT_RULE) {
+        continue;
+      }
+      if (!first) {
+        _append(&result, &length, " ");
+      }
+      first = false;
+
+      rule = knowledge_base->active->rules[graph->rules[order[i]]->items[j]];
+      sprintf(rule_name, "Rule%d :: ", graph->rules[order[i]]->items[j]);
+      _append(&result, &length, rule_name);
+      for (k = 0; k < rule->body.size; ++k) {
+        if (k != 0) {
+          _append(&result, &length, ", ");
+        }
+        str = literal_to_string(rule->body.literals[k]);
+        _append(&result, &length, str);
+        free(str);
+      }
+      _append(&result, &length, " implies ");
+      str = literal_to_string(rule->head);
+      _append(&result, &length, str);
+      _append(&result, &length, ";");
+      free(str);
+    }
+    _append(&result, &length, "]\n");
+  }
+  _append(&result, &length, "}");
+
+  free(order);
+  return result;
+}
+
+/**
+ * @brief Converts the InferenceGraph to the Scene of inferred Literals, i.e.,
+ * the keys that are supported by at least one Rule.
+ *
+ * @return A new Scene * which takes ownership of its Literals. Use
+ * scene_destructor to deallocate.
+ */
+static Scene *_graph_to_inference(const InferenceGraph *const graph) {
+  Scene *inference = scene_constructor(true);
+  size_t *order = _graph_key_order(graph), i;
+  unsigned int j;
+  Literal *copy;
+
+  for (i = 0; i < graph->size; ++i) {
+    for (j = 0; j < graph->rules[order[i]]->size; ++j) {
+      if (graph->rules[order[i]]->items[j] != CONTEXT_RULE) {
+        literal_copy(&copy, graph->literals[order[i]]);
+        scene_add_literal(inference, &copy);
+        break;
+      }
+    }
+  }
+
+  free(order);
+  return inference;
+}
+
+/**
+ * @brief Native replacement of prudensjs_inference. It performs forward
+ * chaining in-process, with the same conflict resolution (linear priorities)
+ * as Prudens-JS. It uses the global_native_settings for constraints, if they
+ * have been constructed.
+ *
+ * @param knowledge_base The KnowledgeBase to be used for the inference.
+ * @param observation A Scene/Context *, which includes all the observed
+ * Literals.
+ * @param inference A Scene ** (reference to a Scene *) to save the inferences.
+ * Deallocate using scene_destructor.
+ */
+void native_inference(const KnowledgeBase *const knowledge_base,
+                      const Scene *const restrict observation,
+                      Scene **const inference) {
+  if (!(knowledge_base && knowledge_base->active && observation && inference)) {
+    return;
+  }
+
+  InferenceGraph graph = {NULL, NULL, 0};
+  _forward_chaining(knowledge_base, observation, &graph, NULL);
+  *inference = _graph_to_inference(&graph);
+  _graph_clear(&graph);
+}
+
+/**
+ * @brief Native replacement of prudensjs_inference_batch. It infers a number n
+ * of Scene/Context, which hold n observations. It uses the
+ * global_native_settings for constraints, if they have been constructed.
+ *
+ * @param knowledge_base The KnowledgeBase to be used for the inference.
+ * @param observations_size The number of different observations given.
+ * @param observations A Scene/Context ** containing a number of different
+ * observations, where each one includes their own observed Literals.
+ * @param inferences A Scene *** (reference to a Scene **) to save the
+ * inferences for each observation. It has the same size as the observations
+ * (observations_size). Deallocate each scene using scene_destructor.
+ * @param save_inferring_rules A char ** (reference to a char *) to save the
+ * inferring rules as a string, in the same format as Prudens-JS. If NULL,
+ * they won't be saved.
+ *
+ * @return 3 if observations_size is 0, 4 if observations is NULL, 5 if the
+ * knowledge_base is NULL, and 0 if it no errors occured.
+ */
+int native_inference_batch(const KnowledgeBase *const knowledge_base,
+                           const size_t observations_size,
+                           Scene **restrict observations,
+                           Scene ***const inferences,
+                           char **const save_inferring_rules) {
+  if (observations_size == 0) {
+    return 3;
+  }
+
+  if (!observations) {
+    return 4;
+  }
+
+  if (!(knowledge_base && knowledge_base->active)) {
+    return 5;
+  }
+
+  (*inferences) = (Scene **)malloc(sizeof(Scene *) * observations_size);
+
+  InferenceGraph graph = {NULL, NULL, 0};
+  char *rules = NULL, *str, number[50];
+  size_t rules_length = 0, i;
+
+  if (save_inferring_rules) {
+    rules = strdup("");
+  }
+
+  for (i = 0; i < observations_size; ++i) {
+    _forward_chaining(knowledge_base, observations[i], &graph, NULL);
+    (*inferences)[i] = _graph_to_inference(&graph);
+
+    if (save_inferring_rules) {
+      sprintf(number, "%s%zu: ", (i == 0) ? "" : "\n\n", i + 2);
+      _append(&rules, &rules_length, number);
+      str = _graph_to_string(knowledge_base, &graph);
+      _append(&rules, &rules_length, str);
+      free(str);
+    }
+    _graph_clear(&graph);
+  }
+
+  if (save_inferring_rules) {
+    *save_inferring_rules = rules;
+  }
+  return 0;
+}
+
+/**
+ * @brief Deallocates the content of a CachedInference, including the Literals
+ * of its InferenceGraph.
+ */
+static void _cached_inference_clear(CachedInference *const cached) {
+  unsigned int i;
+  for (i = 0; i < cached->graph.size; ++i) {
+    literal_destructor(&(cached->graph.literals[i]));
+  }
+  _graph_clear(&(cached->graph));
+  scene_destructor(&(cached->facts));
+}
+
+/**
+ * @brief Constructs an empty NativeInferenceCache, to be used by
+ * native_inference_batch_cached.
+ *
+ * @return A new NativeInferenceCache *. Use native_inference_cache_destructor
+ * to deallocate.
+ */
+NativeInferenceCache *native_inference_cache_constructor() {
+  return (NativeInferenceCache *)calloc(1, sizeof(NativeInferenceCache));
+}
+
+/**
+ * @brief Destructs a NativeInferenceCache.
+ *
+ * @param cache The NativeInferenceCache to be destructed. It should be a
+ * reference to the struct's pointer (NativeInferenceCache **).
+ */
+void native_inference_cache_destructor(NativeInferenceCache **const cache) {
+  if (cache && *cache) {
+    size_t i;
+    for (i = 0; i < (*cache)->size; ++i) {
+      _cached_inference_clear(&((*cache)->inferences[i]));
+    }
+    safe_free((*cache)->inferences);
+    rule_queue_destructor(&((*cache)->previous));
+    rule_queue_destructor(&((*cache)->current));
+    safe_free((*cache)->indices);
+    safe_free((*cache)->changed);
+    safe_free(*cache);
+  }
+}
+
+/**
+ * @brief The fingerprint of the Rule at the given active index.
+ */
+typedef struct RuleFingerprint {
+  uint64_t fingerprint;
+  int index;
+} RuleFingerprint;
+
+/**
+ * @brief Orders the RuleFingerprints by their fingerprint and then by their
+ * index.
+ */
+static int _compare_fingerprints(const void *fingerprint1,
+                                 const void *fingerprint2) {
+  const RuleFingerprint *const _fingerprint1 =
+                            (const RuleFingerprint *)fingerprint1,
+                        *const _fingerprint2 =
+                            (const RuleFingerprint *)fingerprint2;
+  if (_fingerprint1->fingerprint != _fingerprint2->fingerprint) {
+    return (_fingerprint1->fingerprint < _fingerprint2->fingerprint) ? -1 : 1;
+  }
+  return _fingerprint1->index - _fingerprint2->index;
+}
+
+/**
+ * @brief Finds the current index of each previous Rule, keeping only the
+ * longest sequence of previous Rules whose current indices are increasing, so
+ * that the relative priority of the kept Rules has not changed.
+ *
+ * @param previous The previous active Rules.
+ * @param current The current active Rules.
+ * @param indices An array of previous->length to save the current index of each
+ * kept Rule, or -1 for the rest.
+ * @param kept An array of current->length to mark the current Rules that have
+ * been kept.
+ */
+static void _match_rules(const RuleQueue *const previous,
+                         const RuleQueue *const current, int *const indices,
+                         bool *const kept) {
+  const size_t previous_length = previous->length,
+               current_length = current->length;
+  RuleFingerprint *order =
+      (RuleFingerprint *)malloc((current_length + 1) * sizeof(RuleFingerprint));
+  size_t i, low, high, middle;
+  for (i = 0; i < current_length; ++i) {
+    order[i].fingerprint = current->rules[i]->fingerprint;
+    order[i].index = i;
+    kept[i] = false;
+  }
+  qsort(order, current_length, sizeof(RuleFingerprint), _compare_fingerprints);
+
+  const Rule *rule;
+  int index;
+  for (i = 0; i < previous_length; ++i) {
+    rule = previous->rules[i];
+    indices[i] = -1;
+    low = 0;
+    high = current_length;
+    while (low < high) {
+      middle = low + ((high - low) >> 1);
+      if (order[middle].fingerprint < rule->fingerprint) {
+        low = middle + 1;
+      } else {
+        high = middle;
+      }
+    }
+    for (; (low < current_length) &&
+           (order[low].fingerprint == rule->fingerprint);
+         ++low) {
+      index = order[low].index;
+      if (!kept[index] && (rule_equals(current->rules[index], rule) == 1)) {
+        kept[index] = true;
+        indices[i] = index;
+        break;
+      }
+    }
+  }
+  free(order);
+
+  // The longest increasing subsequence of the matched indices, where tails[k]
+  // is the previous index that ends the best subsequence of length k + 1.
+  size_t *tails = (size_t *)malloc((previous_length + 1) * sizeof(size_t)),
+         *predecessors = (size_t *)malloc((previous_length + 1) *
+                                          sizeof(size_t)),
+         length = 0;
+  for (i = 0; i < previous_length; ++i) {
+    if (indices[i] < 0) {
+      continue;
+    }
+    low = 0;
+    high = length;
+    while (low < high) {
+      middle = low + ((high - low) >> 1);
+      if (indices[tails[middle]] < indices[i]) {
+        low = middle + 1;
+      } else {
+        high = middle;
+      }
+    }
+    predecessors[i] = (low > 0) ? tails[low - 1] : previous_length;
+    tails[low] = i;
+    if (low == length) {
+      ++length;
+    }
+  }
+
+  bool *in_sequence = (bool *)calloc(previous_length + 1, sizeof(bool));
+  for (i = length ? tails[length - 1] : previous_length; i < previous_length;
+       i = predecessors[i]) {
+    in_sequence[i] = true;
+  }
+  for (i = 0; i < previous_length; ++i) {
+    if ((indices[i] >= 0) && !in_sequence[i]) {
+      kept[indices[i]] = false;
+      indices[i] = -1;
+    }
+  }
+  free(in_sequence);
+  free(predecessors);
+  free(tails);
+}
+
+/**
+ * @brief Updates the NativeInferenceCache with the active Rules of the given
+ * KnowledgeBase, which will be used by the following calls of
+ * native_inference_batch_cached. The active Rules are compared with the ones of
+ * the previous update, to find the Rules that have been removed, added or whose
+ * relative priority has changed. Should not be called concurrently with
+ * native_inference_batch_cached on the same cache.
+ *
+ * @param cache The NativeInferenceCache to be updated.
+ * @param knowledge_base The KnowledgeBase whose active Rules will be used.
+ * @param observations_size The total number of observations that will be
+ * inferred. If it is not the same as in the previous update, all the cached
+ * inferences are discarded.
+ *
+ * @return 0 if it was updated, or -1 if the cache or the knowledge_base is
+ * NULL.
+ */
+int native_inference_cache_update(NativeInferenceCache *const cache,
+                                  const KnowledgeBase *const knowledge_base,
+                                  const size_t observations_size) {
+  if (!(cache && knowledge_base && knowledge_base->active)) {
+    return -1;
+  }
+
+  size_t i;
+  if (cache->size != observations_size) {
+    for (i = 0; i < cache->size; ++i) {
+      _cached_inference_clear(&(cache->inferences[i]));
+    }
+    free(cache->inferences);
+    cache->inferences =
+        (CachedInference *)calloc(observations_size, sizeof(CachedInference));
+    cache->size = observations_size;
+  }
+
+  rule_queue_destructor(&(cache->previous));
+  cache->previous = cache->current;
+  cache->current = rule_queue_constructor(true);
+  const RuleQueue *const active = knowledge_base->active;
+  Rule *copy;
+  for (i = 0; i < active->length; ++i) {
+    rule_copy(&copy, active->rules[i]);
+    rule_queue_enqueue(cache->current, &copy);
+  }
+  ++cache->generation;
+
+  safe_free(cache->indices);
+  cache->total_changed = 0;
+  if (!cache->previous) {
+    return 0;
+  }
+
+  const RuleQueue *const previous = cache->previous, *const current =
+                                                         cache->current;
+  cache->indices = (int *)malloc((previous->length + 1) * sizeof(int));
+  bool *kept = (bool *)malloc((current->length + 1) * sizeof(bool));
+  _match_rules(previous, current, cache->indices, kept);
+
+  cache->changed = (const Rule **)realloc(
+      cache->changed,
+      (previous->length + current->length + 1) * sizeof(Rule *));
+  for (i = 0; i < previous->length; ++i) {
+    if (cache->indices[i] < 0) {
+      cache->changed[cache->total_changed++] = previous->rules[i];
+    }
+  }
+  for (i = 0; i < current->length; ++i) {
+    if (!kept[i]) {
+      cache->changed[cache->total_changed++] = current->rules[i];
+    }
+  }
+  free(kept);
+  return 0;
+}
+
+/**
+ * @brief Checks whether the cached inference is still the same with the active
+ * Rules of the last update, and if so, updates the Rule indices of its graph.
+ * It is the same if none of the changed Rules has a body that is a subset of
+ * its facts, as the Rules that could have taken part in the inference and their
+ * relative priorities have not changed.
+ *
+ * @return true if it is still the same, false otherwise.
+ */
+static bool _cached_inference_is_valid(const NativeInferenceCache *const cache,
+                                       CachedInference *const cached) {
+  if (!cached->facts) {
+    return false;
+  }
+  if (cached->generation == cache->generation) {
+    return true;
+  }
+  if ((cached->generation + 1 != cache->generation) || !cache->indices) {
+    return false;
+  }
+
+  size_t i;
+  for (i = 0; i < cache->total_changed; ++i) {
+    if (rule_applicable(cache->changed[i], cached->facts) == 1) {
+      return false;
+    }
+  }
+
+  IntVector *rules;
+  unsigned int j;
+  for (i = 0; i < cached->graph.size; ++i) {
+    rules = cached->graph.rules[i];
+    for (j = 0; j < rules->size; ++j) {
+      if (rules->items[j] != CONTEXT_RULE) {
+        rules->items[j] = cache->indices[rules->items[j]];
+      }
+    }
+  }
+  cached->generation = cache->generation;
+  return true;
+}
+
+/**
+ * @brief Incremental version of native_inference_batch. It infers the
+ * observations first to first + observations_size - 1 of a
+ * NativeInferenceCache, and only re-infers the observations whose applicable
+ * active Rules have been changed since the previous update of the cache. The
+ * results are exactly the same as the ones of native_inference_batch. Disjoint
+ * ranges of observations can be inferred concurrently.
+ *
+ * @param knowledge_base The KnowledgeBase of the last update of the cache.
+ * @param cache The NativeInferenceCache, updated with
+ * native_inference_cache_update.
+ * @param first The index of the first observation in the cache.
+ * @param observations_size The number of different observations given.
+ * @param observations A Scene/Context ** containing the observations. They
+ * should be the same observations as the ones given for the same indices
+ * before.
+ * @param inferences A Scene *** (reference to a Scene **) to save the
+ * inferences for each observation. Deallocate each scene using
+ * scene_destructor.
+ * @param save_inferring_rules A char ** (reference to a char *) to save the
+ * inferring rules as a string, in the same format as Prudens-JS. If NULL,
+ * they won't be saved.
+ * @param reinferred A size_t * to save the number of observations that have
+ * been re-inferred. If NULL, it will not be saved.
+ *
+ * @return 3 if observations_size is 0, 4 if observations is NULL, 5 if the
+ * knowledge_base is NULL, 6 if the cache is NULL or it does not include the
+ * observations, and 0 if it no errors occured.
+ */
+int native_inference_batch_cached(const KnowledgeBase *const knowledge_base,
+                                  NativeInferenceCache *const cache,
+                                  const size_t first,
+                                  const size_t observations_size,
+                                  Scene **restrict observations,
+                                  Scene ***const inferences,
+                                  char **const save_inferring_rules,
+                                  size_t *const reinferred) {
+  if (observations_size == 0) {
+    return 3;
+  }
+
+  if (!observations) {
+    return 4;
+  }
+
+  if (!(knowledge_base && knowledge_base->active)) {
+    return 5;
+  }
+
+  if (!cache || (first + observations_size > cache->size)) {
+    return 6;
+  }
+
+  (*inferences) = (Scene **)malloc(sizeof(Scene *) * observations_size);
+
+  CachedInference *cached;
+  Literal *copy;
+  char *rules = NULL, *str, number[50];
+  size_t rules_length = 0, total_reinferred = 0, i;
+  unsigned int j;
+
+  if (save_inferring_rules) {
+    rules = strdup("");
+  }
+
+  for (i = 0; i < observations_size; ++i) {
+    cached = &(cache->inferences[first + i]);
+    if (!_cached_inference_is_valid(cache, cached)) {
+      _cached_inference_clear(cached);
+      cached->facts = scene_constructor(true);
+      _forward_chaining(knowledge_base, observations[i], &(cached->graph),
+                        cached->facts);
+      for (j = 0; j < cached->graph.size; ++j) {
+        literal_copy(&copy, cached->graph.literals[j]);
+        cached->graph.literals[j] = copy;
+      }
+      cached->generation = cache->generation;
+      ++total_reinferred;
+    }
+    (*inferences)[i] = _graph_to_inference(&(cached->graph));
+
+    if (save_inferring_rules) {
+      sprintf(number, "%s%zu: ", (i == 0) ? "" : "\n\n", i + 2);
+      _append(&rules, &rules_length, number);
+      str = _graph_to_string(knowledge_base, &(cached->graph));
+      _append(&rules, &rules_length, str);
+      free(str);
+    }
+  }
+
+  if (save_inferring_rules) {
+    *save_inferring_rules = rules;
+  }
+  if (reinferred) {
+    *reinferred = total_reinferred;
+  }
+  return 0;
+}
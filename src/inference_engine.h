@@ -0,0 +1,37 @@
+#ifndef INFERENCE_ENGINE_H
+#define INFERENCE_ENGINE_H
+
+#include "knowledge_base.h"
+#include "scene.h"
+
+typedef struct NativeSettings *NativeSettings_ptr;
+typedef struct NativeInferenceCache NativeInferenceCache;
+
+extern NativeSettings_ptr global_native_settings;
+
+int native_settings_constructor(const char *const constraints_file);
+int native_settings_destructor();
+
+void native_inference(const KnowledgeBase *const knowledge_base,
+                      const Scene *const restrict observation,
+                      Scene **const inference);
+int native_inference_batch(const KnowledgeBase *const knowledge_base,
+                           const size_t observations_size,
+                           Scene **restrict observations,
+                           Scene ***const inferences,
+                           char **const save_inferring_rules);
+NativeInferenceCache *native_inference_cache_constructor();
+void native_inference_cache_destructor(NativeInferenceCache **const cache);
+int native_inference_cache_update(NativeInferenceCache *const cache,
+                                  const KnowledgeBase *const knowledge_base,
+                                  const size_t observations_size);
+int native_inference_batch_cached(const KnowledgeBase *const knowledge_base,
+                                  NativeInferenceCache *const cache,
+                                  const size_t first,
+                                  const size_t observations_size,
+                                  Scene **restrict observations,
+                                  Scene ***const inferences,
+                                  char **const save_inferring_rules,
+                                  size_t *const reinferred);
+
+#endif
@@ -8,6 +8,25 @@
 #include "knowledge_base.h"
 #include "nerd_utils.h"
 
+/**
+ * @brief The scratch space of knowledge_base_create_new_rules, reused across
+ * calls. Its Scenes only reference the Literals of the given observation and
+ * inference, so they are cleared at each call instead of being constructed
+ * again. It is constructed the first time it is needed.
+ */
+struct KnowledgeBaseScratch {
+  Scene *combined, *uncovered;
+  Context *body;
+  int *random_indices;
+  size_t capacity;
+};
+
+/**
+ * @brief The last version given to a KnowledgeBase. It is shared by all the
+ * KnowledgeBases, so that their versions are never equal.
+ */
+static _Atomic uint64_t _last_version = 0;
+
 /**
  * @brief Constructs a KnowledgeBase.
  *
@@ -24,9 +43,11 @@ KnowledgeBase *knowledge_base_constructor(const float activation_threshold,
   KnowledgeBase *knowledge_base =
       (KnowledgeBase *)malloc(sizeof(KnowledgeBase));
   knowledge_base->activation_threshold = activation_threshold;
-  knowledge_base->active = rule_queue_constructor(false);
+  knowledge_base->active = rule_queue_indexed_constructor(false);
   knowledge_base->hypergraph =
       rule_hypergraph_empty_constructor(use_backward_chaining);
+  knowledge_base->scratch = NULL;
+  knowledge_base->version = ++_last_version;
   return knowledge_base;
 }
 
@@ -40,6 +61,14 @@ void knowledge_base_destructor(KnowledgeBase **const knowledge_base) {
   if (knowledge_base && (*knowledge_base)) {
     rule_queue_destructor(&((*knowledge_base)->active));
     rule_hypergraph_destructor(&((*knowledge_base)->hypergraph));
+    struct KnowledgeBaseScratch *const scratch = (*knowledge_base)->scratch;
+    if (scratch) {
+      scene_destructor(&(scratch->combined));
+      scene_destructor(&(scratch->uncovered));
+      context_destructor(&(scratch->body));
+      free(scratch->random_indices);
+      safe_free((*knowledge_base)->scratch);
+    }
     (*knowledge_base)->activation_threshold = INFINITY;
     safe_free(*knowledge_base);
   }
@@ -58,11 +87,27 @@ void knowledge_base_copy(KnowledgeBase **const restrict destination,
   if (destination && source) {
     *destination = (KnowledgeBase *)malloc(sizeof(KnowledgeBase));
     (*destination)->activation_threshold = source->activation_threshold;
-    (*destination)->active = rule_queue_constructor(false);
+    (*destination)->active = rule_queue_indexed_constructor(false);
+    (*destination)->scratch = NULL;
+    (*destination)->version = ++_last_version;
     rule_hypergraph_copy(destination, source);
   }
 }
 
+/**
+ * @brief Gives the KnowledgeBase a new version, as its Rules or their weights
+ * have changed. The KnowledgeBase functions do it themselves, so it only needs
+ * to be called after changing the Rules directly.
+ *
+ * @param knowledge_base The KnowledgeBase that has changed. If NULL, nothing
+ * will happen.
+ */
+void knowledge_base_mark_changed(KnowledgeBase *const knowledge_base) {
+  if (knowledge_base) {
+    knowledge_base->version = ++_last_version;
+  }
+}
+
 /**
  * @brief Adds a Rule in the KnowledgeBase by taking its ownership. If the
  * weight of the Rule is above the activation_threshold, the Rule will be added
@@ -73,9 +118,10 @@ void knowledge_base_copy(KnowledgeBase **const restrict destination,
  * @param rule The Rule to be added. It should be reference to a Rule * (Rule **
  * - a pointer to a Rule *). If the given Rule had took ownership of its
  * content, a new Rule will be created without taking the ownership of that
- * content as it will belong to the internal RB-Tree. If it does not take the
- * ownership of the its content, the content pointers might stil change, as the
- * body and head will take the pointer of the item allocated in the RB-Tree.
+ * content as it will belong to the RuleHyperGraph's Vertices. If it does not
+ * take the ownership of the its content, the content pointers might stil
+ * change, as the body and head will take the pointer of the Literal of the
+ * existing Vertex.
  *
  * @return 1 if the Rule was added successfully, 0 if it was not added, and -1
  * if one of the parameters is NULL.
@@ -87,6 +133,7 @@ int knowledge_base_add_rule(KnowledgeBase *const knowledge_base,
       if ((*rule)->weight >= knowledge_base->activation_threshold) {
         rule_queue_enqueue(knowledge_base->active, rule);
       }
+      knowledge_base_mark_changed(knowledge_base);
       return 1;
     }
     return 0;
@@ -94,6 +141,39 @@ int knowledge_base_add_rule(KnowledgeBase *const knowledge_base,
   return -1;
 }
 
+/**
+ * @brief Gives the scratch space of the KnowledgeBase, constructing it if it
+ * does not exist yet.
+ */
+static struct KnowledgeBaseScratch *
+_knowledge_base_scratch(KnowledgeBase *const knowledge_base) {
+  if (!knowledge_base->scratch) {
+    struct KnowledgeBaseScratch *scratch =
+        (struct KnowledgeBaseScratch *)malloc(
+            sizeof(struct KnowledgeBaseScratch));
+    scratch->combined = scene_constructor(false);
+    scratch->uncovered = scene_constructor(false);
+    scratch->body = context_constructor(false);
+    scratch->random_indices = NULL;
+    scratch->capacity = 0;
+    knowledge_base->scratch = scratch;
+  }
+  return knowledge_base->scratch;
+}
+
+/**
+ * @brief Makes sure that the random indices of the scratch space can hold the
+ * given number of elements, doubling their capacity if not.
+ */
+static void _reserve_scratch(struct KnowledgeBaseScratch *const scratch,
+                             const size_t size) {
+  if (size > scratch->capacity) {
+    scratch->capacity = size << 1;
+    scratch->random_indices = (int *)realloc(scratch->random_indices,
+                                             scratch->capacity * sizeof(int));
+  }
+}
+
 /**
  * @brief Creates new Rules by finding uncovered Literals. Uncovered Literals,
  * are Literals that have been observed, but have not been inferred.
@@ -118,13 +198,19 @@ void knowledge_base_create_new_rules(KnowledgeBase *const knowledge_base,
                                      const Context *const restrict labels,
                                      const bool force_head) {
   if (knowledge_base && observed && labels) {
-    Context *uncovered = NULL;
-    Scene *combined = NULL;
-    Literal *head = NULL, *temp = NULL, *removed_label = NULL;
-    Body *body = NULL;
+    struct KnowledgeBaseScratch *const scratch =
+        _knowledge_base_scratch(knowledge_base);
+    Scene *const combined = scratch->combined,
+                *const uncovered = scratch->uncovered;
+    Context *const body = scratch->body;
+    Literal *head = NULL, *removed_label = NULL;
     Rule *new_rule = NULL;
 
-    scene_union(observed, inferred, &combined);
+    scene_clear(combined);
+    scene_add_literals(combined, observed->size, observed->literals);
+    if (inferred) {
+      scene_add_literals(combined, inferred->size, inferred->literals);
+    }
 
     unsigned int i;
     if (force_head) {
@@ -137,19 +223,24 @@ void knowledge_base_create_new_rules(KnowledgeBase *const knowledge_base,
         }
       }
       if (!head) {
-        goto failed;
+        return;
       }
 
       if (scene_literal_index(inferred, head) > -1) {
-        goto failed;
+        return;
       }
     } else {
-      scene_difference(observed, inferred, &uncovered);
+      scene_clear(uncovered);
+      for (i = 0; i < observed->size; ++i) {
+        if (scene_literal_index(inferred, observed->literals[i]) < 0) {
+          scene_add_literal(uncovered, &(observed->literals[i]));
+        }
+      }
     }
 
-    pcg32_random_t *rng = global_rng;
+    pcg32_random_t local_rng, *rng = global_rng;
     if (!rng) {
-      rng = (pcg32_random_t *)malloc(sizeof(pcg32_random_t));
+      rng = &local_rng;
       pcg32_srandom_r(rng, time(NULL), 42u);
     }
 
@@ -165,7 +256,7 @@ void knowledge_base_create_new_rules(KnowledgeBase *const knowledge_base,
         }
 
         chosen_head_index = pcg32_random_r(rng) % uncovered->size;
-        literal_copy(&head, uncovered->literals[chosen_head_index]);
+        head = uncovered->literals[chosen_head_index];
 
         head_index = scene_literal_index(combined, head);
         if (head_index >= 0) {
@@ -185,11 +276,12 @@ void knowledge_base_create_new_rules(KnowledgeBase *const knowledge_base,
       }
 
       if (combined->size >= 1) {
-        body = context_constructor(true);
+        scene_clear(body);
         body_size = (pcg32_random_r(rng) % max_body_size) + 1;
         remaining_randoms = combined->size;
 
-        random_indices = (int *)malloc(combined->size * sizeof(int));
+        _reserve_scratch(scratch, combined->size);
+        random_indices = scratch->random_indices;
 
         for (j = 0; j < combined->size; ++j) {
           random_indices[j] = j;
@@ -204,18 +296,16 @@ void knowledge_base_create_new_rules(KnowledgeBase *const knowledge_base,
           chosen_index = random_indices[random_chosen];
           random_indices[random_chosen] = random_indices[remaining_randoms - 1];
           remaining_randoms--;
-          literal_copy(&temp, combined->literals[chosen_index]);
-          context_add_literal(body, &temp);
+          scene_add_literal(body, &(combined->literals[chosen_index]));
         }
 
-        literal_copy(&temp, head);
-        new_rule = rule_constructor(body->size, body->literals, &temp, 0, true);
-
+        // The Rule only references the shared Literals, so it is a single
+        // allocation, and it is discarded if it already exists.
+        new_rule =
+            rule_constructor(body->size, body->literals, &head, 0, false);
         if (knowledge_base_add_rule(knowledge_base, &new_rule) != 1) {
           rule_destructor(&new_rule);
         }
-        safe_free(random_indices);
-        context_destructor(&body);
       }
 
       if (!force_head) {
@@ -224,17 +314,9 @@ void knowledge_base_create_new_rules(KnowledgeBase *const knowledge_base,
 
       if (removed_label) {
         scene_add_literal(combined, &removed_label);
+        removed_label = NULL;
       }
     }
-
-    if (!global_rng) {
-      free(rng);
-    }
-
-  failed:
-    literal_destructor(&head);
-    scene_destructor(&combined);
-    context_destructor(&uncovered);
   }
 }
 
@@ -1,6 +1,8 @@
 #ifndef KNOWLEDGE_BASE_H
 #define KNOWLEDGE_BASE_H
 
+#include <stdint.h>
+
 #include "context.h"
 #include "nerd_utils.h"
 #include "rule_hypergraph.h"
@@ -8,10 +10,19 @@
 #include "scene.h"
 
 struct RuleHyperGraph;
+struct KnowledgeBaseScratch;
+
+/**
+ * @brief The Rules learnt by NERD. version changes whenever its Rules or their
+ * weights change, and no two KnowledgeBases share a version, so it can be used
+ * to find whether a KnowledgeBase has changed since it was last seen.
+ */
 typedef struct KnowledgeBase {
   RuleQueue *active;
   float activation_threshold;
   struct RuleHyperGraph *hypergraph;
+  struct KnowledgeBaseScratch *scratch;
+  uint64_t version;
 } KnowledgeBase;
 
 KnowledgeBase *knowledge_base_constructor(const float activation_threshold,
@@ -19,6 +30,7 @@ KnowledgeBase *knowledge_base_constructor(const float activation_threshold,
 void knowledge_base_destructor(KnowledgeBase **const knowledge_base);
 void knowledge_base_copy(KnowledgeBase **const restrict destination,
                          const KnowledgeBase *const restrict source);
+void knowledge_base_mark_changed(KnowledgeBase *const knowledge_base);
 int knowledge_base_add_rule(KnowledgeBase *const knowledge_base,
                             Rule **const rule);
 void knowledge_base_create_new_rules(KnowledgeBase *const KnowledgeBase,
@@ -1,4 +1,6 @@
 #include <ctype.h>
+#include <pthread.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -8,28 +10,231 @@
 
 pcg32_random_t *global_rng = NULL;
 
+#define ATOM_TABLE_INITIAL_CAPACITY 64
+#define ATOM_TABLE_PAGE_BITS 12
+#define ATOM_TABLE_PAGE_SIZE (1U << ATOM_TABLE_PAGE_BITS)
+#define ATOM_TABLE_MAX_PAGES (1U << 14)
+
+/**
+ * @brief An interned atom: its two shared Literals, the negative one first, and
+ * the hash of the atom.
+ */
+typedef struct AtomEntry {
+  Literal literals[2];
+  unsigned int hash;
+} AtomEntry;
+
+/**
+ * @brief The global table of interned atoms. Each distinct atom is stored once
+ * and is given a dense id, in the order it was first seen. The entries are kept
+ * in pages of ATOM_TABLE_PAGE_SIZE that are never moved or freed, so the
+ * entries of the ids [0, size) can be read without the mutex while another
+ * thread interns atoms. The slots are an open addressing hash table which hold
+ * id + 1 (0 means empty); they, and the growth of the table, are guarded by the
+ * mutex.
+ */
+typedef struct AtomTable {
+  AtomEntry *pages[ATOM_TABLE_MAX_PAGES];
+  unsigned int *slots;
+  _Atomic size_t size;
+  size_t capacity;
+  pthread_mutex_t mutex;
+} AtomTable;
+
+static AtomTable _atom_table = {.mutex = PTHREAD_MUTEX_INITIALIZER};
+
+/**
+ * @brief Gives the entry of an interned atom.
+ */
+static inline AtomEntry *_atom_entry(const unsigned int id) {
+  return &(_atom_table.pages[id >> ATOM_TABLE_PAGE_BITS]
+                            [id & (ATOM_TABLE_PAGE_SIZE - 1)]);
+}
+
+/**
+ * @brief Computes the FNV-1a hash of the given string.
+ */
+static unsigned int _atom_hash(const char *atom) {
+  unsigned int hash = 2166136261U;
+  while (*atom) {
+    hash ^= (unsigned char)*atom++;
+    hash *= 16777619U;
+  }
+  return hash;
+}
+
+/**
+ * @brief Doubles the number of slots of the atom table and re-inserts every
+ * atom. The mutex of the table must be held.
+ */
+static void _atom_table_grow() {
+  _atom_table.capacity = _atom_table.capacity
+                             ? (_atom_table.capacity << 1)
+                             : ATOM_TABLE_INITIAL_CAPACITY;
+  free(_atom_table.slots);
+  _atom_table.slots =
+      (unsigned int *)calloc(_atom_table.capacity, sizeof(unsigned int));
+
+  const size_t mask = _atom_table.capacity - 1,
+               size = atomic_load_explicit(&(_atom_table.size),
+                                           memory_order_relaxed);
+  size_t i, slot;
+  for (i = 0; i < size; ++i) {
+    slot = _atom_entry(i)->hash & mask;
+    while (_atom_table.slots[slot]) {
+      slot = (slot + 1) & mask;
+    }
+    _atom_table.slots[slot] = i + 1;
+  }
+}
+
+/**
+ * @brief Finds the id of the given atom, adding it to the global atom table if
+ * it has not been seen before. The atom is used as is, i.e., it is not trimmed
+ * or converted to lowercase. It is safe to call from many threads at once.
+ *
+ * @param atom The atom to be interned.
+ *
+ * @return The id of the atom.
+ */
+unsigned int literal_intern_atom(const char *const atom) {
+  pthread_mutex_lock(&(_atom_table.mutex));
+  const size_t size =
+      atomic_load_explicit(&(_atom_table.size), memory_order_relaxed);
+  if ((size + 1) * 2 > _atom_table.capacity) {
+    _atom_table_grow();
+  }
+
+  const unsigned int hash = _atom_hash(atom);
+  const size_t mask = _atom_table.capacity - 1;
+  size_t slot = hash & mask;
+  unsigned int id;
+  AtomEntry *entry;
+  while ((id = _atom_table.slots[slot])) {
+    entry = _atom_entry(--id);
+    if ((entry->hash == hash) && (strcmp(entry->literals[0].atom, atom) == 0)) {
+      pthread_mutex_unlock(&(_atom_table.mutex));
+      return id;
+    }
+    slot = (slot + 1) & mask;
+  }
+
+  id = size;
+  const unsigned int page = id >> ATOM_TABLE_PAGE_BITS;
+  if (page >= ATOM_TABLE_MAX_PAGES) {
+    fprintf(stderr, "literal_intern_atom: more than %u atoms.\n",
+            ATOM_TABLE_MAX_PAGES * ATOM_TABLE_PAGE_SIZE);
+    abort();
+  }
+  if (!_atom_table.pages[page]) {
+    _atom_table.pages[page] =
+        (AtomEntry *)malloc(ATOM_TABLE_PAGE_SIZE * sizeof(AtomEntry));
+  }
+  entry = _atom_entry(id);
+  char *const copy = strdup(atom);
+  entry->literals[0] = (Literal){.atom = copy, .id = id, .sign = 0};
+  entry->literals[1] = (Literal){.atom = copy, .id = id, .sign = 1};
+  entry->hash = hash;
+  _atom_table.slots[slot] = id + 1;
+  // Publishes the entry to the threads that read the table without the mutex.
+  atomic_store_explicit(&(_atom_table.size), size + 1, memory_order_release);
+  pthread_mutex_unlock(&(_atom_table.mutex));
+  return id;
+}
+
+/**
+ * @brief Gives the shared Literal of an interned atom with the given sign.
+ */
+static inline Literal *_literal_shared(const unsigned int id, const bool sign) {
+  return &(_atom_entry(id)->literals[sign]);
+}
+
+/**
+ * @brief Checks whether the given atom is already canonical, i.e., it has no
+ * whitespaces at its ends and no uppercase characters. A canonical atom can be
+ * interned as is, without trimming and lowercasing a copy of it.
+ */
+static bool _atom_is_canonical(const char *const atom) {
+  if (!atom[0] || isspace((unsigned char)atom[0])) {
+    return false;
+  }
+
+  size_t i;
+  for (i = 0; atom[i]; ++i) {
+    if (isupper((unsigned char)atom[i])) {
+      return false;
+    }
+  }
+  return !isspace((unsigned char)atom[i - 1]);
+}
+
+/**
+ * @brief Gives the interned atom with the given id.
+ *
+ * @param id The id of the atom.
+ *
+ * @return The atom (do not modify or free it), or NULL if no atom has this id.
+ */
+const char *literal_atom_from_id(const unsigned int id) {
+  if (id < literal_total_atoms()) {
+    return _atom_entry(id)->literals[0].atom;
+  }
+  return NULL;
+}
+
+/**
+ * @brief Gives the total number of distinct atoms that have been interned.
+ *
+ * @return The number of atoms. The ids of the atoms are [0, size).
+ */
+size_t literal_total_atoms() {
+  return atomic_load_explicit(&(_atom_table.size), memory_order_acquire);
+}
+
 /**
  * @brief Constructs a Literal. The atom's characters will be converted to their
- * lowercase form.
+ * lowercase form and the atom will be interned. The atom is only trimmed and
+ * lowercased if it is not canonical already.
  *
  * @param atom The name of the atom to be used.
  * @param sign Indicates whether the atom is negated or not. > 0 (true) is
  * positive, 0 (false) is negative.
  *
- * @return A new Literal * or NULL if atom == NULL. Use literal_destructor to
- * deallocate.
+ * @return The shared Literal * of the atom and the sign, or NULL if atom ==
+ * NULL. It must not be modified. Use literal_destructor to release it.
  */
 Literal *literal_constructor(const char *const atom, const bool sign) {
+  if (atom && _atom_is_canonical(atom)) {
+    return _literal_shared(literal_intern_atom(atom), sign > 0);
+  }
+
   char *trimmed_atom = trim(atom);
   if (trimmed_atom) {
-    Literal *literal = (Literal *)malloc(sizeof(Literal));
-    literal->atom = trimmed_atom;
     unsigned int i;
-    for (i = 0; i < strlen(literal->atom); ++i) {
-      literal->atom[i] = tolower(literal->atom[i]);
+    for (i = 0; trimmed_atom[i]; ++i) {
+      trimmed_atom[i] = tolower(trimmed_atom[i]);
     }
-    literal->sign = sign > 0;
-    return literal;
+    const unsigned int id = literal_intern_atom(trimmed_atom);
+    free(trimmed_atom);
+    return _literal_shared(id, sign > 0);
+  }
+  return NULL;
+}
+
+/**
+ * @brief Constructs a Literal of an already interned atom. No trimming or
+ * lowercasing takes place.
+ *
+ * @param id The id of the interned atom.
+ * @param sign Indicates whether the atom is negated or not. > 0 (true) is
+ * positive, 0 (false) is negative.
+ *
+ * @return The shared Literal * of the atom and the sign, or NULL if no atom has
+ * this id. It must not be modified. Use literal_destructor to release it.
+ */
+Literal *literal_constructor_from_id(const unsigned int id, const bool sign) {
+  if (id < literal_total_atoms()) {
+    return _literal_shared(id, sign > 0);
   }
   return NULL;
 }
@@ -41,42 +246,39 @@ Literal *literal_constructor(const char *const atom, const bool sign) {
  * @param string The string that the Literal will be constructed from. For a
  * negated Literal include a dash (-) in the beginning.
  *
- * @return A new Literal * or NULL if string == NULL. Use literal_destructor to
- * deallocate.
+ * @return The shared Literal * of the atom and the sign, or NULL if string ==
+ * NULL. It must not be modified. Use literal_destructor to release it.
  */
 Literal *literal_constructor_from_string(const char *const string) {
-  char *trimmed_string = trim(string);
-  if (trimmed_string) {
-    Literal *literal;
-    if (trimmed_string[0] == '-') {
-      literal = literal_constructor(trimmed_string + 1, false);
-    } else {
-      literal = literal_constructor(trimmed_string, true);
+  if (string) {
+    const char *start = string;
+    while (isspace((unsigned char)*start)) {
+      ++start;
+    }
+    if (start[0] == '-') {
+      return literal_constructor(start + 1, false);
     }
-    free(trimmed_string);
-    return literal;
+    return literal_constructor(start, true);
   }
   return NULL;
 }
 
 /**
- * @brief Destructs the given Literal.
+ * @brief Releases the given Literal. The shared Literals are never freed, so
+ * only the reference becomes NULL.
  *
- * @param literal The Literal to be destructed. It should be a reference to the
+ * @param literal The Literal to be released. It should be a reference to the
  * struct's pointer (to a Literal *).
  */
 void literal_destructor(Literal **const literal) {
-  if (literal && (*literal)) {
-    if ((*literal)->atom) {
-      safe_free((*literal)->atom);
-    }
-    (*literal)->sign = 0;
-    safe_free(*literal);
+  if (literal) {
+    *literal = NULL;
   }
 }
 
 /**
- * @brief Makes a copy of the given Literal.
+ * @brief Makes a copy of the given Literal. The copy is the shared Literal of
+ * the same atom and sign, so nothing is allocated.
  *
  * @param destination The Literal to save the copy. It should be a reference to
  * the struct's pointer (to a Literal *).
@@ -86,23 +288,21 @@ void literal_destructor(Literal **const literal) {
 void literal_copy(Literal **const destination,
                   const Literal *const restrict source) {
   if (destination && source) {
-    *destination = literal_constructor(source->atom, source->sign);
+    *destination = _literal_shared(source->id, source->sign);
   }
 }
 
 /**
  * @brief Negates the given Literal. If it is positive it will become negative,
- * and vice versa.
+ * and vice versa. The shared Literals cannot be modified, so the reference is
+ * replaced by the shared Literal of the opposite sign.
  *
- * @param literal The Literal to negate. If NULL, nothing will happen.
+ * @param literal The Literal to negate. It should be a reference to the
+ * struct's pointer (to a Literal *). If NULL, nothing will happen.
  */
-void literal_negate(Literal *const literal) {
-  if (literal) {
-    if (literal->sign) {
-      literal->sign = false;
-    } else {
-      literal->sign = true;
-    }
+void literal_negate(Literal **const literal) {
+  if (literal && (*literal)) {
+    *literal = _literal_shared((*literal)->id, !(*literal)->sign);
   }
 }
 
@@ -118,10 +318,7 @@ void literal_negate(Literal *const literal) {
 int literal_equals(const Literal *const restrict literal1,
                    const Literal *const restrict literal2) {
   if (literal1 && literal2) {
-    if (literal1->sign == literal2->sign) {
-      return (strcmp(literal1->atom, literal2->atom) == 0);
-    }
-    return 0;
+    return (literal1->id == literal2->id) && (literal1->sign == literal2->sign);
   }
   return -1;
 }
@@ -139,7 +336,7 @@ int literal_equals(const Literal *const restrict literal1,
 int literal_opposed(const Literal *const restrict literal1,
                     const Literal *const restrict literal2) {
   if (literal1 && literal2) {
-    if (strcmp(literal1->atom, literal2->atom) == 0) {
+    if (literal1->id == literal2->id) {
       return (literal1->sign != literal2->sign);
     }
     return -1;
@@ -3,21 +3,35 @@
 
 #include <pcg_variants.h>
 #include <stdbool.h>
+#include <stddef.h>
 
 // If defined, this seed will be used across the entire algorithm.
 extern pcg32_random_t *global_rng;
 
+/**
+ * @brief A signed atom. The atom is interned: every Literal with the same atom
+ * shares the same string and id. The Literals given by the constructors are
+ * shared too (one per atom and sign), so they must not be modified or freed.
+ * Atoms can be interned by many threads at once, and the Literals of the
+ * interned atoms never move.
+ */
 typedef struct Literal {
   char *atom;
+  unsigned int id;
   bool sign;
 } Literal;
 
+unsigned int literal_intern_atom(const char *const atom);
+const char *literal_atom_from_id(const unsigned int id);
+size_t literal_total_atoms();
+
 Literal *literal_constructor(const char *const atom, const bool sign);
 Literal *literal_constructor_from_string(const char *const string);
+Literal *literal_constructor_from_id(const unsigned int id, const bool sign);
 void literal_destructor(Literal **const literal);
 void literal_copy(Literal **const destination,
                   const Literal *const restrict source);
-void literal_negate(Literal *const literal);
+void literal_negate(Literal **const literal);
 int literal_equals(const Literal *const restrict literal1,
                    const Literal *const restrict literal2);
 int literal_opposed(const Literal *const restrict literal1,
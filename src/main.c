@@ -11,9 +11,12 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include "inference_engine.h"
 #include "metrics.h"
 #include "nerd.h"
 #include "nerd_helper.h"
+#include "nerd_journal.h"
+#include "snapshot_writer.h"
 
 #define DECIMAL_BASE 10
 #define STATE_SEED 31415926535U
@@ -34,10 +37,12 @@ int close_dataset_and_exit(FILE *dataset) {
 typedef struct Arguments {
   char *dataset_path, *labels_path, *incompatibility_path, *nerd_file_path;
   bool has_header, classic, partial_observation, force_entire, force_head,
-      increasing_demotion, no_inference;
+      increasing_demotion, no_inference, native_inference, binary_snapshots,
+      journal, cache;
   float threshold, promotion, demotion, testing_ratio;
   unsigned int breadth, experiment_run, max_rules;
-  size_t iterations;
+  unsigned int snapshot_cadence;
+  size_t iterations, snapshot_instances;
   unsigned long s1, s2;
 } Arguments;
 
@@ -45,6 +50,11 @@ static char args_doc[] = "DATASET-PATH LABELS-PATH THRESHOLD PROMOTION "
                          "DEMOTION BREADTH EXPERIMENT-ID";
 
 static struct argp_option options[] = {
+    {"binary", 'b', 0, 0,
+     "Save the learnt Nerd of each instance in the binary format (.ndb)."},
+    {"cache", 'C', 0, 0,
+     "Parse the training dataset once and keep its observations in memory for "
+     "every iteration, instead of reading them from the file each time."},
     {"classic", 'c', 0, 0,
      "Use classic approach. Default: back-ward chaining."},
     {"increasing-demotion", 'd', 0, 0,
@@ -61,9 +71,19 @@ static struct argp_option options[] = {
      "line of DATASET-PATH is where the headers are."},
     {"incompatibility", 'i', "FILE-PATH", 0,
      "Path of a file containing icompatibility rules."},
+    {"journal", 'j', 0, 0,
+     "Record the changes of the learnt Nerd in a single journal file instead "
+     "of saving it at each instance."},
+    {"snapshot-cadence", 'k', "CADENCE", 0,
+     "When to save (or journal) the learnt Nerd: every N instances, at the "
+     "end of each 'iteration' or whenever the 'active' rules change. Default "
+     "value: 1."},
     {"no-inference", 'I', 0, 0,
      "Forces nerd to not use an inference engine (Prudens-JS)."},
-    {"nerd-file", 'n', "NERD-FILEPATH", 0, "The path of an existing .nd file."},
+    {"nerd-file", 'n', "NERD-FILEPATH", 0,
+     "The path of an existing .nd or .ndb file."},
+    {"native-inference", 'N', 0, 0,
+     "Use the native inference engine instead of Prudens-JS."},
     {"partial-observation", 'p', 0, 0, "The file is partially observed."},
     {"rules", 'r', "MAX-RULES", 0,
      "Total number of rules to learn. Default value: 5."},
@@ -95,6 +115,12 @@ error_t parse_opt(int key, char *arg, struct argp_state *state) {
   Arguments *arguments = state->input;
   char *endptr;
   switch (key) {
+  case 'b':
+    arguments->binary_snapshots = true;
+    break;
+  case 'C':
+    arguments->cache = true;
+    break;
   case 'c':
     arguments->classic = true;
     break;
@@ -121,6 +147,24 @@ error_t parse_opt(int key, char *arg, struct argp_state *state) {
   case 'I':
     arguments->no_inference = true;
     break;
+  case 'j':
+    arguments->journal = true;
+    break;
+  case 'k':
+    if (strcmp(arg, "iteration") == 0) {
+      arguments->snapshot_cadence = SNAPSHOT_CADENCE_ITERATION;
+    } else if (strcmp(arg, "active") == 0) {
+      arguments->snapshot_cadence = SNAPSHOT_CADENCE_ACTIVE_CHANGE;
+    } else {
+      arguments->snapshot_cadence = SNAPSHOT_CADENCE_INSTANCES;
+      arguments->snapshot_instances = strtoul(arg, &endptr, DECIMAL_BASE);
+      check_positive_no_err(endptr, arg, state);
+      if (arguments->snapshot_instances == 0) {
+        printf("'%s' should be greater than 0.", arg);
+        argp_usage(state);
+      }
+    }
+    break;
   case 'n':
     arguments->nerd_file_path = arg;
     Nerd *nerd = nerd_constructor_from_file(arg, true);
@@ -130,6 +174,9 @@ error_t parse_opt(int key, char *arg, struct argp_state *state) {
     }
     nerd_destructor(&nerd);
     break;
+  case 'N':
+    arguments->native_inference = true;
+    break;
   case 'p':
     arguments->partial_observation = true;
     break;
@@ -195,17 +242,23 @@ static Arguments arguments;
 static struct argp argp = {options, parse_opt, args_doc, 0};
 
 int main(int argc, char *argv[]) {
+  arguments.binary_snapshots = false;
+  arguments.cache = false;
   arguments.classic = false;
   arguments.force_entire = false;
   arguments.force_head = false;
   arguments.incompatibility_path = NULL;
   arguments.increasing_demotion = false;
+  arguments.journal = false;
   arguments.has_header = true;
   arguments.iterations = 1;
   arguments.max_rules = 5;
   arguments.nerd_file_path = NULL;
   arguments.no_inference = false;
+  arguments.native_inference = false;
   arguments.partial_observation = false;
+  arguments.snapshot_cadence = SNAPSHOT_CADENCE_INSTANCES;
+  arguments.snapshot_instances = 1;
   arguments.testing_ratio = 0.2;
   arguments.s1 = 0;
   arguments.s2 = 0;
@@ -300,13 +353,23 @@ int main(int argc, char *argv[]) {
     fprintf(file, "i=%s\n", abs_incompatibility_path);
     free(abs_incompatibility_path);
   }
+  if (arguments.native_inference) {
+    fprintf(file, "engine=native\n");
+  } else {
+    fprintf(file, "engine=prudensjs\n");
+  }
   fprintf(file, "state_seed=%zu\nseq_seed=%zu\n", arguments.s1, arguments.s2);
 
   fclose(file);
   global_rng = &generator;
 
+  char delimiter = ' ';
+
+  if (strstr(arguments.dataset_path, ".csv")) {
+    delimiter = ',';
+  }
+
   char *train_path = NULL;
-  FILE *dataset = fopen(arguments.dataset_path, "r");
 
   if (!arguments.force_entire) {
     pcg32_random_t split_rng;
@@ -314,8 +377,14 @@ int main(int argc, char *argv[]) {
     train_path = (char *)calloc((strlen(TRAIN) + strlen(test_directory) + 1),
                                 sizeof(char));
     sprintf(train_path, "%s%s", test_directory, TRAIN);
-    if (train_test_split(dataset, arguments.has_header, arguments.testing_ratio,
-                         &split_rng, train_path, NULL, NULL, NULL) != 0) {
+    Sensor *dataset = sensor_constructor_from_file(
+        arguments.dataset_path, delimiter, false, arguments.has_header);
+    sensor_save_index(dataset);
+    const int split_result =
+        train_test_split(dataset, arguments.testing_ratio, &split_rng,
+                         train_path, NULL, NULL, NULL);
+    sensor_destructor(&dataset);
+    if (split_result != 0) {
       free(train_path);
       free(test_directory);
       return EXIT_FAILURE;
@@ -324,16 +393,25 @@ int main(int argc, char *argv[]) {
     train_path = strdup(dataset_value);
   }
   free(dataset_value);
-  fclose(dataset);
-
-  char delimiter = ' ';
 
-  if (strstr(arguments.dataset_path, ".csv")) {
-    delimiter = ',';
+  // An encoded dataset keeps its labels, so it can be given as LABELS-PATH.
+  Context *labels;
+  sensor_read_labels(arguments.labels_path, delimiter, &labels);
+  if (!labels) {
+    printf("Labels file cannot be accessed!\n");
+    if (!arguments.force_entire) {
+      remove(train_path);
+    }
+    free(train_path);
+    free(test_directory);
+    return EXIT_FAILURE;
   }
 
   Sensor *training_dataset = sensor_constructor_from_file(
       train_path, delimiter, true, arguments.has_header);
+  if (arguments.cache) {
+    sensor_cache(training_dataset);
+  }
 
   if (arguments.breadth == 0)
     arguments.breadth = training_dataset->header_size - 1;
@@ -351,11 +429,15 @@ int main(int argc, char *argv[]) {
     nerd_destructor(&given_nerd);
   }
 
-  char experiment_run[5];
-  sprintf(experiment_run, "%u", arguments.experiment_run);
-
-  prudensjs_settings_constructor(
-      argv[0], test_directory, arguments.incompatibility_path, experiment_run);
+  void (*inference_engine)(const KnowledgeBase *const, const Scene *const,
+                           Scene **const) = NULL;
+  if (arguments.native_inference) {
+    native_settings_constructor(arguments.incompatibility_path);
+    inference_engine = native_inference;
+  } else {
+    prudensjs_settings_constructor(argv[0], arguments.incompatibility_path);
+    inference_engine = prudensjs_inference;
+  }
 
   size_t total_instances = sensor_get_total_observations(training_dataset);
   const size_t iterations_str_size =
@@ -366,62 +448,34 @@ int main(int argc, char *argv[]) {
   Scene **incompatibilities = NULL;
   unsigned int i;
 
-  if (arguments.has_header) {
-    incompatibilities =
-        (Scene **)malloc(training_dataset->header_size * sizeof(Scene *));
-
-    for (i = 0; i < training_dataset->header_size; ++i) {
-      incompatibilities[i] = scene_constructor(true);
-    }
-
-    unsigned int j, k;
-    char *literal, *header;
-    Literal *copy;
-    for (i = 0; i < total_instances; ++i) {
-      sensor_get_next_scene(training_dataset, &observation);
-
-      for (j = 0; j < observation->size; ++j) {
-        literal = literal_to_string(observation->literals[j]);
-        for (k = 0; k < training_dataset->header_size; ++k) {
-          header = (char *)calloc(strlen(training_dataset->header[k]) + 2,
-                                  sizeof(char));
-          sprintf(header, "%s_", training_dataset->header[k]);
-          if (strstr(literal, header)) {
-            literal_copy(&copy, observation->literals[j]);
-            scene_add_literal(incompatibilities[k], &copy);
-            literal_destructor(&copy);
-            break;
-          }
-          safe_free(header);
-        }
-        safe_free(literal);
-      }
-
-      scene_destructor(&observation);
-    }
+  // The header of an encoded dataset is in the file, whether -H is given or
+  // not.
+  if (training_dataset->header) {
+    sensor_get_column_values(training_dataset, &incompatibilities);
   }
 
-  FILE *labels_file = fopen(arguments.labels_path, "r");
-
-  Context *labels = context_constructor(true);
-  Literal *l = NULL;
-  unsigned int j = 0;
-  int c;
-  char buffer[BUFFER_SIZE];
-  memset(buffer, 0, BUFFER_SIZE);
-
-  while ((c = fgetc(labels_file)) != EOF) {
-    if ((c == delimiter) || c == '\n') {
-      l = literal_constructor_from_string(buffer);
-      context_add_literal(labels, &l);
-      memset(buffer, 0, strlen(buffer));
-      j = 0;
-    } else {
-      buffer[j++] = c;
+  NerdJournal *journal = NULL;
+  if (arguments.journal) {
+    char *journal_path = (char *)malloc(
+        (strlen(test_directory) + strlen(NERD_JOURNAL_FILE_NAME) + 1) *
+        sizeof(char));
+    sprintf(journal_path, "%s%s", test_directory, NERD_JOURNAL_FILE_NAME);
+    if (!(journal = nerd_journal_constructor(journal_path, nerd))) {
+      printf("Could not create '%s', the learnt Nerd will be saved at each "
+             "instance instead.\n",
+             journal_path);
     }
+    free(journal_path);
   }
 
-  fclose(labels_file);
+  // The snapshots are written by another thread, so that training does not
+  // wait for the disk.
+  SnapshotWriter *snapshot_writer =
+      journal ? NULL
+              : snapshot_writer_constructor(SNAPSHOT_WRITER_DEFAULT_CAPACITY);
+  SnapshotCadence *snapshot_cadence = snapshot_cadence_constructor(
+      arguments.snapshot_cadence, arguments.snapshot_instances);
+  NerdSnapshot *snapshot = NULL;
 
   size_t iteration, instance,
       total_nerd_time_taken = 0, total_prudens_time_taken = 0,
@@ -435,7 +489,7 @@ int main(int argc, char *argv[]) {
              arguments.iterations, instance + 1, total_instances);
       sensor_get_next_scene(training_dataset, &observation);
 
-      nerd_train(nerd, arguments.no_inference ? NULL : prudensjs_inference,
+      nerd_train(nerd, arguments.no_inference ? NULL : inference_engine,
                  observation, labels, arguments.force_head, &nerd_time_taken,
                  &prudens_time_taken, training_dataset->header,
                  training_dataset->header_size, incompatibilities);
@@ -445,12 +499,26 @@ int main(int argc, char *argv[]) {
       current_iteration_prudens_time += prudens_time_taken;
 
       scene_destructor(&observation);
-      if (test_directory) {
+      if (!snapshot_cadence_is_due(snapshot_cadence, nerd, instance + 1,
+                                   total_instances)) {
+        continue;
+      }
+
+      if (journal &&
+          (nerd_journal_record(journal, nerd, iteration + 1, instance + 1) !=
+           0)) {
+        // Nothing is recorded after a failed record, since each record
+        // depends on the previous ones.
+        printf("Could not write to the journal, the learnt Nerd will be saved "
+               "at each instance instead.\n");
+        nerd_journal_destructor(&journal);
+      }
+      if (!journal && test_directory) {
         size_t current_allocated = 0;
         unsigned int z;
 
         nerd_at_instance_filename = (char *)calloc(
-            (snprintf(NULL, 0, "%siteration_%zu-instance_%zu.nd",
+            (snprintf(NULL, 0, "%siteration_%zu-instance_%zu.ndb",
                       test_directory, arguments.iterations, total_instances) +
              1),
             sizeof(char));
@@ -472,7 +540,19 @@ int main(int argc, char *argv[]) {
         sprintf(nerd_at_instance_filename + current_allocated, "%zu.nd",
                 instance + 1);
 
-        nerd_to_file(nerd, nerd_at_instance_filename);
+        if (arguments.binary_snapshots) {
+          strcat(nerd_at_instance_filename, "b");
+        }
+        if (snapshot_writer) {
+          snapshot = nerd_snapshot_constructor(nerd);
+          snapshot_writer_submit(snapshot_writer, &snapshot,
+                                 nerd_at_instance_filename,
+                                 arguments.binary_snapshots);
+        } else if (arguments.binary_snapshots) {
+          nerd_to_binary_file(nerd, nerd_at_instance_filename);
+        } else {
+          nerd_to_file(nerd, nerd_at_instance_filename);
+        }
         safe_free(nerd_at_instance_filename);
       }
     }
@@ -487,13 +567,23 @@ int main(int argc, char *argv[]) {
   printf("Total time: %zu ms\n\n",
          total_nerd_time_taken + total_prudens_time_taken);
 
-  for (i = 0; i < training_dataset->header_size; ++i) {
-    scene_destructor(&(incompatibilities[i]));
+  if (journal && (nerd_journal_destructor(&journal) != 0)) {
+    printf("The journal of the learnt Nerd could not be saved.\n");
+  }
+  if (snapshot_writer && (snapshot_writer_destructor(&snapshot_writer) != 0)) {
+    printf("Some of the learnt Nerd snapshots could not be saved.\n");
+  }
+  snapshot_cadence_destructor(&snapshot_cadence);
+  if (incompatibilities) {
+    for (i = 0; i < training_dataset->header_size; ++i) {
+      scene_destructor(&(incompatibilities[i]));
+    }
+    free(incompatibilities);
   }
-  free(incompatibilities);
   sensor_destructor(&training_dataset);
   nerd_destructor(&nerd);
   prudensjs_settings_destructor();
+  native_settings_destructor();
 
   context_destructor(&labels);
   if (!arguments.force_entire)
@@ -0,0 +1,98 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "nerd_journal.h"
+#include "nerd_utils.h"
+
+#define DECIMAL_BASE 10
+
+int main(int argc, char *argv[]) {
+  if ((argc != 2) && (argc != 4)) {
+    printf("Journal filepath (.ndj) is required, and optionally the iteration "
+           "and the instance to materialize. Otherwise every journaled "
+           "instance is materialized.\n");
+    return EXIT_FAILURE;
+  }
+
+  size_t iteration = 0, instance = 0;
+  if (argc == 4) {
+    char *endptr;
+    iteration = strtoul(argv[2], &endptr, DECIMAL_BASE);
+    if (*endptr || (iteration == 0)) {
+      printf("'%s' is not a valid iteration.\n", argv[2]);
+      return EXIT_FAILURE;
+    }
+    instance = strtoul(argv[3], &endptr, DECIMAL_BASE);
+    if (*endptr || (instance == 0)) {
+      printf("'%s' is not a valid instance.\n", argv[3]);
+      return EXIT_FAILURE;
+    }
+  }
+
+  // The snapshots are named as the ones saved by main, so the widths of the
+  // last iteration and instance are needed.
+  NerdJournalReader *reader = nerd_journal_reader_constructor(argv[1]);
+  if (!reader) {
+    printf("'%s' is not a valid journal.\n", argv[1]);
+    return EXIT_FAILURE;
+  }
+  size_t max_iteration = 0, max_instance = 0;
+  int error_code;
+  while ((error_code = nerd_journal_reader_next(reader)) == 0) {
+    if (reader->iteration > max_iteration) {
+      max_iteration = reader->iteration;
+    }
+    if (reader->instance > max_instance) {
+      max_instance = reader->instance;
+    }
+  }
+  nerd_journal_reader_destructor(&reader);
+  if (error_code != 1) {
+    printf("'%s' has a bad format.\n", argv[1]);
+    return EXIT_FAILURE;
+  }
+
+  const int iteration_width = snprintf(NULL, 0, "%zu", max_iteration),
+            instance_width = snprintf(NULL, 0, "%zu", max_instance);
+  const char *last_slash = strrchr(argv[1], '/');
+  const size_t directory_size = last_slash ? (last_slash - argv[1] + 1) : 0;
+  char *nerd_file_path = (char *)calloc(
+      directory_size + snprintf(NULL, 0, "iteration_%0*zu-instance_%0*zu.nd",
+                                iteration_width, max_iteration,
+                                instance_width, max_instance) +
+          1,
+      sizeof(char));
+  memcpy(nerd_file_path, argv[1], directory_size);
+
+  size_t total_materialized = 0;
+  Nerd *nerd;
+  reader = nerd_journal_reader_constructor(argv[1]);
+  while (nerd_journal_reader_next(reader) == 0) {
+    if ((reader->iteration == 0) ||
+        ((argc == 4) &&
+         ((reader->iteration != iteration) || (reader->instance != instance)))) {
+      continue;
+    }
+
+    sprintf(nerd_file_path + directory_size, "iteration_%0*zu-instance_%0*zu.nd",
+            iteration_width, reader->iteration, instance_width,
+            reader->instance);
+    nerd = nerd_journal_reader_to_nerd(reader, false);
+    nerd_to_file(nerd, nerd_file_path);
+    nerd_destructor(&nerd);
+    ++total_materialized;
+
+    if (argc == 4) {
+      break;
+    }
+  }
+  nerd_journal_reader_destructor(&reader);
+  free(nerd_file_path);
+
+  if (total_materialized == 0) {
+    printf("No journaled instance was found.\n");
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -1,4 +1,5 @@
 #include <pcg_variants.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <string.h>
 #include <time.h>
@@ -6,97 +7,394 @@
 #include "metrics.h"
 #include "nerd_utils.h"
 
+#define EVALUATION_CHUNK_SIZE 64
+#define EVALUATION_CHUNKS_PER_THREAD 4
+
 /**
- * @brief Evaluates whether Nerd's KnowledgeBase can predict all the observed
- * Literals when hidding a Literal. If the given observation has 6 Literals, 6
- * different scenarios will be tested accordingly.
+ * @brief A chunk of observations whose Literals are hidden and evaluated by one
+ * of the threads of _evaluate_hidden_literals. Each chunk has its own random
+ * number generator stream, so that the hidden Literals do not depend on the
+ * number of threads.
+ */
+typedef struct EvaluationChunk {
+  const KnowledgeBase *knowledge_base;
+  int (*inference_engine_batch)(const KnowledgeBase *const knowledge_base,
+                                const size_t total_observations,
+                                Scene **restrict observation,
+                                Scene ***const inference,
+                                char **const save_inferring_rules);
+  bool header;
+  float ratio;
+  pcg32_random_t rng;
+  Scene *observations[EVALUATION_CHUNK_SIZE];
+  size_t size, total_hidden, total_recovered, total_incorrectly_recovered,
+      total_not_recovered;
+  int error;
+} EvaluationChunk;
+
+/**
+ * @brief A chunk of the observations of evaluate_labels, which are inferred by
+ * one of its threads. If the cache is given, the chunk is inferred
+ * incrementally, where first is the index of its first observation.
+ */
+typedef struct LabelsChunk {
+  const KnowledgeBase *knowledge_base;
+  int (*inference_engine_batch)(const KnowledgeBase *const knowledge_base,
+                                const size_t total_observations,
+                                Scene **restrict observation,
+                                Scene ***const inference,
+                                char **const save_inferring_rules);
+  NativeInferenceCache *cache;
+  Scene **observations, **inferences;
+  size_t first, size, reinferred;
+  bool save_inferring_rules;
+  char *rules;
+  int error;
+} LabelsChunk;
+
+/**
+ * @brief The state shared by the threads of _evaluate_chunks.
+ */
+typedef struct ChunkQueue {
+  void *chunks;
+  size_t chunk_size, total_chunks, next;
+  void (*evaluate_chunk)(void *chunk);
+  pthread_mutex_t mutex;
+} ChunkQueue;
+
+/**
+ * @brief The body of each thread of _evaluate_chunks. It takes the next chunk
+ * that has not been evaluated yet, until none are left.
+ */
+static void *_evaluate_chunks_run(void *argument) {
+  ChunkQueue *queue = (ChunkQueue *)argument;
+  size_t chunk;
+  while (true) {
+    pthread_mutex_lock(&(queue->mutex));
+    chunk = queue->next++;
+    pthread_mutex_unlock(&(queue->mutex));
+    if (chunk >= queue->total_chunks) {
+      return NULL;
+    }
+    queue->evaluate_chunk((char *)queue->chunks + chunk * queue->chunk_size);
+  }
+}
+
+/**
+ * @brief Evaluates the given chunks using up to the given number of threads.
+ * Each chunk is only accessed by the thread evaluating it, so the results do
+ * not depend on the number of threads.
  *
- * @param nerd The Nerd struct where the learnt KnowledgeBase to evaluate is.
- * @param inference_engine An inference engine function. First param should be
- * for the knowledge_base (Knolwedgebase *), second for the observation (Scene
- * *), and the last should be for the inference to be saved (Scene **).
- * @param sensor_to_evaluate The Sensor * containing the evaluation samples.
- * @param total_hidden A size_t pointer to save the total number of the Literals
- * that the algorithm has hidden.
- * @param total_recovered A size_t pointer to save the total number of correctly
- * recovered hidden Literals.
- * @param total_incorrectly_recovered A size_t pointer to save the total number
- * of incorrectly recovered hidden Literals (opposed Literals). If NULL, the
- * number will ne discarded.
- * @param total_not_recovered A size_t pointer to save the total number of
- * hidden Literals that were not recovered. If NULL, the number will be
- * discarded.
+ * @param chunks An array with the chunks.
+ * @param chunk_size The size (in bytes) of each chunk.
+ * @param total_chunks The number of chunks.
+ * @param threads The maximum number of threads. If it is 0 or 1, or a thread
+ * cannot be created, the chunks are evaluated by the calling thread.
+ * @param evaluate_chunk The function that evaluates a single chunk.
+ */
+static void _evaluate_chunks(void *const chunks, const size_t chunk_size,
+                             const size_t total_chunks,
+                             const unsigned int threads,
+                             void (*evaluate_chunk)(void *chunk)) {
+  ChunkQueue queue = {.chunks = chunks,
+                      .chunk_size = chunk_size,
+                      .total_chunks = total_chunks,
+                      .next = 0,
+                      .evaluate_chunk = evaluate_chunk};
+  const size_t total_threads =
+      (threads < total_chunks) ? threads : total_chunks;
+  size_t i, created = 0;
+
+  if (total_threads > 1) {
+    pthread_mutex_init(&(queue.mutex), NULL);
+    pthread_t *workers =
+        (pthread_t *)malloc((total_threads - 1) * sizeof(pthread_t));
+    for (; created < total_threads - 1; ++created) {
+      if (pthread_create(&(workers[created]), NULL, _evaluate_chunks_run,
+                         &queue) != 0) {
+        break;
+      }
+    }
+    _evaluate_chunks_run(&queue);
+    for (i = 0; i < created; ++i) {
+      pthread_join(workers[i], NULL);
+    }
+    free(workers);
+    pthread_mutex_destroy(&(queue.mutex));
+    return;
+  }
+
+  for (i = 0; i < total_chunks; ++i) {
+    evaluate_chunk((char *)chunks + i * chunk_size);
+  }
+}
+
+/**
+ * @brief Evaluates every leave-one-out variant of the observations of an
+ * EvaluationChunk with a single call to the batch inference engine. The i-th
+ * variant of an observation with n Literals holds Literals i + 1, ..., n - 1,
+ * 0, ..., i - 1, in this order.
+ */
+/**
+ * @brief Gives the column prefix ('header_') of the atom of a Literal of a
+ * dataset with a header.
  *
- * @return 0 if the function was executed successfully, -1 if one of the given
- * parameters was NULL, -2 if a non existant path was given to
- * sensor_to_evaluate, or -3 if an error has occurred.
+ * @return The prefix (use free to deallocate it), or NULL if the atom has no
+ * prefix.
  */
-int evaluate_all_literals(
-    const Nerd *const nerd,
-    void (*inference_engine)(const KnowledgeBase *const knowledge_base,
-                             const Scene *const restrict observation,
-                             Scene **inference),
-    const Sensor *const sensor_to_evaluate, size_t *const restrict total_hidden,
-    size_t *const restrict total_recovered,
-    size_t *const restrict total_incorrectly_recovered,
-    size_t *const restrict total_not_recovered) {
-  if (!(nerd && sensor_to_evaluate && total_hidden && total_recovered)) {
-    return -1;
+static char *_column_prefix(const Literal *const literal) {
+  const char *const separator = strchr(literal->atom, '_');
+  if (!separator) {
+    return NULL;
   }
+  const size_t prefix_size = separator - literal->atom + 1;
+  char *prefix = (char *)malloc((prefix_size + 1) * sizeof(char));
+  memcpy(prefix, literal->atom, prefix_size);
+  prefix[prefix_size] = '\0';
+  return prefix;
+}
 
-  const size_t total_observations =
-      sensor_get_total_observations(sensor_to_evaluate);
+/**
+ * @brief Checks whether an inferred Literal incorrectly recovers a hidden one,
+ * i.e., it is opposed to it, or the hidden Literal is negative and the
+ * inferred one is of the same column.
+ *
+ * @param expected_header The column prefix of the hidden Literal, or NULL if
+ * the dataset has no header.
+ */
+static bool _incorrectly_recovered(const Literal *const hidden,
+                                   const Literal *const inferred,
+                                   const char *const expected_header) {
+  return (literal_opposed(hidden, inferred) == 1) ||
+         (expected_header && !hidden->sign &&
+          strstr(inferred->atom, expected_header));
+}
+
+static void _evaluate_all_literals_chunk(void *argument) {
+  EvaluationChunk *chunk = (EvaluationChunk *)argument;
+  size_t total_variants = 0, i, v;
+  unsigned int j, k;
+  for (i = 0; i < chunk->size; ++i) {
+    total_variants += chunk->observations[i]->size;
+  }
+  chunk->total_hidden = total_variants;
+  if (total_variants == 0) {
+    return;
+  }
+
+  Scene **variants = (Scene **)malloc(total_variants * sizeof(Scene *)),
+        **inferences = NULL, *observation;
+  Literal **removed_literals =
+      (Literal **)malloc(total_variants * sizeof(Literal *));
+  Literal *literal;
+
+  for (i = 0, v = 0; i < chunk->size; ++i) {
+    observation = chunk->observations[i];
+    for (j = 0; j < observation->size; ++j, ++v) {
+      variants[v] = scene_constructor(false);
+      removed_literals[v] = observation->literals[j];
+      for (k = 1; k < observation->size; ++k) {
+        literal = observation->literals[(j + k) % observation->size];
+        scene_add_literal(variants[v], &literal);
+      }
+    }
+  }
+
+  if (chunk->inference_engine_batch(chunk->knowledge_base, total_variants,
+                                    variants, &inferences, NULL) != 0) {
+    chunk->error = -3;
+    inferences = NULL;
+  }
 
   Literal *removed_literal;
-  Scene *observation, *inference;
+  char *expected_header = NULL;
+  for (v = 0; v < total_variants; ++v) {
+    scene_destructor(&(variants[v]));
+    if (!inferences) {
+      continue;
+    }
+    removed_literal = removed_literals[v];
+    if (chunk->header) {
+      expected_header = _column_prefix(removed_literal);
+    }
+    for (k = 0; k < inferences[v]->size; ++k) {
+      switch (literal_equals(removed_literal, inferences[v]->literals[k])) {
+      case 1:
+        ++chunk->total_recovered;
+        goto finished;
+      case 0:
+        if (_incorrectly_recovered(removed_literal, inferences[v]->literals[k],
+                                   expected_header)) {
+          ++chunk->total_incorrectly_recovered;
+          goto finished;
+        }
+        break;
+      default:
+        chunk->error = -3;
+        goto finished;
+      }
+    }
+    ++chunk->total_not_recovered;
+  finished:
+    safe_free(expected_header);
+    scene_destructor(&(inferences[v]));
+  }
+
+  free(inferences);
+  free(removed_literals);
+  free(variants);
+}
+
+/**
+ * @brief Hides a ratio of the Literals of each observation of an
+ * EvaluationChunk, using the chunk's random number generator, and evaluates the
+ * remaining observations with a single call to the batch inference engine.
+ */
+static void _evaluate_random_literals_chunk(void *argument) {
+  EvaluationChunk *chunk = (EvaluationChunk *)argument;
+  Scene **removed_literals = (Scene **)malloc(chunk->size * sizeof(Scene *)),
+        **inferences = NULL, *observation;
+  Literal *removed_literal;
+  size_t new_size, remaining, i;
+  unsigned int j, k;
+
+  for (i = 0; i < chunk->size; ++i) {
+    observation = chunk->observations[i];
+    removed_literals[i] = scene_constructor(true);
+    new_size = observation->size - (observation->size * chunk->ratio);
+    remaining = observation->size;
 
+    while (removed_literals[i]->size != new_size) {
+      scene_remove_literal(observation,
+                           pcg32_random_r(&(chunk->rng)) % remaining--,
+                           &removed_literal);
+      scene_add_literal(removed_literals[i], &removed_literal);
+    }
+    chunk->total_hidden += removed_literals[i]->size;
+  }
+
+  if (chunk->inference_engine_batch(chunk->knowledge_base, chunk->size,
+                                    chunk->observations, &inferences,
+                                    NULL) != 0) {
+    chunk->error = -3;
+    inferences = NULL;
+  }
+
+  int equals_result;
   char *expected_header = NULL;
-  size_t j, total_hidden_ = 0, total_recovered_ = 0,
-            total_incorrectly_recovered_ = 0, total_not_recovered_ = 0;
-  unsigned int i, k;
-  for (j = 0; j < total_observations; ++j) {
-    sensor_get_next_scene(sensor_to_evaluate, &observation);
-
-    total_hidden_ += observation->size;
-    for (i = 0; i < observation->size; ++i) {
-      scene_remove_literal(observation, 0, &removed_literal);
-
-      inference_engine(nerd->knowledge_base, observation, &inference);
-
-      if (sensor_to_evaluate->header) {
-        expected_header = (char *)malloc(
-            (strstr(removed_literal->atom, "_") - removed_literal->atom + 2) *
-            sizeof(char));
+  for (i = 0; i < chunk->size; ++i) {
+    for (j = 0; inferences && (j < removed_literals[i]->size); ++j) {
+      removed_literal = removed_literals[i]->literals[j];
+      if (chunk->header) {
+        expected_header = _column_prefix(removed_literal);
       }
-      for (k = 0; k < inference->size; ++k) {
-        switch (literal_equals(removed_literal, inference->literals[k])) {
-        case 1:
-          ++total_recovered_;
-          goto finished;
-        case 0:
-          if ((literal_opposed(removed_literal, inference->literals[k]) == 1) ||
-              (expected_header &&
-               (strstr(removed_literal->atom, expected_header) &&
-                !removed_literal->sign))) {
-            ++total_incorrectly_recovered_;
-            goto finished;
-          }
-          break;
-        default:
-          scene_destructor(&observation);
-          scene_destructor(&inference);
-          safe_free(expected_header);
-          return -3;
+      for (k = 0; k < inferences[i]->size; ++k) {
+        equals_result =
+            literal_equals(removed_literal, inferences[i]->literals[k]);
+        if (equals_result == 1) {
+          ++chunk->total_recovered;
+          goto next_literal;
+        } else if ((equals_result == 0) &&
+                   _incorrectly_recovered(removed_literal,
+                                          inferences[i]->literals[k],
+                                          expected_header)) {
+          ++chunk->total_incorrectly_recovered;
+          goto next_literal;
         }
       }
-      ++total_not_recovered_;
-    finished:
+      ++chunk->total_not_recovered;
+    next_literal:
       safe_free(expected_header);
-      scene_destructor(&inference);
-      scene_add_literal(observation, &removed_literal);
     }
 
-    scene_destructor(&observation);
+    scene_destructor(&(removed_literals[i]));
+    if (inferences) {
+      scene_destructor(&(inferences[i]));
+    }
+  }
+
+  free(inferences);
+  free(removed_literals);
+}
+
+/**
+ * @brief Reads the observations of the Sensor in chunks of
+ * EVALUATION_CHUNK_SIZE and evaluates the hidden Literals of each chunk with
+ * the given function, using the given number of threads. The observations are
+ * read by the calling thread only, in the Sensor's order.
+ *
+ * @param seed The state seed of the random number generators of the chunks.
+ * The i-th chunk uses the i-th stream of this seed.
+ * @param evaluate_chunk The function that hides and evaluates the Literals of
+ * an EvaluationChunk.
+ *
+ * @return 0 if the evaluation ended successfully, or -3 if an error occurred.
+ * See evaluate_all_literals for the rest of the parameters.
+ */
+static int _evaluate_hidden_literals(
+    const Nerd *const nerd,
+    int (*inference_engine_batch)(const KnowledgeBase *const knowledge_base,
+                                  const size_t total_observations,
+                                  Scene **restrict observation,
+                                  Scene ***const inference,
+                                  char **const save_inferring_rules),
+    const Sensor *const sensor_to_evaluate, const unsigned int threads,
+    const float ratio, const uint64_t seed,
+    void (*evaluate_chunk)(void *chunk), size_t *const restrict total_hidden,
+    size_t *const restrict total_recovered,
+    size_t *const restrict total_incorrectly_recovered,
+    size_t *const restrict total_not_recovered) {
+  const size_t total_observations =
+      sensor_get_total_observations(sensor_to_evaluate),
+               chunks_per_round =
+                   ((threads > 1) ? threads : 1) * EVALUATION_CHUNKS_PER_THREAD;
+  EvaluationChunk *chunks =
+      (EvaluationChunk *)malloc(chunks_per_round * sizeof(EvaluationChunk));
+  EvaluationChunk *chunk;
+
+  int error = 0;
+  size_t i = 0, j, total_chunks, chunk_index = 0, total_hidden_ = 0,
+         total_recovered_ = 0, total_incorrectly_recovered_ = 0,
+         total_not_recovered_ = 0;
+  while ((i < total_observations) && (error == 0)) {
+    for (total_chunks = 0;
+         (total_chunks < chunks_per_round) && (i < total_observations);
+         ++total_chunks) {
+      chunk = &(chunks[total_chunks]);
+      *chunk = (EvaluationChunk){
+          .knowledge_base = nerd->knowledge_base,
+          .inference_engine_batch = inference_engine_batch,
+          .header = sensor_to_evaluate->header != NULL,
+          .ratio = ratio};
+      pcg32_srandom_r(&(chunk->rng), seed, chunk_index++);
+      for (; (chunk->size < EVALUATION_CHUNK_SIZE) && (i < total_observations);
+           ++i) {
+        sensor_get_next_scene(sensor_to_evaluate,
+                              &(chunk->observations[chunk->size++]));
+      }
+    }
+
+    _evaluate_chunks(chunks, sizeof(EvaluationChunk), total_chunks, threads,
+                     evaluate_chunk);
+
+    for (j = 0; j < total_chunks; ++j) {
+      chunk = &(chunks[j]);
+      total_hidden_ += chunk->total_hidden;
+      total_recovered_ += chunk->total_recovered;
+      total_incorrectly_recovered_ += chunk->total_incorrectly_recovered;
+      total_not_recovered_ += chunk->total_not_recovered;
+      if (chunk->error != 0) {
+        error = chunk->error;
+      }
+      while (chunk->size > 0) {
+        scene_destructor(&(chunk->observations[--chunk->size]));
+      }
+    }
+  }
+  free(chunks);
+
+  if (error != 0) {
+    return error;
   }
 
   *total_hidden = total_hidden_;
@@ -113,15 +411,79 @@ int evaluate_all_literals(
   return 0;
 }
 
+/**
+ * @brief Evaluates whether Nerd's KnowledgeBase can predict all the observed
+ * Literals when hidding a Literal. If the given observation has 6 Literals, 6
+ * different scenarios will be tested accordingly. The scenarios of every
+ * EVALUATION_CHUNK_SIZE observations are inferred with a single call of the
+ * inference engine, and the chunks are distributed among the given threads.
+ *
+ * @param nerd The Nerd struct where the learnt KnowledgeBase to evaluate is.
+ * @param inference_engine_batch An inference engine function returning int.
+ * First param should be for the knowledge_base (Knolwedgebase *), second for
+ * the total observations, third for the observations (Scene **), fourth should
+ * be for the inferences to be saved (Scene ***), and the last one should be
+ * used to save the inferring rules (char **). It will be given NULL.
+ * @param sensor_to_evaluate The Sensor * containing the evaluation samples.
+ * @param threads The number of threads to evaluate the chunks with. If it is
+ * greater than 1, the inference engine should be safe to call concurrently
+ * (e.g. native_inference_batch, but not prudensjs_inference_batch). The results
+ * do not depend on the number of threads.
+ * @param total_hidden A size_t pointer to save the total number of the Literals
+ * that the algorithm has hidden.
+ * @param total_recovered A size_t pointer to save the total number of correctly
+ * recovered hidden Literals.
+ * @param total_incorrectly_recovered A size_t pointer to save the total number
+ * of incorrectly recovered hidden Literals (opposed Literals). If NULL, the
+ * number will ne discarded.
+ * @param total_not_recovered A size_t pointer to save the total number of
+ * hidden Literals that were not recovered. If NULL, the number will be
+ * discarded.
+ *
+ * @return 0 if the function was executed successfully, -1 if one of the given
+ * parameters was NULL, -2 if a non existant path was given to
+ * sensor_to_evaluate, or -3 if an error has occurred.
+ */
+int evaluate_all_literals(
+    const Nerd *const nerd,
+    int (*inference_engine_batch)(const KnowledgeBase *const knowledge_base,
+                                  const size_t total_observations,
+                                  Scene **restrict observation,
+                                  Scene ***const inference,
+                                  char **const save_inferring_rules),
+    const Sensor *const sensor_to_evaluate, const unsigned int threads,
+    size_t *const restrict total_hidden, size_t *const restrict total_recovered,
+    size_t *const restrict total_incorrectly_recovered,
+    size_t *const restrict total_not_recovered) {
+  if (!(nerd && sensor_to_evaluate && total_hidden && total_recovered)) {
+    return -1;
+  }
+
+  return _evaluate_hidden_literals(
+      nerd, inference_engine_batch, sensor_to_evaluate, threads, 0, 0,
+      _evaluate_all_literals_chunk, total_hidden, total_recovered,
+      total_incorrectly_recovered, total_not_recovered);
+}
+
 /**
  * @brief Evalaute whether the Nerd's learnt KnowledgeBase can predict (recover)
- * the random Literals that will be hidden (removed) by the algorithm.
+ * the random Literals that will be hidden (removed) by the algorithm. Every
+ * EVALUATION_CHUNK_SIZE observations are inferred with a single call of the
+ * inference engine, and the chunks are distributed among the given threads.
+ * The Literals of each chunk are hidden using a different stream of the same
+ * seed, which is taken from the global_rng (or the time if it is NULL), so the
+ * results do not depend on the number of threads.
  *
  * @param nerd The Nerd struct where the learnt KnowledgeBase to evaluate is.
- * @param inference_engine An inference engine function. First param should be
- * for the knowledge_base (Knolwedgebase *), second for the observation (Scene
- * *), and the last should be for the inference to be saved (Scene **).
+ * @param inference_engine_batch An inference engine function returning int.
+ * First param should be for the knowledge_base (Knolwedgebase *), second for
+ * the total observations, third for the observations (Scene **), fourth should
+ * be for the inferences to be saved (Scene ***), and the last one should be
+ * used to save the inferring rules (char **). It will be given NULL.
  * @param sensor_to_evaluate The Sensor * containing the evaluation samples.
+ * @param threads The number of threads to evaluate the chunks with. If it is
+ * greater than 1, the inference engine should be safe to call concurrently
+ * (e.g. native_inference_batch, but not prudensjs_inference_batch).
  * @param ratio A float variable which indicates the ratio of the Literals to be
  * hidden.
  * @param total_hidden A size_t pointer to save the total number of the Literals
@@ -136,16 +498,20 @@ int evaluate_all_literals(
  * discarded.
  *
  * @return 0 if the function was executed successfully, -1 if one of the given
- * parameters was NULL or the ratio was not in the range (0, 1), or -2 if a non
- * existant path was given to sensor_to_evaluate.
+ * parameters was NULL or the ratio was not in the range (0, 1), -2 if a non
+ * existant path was given to sensor_to_evaluate, or -3 if the inference engine
+ * failed.
  */
 int evaluate_random_literals(
     const Nerd *const nerd,
-    void (*inference_engine)(const KnowledgeBase *const knowledge_base,
-                             const Scene *const restrict observation,
-                             Scene **inference),
-    const Sensor *const sensor_to_evaluate, const float ratio,
-    size_t *const restrict total_hidden, size_t *const restrict total_recovered,
+    int (*inference_engine_batch)(const KnowledgeBase *const knowledge_base,
+                                  const size_t total_observations,
+                                  Scene **restrict observation,
+                                  Scene ***const inference,
+                                  char **const save_inferring_rules),
+    const Sensor *const sensor_to_evaluate, const unsigned int threads,
+    const float ratio, size_t *const restrict total_hidden,
+    size_t *const restrict total_recovered,
     size_t *const restrict total_incorrectly_recovered,
     size_t *const restrict total_not_recovered) {
   if (!(nerd && sensor_to_evaluate && total_hidden && total_recovered &&
@@ -153,156 +519,102 @@ int evaluate_random_literals(
     return -1;
   }
 
-  const size_t total_observations =
-      sensor_get_total_observations(sensor_to_evaluate);
-
-  Literal *removed_literal = NULL;
-  Scene *removed_literals = NULL, *observation = NULL, *inference = NULL;
-  pcg32_random_t *rng = global_rng;
-  if (!rng) {
-    rng = (pcg32_random_t *)malloc(sizeof(pcg32_random_t));
-    pcg32_srandom_r(rng, time(NULL), 314159U);
-  }
-
-  int equals_result;
-  size_t total_hidden_ = 0, total_recovered_ = 0,
-         total_incorrectly_recovered_ = 0, total_not_recovered_ = 0, remaining,
-         new_size;
-  unsigned int i, j, k, *possible_indices = NULL;
-  char *expected_header = NULL;
-
-  for (i = 0; i < total_observations; ++i) {
-    removed_literals = scene_constructor(true);
-    sensor_get_next_scene(sensor_to_evaluate, &observation);
-    const size_t observation_size = observation->size;
-
-    possible_indices = (unsigned int *)malloc(observation_size * sizeof(int));
-    for (j = 0; j < observation_size; ++j) {
-      possible_indices[j] = j;
-    }
-
-    new_size = observation_size - (observation_size * ratio);
-    remaining = observation->size;
-
-    while (removed_literals->size != new_size) {
-      scene_remove_literal(observation,
-                           possible_indices[pcg32_random_r(rng) % remaining--],
-                           &removed_literal);
-      scene_add_literal(removed_literals, &removed_literal);
-    }
-    safe_free(possible_indices);
-
-    inference_engine(nerd->knowledge_base, observation, &inference);
+  const uint64_t seed =
+      global_rng ? pcg32_random_r(global_rng) : (uint64_t)time(NULL);
 
-    total_hidden_ += removed_literals->size;
-
-    for (j = 0; j < removed_literals->size; ++j) {
-      removed_literal = removed_literals->literals[j];
-      size_t header_size = 0;
-      if (sensor_to_evaluate->header) {
-        header_size =
-            strchr(removed_literal->atom, '_') - removed_literal->atom + 2;
-        expected_header = (char *)malloc(header_size * sizeof(char));
-        strncpy(expected_header, removed_literal->atom, header_size - 1);
-        expected_header[header_size - 1] = '\0';
-      }
-      for (k = 0; k < inference->size; ++k) {
-        equals_result = literal_equals(removed_literal, inference->literals[k]);
-        if (equals_result == 1) {
-          ++total_recovered_;
-          goto next_literal;
-        } else if (equals_result == 0) {
-          if ((literal_opposed(removed_literal, inference->literals[k]) == 1) ||
-              (sensor_to_evaluate->header &&
-               (strstr(inference->literals[k]->atom, expected_header) &&
-                !removed_literal->sign))) {
-            ++total_incorrectly_recovered_;
-            goto next_literal;
-          }
-        }
-      }
-      ++total_not_recovered_;
-    next_literal:
-      safe_free(expected_header);
-    }
+  return _evaluate_hidden_literals(
+      nerd, inference_engine_batch, sensor_to_evaluate, threads, ratio, seed,
+      _evaluate_random_literals_chunk, total_hidden, total_recovered,
+      total_incorrectly_recovered, total_not_recovered);
+}
 
-    scene_destructor(&observation);
-    scene_destructor(&removed_literals);
-    scene_destructor(&inference);
+/**
+ * @brief Infers the observations of a LabelsChunk with a single call to the
+ * batch inference engine, or to the incremental native inference.
+ */
+static void _evaluate_labels_chunk(void *argument) {
+  LabelsChunk *chunk = (LabelsChunk *)argument;
+  int error;
+  if (chunk->cache) {
+    error = native_inference_batch_cached(
+        chunk->knowledge_base, chunk->cache, chunk->first, chunk->size,
+        chunk->observations, &(chunk->inferences),
+        chunk->save_inferring_rules ? &(chunk->rules) : NULL,
+        &(chunk->reinferred));
+  } else {
+    error = chunk->inference_engine_batch(
+        chunk->knowledge_base, chunk->size, chunk->observations,
+        &(chunk->inferences),
+        chunk->save_inferring_rules ? &(chunk->rules) : NULL);
   }
-
-  if (!global_rng) {
-    free(rng);
+  if (error != 0) {
+    chunk->error = -3;
+    chunk->inferences = NULL;
+    chunk->rules = NULL;
   }
+}
 
-  *total_hidden = total_hidden_;
-  *total_recovered = total_recovered_;
-
-  if (total_incorrectly_recovered) {
-    *total_incorrectly_recovered = total_incorrectly_recovered_;
+/**
+ * @brief Concatenates the inferring rules of the chunks of evaluate_labels.
+ * Each chunk numbers its observations from 2 onwards (as Prudens-JS does), and
+ * separates them with an empty line, so the numbers of a chunk are offset by
+ * the index of its first observation.
+ *
+ * @return A new char * with the inferring rules of all the chunks.
+ */
+static char *_merge_inferring_rules(const LabelsChunk *const chunks,
+                                    const size_t total_chunks,
+                                    const size_t chunk_size) {
+  size_t length = 1, i, offset = 0;
+  for (i = 0; i < total_chunks; ++i) {
+    // Each number may get longer by up to 20 digits.
+    length += strlen(chunks[i].rules) + 2 + chunks[i].size * 20;
   }
 
-  if (total_not_recovered) {
-    *total_not_recovered = total_not_recovered_;
+  char *result = (char *)malloc(length * sizeof(char)), *current, *end, *next;
+  size_t number, body_length;
+  result[0] = '\0';
+  for (i = 0; i < total_chunks; ++i) {
+    current = chunks[i].rules;
+    while (*current) {
+      number = strtoul(current, &end, 10);
+      if ((end == current) || (strncmp(end, ": ", 2) != 0)) {
+        strcpy(result + offset, current);
+        offset += strlen(current);
+        break;
+      }
+      next = strstr(end, "\n\n");
+      body_length = next ? (size_t)(next - end) : strlen(end);
+      offset += sprintf(result + offset, "%s%zu", (offset == 0) ? "" : "\n\n",
+                        number + i * chunk_size);
+      memcpy(result + offset, end, body_length);
+      offset += body_length;
+      result[offset] = '\0';
+      current = next ? next + 2 : end + body_length;
+    }
   }
-
-  return 0;
+  return result;
 }
 
 /**
- * @brief Evaluates the Nerd's learnt KnowledgeBase by checking whether it can
- * find the corresponding Literal marked as a label. The labels are given as a
- * Context with the labels. The algorithm will find the label from the original
- * observation, and then it will use the integrated inference engine to find out
- * whether the engine can infer that Literal or not.
- *
- * @param nerd The Nerd struct where the learnt KnowledgeBase to evaluate is.
- * @param inference_engine An inference engine function returning int. First
- * param should be for the knowledge_base (Knolwedgebase *), second for the
- * total observations, third for the observations (Scene **), third should be
- * for the inferences to be saved (Scene ***), and the last one should be used
- * to save the inferring rules as a strings separated with a new line '\n' (char
- * **).
- * @param sensor_to_evaluate The Sensor * containing the evaluation samples.
- * @param labels The Context containing all the Literals that act a labels.
- * @param accuracy A pointer to a float variable to save the overall accuracy of
- * the KnowledgeBase over the given samples. If NULL is given, it will not be
- * saved.
- * @param abstain_ratio A pointer to a float variable to save the abstain ratio
- * of the KnowledgeBase over the given samples. Abstain means that with the
- * given KnowledgeBase a label cannot be predicted, either correct or incorrect.
- * If NULL is given, this ratio will not be saved.
- * @param total_observations A size_t * to save the number of total
- * observations. If NULL, it will not be saved.
- * @param observations A Scene *** to save the observations. It should be a
- * reference to a Scene **. Requires total_observations to work. If NULL is
- * given, they will not be saved.
- * @param inferences A Scene *** to save the inferences. It should be a
- * reference to a Scene **. Requires total_observations to work. If NULL is
- * given, they will not be saved.
- * @param save_inferring_rules A char ** (reference to a char *) to save the
- * inferring rules as a string. If NULL, they won't be saved.
- * @param partial_observation Indicates if the observation is partially
- * observed, and the label could be missing.
- *
- * @return 0 if the evaluation ended successfully, -1 if it one nerd, settings,
- * file_to_evaluation or labels where NULL, > 0 which will be the index of the
- * first observation that does not have a provided label (index calculated from
- * the given file), -2 if total_observation was not given, but either
- * observations or inferences were given.
+ * @brief The implementation of evaluate_labels and
+ * evaluate_labels_incremental. If the cache is given, the observations are
+ * inferred incrementally with it, instead of the inference_engine_batch, and
+ * the number of re-inferred observations is saved in reinferred (if not NULL).
  */
-int evaluate_labels(
+static int _evaluate_labels(
     const Nerd *const nerd,
     int (*inference_engine_batch)(const KnowledgeBase *const knowledge_base,
                                   const size_t total_observations,
                                   Scene **restrict observation,
                                   Scene ***const inference,
                                   char **const save_inferring_rules),
-    const Sensor *const sensor_to_evaluate, const Context *const labels,
+    NativeInferenceCache *const cache, const Sensor *const sensor_to_evaluate,
+    const unsigned int threads, const Context *const labels,
     float *const restrict accuracy, float *const restrict abstain_ratio,
     size_t *const total_observations, Scene ***const restrict observations,
     Scene ***const restrict inferences, char **const save_inferring_rules,
-    bool partial_observation) {
+    bool partial_observation, size_t *const reinferred) {
   if (!(nerd && sensor_to_evaluate && labels)) {
     return -1;
   }
@@ -350,8 +662,91 @@ int evaluate_labels(
     }
   }
 
-  inference_engine_batch(nerd->knowledge_base, _total_observations,
-                         _observations, &_inferences, save_inferring_rules);
+  // Without threads, all the observations are inferred with a single call.
+  const size_t chunk_size =
+                   (threads > 1) ? EVALUATION_CHUNK_SIZE : _total_observations,
+               total_chunks =
+                   chunk_size ? (_total_observations + chunk_size - 1) /
+                                    chunk_size
+                              : 0;
+  LabelsChunk *chunks =
+      (LabelsChunk *)malloc(total_chunks * sizeof(LabelsChunk));
+  size_t k;
+  for (k = 0; k < total_chunks; ++k) {
+    chunks[k] = (LabelsChunk){
+        .knowledge_base = nerd->knowledge_base,
+        .inference_engine_batch = inference_engine_batch,
+        .cache = cache,
+        .observations = _observations + k * chunk_size,
+        .first = k * chunk_size,
+        .size = (k == total_chunks - 1) ? _total_observations - k * chunk_size
+                                        : chunk_size,
+        .save_inferring_rules = save_inferring_rules != NULL};
+  }
+  if (cache) {
+    native_inference_cache_update(cache, nerd->knowledge_base,
+                                  _total_observations);
+  }
+
+  _evaluate_chunks(chunks, sizeof(LabelsChunk), total_chunks, threads,
+                   _evaluate_labels_chunk);
+  if (reinferred) {
+    *reinferred = 0;
+    for (k = 0; k < total_chunks; ++k) {
+      *reinferred += chunks[k].reinferred;
+    }
+  }
+
+  int error = 0;
+  if (total_chunks == 1) {
+    _inferences = chunks[0].inferences;
+    error = chunks[0].error;
+  } else if (total_chunks > 1) {
+    _inferences = (Scene **)malloc(sizeof(Scene *) * _total_observations);
+    for (k = 0; k < total_chunks; ++k) {
+      if (chunks[k].error != 0) {
+        error = chunks[k].error;
+      } else {
+        memcpy(_inferences + k * chunk_size, chunks[k].inferences,
+               chunks[k].size * sizeof(Scene *));
+        free(chunks[k].inferences);
+      }
+    }
+  }
+
+  if (error != 0) {
+    for (k = 0; k < total_chunks; ++k) {
+      if (chunks[k].error == 0) {
+        for (i = 0; i < chunks[k].size; ++i) {
+          scene_destructor(&(_inferences[k * chunk_size + i]));
+        }
+      }
+      free(chunks[k].rules);
+    }
+    if (total_chunks > 1) {
+      free(_inferences);
+    }
+    for (i = 0; i < _total_observations; ++i) {
+      scene_destructor(&(_observations[i]));
+    }
+    free(_observations);
+    free(evaluation_literal_indices);
+    free(chunks);
+    return -3;
+  }
+
+  if (save_inferring_rules && (total_chunks > 0)) {
+    if (total_chunks == 1) {
+      *save_inferring_rules = chunks[0].rules;
+    } else {
+      *save_inferring_rules =
+          _merge_inferring_rules(chunks, total_chunks, chunk_size);
+      for (k = 0; k < total_chunks; ++k) {
+        free(chunks[k].rules);
+      }
+    }
+  }
+  free(chunks);
 
   if (accuracy || abstain_ratio) {
     unsigned int positives = 0, negatives = 0, unobserved = 0;
@@ -410,3 +805,106 @@ int evaluate_labels(
 
   return 0;
 }
+
+/**
+ * @brief Evaluates the Nerd's learnt KnowledgeBase by checking whether it can
+ * find the corresponding Literal marked as a label. The labels are given as a
+ * Context with the labels. The algorithm will find the label from the original
+ * observation, and then it will use the integrated inference engine to find out
+ * whether the engine can infer that Literal or not.
+ *
+ * @param nerd The Nerd struct where the learnt KnowledgeBase to evaluate is.
+ * @param inference_engine An inference engine function returning int. First
+ * param should be for the knowledge_base (Knolwedgebase *), second for the
+ * total observations, third for the observations (Scene **), third should be
+ * for the inferences to be saved (Scene ***), and the last one should be used
+ * to save the inferring rules as a strings separated with a new line '\n' (char
+ * **).
+ * @param sensor_to_evaluate The Sensor * containing the evaluation samples.
+ * @param threads The number of threads to infer the observations with. If it is
+ * greater than 1, the observations are inferred in chunks of
+ * EVALUATION_CHUNK_SIZE, and the inference engine should be safe to call
+ * concurrently (e.g. native_inference_batch, but not
+ * prudensjs_inference_batch). Otherwise, they are inferred with a single call.
+ * @param labels The Context containing all the Literals that act a labels.
+ * @param accuracy A pointer to a float variable to save the overall accuracy of
+ * the KnowledgeBase over the given samples. If NULL is given, it will not be
+ * saved.
+ * @param abstain_ratio A pointer to a float variable to save the abstain ratio
+ * of the KnowledgeBase over the given samples. Abstain means that with the
+ * given KnowledgeBase a label cannot be predicted, either correct or incorrect.
+ * If NULL is given, this ratio will not be saved.
+ * @param total_observations A size_t * to save the number of total
+ * observations. If NULL, it will not be saved.
+ * @param observations A Scene *** to save the observations. It should be a
+ * reference to a Scene **. Requires total_observations to work. If NULL is
+ * given, they will not be saved.
+ * @param inferences A Scene *** to save the inferences. It should be a
+ * reference to a Scene **. Requires total_observations to work. If NULL is
+ * given, they will not be saved.
+ * @param save_inferring_rules A char ** (reference to a char *) to save the
+ * inferring rules as a string. If NULL, they won't be saved.
+ * @param partial_observation Indicates if the observation is partially
+ * observed, and the label could be missing.
+ *
+ * @return 0 if the evaluation ended successfully, -1 if it one nerd, settings,
+ * file_to_evaluation or labels where NULL, > 0 which will be the index of the
+ * first observation that does not have a provided label (index calculated from
+ * the given file), -2 if total_observation was not given, but either
+ * observations or inferences were given, or -3 if the inference engine failed.
+ */
+int evaluate_labels(
+    const Nerd *const nerd,
+    int (*inference_engine_batch)(const KnowledgeBase *const knowledge_base,
+                                  const size_t total_observations,
+                                  Scene **restrict observation,
+                                  Scene ***const inference,
+                                  char **const save_inferring_rules),
+    const Sensor *const sensor_to_evaluate, const unsigned int threads,
+    const Context *const labels, float *const restrict accuracy,
+    float *const restrict abstain_ratio, size_t *const total_observations,
+    Scene ***const restrict observations, Scene ***const restrict inferences,
+    char **const save_inferring_rules, bool partial_observation) {
+  return _evaluate_labels(nerd, inference_engine_batch, NULL,
+                          sensor_to_evaluate, threads, labels, accuracy,
+                          abstain_ratio, total_observations, observations,
+                          inferences, save_inferring_rules, partial_observation,
+                          NULL);
+}
+
+/**
+ * @brief Evaluates the Nerd's learnt KnowledgeBase as evaluate_labels does,
+ * using the native inference incrementally. The cache keeps the inference of
+ * each observation, so when it is used to evaluate consecutive KnowledgeBases
+ * (e.g., the snapshots of a run), only the observations whose applicable
+ * active Rules have been removed, added or changed their relative priority are
+ * re-inferred. The results are the same as the ones of evaluate_labels with
+ * native_inference_batch.
+ *
+ * @param nerd The Nerd struct where the learnt KnowledgeBase to evaluate is.
+ * @param cache The NativeInferenceCache of the observations. It should only be
+ * used with Sensors that give the same observations in each call (e.g., a
+ * reused Sensor, whose observations are all evaluated).
+ * @param reinferred A size_t * to save the number of observations that have
+ * been re-inferred. If NULL, it will not be saved.
+ *
+ * See evaluate_labels for the rest of the parameters.
+ *
+ * @return The same as evaluate_labels, and -1 if the cache is NULL.
+ */
+int evaluate_labels_incremental(
+    const Nerd *const nerd, NativeInferenceCache *const cache,
+    const Sensor *const sensor_to_evaluate, const unsigned int threads,
+    const Context *const labels, float *const restrict accuracy,
+    float *const restrict abstain_ratio, size_t *const total_observations,
+    Scene ***const restrict observations, Scene ***const restrict inferences,
+    char **const save_inferring_rules, bool partial_observation,
+    size_t *const reinferred) {
+  if (!cache) {
+    return -1;
+  }
+  return _evaluate_labels(nerd, NULL, cache, sensor_to_evaluate, threads,
+                          labels, accuracy, abstain_ratio, total_observations,
+                          observations, inferences, save_inferring_rules,
+                          partial_observation, reinferred);
+}
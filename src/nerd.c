@@ -1,8 +1,16 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <limits.h>
 #include <math.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <time.h>
+#include <unistd.h>
 
 #include "metrics.h"
 #include "nerd.h"
@@ -11,6 +19,27 @@
 #define SECONDS_TO_MILLISECONDS 1e3
 #define NANOSECONDS_TO_MILLISECONDS 1e-6
 
+#define NERD_BINARY_MAGIC "NERDBIN"
+#define NERD_BINARY_VERSION 1
+
+/**
+ * @brief The header of a binary Nerd file (.ndb). It is followed by
+ * number_of_atoms uint32_t offsets into the atom strings, the strings_size
+ * bytes of NUL-terminated atoms (padded to 4 bytes), and rules_size uint32_t
+ * words of Rules. Each Rule is stored as its head, its body size, its weight
+ * (the bits of the float) and its body Literals, where a Literal is
+ * (atom index << 1) | sign. Active Rules come first in their priority order,
+ * followed by the inactive ones, as in the .nd format.
+ */
+typedef struct NerdBinaryHeader {
+  char magic[8];
+  uint32_t version, increasing_demotion;
+  uint64_t max_rules_per_instance, breadth, depth, number_of_rules,
+      strings_size, rules_size;
+  uint32_t number_of_atoms;
+  float promotion_weight, demotion_weight, activation_threshold;
+} NerdBinaryHeader;
+
 /**
  * @brief Constructs a Nerd structure (object).
  *
@@ -53,13 +82,145 @@ Nerd *nerd_constructor(const float activation_threshold,
   return nerd;
 }
 
+/**
+ * @brief Constructs a Nerd structure (object) from a binary Nerd file (.ndb).
+ * The file is mapped to memory, its atoms are interned once and its Rules are
+ * constructed directly from their atom indices.
+ *
+ * @return A new Nerd object * or NULL if the file could not be mapped or has
+ * an incorrect format. Use nerd_destructor to deallocate.
+ */
+static Nerd *_nerd_constructor_from_binary_file(const char *const filepath,
+                                                const bool use_backward_chaining) {
+  const int fd = open(filepath, O_RDONLY);
+  if (fd == -1) {
+    return NULL;
+  }
+  struct stat file_stat;
+  if ((fstat(fd, &file_stat) != 0) ||
+      ((size_t)file_stat.st_size < sizeof(NerdBinaryHeader))) {
+    close(fd);
+    return NULL;
+  }
+  const size_t file_size = file_stat.st_size;
+  void *const map = mmap(NULL, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) {
+    return NULL;
+  }
+
+  const NerdBinaryHeader *const header = (const NerdBinaryHeader *)map;
+  const size_t strings_offset = sizeof(NerdBinaryHeader) +
+                                header->number_of_atoms * sizeof(uint32_t),
+               padded_strings_size = (header->strings_size + 3) & ~(size_t)3;
+  if ((memcmp(header->magic, NERD_BINARY_MAGIC, sizeof(header->magic)) != 0) ||
+      (header->version != NERD_BINARY_VERSION) ||
+      (header->strings_size > file_size) || (header->rules_size > file_size) ||
+      (strings_offset + padded_strings_size +
+           header->rules_size * sizeof(uint32_t) !=
+       file_size) ||
+      ((header->strings_size > 0) &&
+       (((const char *)map)[strings_offset + header->strings_size - 1] !=
+        '\0'))) {
+    munmap(map, file_size);
+    return NULL;
+  }
+
+  const uint32_t *const offsets =
+      (const uint32_t *)((const char *)map + sizeof(NerdBinaryHeader));
+  const char *const strings = (const char *)map + strings_offset;
+  const uint32_t *const words =
+      (const uint32_t *)(strings + padded_strings_size);
+
+  Nerd *nerd = (Nerd *)malloc(sizeof(Nerd));
+  nerd->max_rules_per_instance = header->max_rules_per_instance;
+  nerd->breadth = header->breadth;
+  nerd->depth = header->depth;
+  nerd->promotion_weight = header->promotion_weight;
+  nerd->demotion_weight = header->demotion_weight;
+  nerd->increasing_demotion = header->increasing_demotion;
+  nerd->knowledge_base = knowledge_base_constructor(
+      header->activation_threshold, use_backward_chaining);
+
+  unsigned int *ids =
+      (unsigned int *)malloc(header->number_of_atoms * sizeof(unsigned int));
+  size_t i;
+  for (i = 0; i < header->number_of_atoms; ++i) {
+    if (offsets[i] >= header->strings_size) {
+      goto failed;
+    }
+    ids[i] = literal_intern_atom(strings + offsets[i]);
+  }
+
+  Literal **body = NULL, *head;
+  Rule *rule;
+  size_t body_capacity = 0, position = 0, rule_index;
+  uint32_t body_size;
+  float weight;
+  for (rule_index = 0; rule_index < header->number_of_rules; ++rule_index) {
+    if ((header->rules_size - position < 3) ||
+        ((body_size = words[position + 1]) == 0) ||
+        (header->rules_size - position - 3 < body_size)) {
+      goto failed_rules;
+    }
+    if ((words[position] >> 1) >= header->number_of_atoms) {
+      goto failed_rules;
+    }
+    head = literal_constructor_from_id(ids[words[position] >> 1],
+                                       words[position] & 1);
+    memcpy(&weight, words + position + 2, sizeof(float));
+    position += 3;
+
+    if (body_size > body_capacity) {
+      body_capacity = body_size;
+      body = (Literal **)realloc(body, body_capacity * sizeof(Literal *));
+    }
+    for (i = 0; i < body_size; ++i) {
+      if ((words[position + i] >> 1) >= header->number_of_atoms) {
+        while (i > 0) {
+          literal_destructor(&(body[--i]));
+        }
+        literal_destructor(&head);
+        goto failed_rules;
+      }
+      body[i] = literal_constructor_from_id(ids[words[position + i] >> 1],
+                                            words[position + i] & 1);
+    }
+    position += body_size;
+
+    // A checkpoint holds each Rule once, so a Rule that is not added (e.g.
+    // a duplicate) makes the file invalid.
+    rule = rule_constructor(body_size, body, &head, weight, true);
+    if (knowledge_base_add_rule(nerd->knowledge_base, &rule) != 1) {
+      rule_destructor(&rule);
+      goto failed_rules;
+    }
+  }
+  if (position != header->rules_size) {
+    goto failed_rules;
+  }
+
+  free(body);
+  free(ids);
+  munmap(map, file_size);
+  return nerd;
+failed_rules:
+  free(body);
+failed:
+  free(ids);
+  munmap(map, file_size);
+  nerd_destructor(&nerd);
+  return NULL;
+}
+
 /**
  * @brief Constructs a Nerd structure (object) using an existing nerd file. If
  * the file has an incorrect format or there are missing information, the
  * process will fail.
  *
  * @param filepath The path to the file that contains previous a Nerd structure
- * parameters (except the number of epochs) and the learnt KnowledgeBase.
+ * parameters (except the number of epochs) and the learnt KnowledgeBase. Both
+ * the text (.nd) and the binary (.ndb) formats are accepted.
  * @param use_backward_chaining A boolean value which indicates whether the
  * hypergraph should demoted rules using the backward chaining algorithm or not.
  *
@@ -73,6 +234,14 @@ Nerd *nerd_constructor_from_file(const char *const filepath,
     if (!file) {
       return NULL;
     }
+    char magic[sizeof(NERD_BINARY_MAGIC)];
+    if ((fread(magic, sizeof(char), sizeof(magic), file) == sizeof(magic)) &&
+        (memcmp(magic, NERD_BINARY_MAGIC, sizeof(magic)) == 0)) {
+      fclose(file);
+      return _nerd_constructor_from_binary_file(filepath,
+                                                use_backward_chaining);
+    }
+    rewind(file);
     Nerd *nerd = (Nerd *)malloc(sizeof(Nerd));
 
     size_t buffer_size = BUFFER_SIZE;
@@ -124,7 +293,7 @@ Nerd *nerd_constructor_from_file(const char *const filepath,
     char *tokens;
     Literal *literal;
     Rule *rule;
-    Body *body = scene_constructor(true);
+    Scene *body = scene_constructor(true);
 
     memset(buffer, 0, strlen(buffer));
 
@@ -279,6 +448,145 @@ void nerd_train(Nerd *const nerd,
   }
 }
 
+/**
+ * @brief Constructs a NerdSnapshot, a consistent copy of the Nerd's parameters
+ * and Rules. It holds no references to the Nerd, so the Nerd can keep learning
+ * while the snapshot is written (e.g. by another thread).
+ *
+ * @param nerd The Nerd to be captured.
+ *
+ * @return A new NerdSnapshot *, or NULL if the nerd is NULL. Use
+ * nerd_snapshot_destructor to deallocate.
+ */
+NerdSnapshot *nerd_snapshot_constructor(const Nerd *const nerd) {
+  if (!nerd) {
+    return NULL;
+  }
+
+  RuleQueue *inactive_rules;
+  rule_hypergraph_get_inactive_rules(nerd->knowledge_base, &inactive_rules);
+  const RuleQueue *const queues[2] = {nerd->knowledge_base->active,
+                                      inactive_rules};
+
+  NerdSnapshot *snapshot = (NerdSnapshot *)malloc(sizeof(NerdSnapshot));
+  snapshot->max_rules_per_instance = nerd->max_rules_per_instance;
+  snapshot->breadth = nerd->breadth;
+  snapshot->depth = nerd->depth;
+  snapshot->promotion_weight = nerd->promotion_weight;
+  snapshot->demotion_weight = nerd->demotion_weight;
+  snapshot->increasing_demotion = nerd->increasing_demotion;
+  snapshot->activation_threshold = nerd->knowledge_base->activation_threshold;
+  snapshot->number_of_rules = queues[0]->length + queues[1]->length;
+
+  size_t number_of_literals = 0;
+  unsigned int q, i, j;
+  for (q = 0; q < 2; ++q) {
+    for (i = 0; i < queues[q]->length; ++i) {
+      number_of_literals += queues[q]->rules[i]->body.size + 1;
+    }
+  }
+
+  snapshot->literals = (Literal *)malloc(number_of_literals * sizeof(Literal));
+  snapshot->weights = (float *)malloc(snapshot->number_of_rules * sizeof(float));
+  snapshot->offsets =
+      (size_t *)malloc((snapshot->number_of_rules + 1) * sizeof(size_t));
+
+  const Rule *rule;
+  size_t rule_index = 0, offset = 0;
+  for (q = 0; q < 2; ++q) {
+    for (i = 0; i < queues[q]->length; ++i, ++rule_index) {
+      rule = queues[q]->rules[i];
+      snapshot->offsets[rule_index] = offset;
+      snapshot->weights[rule_index] = rule->weight;
+      snapshot->literals[offset++] = *(rule->head);
+      for (j = 0; j < rule->body.size; ++j) {
+        snapshot->literals[offset++] = *(rule->body.literals[j]);
+      }
+    }
+  }
+  snapshot->offsets[rule_index] = offset;
+  rule_queue_destructor(&inactive_rules);
+
+  return snapshot;
+}
+
+/**
+ * @brief Destructs a NerdSnapshot.
+ *
+ * @param snapshot The NerdSnapshot to be destructed. It should be a reference
+ * to the struct's pointer (to a NerdSnapshot *).
+ */
+void nerd_snapshot_destructor(NerdSnapshot **const snapshot) {
+  if (snapshot && (*snapshot)) {
+    safe_free((*snapshot)->literals);
+    safe_free((*snapshot)->weights);
+    safe_free((*snapshot)->offsets);
+    safe_free(*snapshot);
+  }
+}
+
+/**
+ * @brief Writes a Literal of a snapshot as in literal_to_string.
+ */
+static inline void _snapshot_write_literal(const Literal *const literal,
+                                           FILE *const file) {
+  if (!literal->sign) {
+    fputc('-', file);
+  }
+  fputs(literal->atom, file);
+}
+
+/**
+ * @brief Saves a NerdSnapshot to a text file (.nd), in the same format as
+ * nerd_to_file.
+ *
+ * @param snapshot The NerdSnapshot to be saved.
+ * @param filepath The path and name of the file to save it.
+ *
+ * @return 0 if it was saved, -1 if the file could not be written and -2 if one
+ * of the arguments is NULL.
+ */
+int nerd_snapshot_to_file(const NerdSnapshot *const snapshot,
+                          const char *const filepath) {
+  if (!(snapshot && filepath)) {
+    return -2;
+  }
+
+  FILE *file = fopen(filepath, "wb");
+  if (!file) {
+    return -1;
+  }
+
+  fprintf(file, "max_rules_per_instance: %zu\n",
+          snapshot->max_rules_per_instance);
+  fprintf(file, "breadth: %zu\n", snapshot->breadth);
+  fprintf(file, "depth: %zu\n", snapshot->depth);
+  fprintf(file, "promotion_weight: %f\n", snapshot->promotion_weight);
+  fprintf(file, "demotion_weight: %f %hu\n", snapshot->demotion_weight,
+          snapshot->increasing_demotion);
+
+  fprintf(file, "knowledge_base:\n");
+  fprintf(file, "  activation_threshold: %f\n",
+          snapshot->activation_threshold);
+  fprintf(file, "  rules:\n");
+
+  size_t i, j;
+  for (i = 0; i < snapshot->number_of_rules; ++i) {
+    fputs("    (", file);
+    for (j = snapshot->offsets[i] + 1; j < snapshot->offsets[i + 1]; ++j) {
+      if (j != snapshot->offsets[i] + 1) {
+        fputs(", ", file);
+      }
+      _snapshot_write_literal(&(snapshot->literals[j]), file);
+    }
+    fputs(") => ", file);
+    _snapshot_write_literal(&(snapshot->literals[snapshot->offsets[i]]), file);
+    fprintf(file, " (%.4f),\n", snapshot->weights[i]);
+  }
+
+  return (fclose(file) == 0) ? 0 : -1;
+}
+
 /**
  * @brief Saves/Converts the Nerd structure to a file which all the parameters
  * that were used and the learnt KnowledgeBase are saved, except the number of
@@ -293,37 +601,132 @@ void nerd_to_file(const Nerd *const nerd, const char *const filepath) {
     return;
   }
 
-  FILE *file = fopen(filepath, "wb");
-  unsigned int i;
-  char *str = NULL;
+  NerdSnapshot *snapshot = nerd_snapshot_constructor(nerd);
+  nerd_snapshot_to_file(snapshot, filepath);
+  nerd_snapshot_destructor(&snapshot);
+}
 
-  fprintf(file, "max_rules_per_instance: %zu\n", nerd->max_rules_per_instance);
-  fprintf(file, "breadth: %zu\n", nerd->breadth);
-  fprintf(file, "depth: %zu\n", nerd->depth);
-  fprintf(file, "promotion_weight: %f\n", nerd->promotion_weight);
-  fprintf(file, "demotion_weight: %f %hu\n", nerd->demotion_weight,
-          nerd->increasing_demotion);
+/**
+ * @brief Saves a NerdSnapshot to a binary file (.ndb). It holds the same
+ * information as nerd_snapshot_to_file, and it can be loaded with
+ * nerd_constructor_from_file without any parsing.
+ *
+ * @param snapshot The NerdSnapshot to be saved.
+ * @param filepath The path and name of the file to save it.
+ *
+ * @return 0 if it was saved, -1 if the file could not be written and -2 if one
+ * of the arguments is NULL.
+ */
+int nerd_snapshot_to_binary_file(const NerdSnapshot *const snapshot,
+                                 const char *const filepath) {
+  if (!(snapshot && filepath)) {
+    return -2;
+  }
 
-  fprintf(file, "knowledge_base:\n");
-  fprintf(file, "  activation_threshold: %f\n",
-          nerd->knowledge_base->activation_threshold);
-  fprintf(file, "  rules:\n");
+  // The atom table is not read, since the Nerd may keep interning atoms while
+  // the snapshot is written; the interned strings themselves never move.
+  const size_t words_size = snapshot->offsets[snapshot->number_of_rules] +
+                            (snapshot->number_of_rules << 1);
+  size_t i, j, total_atoms = 0;
+  for (i = 0; i < snapshot->offsets[snapshot->number_of_rules]; ++i) {
+    if (snapshot->literals[i].id >= total_atoms) {
+      total_atoms = snapshot->literals[i].id + 1;
+    }
+  }
+  unsigned int *local_ids =
+      (unsigned int *)malloc(total_atoms * sizeof(unsigned int));
+  memset(local_ids, 0xff, total_atoms * sizeof(unsigned int));
+  const char **atoms = NULL;
+  uint32_t *words = (uint32_t *)malloc(words_size * sizeof(uint32_t)),
+           number_of_atoms = 0;
+
+  const Literal *literal;
+  size_t position = 0;
+  for (i = 0; i < snapshot->number_of_rules; ++i) {
+    for (j = snapshot->offsets[i]; j < snapshot->offsets[i + 1]; ++j) {
+      literal = &(snapshot->literals[j]);
+      if (local_ids[literal->id] == UINT_MAX) {
+        atoms = (const char **)realloc(
+            atoms, (number_of_atoms + 1) * sizeof(const char *));
+        atoms[number_of_atoms] = literal->atom;
+        local_ids[literal->id] = number_of_atoms++;
+      }
+      words[position] = (local_ids[literal->id] << 1) | literal->sign;
+      if (j == snapshot->offsets[i]) {
+        words[position + 1] = snapshot->offsets[i + 1] - j - 1;
+        memcpy(words + position + 2, &(snapshot->weights[i]), sizeof(float));
+        position += 2;
+      }
+      ++position;
+    }
+  }
 
-  for (i = 0; i < nerd->knowledge_base->active->length; ++i) {
-    str = rule_to_string(nerd->knowledge_base->active->rules[i]);
-    fprintf(file, "    %s,\n", str);
-    safe_free(str);
+  NerdBinaryHeader header;
+  memset(&header, 0, sizeof(NerdBinaryHeader));
+  memcpy(header.magic, NERD_BINARY_MAGIC, sizeof(header.magic));
+  header.version = NERD_BINARY_VERSION;
+  header.increasing_demotion = snapshot->increasing_demotion;
+  header.max_rules_per_instance = snapshot->max_rules_per_instance;
+  header.breadth = snapshot->breadth;
+  header.depth = snapshot->depth;
+  header.number_of_rules = snapshot->number_of_rules;
+  header.rules_size = words_size;
+  header.number_of_atoms = number_of_atoms;
+  header.promotion_weight = snapshot->promotion_weight;
+  header.demotion_weight = snapshot->demotion_weight;
+  header.activation_threshold = snapshot->activation_threshold;
+
+  uint32_t *offsets = (uint32_t *)malloc(number_of_atoms * sizeof(uint32_t));
+  for (i = 0; i < number_of_atoms; ++i) {
+    offsets[i] = header.strings_size;
+    header.strings_size += strlen(atoms[i]) + 1;
   }
 
-  RuleQueue *inactive_rules;
-  rule_hypergraph_get_inactive_rules(nerd->knowledge_base, &inactive_rules);
+  int error_code = 0;
+  FILE *file = fopen(filepath, "wb");
+  if (!file) {
+    error_code = -1;
+    goto finished;
+  }
 
-  for (i = 0; i < inactive_rules->length; ++i) {
-    str = rule_to_string(inactive_rules->rules[i]);
-    fprintf(file, "    %s,\n", str);
-    safe_free(str);
+  const char padding[3] = {0};
+  fwrite(&header, sizeof(NerdBinaryHeader), 1, file);
+  fwrite(offsets, sizeof(uint32_t), number_of_atoms, file);
+  for (i = 0; i < number_of_atoms; ++i) {
+    fwrite(atoms[i], sizeof(char), strlen(atoms[i]) + 1, file);
+  }
+  fwrite(padding, sizeof(char), (4 - (header.strings_size & 3)) & 3, file);
+  fwrite(words, sizeof(uint32_t), words_size, file);
+  if (fclose(file) != 0) {
+    error_code = -1;
+  }
+
+finished:
+  free(offsets);
+  free(local_ids);
+  free(atoms);
+  free(words);
+  return error_code;
+}
+
+/**
+ * @brief Converts a Nerd structure (object) and saves it in a binary file
+ * (.ndb). It holds the same information as nerd_to_file, and it can be loaded
+ * with nerd_constructor_from_file without any parsing.
+ *
+ * @param nerd The Nerd structure to be converted and saved.
+ * @param filepath The path and name of the file to save it.
+ *
+ * @return 0 if it was saved, -1 if the file could not be written and -2 if one
+ * of the arguments is NULL.
+ */
+int nerd_to_binary_file(const Nerd *const nerd, const char *const filepath) {
+  if (!(nerd && filepath)) {
+    return -2;
   }
-  rule_queue_destructor(&inactive_rules);
 
-  fclose(file);
+  NerdSnapshot *snapshot = nerd_snapshot_constructor(nerd);
+  const int error_code = nerd_snapshot_to_binary_file(snapshot, filepath);
+  nerd_snapshot_destructor(&snapshot);
+  return error_code;
 }
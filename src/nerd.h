@@ -14,6 +14,21 @@ typedef struct Nerd {
   bool increasing_demotion;
 } Nerd;
 
+/**
+ * @brief A consistent copy of a Nerd's parameters and Rules. The Rules are kept
+ * as in the .nd format; the active ones in their priority order, followed by
+ * the inactive ones. The head of the i-th Rule is literals[offsets[i]] and its
+ * body follows it up to literals[offsets[i + 1]].
+ */
+typedef struct NerdSnapshot {
+  Literal *literals;
+  float *weights;
+  size_t *offsets;
+  size_t number_of_rules, max_rules_per_instance, breadth, depth;
+  float promotion_weight, demotion_weight, activation_threshold;
+  bool increasing_demotion;
+} NerdSnapshot;
+
 Nerd *nerd_constructor(const float activation_threshold,
                        const unsigned int max_rules_per_instance,
                        const unsigned int breadth, const unsigned int depth,
@@ -35,5 +50,13 @@ void nerd_train(Nerd *const nerd,
                 Scene **incompatibilities);
 void nerd_to_string(const Nerd *const nerd);
 void nerd_to_file(const Nerd *const nerd, const char *const filepath);
+int nerd_to_binary_file(const Nerd *const nerd, const char *const filepath);
+
+NerdSnapshot *nerd_snapshot_constructor(const Nerd *const nerd);
+void nerd_snapshot_destructor(NerdSnapshot **const snapshot);
+int nerd_snapshot_to_file(const NerdSnapshot *const snapshot,
+                          const char *const filepath);
+int nerd_snapshot_to_binary_file(const NerdSnapshot *const snapshot,
+                                 const char *const filepath);
 
 #endif
@@ -1,26 +1,47 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <signal.h>
 #include <string.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 #include "nerd_helper.h"
 #include "nerd_utils.h"
 
 static const char *_node = "node";
 static const char *_prudensjs_dir = "prudens-js/prudens-infer.js";
-static const char *_temp = ".temp";
 
+/**
+ * @brief The settings of the Prudens-JS worker. worker is -1 once the worker
+ * has stopped. knowledge_base_version is the version of the last KnowledgeBase
+ * sent to the worker, or 0 if none has been sent.
+ */
 typedef struct PrudensSettings {
-  char *temp_file;
-  char *prudensjs_call;
+  pid_t worker;
+  FILE *to_worker, *from_worker;
+  uint64_t knowledge_base_version;
 } PrudensSettings;
 
 PrudensSettings_ptr global_prudens_settings = NULL;
 
 /**
- * TODO Document this constructor.
+ * @brief Constructs the global_prudens_settings and starts a long-lived
+ * Prudens-JS worker (Node-JS), which will be used by all the following
+ * inference calls. The worker communicates through pipes with this process, so
+ * no process is spawned and no file is created per inference.
+ *
+ * @param argv0 The path of the executable (argv[0]). The Prudens-JS directory
+ * is expected to be located at the parent directory of 'bin'.
+ * @param constraints_file The path of a file containing incompatibility
+ * constraints. If NULL, no constraints will be used.
+ *
+ * @return 0 if no errors occured, 2 if the constraints_file does not exist (the
+ * worker will be started without any constraints), 3 if the worker could not be
+ * started and -2 if argv0 is NULL.
  */
 int prudensjs_settings_constructor(const char *const argv0,
-                                   const char *const test_directory,
-                                   const char *const constraints_file,
-                                   char *extra_args) {
+                                   const char *const constraints_file) {
   if (!argv0) {
     return -2;
   }
@@ -30,173 +51,241 @@ int prudensjs_settings_constructor(const char *const argv0,
     prudensjs_settings_destructor();
   }
 
-  const size_t current_directory_size = strstr(argv0, "bin") - argv0;
-  char *current_directory =
-      (char *)malloc((current_directory_size + 1) * sizeof(char));
-  memset(current_directory, '\0', current_directory_size + 1);
-  memcpy(current_directory, argv0, current_directory_size);
-
-  size_t current_string_length = 0, string_set_so_far = 0,
-         total_string_length = strlen(_node) + 1 + strlen(current_directory) +
-                               strlen(_prudensjs_dir) + 1 + strlen(_temp) + 1;
-  if (extra_args) {
-    total_string_length += strlen(extra_args);
-  }
-
-  global_prudens_settings = (PrudensSettings *)malloc(sizeof(PrudensSettings));
-  global_prudens_settings->prudensjs_call =
-      (char *)malloc(total_string_length * sizeof(char));
-  current_string_length = strlen(_node);
-  memcpy(global_prudens_settings->prudensjs_call, _node, current_string_length);
-  string_set_so_far += current_string_length;
-
-  memcpy(global_prudens_settings->prudensjs_call + string_set_so_far, " ", 1);
-  ++string_set_so_far;
-
-  current_string_length = strlen(current_directory);
-  memcpy(global_prudens_settings->prudensjs_call + string_set_so_far,
-         current_directory, current_string_length);
-  string_set_so_far += current_string_length;
-
-  current_string_length = strlen(_prudensjs_dir);
-  memcpy(global_prudens_settings->prudensjs_call + string_set_so_far,
-         _prudensjs_dir, current_string_length);
-  string_set_so_far += current_string_length;
-
-  const char *temp_directory = test_directory;
-  if ((!test_directory) ||
-      (test_directory && (test_directory[strlen(test_directory) - 1] != '/'))) {
-    error_code = 1;
-    temp_directory = current_directory;
-  }
-
-  current_string_length = strlen(temp_directory) + strlen(_temp) + 1;
-  if (extra_args) {
-    current_string_length += strlen(extra_args);
-  }
-  total_string_length += current_string_length + 1;
-
-  global_prudens_settings->temp_file =
-      (char *)malloc(current_string_length * sizeof(char));
-  if (extra_args) {
-    sprintf(global_prudens_settings->temp_file, "%s%s%s", temp_directory, _temp,
-            extra_args);
-  } else {
-    sprintf(global_prudens_settings->temp_file, "%s%s", temp_directory, _temp);
-  }
-
-  global_prudens_settings->prudensjs_call =
-      (char *)realloc(global_prudens_settings->prudensjs_call,
-                      total_string_length * sizeof(char));
-
-  memcpy(global_prudens_settings->prudensjs_call + string_set_so_far, " ", 1);
-  ++string_set_so_far;
-
-  current_string_length = strlen(global_prudens_settings->temp_file);
-  memcpy(global_prudens_settings->prudensjs_call + string_set_so_far,
-         global_prudens_settings->temp_file, current_string_length);
-  string_set_so_far += current_string_length;
+  const char *bin = strstr(argv0, "bin");
+  const size_t current_directory_size = bin ? (size_t)(bin - argv0) : 0;
+  char *script = (char *)malloc(
+      (current_directory_size + strlen(_prudensjs_dir) + 1) * sizeof(char));
+  memcpy(script, argv0, current_directory_size);
+  strcpy(script + current_directory_size, _prudensjs_dir);
 
+  const char *constraints = constraints_file;
   if (constraints_file) {
     FILE *file = fopen(constraints_file, "r");
     if (!file) {
       error_code = 2;
+      constraints = NULL;
     } else {
       fclose(file);
-      current_string_length = strlen(constraints_file);
-      total_string_length += current_string_length + 1;
+    }
+  }
 
-      global_prudens_settings->prudensjs_call =
-          (char *)realloc(global_prudens_settings->prudensjs_call,
-                          total_string_length * sizeof(char));
+  int to_worker[2], from_worker[2];
+  if (pipe(to_worker) != 0) {
+    free(script);
+    return 3;
+  }
+  if (pipe(from_worker) != 0) {
+    close(to_worker[0]);
+    close(to_worker[1]);
+    free(script);
+    return 3;
+  }
 
-      memcpy(global_prudens_settings->prudensjs_call + string_set_so_far, " ",
-             1);
-      ++string_set_so_far;
+  fflush(stdout);
+  pid_t worker = fork();
+  if (worker == -1) {
+    close(to_worker[0]);
+    close(to_worker[1]);
+    close(from_worker[0]);
+    close(from_worker[1]);
+    free(script);
+    return 3;
+  }
 
-      memcpy(global_prudens_settings->prudensjs_call + string_set_so_far,
-             constraints_file, current_string_length);
-      string_set_so_far += current_string_length;
-    }
+  if (worker == 0) {
+    dup2(to_worker[0], STDIN_FILENO);
+    dup2(from_worker[1], STDOUT_FILENO);
+    close(to_worker[0]);
+    close(to_worker[1]);
+    close(from_worker[0]);
+    close(from_worker[1]);
+    execlp(_node, _node, script, constraints, (char *)NULL);
+    _exit(EXIT_FAILURE);
   }
 
-  memset(global_prudens_settings->prudensjs_call + string_set_so_far, '\0', 1);
-  free(current_directory);
+  close(to_worker[0]);
+  close(from_worker[1]);
+  free(script);
+
+  global_prudens_settings = (PrudensSettings *)malloc(sizeof(PrudensSettings));
+  global_prudens_settings->worker = worker;
+  global_prudens_settings->to_worker = fdopen(to_worker[1], "w");
+  global_prudens_settings->from_worker = fdopen(from_worker[0], "r");
+  global_prudens_settings->knowledge_base_version = 0;
+
   return error_code;
 }
 
 /**
- * TODO Document this destructor.
+ * @brief Stops the Prudens-JS worker, if it is still running, by closing its
+ * pipes and waiting for it to exit. It is also used when the communication with
+ * the worker fails (e.g., node could not be started or it crashed), so the
+ * following requests fail instead of writing to a closed pipe.
+ */
+static void _prudensjs_stop_worker() {
+  if (global_prudens_settings->worker == -1) {
+    return;
+  }
+
+  struct sigaction ignore = {.sa_handler = SIG_IGN}, previous;
+  sigemptyset(&(ignore.sa_mask));
+  sigaction(SIGPIPE, &ignore, &previous);
+  fclose(global_prudens_settings->to_worker);
+  sigaction(SIGPIPE, &previous, NULL);
+  fclose(global_prudens_settings->from_worker);
+  waitpid(global_prudens_settings->worker, NULL, 0);
+  global_prudens_settings->to_worker = NULL;
+  global_prudens_settings->from_worker = NULL;
+  global_prudens_settings->worker = -1;
+  global_prudens_settings->knowledge_base_version = 0;
+}
+
+/**
+ * @brief Destructs the global_prudens_settings and stops the Prudens-JS worker.
+ *
+ * @return 1 if the settings were not constructed, 0 otherwise.
  */
 int prudensjs_settings_destructor() {
   if (!global_prudens_settings) {
     return 1;
   }
 
-  safe_free(global_prudens_settings->prudensjs_call);
-  safe_free(global_prudens_settings->temp_file);
+  _prudensjs_stop_worker();
   safe_free(global_prudens_settings);
 
   return 0;
 }
 
 /**
- * @brief Calls Prudens-JS using Node-JS. It creates a file with a converted
- * KnowledgeBase and a Scene/Context, which holds an observation and saves the
- * inference. It uses the global_prudens_settings.
+ * @brief Sends an inference request for the given observations to the
+ * Prudens-JS worker. The KnowledgeBase is only sent if its version has changed
+ * since the last request, otherwise the worker reuses the one it has already
+ * parsed. SIGPIPE is ignored while writing, so a worker that has exited makes
+ * the request fail instead of terminating this process.
  *
- * @param knowledge_base The KnowledgeBase to be used in Prudens-JS.
- * @param observation A Scene/Context *, which includes all the observed
- * Literals.
- * @param inference A Scene ** (reference to a Scene *) to save the inferences
- * made by Prudens-JS. Deallocate using scene_destructor.
+ * @return 0 if the request was sent, 5 if the knowledge_base is NULL and -1 if
+ * the worker is not running or writing to it failed.
  */
-void prudensjs_inference(const KnowledgeBase *const knowledge_base,
-                         const Scene *const restrict observation,
-                         Scene **const inference) {
-  if (!global_prudens_settings) {
-    return;
+static int _prudensjs_send_request(const KnowledgeBase *const knowledge_base,
+                                   const size_t observations_size,
+                                   Scene **restrict observations,
+                                   const bool save_inferring_rules) {
+  if (!knowledge_base) {
+    return 5;
+  }
+  if (global_prudens_settings->worker == -1) {
+    return -1;
   }
 
-  char *knowledge_base_prudensjs = knowledge_base_to_prudensjs(knowledge_base),
-       *context_prudensjs = context_to_prudensjs(observation);
-  if (!(knowledge_base_prudensjs && context_prudensjs)) {
-    return;
+  char *str = NULL;
+  if (global_prudens_settings->knowledge_base_version !=
+      knowledge_base->version) {
+    str = knowledge_base_to_prudensjs(knowledge_base);
+    if (!str) {
+      return 5;
+    }
   }
 
-  FILE *file = fopen(global_prudens_settings->temp_file, "wb");
+  struct sigaction ignore = {.sa_handler = SIG_IGN}, previous;
+  sigemptyset(&(ignore.sa_mask));
+  sigaction(SIGPIPE, &ignore, &previous);
 
-  fprintf(file, "%s\n%s\n", knowledge_base_prudensjs, context_prudensjs);
-  free(knowledge_base_prudensjs);
-  free(context_prudensjs);
-  fclose(file);
-  system(global_prudens_settings->prudensjs_call);
+  FILE *to_worker = global_prudens_settings->to_worker;
+  bool failed = false;
+  if (str) {
+    failed = fprintf(to_worker, "K %s\n", str) < 0;
+    safe_free(str);
+    global_prudens_settings->knowledge_base_version = knowledge_base->version;
+  }
 
-  file = fopen(global_prudens_settings->temp_file, "rb");
-  if (feof(file)) {
-    fclose(file);
-    return;
+  failed = failed || (fprintf(to_worker, "I %zu %d\n", observations_size,
+                              save_inferring_rules) < 0);
+  size_t i;
+  for (i = 0; (i < observations_size) && !failed; ++i) {
+    str = context_to_prudensjs(observations[i]);
+    failed = fprintf(to_worker, "%s\n", str) < 0;
+    free(str);
+  }
+  failed = failed || (fflush(to_worker) != 0);
+
+  sigaction(SIGPIPE, &previous, NULL);
+
+  if (failed) {
+    _prudensjs_stop_worker();
+    return -1;
+  }
+  return 0;
+}
+
+/**
+ * @brief Reads the inferred Literals of a single observation from the
+ * Prudens-JS worker.
+ *
+ * @param inference A Scene ** (reference to a Scene *) to save the inferred
+ * Literals. Deallocate using scene_destructor.
+ *
+ * @return 0 if it was read successfully, -1 otherwise.
+ */
+static int _prudensjs_read_inference(Scene **const inference) {
+  char *line = NULL, *token, *end;
+  size_t line_size = 0;
+  if (getline(&line, &line_size, global_prudens_settings->from_worker) == -1) {
+    free(line);
+    _prudensjs_stop_worker();
+    return -1;
   }
 
-  char buffer[BUFFER_SIZE];
   *inference = scene_constructor(true);
   Literal *literal;
-  while (fscanf(file, "%s", buffer) != EOF) {
-    literal = literal_constructor_from_string(buffer);
-    scene_add_literal(*inference, &literal);
+  token = line;
+  while (*token) {
+    end = token + strcspn(token, " \n");
+    if (end != token) {
+      const char c = *end;
+      *end = '\0';
+      literal = literal_constructor_from_string(token);
+      scene_add_literal(*inference, &literal);
+      *end = c;
+    }
+    token = (*end) ? end + 1 : end;
   }
 
-  fclose(file);
-  remove(global_prudens_settings->temp_file);
+  free(line);
+  return 0;
 }
 
 /**
- * @brief Calls Prudens-JS using Node-JS. It creates a file with a converted
- * KnowledgeBase and a number n of Scene/Context, which holds n observations and
- * saves the inference for each one of them. It uses the
+ * @brief Calls the Prudens-JS worker to infer a single observation. It uses the
  * global_prudens_settings.
  *
  * @param knowledge_base The KnowledgeBase to be used in Prudens-JS.
+ * @param observation A Scene/Context *, which includes all the observed
+ * Literals.
+ * @param inference A Scene ** (reference to a Scene *) to save the inferences
+ * made by Prudens-JS. Deallocate using scene_destructor. It will be NULL if the
+ * communication with the worker failed.
+ */
+void prudensjs_inference(const KnowledgeBase *const knowledge_base,
+                         const Scene *const restrict observation,
+                         Scene **const inference) {
+  if (!global_prudens_settings || !observation) {
+    return;
+  }
+
+  *inference = NULL;
+  Scene *observations[1] = {(Scene *)observation};
+  if (_prudensjs_send_request(knowledge_base, 1, observations, false) != 0) {
+    return;
+  }
+  _prudensjs_read_inference(inference);
+}
+
+/**
+ * @brief Calls the Prudens-JS worker to infer a number n of Scene/Context,
+ * which holds n observations, and saves the inference for each one of them. It
+ * uses the global_prudens_settings.
+ *
+ * @param knowledge_base The KnowledgeBase to be used in Prudens-JS.
  * @param observations_size The number of different observations given.
  * @param observations A Scene/Context ** containing a number of different
  * observations, where each one includes their own observed Literals.
@@ -208,8 +297,8 @@ void prudensjs_inference(const KnowledgeBase *const knowledge_base,
  * inferring rules as a string. If NULL, they won't be saved.
  *
  * @return 1 if settings are NULL, 3 if observations_size is 0, 4 if
- * observations is NULL, 5 if the knowledge_base is NULL, -1 if the file opening
- * failed, and 0 if it no errors occured.
+ * observations is NULL, 5 if the knowledge_base is NULL, -1 if the
+ * communication with the worker failed, and 0 if it no errors occured.
  */
 int prudensjs_inference_batch(const KnowledgeBase *const knowledge_base,
                               const size_t observations_size,
@@ -228,94 +317,43 @@ int prudensjs_inference_batch(const KnowledgeBase *const knowledge_base,
     return 4;
   }
 
-  (*inferences) = (Scene **)malloc(sizeof(Scene *) * observations_size);
-
-  char *str = knowledge_base_to_prudensjs(knowledge_base);
-  if (!str) {
-    return 5;
+  int error_code = _prudensjs_send_request(knowledge_base, observations_size,
+                                           observations, save_inferring_rules);
+  if (error_code != 0) {
+    return error_code;
   }
 
-  FILE *file = fopen(global_prudens_settings->temp_file, "wb");
-  fprintf(file, "%s\n", str);
-  safe_free(str);
+  (*inferences) = (Scene **)malloc(sizeof(Scene *) * observations_size);
 
   size_t i;
   for (i = 0; i < observations_size; ++i) {
-    str = context_to_prudensjs(observations[i]);
-    fprintf(file, "%s\n", str);
-    free(str);
-  }
-  fclose(file);
-
-  char *prudens_call = NULL;
-
-  if (!save_inferring_rules) {
-    prudens_call = strdup(global_prudens_settings->prudensjs_call);
-  } else {
-    prudens_call = calloc(strlen(global_prudens_settings->prudensjs_call) + 5,
-                          sizeof(char));
-    memcpy(prudens_call, global_prudens_settings->prudensjs_call,
-           strlen(global_prudens_settings->prudensjs_call));
-    memcpy(prudens_call + strlen(global_prudens_settings->prudensjs_call),
-           " s=1", strlen(" s=1"));
-  }
-
-  system(prudens_call);
-
-  free(prudens_call);
-
-  file = fopen(global_prudens_settings->temp_file, "rb");
-  if (feof(file)) {
-    fclose(file);
-    return -1;
-  }
-
-  size_t buffer_size = BUFFER_SIZE;
-  char *buffer = (char *)calloc(buffer_size, sizeof(char));
-  size_t buffer_loc = 0;
-
-  Literal *l;
-  int c;
-  for (i = 0; i < observations_size; ++i) {
-    (*inferences)[i] = scene_constructor(true);
-
-    while ((c = fgetc(file)) != EOF) {
-      if ((c != ' ') && (c != '\n')) {
-        buffer[buffer_loc++] = c;
-
-        if (buffer_loc == buffer_size) {
-          buffer_size <<= 1;
-          buffer = (char *)realloc(buffer, buffer_size * sizeof(char));
-          memset(buffer + (buffer_size >> 1), 0, buffer_size >> 1);
-        }
-      } else {
-        l = literal_constructor_from_string(buffer);
-        scene_add_literal((*inferences)[i], &l);
-        memset(buffer, 0, strlen(buffer));
-        buffer_loc = 0;
-        if (c == '\n') {
-          break;
-        }
-      }
+    if (_prudensjs_read_inference(&((*inferences)[i])) != 0) {
+      goto failed;
     }
   }
 
-  memset(buffer, 0, strlen(buffer));
-  buffer_loc = 0;
   if (save_inferring_rules) {
-    while ((c = fgetc(file)) != EOF) {
-      if (buffer_loc == buffer_size) {
-        buffer_size <<= 1;
-        buffer = (char *)realloc(buffer, buffer_size * sizeof(char));
-        memset(buffer + (buffer_size >> 1), 0, buffer_size >> 1);
-      }
-      buffer[buffer_loc++] = c;
+    size_t rules_size;
+    if ((fscanf(global_prudens_settings->from_worker, "%zu", &rules_size) !=
+         1) ||
+        (fgetc(global_prudens_settings->from_worker) == EOF)) {
+      goto failed;
     }
-    *save_inferring_rules = strdup(buffer);
-  }
 
-  free(buffer);
-  fclose(file);
-  remove(global_prudens_settings->temp_file);
+    *save_inferring_rules = (char *)calloc(rules_size + 1, sizeof(char));
+    if (fread(*save_inferring_rules, sizeof(char), rules_size,
+              global_prudens_settings->from_worker) != rules_size) {
+      safe_free(*save_inferring_rules);
+      goto failed;
+    }
+  }
   return 0;
+
+failed:
+  _prudensjs_stop_worker();
+  while (i > 0) {
+    scene_destructor(&((*inferences)[--i]));
+  }
+  safe_free(*inferences);
+  return -1;
 }
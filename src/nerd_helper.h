@@ -11,9 +11,7 @@ typedef struct PrudensSettings *PrudensSettings_ptr;
 extern PrudensSettings_ptr global_prudens_settings;
 
 int prudensjs_settings_constructor(const char *const argv0,
-                                   const char *const test_directory,
-                                   const char *const constraints_file,
-                                   char *extra_args);
+                                   const char *const constraints_file);
 int prudensjs_settings_destructor();
 
 void prudensjs_inference(const KnowledgeBase *const knowledge_base,
@@ -0,0 +1,815 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <limits.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "nerd_journal.h"
+#include "nerd_utils.h"
+
+#define NERD_JOURNAL_MAGIC "NERDJNL"
+#define NERD_JOURNAL_VERSION 1
+#define NERD_JOURNAL_INITIAL_CAPACITY 16
+#define NERD_JOURNAL_NOT_FOUND UINT32_MAX
+
+/**
+ * @brief The header of a journal file (.ndj). It is followed by one record per
+ * journaled (iteration, instance), the first of which is the base checkpoint
+ * (0, 0) that adds every Rule of the initial KnowledgeBase.
+ */
+typedef struct NerdJournalHeader {
+  char magic[8];
+  uint32_t version, increasing_demotion;
+  uint64_t max_rules_per_instance, breadth, depth;
+  float promotion_weight, demotion_weight, activation_threshold;
+  uint32_t padding;
+} NerdJournalHeader;
+
+/**
+ * @brief The header of a journal record. It is followed by the atoms_size bytes
+ * of the new NUL-terminated atoms (padded to 4 bytes), the rules_size uint32_t
+ * words of the added Rules, the ids of the removed Rules, the (id, weight)
+ * pairs of the reweighted Rules and, unless active_size is UINT32_MAX, the ids
+ * of the active Rules in their priority order.
+ *
+ * Rules get their ids in the order they are added, starting from 0. An added
+ * Rule is stored as its head, its body size, its weight (the bits of the float)
+ * and its body Literals, where a Literal is (atom index << 1) | sign.
+ */
+typedef struct NerdJournalRecord {
+  uint32_t iteration, instance, number_of_atoms, atoms_size, rules_size,
+      number_of_added, number_of_removed, number_of_reweighted, active_size;
+} NerdJournalRecord;
+
+/**
+ * @brief A growable array of uint32_t words.
+ */
+typedef struct Words {
+  uint32_t *items;
+  size_t size, capacity;
+} Words;
+
+/**
+ * @brief A Rule known to the journal. keys holds the head and then the body
+ * Literals as (interned atom id << 1) | sign, the latter in ascending order (as
+ * the body_keys of a Rule).
+ */
+typedef struct JournalEntry {
+  uint64_t fingerprint;
+  uint32_t *keys;
+  unsigned int body_size, stamp;
+  float weight;
+} JournalEntry;
+
+struct NerdJournal {
+  FILE *file;
+  // The atom index in the journal of each interned atom id, UINT_MAX if the
+  // atom has not been written yet.
+  unsigned int *local_ids;
+  size_t local_ids_size;
+  uint32_t number_of_atoms;
+  JournalEntry *entries;
+  size_t number_of_entries, entries_capacity;
+  // Open addressing index from a Rule's fingerprint to its (entry index + 1),
+  // holding only the Rules that are currently in the KnowledgeBase.
+  uint32_t *slots;
+  size_t slots_capacity, number_of_alive;
+  Words active, current_active, added, removed, reweighted;
+  char *strings;
+  size_t strings_size, strings_capacity;
+  unsigned int stamp;
+};
+
+/**
+ * @brief Appends an item to the given Words.
+ */
+static void _words_push(Words *const words, const uint32_t item) {
+  if (words->size == words->capacity) {
+    words->capacity =
+        words->capacity ? (words->capacity << 1) : NERD_JOURNAL_INITIAL_CAPACITY;
+    words->items =
+        (uint32_t *)realloc(words->items, words->capacity * sizeof(uint32_t));
+  }
+  words->items[words->size++] = item;
+}
+
+/**
+ * @brief Gives the bits of a float as a uint32_t, the way weights are stored in
+ * the journal.
+ */
+static inline uint32_t _float_bits(const float value) {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(uint32_t));
+  return bits;
+}
+
+/**
+ * @brief Gives the key of a Literal inside the journal, i.e., (atom index <<
+ * 1) | sign. Atoms that have not been written yet are added to the strings of
+ * the current record.
+ */
+static uint32_t _journal_key(NerdJournal *const journal,
+                             const Literal *const literal) {
+  if (literal->id >= journal->local_ids_size) {
+    const size_t total_atoms = literal_total_atoms();
+    journal->local_ids = (unsigned int *)realloc(
+        journal->local_ids, total_atoms * sizeof(unsigned int));
+    memset(journal->local_ids + journal->local_ids_size, 0xff,
+           (total_atoms - journal->local_ids_size) * sizeof(unsigned int));
+    journal->local_ids_size = total_atoms;
+  }
+
+  if (journal->local_ids[literal->id] == UINT_MAX) {
+    const size_t length = strlen(literal->atom) + 1;
+    if (journal->strings_size + length > journal->strings_capacity) {
+      while (journal->strings_size + length > journal->strings_capacity) {
+        journal->strings_capacity = journal->strings_capacity
+                                        ? (journal->strings_capacity << 1)
+                                        : BUFFER_SIZE;
+      }
+      journal->strings =
+          (char *)realloc(journal->strings, journal->strings_capacity);
+    }
+    memcpy(journal->strings + journal->strings_size, literal->atom, length);
+    journal->strings_size += length;
+    journal->local_ids[literal->id] = journal->number_of_atoms++;
+  }
+  return (journal->local_ids[literal->id] << 1) | literal->sign;
+}
+
+/**
+ * @brief Checks whether the given entry holds the given Rule.
+ */
+static bool _journal_entry_matches(const JournalEntry *const entry,
+                                   const Rule *const rule) {
+  if ((entry->fingerprint != rule->fingerprint) ||
+      (entry->body_size != rule->body.size) ||
+      (entry->keys[0] != rule->head_key)) {
+    return false;
+  }
+
+  unsigned int i;
+  for (i = 0; i < rule->body.size; ++i) {
+    if (entry->keys[i + 1] != rule->body_keys[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Finds the entry of the given Rule.
+ *
+ * @return The index of the entry, or NERD_JOURNAL_NOT_FOUND if the Rule is not
+ * in the journal.
+ */
+static uint32_t _journal_find(const NerdJournal *const journal,
+                              const Rule *const rule) {
+  if (journal->slots_capacity == 0) {
+    return NERD_JOURNAL_NOT_FOUND;
+  }
+
+  const size_t mask = journal->slots_capacity - 1;
+  size_t slot = rule->fingerprint & mask;
+  uint32_t index;
+  while ((index = journal->slots[slot])) {
+    if (_journal_entry_matches(&(journal->entries[index - 1]), rule)) {
+      return index - 1;
+    }
+    slot = (slot + 1) & mask;
+  }
+  return NERD_JOURNAL_NOT_FOUND;
+}
+
+/**
+ * @brief Places the given entry in the fingerprint index. The index should
+ * have at least one free slot.
+ */
+static void _journal_place(NerdJournal *const journal, const uint32_t index) {
+  const size_t mask = journal->slots_capacity - 1;
+  size_t slot = journal->entries[index].fingerprint & mask;
+  while (journal->slots[slot]) {
+    slot = (slot + 1) & mask;
+  }
+  journal->slots[slot] = index + 1;
+}
+
+/**
+ * @brief Adds the given entry to the fingerprint index, doubling the index
+ * when it gets half full.
+ */
+static void _journal_insert(NerdJournal *const journal, const uint32_t index) {
+  if (((journal->number_of_alive + 1) << 1) > journal->slots_capacity) {
+    uint32_t *old_slots = journal->slots;
+    const size_t old_capacity = journal->slots_capacity;
+    journal->slots_capacity = old_capacity ? (old_capacity << 1)
+                                           : NERD_JOURNAL_INITIAL_CAPACITY;
+    journal->slots =
+        (uint32_t *)calloc(journal->slots_capacity, sizeof(uint32_t));
+    size_t i;
+    for (i = 0; i < old_capacity; ++i) {
+      if (old_slots[i]) {
+        _journal_place(journal, old_slots[i] - 1);
+      }
+    }
+    free(old_slots);
+  }
+  _journal_place(journal, index);
+  ++journal->number_of_alive;
+}
+
+/**
+ * @brief Removes the given entry from the fingerprint index, shifting back the
+ * entries that follow it so no tombstones are needed.
+ */
+static void _journal_delete(NerdJournal *const journal, const uint32_t index) {
+  const size_t mask = journal->slots_capacity - 1;
+  size_t slot = journal->entries[index].fingerprint & mask, next, home;
+  while (journal->slots[slot] != index + 1) {
+    slot = (slot + 1) & mask;
+  }
+
+  next = slot;
+  while (true) {
+    next = (next + 1) & mask;
+    if (!journal->slots[next]) {
+      break;
+    }
+    home = journal->entries[journal->slots[next] - 1].fingerprint & mask;
+    if (((next - home) & mask) >= ((next - slot) & mask)) {
+      journal->slots[slot] = journal->slots[next];
+      slot = next;
+    }
+  }
+  journal->slots[slot] = 0;
+  --journal->number_of_alive;
+}
+
+/**
+ * @brief Adds a new entry for the given Rule, and appends the Rule to the added
+ * Rules of the current record.
+ *
+ * @return The index (id) of the new entry.
+ */
+static uint32_t _journal_add(NerdJournal *const journal,
+                             const Rule *const rule) {
+  if (journal->number_of_entries == journal->entries_capacity) {
+    journal->entries_capacity = journal->entries_capacity
+                                    ? (journal->entries_capacity << 1)
+                                    : NERD_JOURNAL_INITIAL_CAPACITY;
+    journal->entries = (JournalEntry *)realloc(
+        journal->entries, journal->entries_capacity * sizeof(JournalEntry));
+  }
+
+  const uint32_t index = journal->number_of_entries++;
+  JournalEntry *const entry = &(journal->entries[index]);
+  entry->fingerprint = rule->fingerprint;
+  entry->body_size = rule->body.size;
+  entry->weight = rule->weight;
+  entry->keys =
+      (uint32_t *)malloc((rule->body.size + 1) * sizeof(uint32_t));
+  entry->keys[0] = rule->head_key;
+
+  _words_push(&(journal->added), _journal_key(journal, rule->head));
+  _words_push(&(journal->added), rule->body.size);
+  _words_push(&(journal->added), _float_bits(rule->weight));
+  unsigned int i;
+  for (i = 0; i < rule->body.size; ++i) {
+    entry->keys[i + 1] = rule->body_keys[i];
+    _words_push(&(journal->added),
+                _journal_key(journal, rule->body.literals[i]));
+  }
+
+  _journal_insert(journal, index);
+  return index;
+}
+
+/**
+ * @brief Constructs a NerdJournal, which records how the KnowledgeBase of a
+ * Nerd changes over the training. The parameters of the Nerd and its current
+ * KnowledgeBase are written as the base checkpoint (iteration 0, instance 0).
+ *
+ * @param filepath The path of the journal file (.ndj) to be created.
+ * @param nerd The Nerd whose training will be journaled.
+ *
+ * @return A new NerdJournal *, or NULL if one of the arguments is NULL or the
+ * file could not be created. Use nerd_journal_destructor to deallocate.
+ */
+NerdJournal *nerd_journal_constructor(const char *const filepath,
+                                      const Nerd *const nerd) {
+  if (!(filepath && nerd)) {
+    return NULL;
+  }
+
+  FILE *file = fopen(filepath, "wb");
+  if (!file) {
+    return NULL;
+  }
+
+  NerdJournalHeader header;
+  memset(&header, 0, sizeof(NerdJournalHeader));
+  memcpy(header.magic, NERD_JOURNAL_MAGIC, sizeof(header.magic));
+  header.version = NERD_JOURNAL_VERSION;
+  header.increasing_demotion = nerd->increasing_demotion;
+  header.max_rules_per_instance = nerd->max_rules_per_instance;
+  header.breadth = nerd->breadth;
+  header.depth = nerd->depth;
+  header.promotion_weight = nerd->promotion_weight;
+  header.demotion_weight = nerd->demotion_weight;
+  header.activation_threshold = nerd->knowledge_base->activation_threshold;
+  fwrite(&header, sizeof(NerdJournalHeader), 1, file);
+
+  NerdJournal *journal = (NerdJournal *)calloc(1, sizeof(NerdJournal));
+  journal->file = file;
+  if (nerd_journal_record(journal, nerd, 0, 0) != 0) {
+    nerd_journal_destructor(&journal);
+    return NULL;
+  }
+  return journal;
+}
+
+/**
+ * @brief Destructs a NerdJournal, and closes its file.
+ *
+ * @param journal The NerdJournal to be destructed. It should be a reference to
+ * the struct's pointer (to a NerdJournal *).
+ *
+ * @return 0 if the journal was closed successfully, -1 if the file could not be
+ * written and -2 if the journal is NULL.
+ */
+int nerd_journal_destructor(NerdJournal **const journal) {
+  if (!(journal && (*journal))) {
+    return -2;
+  }
+
+  const int error_code = (fclose((*journal)->file) == 0) ? 0 : -1;
+  size_t i;
+  for (i = 0; i < (*journal)->number_of_entries; ++i) {
+    safe_free((*journal)->entries[i].keys);
+  }
+  safe_free((*journal)->entries);
+  safe_free((*journal)->local_ids);
+  safe_free((*journal)->slots);
+  safe_free((*journal)->active.items);
+  safe_free((*journal)->current_active.items);
+  safe_free((*journal)->added.items);
+  safe_free((*journal)->removed.items);
+  safe_free((*journal)->reweighted.items);
+  safe_free((*journal)->strings);
+  safe_free(*journal);
+  return error_code;
+}
+
+/**
+ * @brief The state of nerd_journal_record while it visits the Rules of the
+ * RuleHyperGraph.
+ */
+typedef struct JournalVisit {
+  NerdJournal *journal;
+  float activation_threshold;
+  uint32_t number_of_added;
+} JournalVisit;
+
+/**
+ * @brief Marks the given Rule as seen by the current record, adding it to the
+ * journal if it is new, or noting its weight if it changed. If the Rule is
+ * active, its entry is appended to the current active order.
+ */
+static void _journal_visit_rule(JournalVisit *const visit,
+                                const Rule *const rule, const bool active) {
+  NerdJournal *const journal = visit->journal;
+  uint32_t index = _journal_find(journal, rule);
+  if (index == NERD_JOURNAL_NOT_FOUND) {
+    index = _journal_add(journal, rule);
+    ++visit->number_of_added;
+  } else if (_float_bits(journal->entries[index].weight) !=
+             _float_bits(rule->weight)) {
+    journal->entries[index].weight = rule->weight;
+    _words_push(&(journal->reweighted), index);
+    _words_push(&(journal->reweighted), _float_bits(rule->weight));
+  }
+  journal->entries[index].stamp = journal->stamp;
+  if (active) {
+    _words_push(&(journal->current_active), index);
+  }
+}
+
+/**
+ * @brief Visits a Rule of the RuleHyperGraph, unless it is active; the active
+ * Rules are visited in their priority order instead.
+ */
+static void _journal_visit_inactive_rule(const Rule *rule, void *argument) {
+  JournalVisit *const visit = (JournalVisit *)argument;
+  if (rule->weight < visit->activation_threshold) {
+    _journal_visit_rule(visit, rule, false);
+  }
+}
+
+/**
+ * @brief Records the changes of the Nerd's KnowledgeBase since the previous
+ * record; the Rules that were added, removed or reweighted, and the priority
+ * order of the active Rules if it changed.
+ *
+ * @param journal The NerdJournal to append the record to.
+ * @param nerd The Nerd whose KnowledgeBase will be recorded. It should be the
+ * Nerd that the journal was constructed with.
+ * @param iteration The current iteration (epoch), starting from 1.
+ * @param instance The current instance of the iteration, starting from 1.
+ *
+ * @return 0 if the record was written, -1 if the file could not be written and
+ * -2 if one of the arguments is NULL.
+ */
+int nerd_journal_record(NerdJournal *const journal, const Nerd *const nerd,
+                        const size_t iteration, const size_t instance) {
+  if (!(journal && nerd)) {
+    return -2;
+  }
+
+  ++journal->stamp;
+  journal->strings_size = 0;
+  journal->current_active.size = 0;
+  journal->added.size = 0;
+  journal->removed.size = 0;
+  journal->reweighted.size = 0;
+  const uint32_t previous_number_of_atoms = journal->number_of_atoms;
+
+  // The Rules are matched by their fingerprints, so only the order of the
+  // active Rules matters.
+  JournalVisit visit = {
+      .journal = journal,
+      .activation_threshold = nerd->knowledge_base->activation_threshold,
+      .number_of_added = 0};
+  const RuleQueue *const active = nerd->knowledge_base->active;
+  unsigned int i;
+  for (i = 0; i < active->length; ++i) {
+    _journal_visit_rule(&visit, active->rules[i], true);
+  }
+  rule_hypergraph_for_each_rule(nerd->knowledge_base->hypergraph,
+                                _journal_visit_inactive_rule, &visit);
+  const uint32_t number_of_added = visit.number_of_added;
+
+  JournalEntry *entry;
+  size_t s;
+  for (s = 0; s < journal->slots_capacity; ++s) {
+    if (journal->slots[s]) {
+      entry = &(journal->entries[journal->slots[s] - 1]);
+      if (entry->stamp != journal->stamp) {
+        _words_push(&(journal->removed), journal->slots[s] - 1);
+      }
+    }
+  }
+  for (s = 0; s < journal->removed.size; ++s) {
+    _journal_delete(journal, journal->removed.items[s]);
+    safe_free(journal->entries[journal->removed.items[s]].keys);
+  }
+
+  const bool active_changed =
+      (journal->active.size != journal->current_active.size) ||
+      ((journal->active.size != 0) &&
+       (memcmp(journal->active.items, journal->current_active.items,
+               journal->active.size * sizeof(uint32_t)) != 0));
+  if (active_changed) {
+    const Words temp = journal->active;
+    journal->active = journal->current_active;
+    journal->current_active = temp;
+  }
+
+  const NerdJournalRecord record = {
+      .iteration = iteration,
+      .instance = instance,
+      .number_of_atoms = journal->number_of_atoms - previous_number_of_atoms,
+      .atoms_size = journal->strings_size,
+      .rules_size = journal->added.size,
+      .number_of_added = number_of_added,
+      .number_of_removed = journal->removed.size,
+      .number_of_reweighted = journal->reweighted.size >> 1,
+      .active_size = active_changed ? journal->active.size : UINT32_MAX};
+  const char padding[3] = {0};
+
+  fwrite(&record, sizeof(NerdJournalRecord), 1, journal->file);
+  fwrite(journal->strings, sizeof(char), journal->strings_size, journal->file);
+  fwrite(padding, sizeof(char), (4 - (journal->strings_size & 3)) & 3,
+         journal->file);
+  fwrite(journal->added.items, sizeof(uint32_t), journal->added.size,
+         journal->file);
+  fwrite(journal->removed.items, sizeof(uint32_t), journal->removed.size,
+         journal->file);
+  fwrite(journal->reweighted.items, sizeof(uint32_t), journal->reweighted.size,
+         journal->file);
+  if (active_changed) {
+    fwrite(journal->active.items, sizeof(uint32_t), journal->active.size,
+           journal->file);
+  }
+
+  // Each record is flushed, so that a failed write is reported by the record
+  // that caused it.
+  return ((fflush(journal->file) != 0) || ferror(journal->file)) ? -1 : 0;
+}
+
+/**
+ * @brief Constructs a NerdJournalReader, which maps the given journal file to
+ * memory. Use nerd_journal_reader_next to replay its records, starting with the
+ * base checkpoint.
+ *
+ * @param filepath The path of the journal file (.ndj).
+ *
+ * @return A new NerdJournalReader *, or NULL if the file could not be mapped or
+ * it is not a journal. Use nerd_journal_reader_destructor to deallocate.
+ */
+NerdJournalReader *nerd_journal_reader_constructor(const char *const filepath) {
+  if (!filepath) {
+    return NULL;
+  }
+
+  const int fd = open(filepath, O_RDONLY);
+  if (fd == -1) {
+    return NULL;
+  }
+  struct stat file_stat;
+  if ((fstat(fd, &file_stat) != 0) ||
+      ((size_t)file_stat.st_size < sizeof(NerdJournalHeader))) {
+    close(fd);
+    return NULL;
+  }
+  void *const map =
+      mmap(NULL, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) {
+    return NULL;
+  }
+
+  const NerdJournalHeader *const header = (const NerdJournalHeader *)map;
+  if ((memcmp(header->magic, NERD_JOURNAL_MAGIC, sizeof(header->magic)) != 0) ||
+      (header->version != NERD_JOURNAL_VERSION)) {
+    munmap(map, file_stat.st_size);
+    return NULL;
+  }
+
+  NerdJournalReader *reader =
+      (NerdJournalReader *)calloc(1, sizeof(NerdJournalReader));
+  reader->map = map;
+  reader->map_size = file_stat.st_size;
+  reader->position = sizeof(NerdJournalHeader);
+  return reader;
+}
+
+/**
+ * @brief Destructs a NerdJournalReader, and unmaps its file.
+ *
+ * @param reader The NerdJournalReader to be destructed. It should be a
+ * reference to the struct's pointer (to a NerdJournalReader *).
+ */
+void nerd_journal_reader_destructor(NerdJournalReader **const reader) {
+  if (reader && (*reader)) {
+    munmap((*reader)->map, (*reader)->map_size);
+    safe_free((*reader)->atoms);
+    safe_free((*reader)->atom_ids);
+    safe_free((*reader)->rules);
+    safe_free((*reader)->active);
+    safe_free(*reader);
+  }
+}
+
+/**
+ * @brief Replays the next record of the journal.
+ *
+ * @param reader The NerdJournalReader to advance.
+ *
+ * @return 0 if a record was replayed, 1 if there are no more records, -1 if the
+ * record has an incorrect format (the reader should not be used further) and -2
+ * if the reader is NULL.
+ */
+int nerd_journal_reader_next(NerdJournalReader *const reader) {
+  if (!reader) {
+    return -2;
+  }
+  if (reader->position == reader->map_size) {
+    return 1;
+  }
+
+  const char *const start = (const char *)reader->map + reader->position;
+  const size_t available = reader->map_size - reader->position;
+  if (available < sizeof(NerdJournalRecord)) {
+    return -1;
+  }
+
+  const NerdJournalRecord *const record = (const NerdJournalRecord *)start;
+  const size_t padded_atoms_size = ((size_t)record->atoms_size + 3) & ~(size_t)3,
+               active_size =
+                   (record->active_size == UINT32_MAX) ? 0 : record->active_size,
+               number_of_words = (size_t)record->rules_size +
+                                 record->number_of_removed +
+                                 ((size_t)record->number_of_reweighted << 1) +
+                                 active_size;
+  if ((padded_atoms_size > available) ||
+      (number_of_words > available / sizeof(uint32_t)) ||
+      (sizeof(NerdJournalRecord) + padded_atoms_size +
+           number_of_words * sizeof(uint32_t) >
+       available)) {
+    return -1;
+  }
+
+  const char *atom = start + sizeof(NerdJournalRecord),
+             *const atoms_end = atom + record->atoms_size;
+  reader->atoms = (const char **)realloc(
+      reader->atoms,
+      (reader->number_of_atoms + record->number_of_atoms) * sizeof(char *));
+  reader->atom_ids = (unsigned int *)realloc(
+      reader->atom_ids, (reader->number_of_atoms + record->number_of_atoms) *
+                            sizeof(unsigned int));
+  uint32_t i;
+  size_t length;
+  for (i = 0; i < record->number_of_atoms; ++i) {
+    if (atom >= atoms_end) {
+      return -1;
+    }
+    length = strnlen(atom, atoms_end - atom);
+    if (atom + length == atoms_end) {
+      return -1;
+    }
+    reader->atoms[reader->number_of_atoms] = atom;
+    reader->atom_ids[reader->number_of_atoms++] = UINT_MAX;
+    atom += length + 1;
+  }
+
+  const uint32_t *words = (const uint32_t *)(start + sizeof(NerdJournalRecord) +
+                                             padded_atoms_size),
+                 *const rules_end = words + record->rules_size;
+  reader->rules = (NerdJournalRule *)realloc(
+      reader->rules, (reader->number_of_rules + record->number_of_added) *
+                         sizeof(NerdJournalRule));
+  uint32_t j;
+  for (i = 0; i < record->number_of_added; ++i) {
+    if ((rules_end - words < 3) || (words[1] == 0) ||
+        ((uint32_t)(rules_end - words - 3) < words[1])) {
+      return -1;
+    }
+    for (j = 0; j < words[1] + 3; j = (j == 0) ? 3 : (j + 1)) {
+      if ((words[j] >> 1) >= reader->number_of_atoms) {
+        return -1;
+      }
+    }
+    NerdJournalRule *const rule = &(reader->rules[reader->number_of_rules++]);
+    rule->keys = words;
+    memcpy(&(rule->weight), words + 2, sizeof(float));
+    rule->alive = true;
+    words += words[1] + 3;
+  }
+  if (words != rules_end) {
+    return -1;
+  }
+
+  for (i = 0; i < record->number_of_removed; ++i, ++words) {
+    if ((*words >= reader->number_of_rules) ||
+        !reader->rules[*words].alive) {
+      return -1;
+    }
+    reader->rules[*words].alive = false;
+  }
+
+  for (i = 0; i < record->number_of_reweighted; ++i, words += 2) {
+    if ((words[0] >= reader->number_of_rules) ||
+        !reader->rules[words[0]].alive) {
+      return -1;
+    }
+    memcpy(&(reader->rules[words[0]].weight), words + 1, sizeof(float));
+  }
+
+  if (record->active_size != UINT32_MAX) {
+    reader->active =
+        (uint32_t *)realloc(reader->active, active_size * sizeof(uint32_t));
+    for (i = 0; i < active_size; ++i) {
+      if ((words[i] >= reader->number_of_rules) ||
+          !reader->rules[words[i]].alive) {
+        return -1;
+      }
+      reader->active[i] = words[i];
+    }
+    reader->active_size = active_size;
+    words += active_size;
+  }
+
+  reader->iteration = record->iteration;
+  reader->instance = record->instance;
+  reader->position = (const char *)words - (const char *)reader->map;
+  return 0;
+}
+
+/**
+ * @brief Constructs a Literal from its key in the journal, interning its atom
+ * the first time it is needed.
+ */
+static Literal *_reader_literal(NerdJournalReader *const reader,
+                                const uint32_t key) {
+  const uint32_t atom = key >> 1;
+  if (reader->atom_ids[atom] == UINT_MAX) {
+    reader->atom_ids[atom] = literal_intern_atom(reader->atoms[atom]);
+  }
+  return literal_constructor_from_id(reader->atom_ids[atom], key & 1);
+}
+
+/**
+ * @brief Constructs the Rule of the journal with the given id, with its current
+ * weight, and adds it to the KnowledgeBase.
+ */
+static void _reader_add_rule(NerdJournalReader *const reader,
+                             KnowledgeBase *const knowledge_base,
+                             const uint32_t id, Literal **const body) {
+  const NerdJournalRule *const journal_rule = &(reader->rules[id]);
+  Literal *head = _reader_literal(reader, journal_rule->keys[0]);
+  uint32_t i;
+  for (i = 0; i < journal_rule->keys[1]; ++i) {
+    body[i] = _reader_literal(reader, journal_rule->keys[i + 3]);
+  }
+  Rule *rule = rule_constructor(journal_rule->keys[1], body, &head,
+                                journal_rule->weight, true);
+  knowledge_base_add_rule(knowledge_base, &rule);
+}
+
+/**
+ * @brief Materializes the Nerd at the last replayed record of the journal. The
+ * active Rules are added in their priority order, followed by the inactive
+ * ones.
+ *
+ * @param reader The NerdJournalReader to materialize.
+ * @param use_backward_chaining A boolean value which indicates whether the
+ * hypergraph should demote rules using the backward chaining algorithm or not.
+ *
+ * @return A new Nerd object *, or NULL if the reader is NULL. Use
+ * nerd_destructor to deallocate.
+ */
+Nerd *nerd_journal_reader_to_nerd(NerdJournalReader *const reader,
+                                  const bool use_backward_chaining) {
+  if (!reader) {
+    return NULL;
+  }
+
+  const NerdJournalHeader *const header =
+      (const NerdJournalHeader *)reader->map;
+  Nerd *nerd = (Nerd *)malloc(sizeof(Nerd));
+  nerd->max_rules_per_instance = header->max_rules_per_instance;
+  nerd->breadth = header->breadth;
+  nerd->depth = header->depth;
+  nerd->promotion_weight = header->promotion_weight;
+  nerd->demotion_weight = header->demotion_weight;
+  nerd->increasing_demotion = header->increasing_demotion;
+  nerd->knowledge_base = knowledge_base_constructor(
+      header->activation_threshold, use_backward_chaining);
+
+  bool *is_active = (bool *)calloc(reader->number_of_rules + 1, sizeof(bool));
+  size_t i, max_body_size = 0;
+  for (i = 0; i < reader->number_of_rules; ++i) {
+    if (reader->rules[i].alive && (reader->rules[i].keys[1] > max_body_size)) {
+      max_body_size = reader->rules[i].keys[1];
+    }
+  }
+  Literal **body = (Literal **)malloc((max_body_size + 1) * sizeof(Literal *));
+
+  for (i = 0; i < reader->active_size; ++i) {
+    is_active[reader->active[i]] = true;
+    _reader_add_rule(reader, nerd->knowledge_base, reader->active[i], body);
+  }
+  for (i = 0; i < reader->number_of_rules; ++i) {
+    if (reader->rules[i].alive && !is_active[i]) {
+      _reader_add_rule(reader, nerd->knowledge_base, i, body);
+    }
+  }
+
+  free(body);
+  free(is_active);
+  return nerd;
+}
+
+/**
+ * @brief Constructs a Nerd structure (object) as it was at the given iteration
+ * and instance of a journaled training.
+ *
+ * @param filepath The path of the journal file (.ndj).
+ * @param iteration The iteration of the Nerd, starting from 1. Use 0 (with
+ * instance 0) for the base checkpoint.
+ * @param instance The instance of the iteration, starting from 1.
+ * @param use_backward_chaining A boolean value which indicates whether the
+ * hypergraph should demote rules using the backward chaining algorithm or not.
+ *
+ * @return A new Nerd object *, or NULL if the journal could not be read or
+ * does not contain the given iteration and instance. Use nerd_destructor to
+ * deallocate.
+ */
+Nerd *nerd_constructor_from_journal(const char *const filepath,
+                                    const size_t iteration,
+                                    const size_t instance,
+                                    const bool use_backward_chaining) {
+  NerdJournalReader *reader = nerd_journal_reader_constructor(filepath);
+  Nerd *nerd = NULL;
+  while (nerd_journal_reader_next(reader) == 0) {
+    if ((reader->iteration == iteration) && (reader->instance == instance)) {
+      nerd = nerd_journal_reader_to_nerd(reader, use_backward_chaining);
+      break;
+    }
+  }
+  nerd_journal_reader_destructor(&reader);
+  return nerd;
+}
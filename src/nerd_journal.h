@@ -0,0 +1,55 @@
+#ifndef NERD_JOURNAL_H
+#define NERD_JOURNAL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "nerd.h"
+
+#define NERD_JOURNAL_FILE_NAME "journal.ndj"
+
+typedef struct NerdJournal NerdJournal;
+
+/**
+ * @brief A Rule of a journal as it is replayed. keys points into the mapped
+ * journal file and holds the head, the body size, the weight that the Rule was
+ * added with and the body Literals.
+ */
+typedef struct NerdJournalRule {
+  const uint32_t *keys;
+  float weight;
+  bool alive;
+} NerdJournalRule;
+
+/**
+ * @brief Replays a journal record by record. iteration and instance are the
+ * ones of the last replayed record (0 and 0 for the base checkpoint).
+ */
+typedef struct NerdJournalReader {
+  void *map;
+  size_t map_size, position, iteration, instance;
+  const char **atoms;
+  unsigned int *atom_ids;
+  NerdJournalRule *rules;
+  uint32_t *active;
+  size_t number_of_atoms, number_of_rules, active_size;
+} NerdJournalReader;
+
+NerdJournal *nerd_journal_constructor(const char *const filepath,
+                                      const Nerd *const nerd);
+int nerd_journal_destructor(NerdJournal **const journal);
+int nerd_journal_record(NerdJournal *const journal, const Nerd *const nerd,
+                        const size_t iteration, const size_t instance);
+
+NerdJournalReader *nerd_journal_reader_constructor(const char *const filepath);
+void nerd_journal_reader_destructor(NerdJournalReader **const reader);
+int nerd_journal_reader_next(NerdJournalReader *const reader);
+Nerd *nerd_journal_reader_to_nerd(NerdJournalReader *const reader,
+                                  const bool use_backward_chaining);
+Nerd *nerd_constructor_from_journal(const char *const filepath,
+                                    const size_t iteration,
+                                    const size_t instance,
+                                    const bool use_backward_chaining);
+
+#endif
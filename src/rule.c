@@ -1,11 +1,77 @@
 #include <float.h>
 #include <malloc.h>
 #include <math.h>
+#include <stddef.h>
 #include <string.h>
 
 #include "nerd_utils.h"
 #include "rule.h"
 
+/**
+ * @brief Mixes the bits of the given value (SplitMix64 finalizer), so that
+ * similar Literals give unrelated hashes.
+ */
+static inline uint64_t _mix(uint64_t value) {
+  value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+  return value ^ (value >> 31);
+}
+
+/**
+ * @brief Gives the key of a Literal, by which the body keys of a Rule are
+ * sorted.
+ */
+static inline unsigned int _literal_key(const Literal *const literal) {
+  return (literal->id << 1) | literal->sign;
+}
+
+/**
+ * @brief Computes the fingerprint of a Rule. The body keys are combined with a
+ * commutative operation (addition), so the order of the body does not affect
+ * the result, and the head is mixed separately so it cannot be swapped with a
+ * body Literal. It is computed once when the Rule is constructed, so it only
+ * needs to be called for Rules whose body or head are changed afterwards.
+ *
+ * @param rule The Rule to compute the fingerprint of.
+ *
+ * @return The 64-bit fingerprint of the Rule, or 0 if the Rule is NULL.
+ */
+uint64_t rule_fingerprint(const Rule *const rule) {
+  if (!rule) {
+    return 0;
+  }
+
+  uint64_t body = rule->body.size;
+  size_t i;
+  for (i = 0; i < rule->body.size; ++i) {
+    body += _mix(rule->body_keys[i]);
+  }
+  return _mix(body ^ _mix(_mix(rule->head_key)));
+}
+
+/**
+ * @brief Gives the offset of the body Literals from the start of a Rule that
+ * can hold the given number of body Literals. They follow the body keys,
+ * aligned for a Literal *.
+ */
+static inline size_t _body_literals_offset(const size_t capacity) {
+  const size_t offset =
+      offsetof(Rule, body_keys) + (capacity * sizeof(unsigned int));
+  return (offset + _Alignof(Literal *) - 1) & ~(_Alignof(Literal *) - 1);
+}
+
+/**
+ * @brief Allocates a Rule that can hold the given number of body Literals, with
+ * an empty body.
+ */
+static Rule *_rule_allocate(const size_t capacity) {
+  const size_t offset = _body_literals_offset(capacity);
+  Rule *rule = (Rule *)malloc(offset + (capacity * sizeof(Literal *)));
+  rule->body.literals = (Literal **)((char *)rule + offset);
+  rule->body.size = 0;
+  return rule;
+}
+
 /**
  * @brief Constructs a Rule.
  *
@@ -13,7 +79,8 @@
  * @param body An array containing a series of Literals required to activate the
  * Rule. It should be an array of Literal * (or a Literal **). Upon succession,
  * the items in this array/pointer paremter will become NULL, if and only if
- * take_ownership is true.
+ * take_ownership is true. NULL Literals and Literals that already exist in the
+ * body are skipped.
  * @param head The head of the Rule when it gets activated. It should be a
  * reference to a Literal * (Literal ** - a pointer to a Literal *). Upon
  * succession, this parameter will become NULL, if and only if take_ownership is
@@ -31,20 +98,40 @@ Rule *rule_constructor(const unsigned int body_size, Literal **const body,
                        Literal **const head, const float weight,
                        const bool take_ownership) {
   if (head && (*head) && body && (body_size > 0)) {
-    Rule *rule = (Rule *)malloc(sizeof(Rule));
+    Rule *rule = _rule_allocate(body_size);
 
     rule->head = *head;
+    rule->head_key = _literal_key(*head);
     if (take_ownership) {
       *head = NULL;
     }
-    rule->body = context_constructor(take_ownership);
 
-    unsigned int i;
+    unsigned int i, key;
+    size_t position;
     for (i = 0; i < body_size; ++i) {
-      context_add_literal(rule->body, &(body[i]));
+      if (!body[i]) {
+        continue;
+      }
+      key = _literal_key(body[i]);
+      for (position = rule->body.size;
+           (position > 0) && (rule->body_keys[position - 1] > key); --position)
+        ;
+      if ((position > 0) && (rule->body_keys[position - 1] == key)) {
+        continue;
+      }
+      memmove(rule->body_keys + position + 1, rule->body_keys + position,
+              (rule->body.size - position) * sizeof(unsigned int));
+      rule->body_keys[position] = key;
+      rule->body.literals[rule->body.size++] = body[i];
+      if (take_ownership) {
+        body[i] = NULL;
+      }
     }
 
     rule->weight = weight;
+    rule->queue_index = -1;
+    rule->took_ownership = take_ownership;
+    rule->fingerprint = rule_fingerprint(rule);
     return rule;
   }
   return NULL;
@@ -58,10 +145,6 @@ Rule *rule_constructor(const unsigned int body_size, Literal **const body,
  */
 void rule_destructor(Rule **const rule) {
   if (rule && (*rule)) {
-    if (scene_is_taking_ownership((*rule)->body)) {
-      literal_destructor(&((*rule)->head));
-    }
-    context_destructor(&((*rule)->body));
     (*rule)->weight = INFINITY;
     safe_free(*rule);
   }
@@ -77,14 +160,19 @@ void rule_destructor(Rule **const rule) {
  */
 void rule_copy(Rule **const destination, const Rule *const restrict source) {
   if (destination && source) {
-    *destination = (Rule *)malloc(sizeof(Rule));
-    if (scene_is_taking_ownership(source->body)) {
-      literal_copy(&((*destination)->head), source->head);
-    } else {
-      (*destination)->head = source->head;
-    }
-    scene_copy(&((*destination)->body), source->body);
-    (*destination)->weight = source->weight;
+    Rule *copy = _rule_allocate(source->body.size);
+    copy->head = source->head;
+    copy->body.size = source->body.size;
+    memcpy(copy->body.literals, source->body.literals,
+           source->body.size * sizeof(Literal *));
+    memcpy(copy->body_keys, source->body_keys,
+           source->body.size * sizeof(unsigned int));
+    copy->weight = source->weight;
+    copy->queue_index = -1;
+    copy->fingerprint = source->fingerprint;
+    copy->head_key = source->head_key;
+    copy->took_ownership = source->took_ownership;
+    *destination = copy;
   }
 }
 
@@ -99,7 +187,7 @@ void rule_copy(Rule **const destination, const Rule *const restrict source) {
  */
 int rule_took_ownership(const Rule *const rule) {
   if (rule) {
-    return scene_is_taking_ownership(rule->body);
+    return rule->took_ownership;
   }
   return -1;
 }
@@ -143,18 +231,10 @@ void rule_demote(Rule *const rule, const float amount) {
  */
 int rule_applicable(const Rule *const rule, const Context *const context) {
   if (rule && context) {
-    unsigned int i, j, applicable_literals = 0;
-    for (i = 0; i < context->size; ++i) {
-      for (j = 0; j < rule->body->size; ++j) {
-        if (literal_equals(context->literals[i], rule->body->literals[j])) {
-          ++applicable_literals;
-          if (applicable_literals == rule->body->size) {
-            return 1;
-          }
-        }
-      }
+    if (rule->body.size == 0) {
+      return 0;
     }
-    return 0;
+    return scene_contains_keys(context, rule->body.size, rule->body_keys);
   }
   return -1;
 }
@@ -172,13 +252,7 @@ int rule_applicable(const Rule *const rule, const Context *const context) {
  */
 int rule_concurs(const Rule *const rule, const Context *const context) {
   if (rule && context) {
-    unsigned int i;
-    for (i = 0; i < context->size; ++i) {
-      if (literal_equals(rule->head, context->literals[i])) {
-        return 1;
-      }
-    }
-    return 0;
+    return scene_literal_index(context, rule->head) > -1;
   }
   return -1;
 }
@@ -196,28 +270,11 @@ int rule_concurs(const Rule *const rule, const Context *const context) {
 int rule_equals(const Rule *const restrict rule1,
                 const Rule *const restrict rule2) {
   if (rule1 && rule2) {
-    if (rule1->body->size == rule2->body->size) {
-      if (literal_equals(rule1->head, rule2->head)) {
-        unsigned int i, j;
-        unsigned short failed = 0;
-        for (i = 0; i < rule1->body->size; ++i) {
-          for (j = 0; j < rule2->body->size; ++j) {
-            if (!literal_equals(rule1->body->literals[i],
-                                rule2->body->literals[j])) {
-              ++failed;
-            }
-          }
-
-          if (failed == rule1->body->size) {
-            return 0;
-          } else {
-            failed = 0;
-          }
-        }
-        return 1;
-      }
-    }
-    return 0;
+    return (rule1->fingerprint == rule2->fingerprint) &&
+           (rule1->head_key == rule2->head_key) &&
+           (rule1->body.size == rule2->body.size) &&
+           (memcmp(rule1->body_keys, rule2->body_keys,
+                   rule1->body.size * sizeof(unsigned int)) == 0);
   }
   return -1;
 }
@@ -232,11 +289,11 @@ int rule_equals(const Rule *const restrict rule1,
  */
 char *rule_to_string(const Rule *const rule) {
   if (rule) {
-    if (rule->body && (rule->body->size != 0) && rule->head) {
+    if ((rule->body.size != 0) && rule->head) {
       char *literal_string, *result = strdup("(");
       size_t result_size = strlen(result) + 1;
 
-      literal_string = literal_to_string(rule->body->literals[0]);
+      literal_string = literal_to_string(rule->body.literals[0]);
       result_size += strlen(literal_string);
       char *temp = strdup(result);
       result = (char *)realloc(result, result_size);
@@ -245,8 +302,8 @@ char *rule_to_string(const Rule *const rule) {
       free(literal_string);
 
       unsigned int i;
-      for (i = 1; i < rule->body->size; ++i) {
-        literal_string = literal_to_string(rule->body->literals[i]);
+      for (i = 1; i < rule->body.size; ++i) {
+        literal_string = literal_to_string(rule->body.literals[i]);
         result_size += strlen(literal_string) + 2;
         temp = strdup(result);
         result = (char *)realloc(result, result_size);
@@ -283,7 +340,7 @@ char *rule_to_string(const Rule *const rule) {
 char *rule_to_prudensjs(const Rule *const rule,
                         const unsigned int rule_number) {
   if (rule) {
-    if (rule->body && (rule->body->size != 0) && rule->head) {
+    if ((rule->body.size != 0) && rule->head) {
       char temp_buffer[50];
       int rule_number_size = sprintf(temp_buffer, "%d", rule_number);
 
@@ -293,9 +350,9 @@ char *rule_to_prudensjs(const Rule *const rule,
       size_t body_size = strlen(body) + 1, result_size;
 
       unsigned int i;
-      for (i = 0; i < rule->body->size - 1; ++i) {
+      for (i = 0; i < rule->body.size - 1; ++i) {
         literal_prudensjs_string =
-            literal_to_prudensjs(rule->body->literals[i]);
+            literal_to_prudensjs(rule->body.literals[i]);
         body_size += strlen(literal_prudensjs_string) + 2;
         temp = strdup(body);
         body = (char *)realloc(body, body_size);
@@ -304,7 +361,7 @@ char *rule_to_prudensjs(const Rule *const rule,
         free(literal_prudensjs_string);
       }
 
-      literal_prudensjs_string = literal_to_prudensjs(rule->body->literals[i]);
+      literal_prudensjs_string = literal_to_prudensjs(rule->body.literals[i]);
       body_size += strlen(literal_prudensjs_string) + 11;
       temp = strdup(body);
       body = (char *)realloc(body, body_size);
@@ -2,17 +2,40 @@
 #define RULE_H
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #include "context.h"
 #include "literal.h"
 
+/**
+ * @brief The body Literals of a Rule, in the order they were given. They are
+ * stored in the same allocation as their Rule, so a Body is not a Context and
+ * it should not be given to the Scene functions.
+ */
+typedef struct Body {
+  Literal **literals;
+  size_t size;
+} Body;
 
-typedef Context Body;
-
+/**
+ * @brief A Body (Literals) which implies a head (Literal). queue_index is the
+ * position of the Rule in the indexed RuleQueue that holds it (e.g., the active
+ * Rules of a KnowledgeBase), or -1 if none holds it. fingerprint is a hash of
+ * the head and the body (regardless of the order of the body Literals), so
+ * Rules with different fingerprints are never equal. head_key and body_keys are
+ * the keys ((id << 1) | sign) of the head and the body Literals, the latter in
+ * ascending order, so that Rules are checked over contiguous integers. A Rule,
+ * its body_keys and its body Literals are a single allocation.
+ */
 typedef struct Rule {
-  Body *body;
   Literal *head;
+  Body body;
   float weight;
+  int queue_index;
+  uint64_t fingerprint;
+  unsigned int head_key;
+  bool took_ownership;
+  unsigned int body_keys[];
 } Rule;
 
 Rule *rule_constructor(const unsigned int body_size, Literal **const body,
@@ -20,6 +43,7 @@ Rule *rule_constructor(const unsigned int body_size, Literal **const body,
                        const bool take_ownership);
 void rule_destructor(Rule **const rule);
 void rule_copy(Rule **const destination, const Rule *const restrict source);
+uint64_t rule_fingerprint(const Rule *const rule);
 int rule_took_ownership(const Rule *const rule);
 void rule_promote(Rule *const rule, const float amount);
 void rule_demote(Rule *const rule, const float amount);
@@ -1,31 +1,112 @@
-#include <prb.h>
 #include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include "nerd_utils.h"
-#include "queue.h"
 #include "rule_hypergraph.h"
 
 typedef struct Vertex Vertex;
 
+/**
+ * @brief An Edge connects the body Vertices of a Rule (from) to its head
+ * Vertex. counter holds how many of its body Literals were found in the scene
+ * of the latest applicability pass (see _mark_applicable_edges), and it is only
+ * valid if stamp equals to that pass.
+ */
 typedef struct Edge {
   Rule *rule;
   Vertex **from;
   size_t number_of_vertices;
+  unsigned int counter, stamp;
 } Edge;
 
+/**
+ * @brief A Vertex of a Literal. edges are the Edges whose Rule has this Literal
+ * as its head, and body_edges are the Edges whose Rule has it in its body. id
+ * is the position the Vertex was inserted in the RuleHyperGraph, which is used
+ * to index the traversal bitmaps.
+ */
 typedef struct Vertex {
   Literal *literal;
-  Edge **edges;
-  size_t number_of_edges;
+  Edge **edges, **body_edges;
+  size_t number_of_edges, number_of_body_edges;
+  unsigned int id;
 } Vertex;
 
-typedef struct prb_table prb_table;
+/**
+ * @brief An entry of the backward chaining traversal; a Vertex and the depth
+ * it was reached at.
+ */
+typedef struct TraversalEntry {
+  Vertex *vertex;
+  unsigned int depth;
+} TraversalEntry;
+
+/**
+ * @brief The initial number of slots of the Vertex index. It should be a power
+ * of 2.
+ */
+#define VERTEX_INDEX_INITIAL_CAPACITY 16
+
+/**
+ * @brief A slot of the Rule fingerprint set. The slot is empty if count is 0.
+ * The count allows different Rules with the same fingerprint to coexist.
+ */
+typedef struct FingerprintSlot {
+  uint64_t fingerprint;
+  unsigned int count;
+} FingerprintSlot;
+
+/**
+ * @brief The header columns whose name is found in an atom (see
+ * rule_hypergraph_update_rules). They are found the first time the atom is
+ * seen with a header.
+ */
+typedef struct AtomColumns {
+  unsigned int *columns;
+  unsigned int size;
+  bool resolved;
+} AtomColumns;
+
+/**
+ * @brief A column of an observed Literal, which is the i-th Literal of the
+ * observed but not inferred Scene.
+ */
+typedef struct LiteralColumn {
+  unsigned int column, i;
+} LiteralColumn;
 
+/**
+ * The Vertices are kept in an open-addressing hash index (with linear probing),
+ * keyed by the atom id and the sign of their Literal. A slot is empty if it is
+ * NULL. The fingerprints of all the Rules are kept in a similar set, so that
+ * adding a Rule only compares it with existing Rules if they might be equal.
+ */
 struct RuleHyperGraph {
-  prb_table *literal_tree;
+  Vertex **vertices;
+  FingerprintSlot *fingerprints;
+  size_t number_of_vertices, capacity, number_of_fingerprints,
+      fingerprints_capacity;
+  unsigned int applicability_stamp;
   bool use_backward_chaining;
+  // Scratch space of rule_hypergraph_update_rules, reused across calls.
+  uint64_t *visited, *inferred_only;
+  TraversalEntry *traversal;
+  size_t scratch_capacity;
+  // The columns of each atom id in columns_header (a copy of the last header
+  // given), so that the header is searched once per atom instead of at each
+  // update.
+  AtomColumns *atom_columns;
+  size_t atom_columns_capacity, columns_header_size;
+  char **columns_header;
+  LiteralColumn *literal_columns;
+  size_t literal_columns_capacity;
+  // The Scenes of rule_hypergraph_update_rules only reference the Literals of
+  // the current update, so they are cleared at each update instead of being
+  // constructed again.
+  Scene *observed_and_inferred, *observed_diff_inferred, *opposing_literals;
+  Vertex **vertices_to_check;
+  size_t vertices_to_check_capacity;
 };
 
 // XXX Should we remove literals that are not used?
@@ -59,7 +140,10 @@ Vertex *vertex_constructor(Literal *const literal) {
   Vertex *vertex = (Vertex *)malloc(sizeof(Vertex));
   vertex->literal = literal;
   vertex->edges = NULL;
+  vertex->body_edges = NULL;
   vertex->number_of_edges = 0;
+  vertex->number_of_body_edges = 0;
+  vertex->id = 0;
   return vertex;
 }
 
@@ -79,6 +163,7 @@ void vertex_destructor(Vertex **const vertex, const bool destruct_literal) {
       edge_destructor(&((*vertex)->edges[i]));
     }
     safe_free((*vertex)->edges);
+    safe_free((*vertex)->body_edges);
     if (destruct_literal) {
       literal_destructor(&((*vertex)->literal));
     }
@@ -86,6 +171,212 @@ void vertex_destructor(Vertex **const vertex, const bool destruct_literal) {
   }
 }
 
+/**
+ * @brief Compares the string representations of two Vertices' Literals (as given
+ * by literal_to_string), without constructing them. It is used to traverse the
+ * Vertices in a deterministic order.
+ */
+int compare_literals(const void *vertex1, const void *vertex2) {
+  const Literal *l1 = (*(const Vertex *const *)vertex1)->literal,
+                *l2 = (*(const Vertex *const *)vertex2)->literal;
+
+  if (l1->sign == l2->sign) {
+    return strcmp(l1->atom, l2->atom);
+  }
+
+  int result;
+  if (!l1->sign) {
+    result = '-' - (unsigned char)l2->atom[0];
+    return result ? result : strcmp(l1->atom, l2->atom + 1);
+  }
+  result = (unsigned char)l1->atom[0] - '-';
+  return result ? result : strcmp(l1->atom + 1, l2->atom);
+}
+
+/**
+ * @brief Gives the slot of the Vertex index where the search for the given
+ * Literal should start from.
+ */
+static inline size_t _vertex_index_slot(const RuleHyperGraph *const hypergraph,
+                                        const Literal *const literal) {
+  const unsigned int key = (literal->id << 1) | literal->sign;
+  return (key * 2654435761u) & (hypergraph->capacity - 1);
+}
+
+/**
+ * @brief Finds the Vertex of the given Literal in the RuleHyperGraph.
+ *
+ * @return The Vertex * of the Literal, or NULL if it does not exist.
+ */
+static Vertex *_vertex_index_find(const RuleHyperGraph *const hypergraph,
+                                  const Literal *const literal) {
+  size_t slot = _vertex_index_slot(hypergraph, literal);
+  Vertex *vertex;
+  while ((vertex = hypergraph->vertices[slot])) {
+    if ((vertex->literal->id == literal->id) &&
+        (vertex->literal->sign == literal->sign)) {
+      return vertex;
+    }
+    slot = (slot + 1) & (hypergraph->capacity - 1);
+  }
+  return NULL;
+}
+
+/**
+ * @brief Inserts a Vertex into the RuleHyperGraph's index, if a Vertex of the
+ * same Literal does not already exist. The index grows when it becomes half
+ * full.
+ *
+ * @return NULL if the Vertex was inserted, or the existing Vertex otherwise.
+ */
+static Vertex *_vertex_index_insert(RuleHyperGraph *const hypergraph,
+                                    Vertex *const vertex) {
+  Vertex *existing = _vertex_index_find(hypergraph, vertex->literal);
+  if (existing) {
+    return existing;
+  }
+
+  size_t i, slot;
+  if (((hypergraph->number_of_vertices + 1) << 1) > hypergraph->capacity) {
+    Vertex **old = hypergraph->vertices;
+    const size_t old_capacity = hypergraph->capacity;
+    hypergraph->capacity <<= 1;
+    hypergraph->vertices =
+        (Vertex **)calloc(hypergraph->capacity, sizeof(Vertex *));
+    for (i = 0; i < old_capacity; ++i) {
+      if (old[i]) {
+        slot = _vertex_index_slot(hypergraph, old[i]->literal);
+        while (hypergraph->vertices[slot]) {
+          slot = (slot + 1) & (hypergraph->capacity - 1);
+        }
+        hypergraph->vertices[slot] = old[i];
+      }
+    }
+    free(old);
+  }
+
+  slot = _vertex_index_slot(hypergraph, vertex->literal);
+  while (hypergraph->vertices[slot]) {
+    slot = (slot + 1) & (hypergraph->capacity - 1);
+  }
+  hypergraph->vertices[slot] = vertex;
+  vertex->id = hypergraph->number_of_vertices++;
+  return NULL;
+}
+
+/**
+ * @brief Gives the Vertices of the RuleHyperGraph ordered by their Literals'
+ * string representation. It should only be used when the order matters (e.g.,
+ * copying or printing), as it is not as cheap as looking up a Vertex.
+ *
+ * @return A Vertex ** with hypergraph->number_of_vertices elements. Use free()
+ * to deallocate it (not the Vertices). NULL if the RuleHyperGraph is empty.
+ */
+static Vertex **_vertex_index_ordered(const RuleHyperGraph *const hypergraph) {
+  if (hypergraph->number_of_vertices == 0) {
+    return NULL;
+  }
+
+  Vertex **ordered =
+      (Vertex **)malloc(hypergraph->number_of_vertices * sizeof(Vertex *));
+  size_t i, j = 0;
+  for (i = 0; i < hypergraph->capacity; ++i) {
+    if (hypergraph->vertices[i]) {
+      ordered[j++] = hypergraph->vertices[i];
+    }
+  }
+  qsort(ordered, j, sizeof(Vertex *), compare_literals);
+  return ordered;
+}
+
+/**
+ * @brief Finds the slot of the given fingerprint in the RuleHyperGraph's
+ * fingerprint set, or the empty slot where it should be inserted.
+ */
+static size_t _fingerprint_set_slot(const RuleHyperGraph *const hypergraph,
+                                    const uint64_t fingerprint) {
+  const size_t mask = hypergraph->fingerprints_capacity - 1;
+  size_t slot = fingerprint & mask;
+  while ((hypergraph->fingerprints[slot].count != 0) &&
+         (hypergraph->fingerprints[slot].fingerprint != fingerprint)) {
+    slot = (slot + 1) & mask;
+  }
+  return slot;
+}
+
+/**
+ * @brief Checks whether a Rule with the given fingerprint might exist in the
+ * RuleHyperGraph.
+ *
+ * @return true if the fingerprint exists, false otherwise.
+ */
+static bool _fingerprint_set_contains(const RuleHyperGraph *const hypergraph,
+                                      const uint64_t fingerprint) {
+  return hypergraph->fingerprints[_fingerprint_set_slot(hypergraph, fingerprint)]
+             .count != 0;
+}
+
+/**
+ * @brief Adds a fingerprint to the RuleHyperGraph's fingerprint set. The set
+ * grows when it becomes half full.
+ */
+static void _fingerprint_set_add(RuleHyperGraph *const hypergraph,
+                                 const uint64_t fingerprint) {
+  size_t i, slot;
+  if (((hypergraph->number_of_fingerprints + 1) << 1) >
+      hypergraph->fingerprints_capacity) {
+    FingerprintSlot *old = hypergraph->fingerprints;
+    const size_t old_capacity = hypergraph->fingerprints_capacity;
+    hypergraph->fingerprints_capacity <<= 1;
+    hypergraph->fingerprints = (FingerprintSlot *)calloc(
+        hypergraph->fingerprints_capacity, sizeof(FingerprintSlot));
+    for (i = 0; i < old_capacity; ++i) {
+      if (old[i].count != 0) {
+        slot = _fingerprint_set_slot(hypergraph, old[i].fingerprint);
+        hypergraph->fingerprints[slot] = old[i];
+      }
+    }
+    free(old);
+  }
+
+  slot = _fingerprint_set_slot(hypergraph, fingerprint);
+  if (hypergraph->fingerprints[slot].count == 0) {
+    hypergraph->fingerprints[slot].fingerprint = fingerprint;
+    ++hypergraph->number_of_fingerprints;
+  }
+  ++hypergraph->fingerprints[slot].count;
+}
+
+/**
+ * @brief Removes a fingerprint from the RuleHyperGraph's fingerprint set. When
+ * a slot is emptied, the following slots of its cluster are shifted back, so
+ * no tombstones are needed.
+ */
+static void _fingerprint_set_remove(RuleHyperGraph *const hypergraph,
+                                    const uint64_t fingerprint) {
+  const size_t mask = hypergraph->fingerprints_capacity - 1;
+  size_t slot = _fingerprint_set_slot(hypergraph, fingerprint), next, home;
+  if ((hypergraph->fingerprints[slot].count == 0) ||
+      (--hypergraph->fingerprints[slot].count != 0)) {
+    return;
+  }
+  --hypergraph->number_of_fingerprints;
+
+  next = slot;
+  while (true) {
+    next = (next + 1) & mask;
+    if (hypergraph->fingerprints[next].count == 0) {
+      break;
+    }
+    home = hypergraph->fingerprints[next].fingerprint & mask;
+    if (((next - home) & mask) >= ((next - slot) & mask)) {
+      hypergraph->fingerprints[slot] = hypergraph->fingerprints[next];
+      hypergraph->fingerprints[next].count = 0;
+      slot = next;
+    }
+  }
+}
+
 /**
  * @brief Constructs a RuleHyperGraph Edge.
  *
@@ -96,9 +387,9 @@ void vertex_destructor(Vertex **const vertex, const bool destruct_literal) {
  * should be reference to a Rule * (Rule ** - a pointer to a Rule *). If the
  * given Rule had took ownership of its content, a new Rule will be created
  * without taking the ownership of that content as it will belong to the
- * internal RB-Tree. If it does not take the ownership of the its content, the
- * content pointers might stil change, as the body and head will take the
- * pointer of the item allocated in the RB-Tree.
+ * RuleHyperGraph's Vertices. If it does not take the ownership of the its
+ * content, the content pointers might stil change, as the body and head will
+ * take the pointer of the Literal of the existing Vertex.
  * @param head_vertex The Vertex that the edge will be created for. It will not
  * be added to the Vertex.
  *
@@ -111,49 +402,32 @@ Edge *edge_constructor(RuleHyperGraph *const rule_hypergraph, Rule **const rule,
   }
 
   Edge *edge = (Edge *)malloc(sizeof(Edge));
-  edge->from = (Vertex **)malloc(sizeof(Vertex *) * (*rule)->body->size);
-  edge->number_of_vertices = (*rule)->body->size;
+  edge->from = (Vertex **)malloc(sizeof(Vertex *) * (*rule)->body.size);
+  edge->number_of_vertices = (*rule)->body.size;
+  edge->counter = 0;
+  edge->stamp = 0;
   Vertex *vertex;
-  void *result;
   unsigned int i;
 
-  if (rule_took_ownership(*rule)) {
-    Literal **body = (*rule)->body->literals;
-    for (i = 0; i < (*rule)->body->size; ++i) {
-      vertex = vertex_constructor((*rule)->body->literals[i]);
-
-      result = prb_insert(rule_hypergraph->literal_tree, vertex);
-      if (result) {
-        vertex_destructor(&vertex, true);
-        vertex = result;
-        body[i] = vertex->literal;
-      }
-      edge->from[i] = vertex;
-    }
-    Rule *new_rule =
-        rule_constructor((*rule)->body->size, body, &(head_vertex->literal),
-                         (*rule)->weight, false);
+  (*rule)->head = head_vertex->literal;
+  for (i = 0; i < (*rule)->body.size; ++i) {
+    vertex = _vertex_index_find(rule_hypergraph, (*rule)->body.literals[i]);
 
-    if ((*rule)->head != head_vertex->literal) {
-      literal_destructor(&((*rule)->head));
+    if (vertex) {
+      (*rule)->body.literals[i] = vertex->literal;
+    } else {
+      vertex = vertex_constructor((*rule)->body.literals[i]);
+      _vertex_index_insert(rule_hypergraph, vertex);
     }
-    free(body);
-    safe_free((*rule)->body);
-    safe_free((*rule));
+    edge->from[i] = vertex;
+  }
+
+  if (rule_took_ownership(*rule)) {
+    Rule *new_rule;
+    rule_copy(&new_rule, *rule);
+    new_rule->took_ownership = false;
+    rule_destructor(rule);
     *rule = new_rule;
-  } else {
-    (*rule)->head = head_vertex->literal;
-    for (i = 0; i < (*rule)->body->size; ++i) {
-      vertex = vertex_constructor((*rule)->body->literals[i]);
-
-      result = prb_insert(rule_hypergraph->literal_tree, vertex);
-      if (result) {
-        vertex_destructor(&vertex, false);
-        vertex = result;
-        (*rule)->body->literals[i] = vertex->literal;
-      }
-      edge->from[i] = vertex;
-    }
   }
   edge->rule = *rule;
   return edge;
@@ -161,7 +435,8 @@ Edge *edge_constructor(RuleHyperGraph *const rule_hypergraph, Rule **const rule,
 
 /**
  * @brief Adds an Edge to a Vertex. The Vertex is the head of the Rule, and the
- * Edge contains the origin (body) of the Rule.
+ * Edge contains the origin (body) of the Rule. The Edge is also added to the
+ * body_edges of each of its origin Vertices.
  *
  * @param vertex The Vertex to add the Edge to.
  * @param edge The Edge to be added to the Vertex.
@@ -171,6 +446,38 @@ void vertex_add_edge(Vertex *const vertex, Edge *const edge) {
     vertex->edges = (Edge **)realloc(
         vertex->edges, sizeof(Edge *) * ++vertex->number_of_edges);
     vertex->edges[vertex->number_of_edges - 1] = edge;
+
+    Vertex *from;
+    unsigned int i;
+    for (i = 0; i < edge->number_of_vertices; ++i) {
+      from = edge->from[i];
+      from->body_edges = (Edge **)realloc(
+          from->body_edges, sizeof(Edge *) * ++from->number_of_body_edges);
+      from->body_edges[from->number_of_body_edges - 1] = edge;
+    }
+  }
+}
+
+/**
+ * @brief Removes an Edge from the body_edges of each of its origin Vertices.
+ * The order of the body_edges is not preserved.
+ *
+ * @param edge The Edge to be unlinked.
+ */
+static void _edge_unlink_body(const Edge *const edge) {
+  Vertex *from;
+  unsigned int i, j;
+  for (i = 0; i < edge->number_of_vertices; ++i) {
+    from = edge->from[i];
+    for (j = 0; j < from->number_of_body_edges; ++j) {
+      if (from->body_edges[j] == edge) {
+        from->body_edges[j] = from->body_edges[--from->number_of_body_edges];
+        break;
+      }
+    }
+    if (from->number_of_body_edges == 0) {
+      safe_free(from->body_edges);
+    }
   }
 }
 
@@ -183,6 +490,7 @@ void vertex_add_edge(Vertex *const vertex, Edge *const edge) {
  */
 void vertex_remove_edge(Vertex *const vertex, unsigned int index) {
   if (vertex && (index < vertex->number_of_edges)) {
+    _edge_unlink_body(vertex->edges[index]);
     edge_destructor(&(vertex->edges[index]));
     --vertex->number_of_edges;
     if (vertex->number_of_edges == 0) {
@@ -208,38 +516,7 @@ void vertex_remove_edge(Vertex *const vertex, unsigned int index) {
 }
 
 /**
- * @brief Function to be used with the RB-Tree to deallocate the Vertices and
- * the Edges.
- */
-void item_destructor(void *item, void *param) {
-  if (param)
-    return;
-
-  Vertex *v = (Vertex *)item;
-  vertex_destructor(&v, true);
-}
-
-/**
- * @brief Function to be used with the RB-Tree to find the appropriate location
- * of a Vertex through comparison.
- */
-int compare_literals(const void *vertex1, const void *vertex2, void *param) {
-  if (param)
-    return 0;
-
-  const Vertex *v1 = (Vertex *)vertex1, *v2 = (Vertex *)vertex2;
-  char *l1_string = literal_to_string(v1->literal),
-       *l2_string = literal_to_string(v2->literal);
-  int result = strcmp(l1_string, l2_string);
-
-  free(l1_string);
-  free(l2_string);
-
-  return result;
-}
-
-/**
- * @brief Costructs an empty RuleHyperGraph with an empty RB-Tree.
+ * @brief Costructs an empty RuleHyperGraph with an empty Vertex index.
  *
  * @param use_backward_chaining A boolean value which indicates whether the
  * hypergraph should demoted rules using the backward chaining algorithm or not.
@@ -250,22 +527,66 @@ RuleHyperGraph *
 rule_hypergraph_empty_constructor(const bool use_backward_chaining) {
   RuleHyperGraph *hypergraph = (RuleHyperGraph *)malloc(sizeof(RuleHyperGraph));
 
-  hypergraph->literal_tree = prb_create(compare_literals, NULL, NULL);
+  hypergraph->vertices =
+      (Vertex **)calloc(VERTEX_INDEX_INITIAL_CAPACITY, sizeof(Vertex *));
+  hypergraph->number_of_vertices = 0;
+  hypergraph->capacity = VERTEX_INDEX_INITIAL_CAPACITY;
+  hypergraph->fingerprints = (FingerprintSlot *)calloc(
+      VERTEX_INDEX_INITIAL_CAPACITY, sizeof(FingerprintSlot));
+  hypergraph->number_of_fingerprints = 0;
+  hypergraph->fingerprints_capacity = VERTEX_INDEX_INITIAL_CAPACITY;
+  hypergraph->applicability_stamp = 0;
+  hypergraph->visited = NULL;
+  hypergraph->inferred_only = NULL;
+  hypergraph->traversal = NULL;
+  hypergraph->scratch_capacity = 0;
+  hypergraph->atom_columns = NULL;
+  hypergraph->atom_columns_capacity = 0;
+  hypergraph->columns_header = NULL;
+  hypergraph->columns_header_size = 0;
+  hypergraph->literal_columns = NULL;
+  hypergraph->literal_columns_capacity = 0;
+  hypergraph->observed_and_inferred = scene_constructor(false);
+  hypergraph->observed_diff_inferred = scene_constructor(false);
+  hypergraph->opposing_literals = scene_constructor(false);
+  hypergraph->vertices_to_check = NULL;
+  hypergraph->vertices_to_check_capacity = 0;
   hypergraph->use_backward_chaining = use_backward_chaining;
 
   return hypergraph;
 }
 
 /**
- * @brief Destructs the given RuleHyperGraph and its RB-Tree.
+ * @brief Destructs the given RuleHyperGraph and all of its Vertices.
  *
  * @param rule_hypergraph The RuleHyperGraph to be destructed. It should be
  * reference to a RuleHyperGraph (RuleHyperGraph ** - a pointer to a
  * RuleHyperGraph *). Upon succession, this parameter will become NULL.
  */
 void rule_hypergraph_destructor(RuleHyperGraph **const rule_hypergraph) {
-  if (rule_hypergraph && *rule_hypergraph && (*rule_hypergraph)->literal_tree) {
-    prb_destroy((*rule_hypergraph)->literal_tree, item_destructor);
+  if (rule_hypergraph && *rule_hypergraph && (*rule_hypergraph)->vertices) {
+    size_t i;
+    for (i = 0; i < (*rule_hypergraph)->capacity; ++i) {
+      vertex_destructor(&((*rule_hypergraph)->vertices[i]), true);
+    }
+    safe_free((*rule_hypergraph)->vertices);
+    safe_free((*rule_hypergraph)->fingerprints);
+    safe_free((*rule_hypergraph)->visited);
+    safe_free((*rule_hypergraph)->inferred_only);
+    safe_free((*rule_hypergraph)->traversal);
+    for (i = 0; i < (*rule_hypergraph)->atom_columns_capacity; ++i) {
+      free((*rule_hypergraph)->atom_columns[i].columns);
+    }
+    safe_free((*rule_hypergraph)->atom_columns);
+    for (i = 0; i < (*rule_hypergraph)->columns_header_size; ++i) {
+      free((*rule_hypergraph)->columns_header[i]);
+    }
+    safe_free((*rule_hypergraph)->columns_header);
+    safe_free((*rule_hypergraph)->literal_columns);
+    scene_destructor(&((*rule_hypergraph)->observed_and_inferred));
+    scene_destructor(&((*rule_hypergraph)->observed_diff_inferred));
+    scene_destructor(&((*rule_hypergraph)->opposing_literals));
+    safe_free((*rule_hypergraph)->vertices_to_check);
     safe_free(*rule_hypergraph);
   }
 }
@@ -285,21 +606,21 @@ void rule_hypergraph_copy(KnowledgeBase **const destination,
     (*destination)->hypergraph = rule_hypergraph_empty_constructor(
         source->hypergraph->use_backward_chaining);
 
-    struct prb_traverser traverser;
-
-    Vertex *current_vertex =
-        prb_t_first(&traverser, source->hypergraph->literal_tree);
+    Vertex **ordered = _vertex_index_ordered(source->hypergraph),
+           *current_vertex;
 
+    size_t v;
     unsigned int i, j;
-    while (current_vertex) {
+    for (v = 0; v < source->hypergraph->number_of_vertices; ++v) {
+      current_vertex = ordered[v];
       for (i = 0; i < current_vertex->number_of_edges; ++i) {
         Literal *head,
             **body = (Literal **)malloc(
-                sizeof(Literal *) * current_vertex->edges[i]->rule->body->size);
+                sizeof(Literal *) * current_vertex->edges[i]->rule->body.size);
         literal_copy(&head, current_vertex->edges[i]->rule->head);
-        for (j = 0; j < current_vertex->edges[i]->rule->body->size; ++j) {
+        for (j = 0; j < current_vertex->edges[i]->rule->body.size; ++j) {
           literal_copy(&(body[j]),
-                       current_vertex->edges[i]->rule->body->literals[j]);
+                       current_vertex->edges[i]->rule->body.literals[j]);
         }
         Rule *rule = rule_constructor(
             j, body, &head, current_vertex->edges[i]->rule->weight, true);
@@ -307,9 +628,27 @@ void rule_hypergraph_copy(KnowledgeBase **const destination,
 
         knowledge_base_add_rule(*destination, &rule);
       }
-      current_vertex = prb_t_next(&traverser);
+    }
+    safe_free(ordered);
+  }
+}
+
+/**
+ * @brief Checks whether the given head Vertex has an Edge with a Rule equal to
+ * the given one. Rules are only compared if their fingerprint exists.
+ */
+static bool _vertex_has_rule(const RuleHyperGraph *const hypergraph,
+                             const Vertex *const head_vertex,
+                             const Rule *const rule) {
+  if (_fingerprint_set_contains(hypergraph, rule->fingerprint)) {
+    unsigned int i;
+    for (i = 0; i < head_vertex->number_of_edges; ++i) {
+      if (rule_equals(head_vertex->edges[i]->rule, rule)) {
+        return true;
+      }
     }
   }
+  return false;
 }
 
 /**
@@ -319,10 +658,10 @@ void rule_hypergraph_copy(KnowledgeBase **const destination,
  * @param rule_hypergraph The RuleHyperGraph to add the Rule.
  * @param rule The Rule to be added to the RuleHyperGraph. If the given Rule had
  * took ownership of its content, a new Rule will be created without taking the
- * ownership of that content as it will belong to the internal RB-Tree. If it
- * does not take the ownership of the its content, the content pointers might
- * stil change, as the body and head will take the pointer of the item allocated
- * in the RB-Tree.
+ * ownership of that content as it will belong to the RuleHyperGraph's Vertices.
+ * If it does not take the ownership of the its content, the content pointers
+ * might stil change, as the body and head will take the pointer of the Literal
+ * of the existing Vertex.
  *
  * @return 1 if Rule was successfully added, 0 if it was not, and -1 if one of
  * the parameters was NULL.
@@ -330,22 +669,20 @@ void rule_hypergraph_copy(KnowledgeBase **const destination,
 int rule_hypergraph_add_rule(RuleHyperGraph *const rule_hypergraph,
                              Rule **const rule) {
   if (rule_hypergraph && rule && *rule) {
-    Vertex *head_vertex = vertex_constructor((*rule)->head);
-    void *result = prb_insert(rule_hypergraph->literal_tree, head_vertex);
+    Vertex *head_vertex = _vertex_index_find(rule_hypergraph, (*rule)->head);
 
-    if (result) {
-      vertex_destructor(&head_vertex, false);
-      head_vertex = result;
+    if (!head_vertex) {
+      head_vertex = vertex_constructor((*rule)->head);
+      _vertex_index_insert(rule_hypergraph, head_vertex);
     }
 
-    unsigned int i;
-    for (i = 0; i < head_vertex->number_of_edges; ++i) {
-      if (rule_equals(head_vertex->edges[i]->rule, *rule)) {
-        return 0;
-      }
+    if (_vertex_has_rule(rule_hypergraph, head_vertex, *rule)) {
+      return 0;
     }
+    const uint64_t fingerprint = (*rule)->fingerprint;
     Edge *edge = edge_constructor(rule_hypergraph, rule, head_vertex);
     vertex_add_edge(head_vertex, edge);
+    _fingerprint_set_add(rule_hypergraph, fingerprint);
     return 1;
   }
   return -1;
@@ -362,18 +699,15 @@ int rule_hypergraph_add_rule(RuleHyperGraph *const rule_hypergraph,
 void rule_hypergraph_remove_rule(RuleHyperGraph *const rule_hypergraph,
                                  Rule *const rule) {
   if (rule_hypergraph && rule) {
-    Vertex *v = vertex_constructor(rule->head);
-    void *result = prb_find(rule_hypergraph->literal_tree, v);
-
-    vertex_destructor(&v, false);
-    if (!result) {
+    Vertex *v = _vertex_index_find(rule_hypergraph, rule->head);
+    if (!v) {
       return;
     }
-    v = result;
 
     unsigned int i;
     for (i = 0; i < v->number_of_edges; ++i) {
       if (v->edges[i]->rule == rule) {
+        _fingerprint_set_remove(rule_hypergraph, rule->fingerprint);
         vertex_remove_edge(v, i);
       }
     }
@@ -397,11 +731,12 @@ void rule_hypergraph_get_inactive_rules(
     RuleQueue **const inactive_rules) {
   if (knowledge_base && inactive_rules) {
     *inactive_rules = rule_queue_constructor(false);
-    struct prb_traverser traverser;
-    Vertex *result = (Vertex *)prb_t_first(
-        &traverser, knowledge_base->hypergraph->literal_tree);
+    Vertex **ordered = _vertex_index_ordered(knowledge_base->hypergraph),
+           *result;
+    size_t v;
     unsigned int i;
-    while (result) {
+    for (v = 0; v < knowledge_base->hypergraph->number_of_vertices; ++v) {
+      result = ordered[v];
       for (i = 0; i < result->number_of_edges; ++i) {
         Rule *current_rule = result->edges[i]->rule;
 
@@ -409,9 +744,265 @@ void rule_hypergraph_get_inactive_rules(
           rule_queue_enqueue(*inactive_rules, &(current_rule));
         }
       }
-      result = (Vertex *)prb_t_next(&traverser);
     }
+    safe_free(ordered);
+  }
+}
+
+/**
+ * @brief Visits every Rule of the RuleHyperGraph, in no particular order. The
+ * Vertices are walked as they are stored, so nothing is allocated or sorted;
+ * use rule_hypergraph_get_inactive_rules when the order matters.
+ *
+ * @param rule_hypergraph The RuleHyperGraph whose Rules will be visited.
+ * @param visit The function to call with each Rule and the given argument. It
+ * must not add Rules to or remove Rules from the RuleHyperGraph.
+ * @param argument The argument to pass to visit.
+ */
+void rule_hypergraph_for_each_rule(const RuleHyperGraph *const rule_hypergraph,
+                                   void (*visit)(const Rule *rule,
+                                                 void *argument),
+                                   void *argument) {
+  if (rule_hypergraph && visit) {
+    const Vertex *vertex;
+    size_t v;
+    unsigned int i;
+    for (v = 0; v < rule_hypergraph->capacity; ++v) {
+      if ((vertex = rule_hypergraph->vertices[v])) {
+        for (i = 0; i < vertex->number_of_edges; ++i) {
+          visit(vertex->edges[i]->rule, argument);
+        }
+      }
+    }
+  }
+}
+
+/**
+ * @brief Finds all the applicable Rules of the RuleHyperGraph given a Scene, in
+ * a single pass over the Scene. For each Literal of the Scene, the counters of
+ * the Edges whose body contains it are increased, so an Edge is applicable when
+ * its counter reaches the size of its body. The counters of the previous pass
+ * are invalidated by advancing the stamp of the RuleHyperGraph.
+ *
+ * @param hypergraph The RuleHyperGraph whose Edges will be marked.
+ * @param scene The Scene that the Rules will be checked with.
+ */
+static void _mark_applicable_edges(RuleHyperGraph *const hypergraph,
+                                   const Scene *const scene) {
+  const unsigned int stamp = ++hypergraph->applicability_stamp;
+  Vertex *vertex;
+  Edge *edge;
+  unsigned int i, j;
+  for (i = 0; i < scene->size; ++i) {
+    vertex = _vertex_index_find(hypergraph, scene->literals[i]);
+    if (vertex) {
+      for (j = 0; j < vertex->number_of_body_edges; ++j) {
+        edge = vertex->body_edges[j];
+        if (edge->stamp != stamp) {
+          edge->stamp = stamp;
+          edge->counter = 0;
+        }
+        ++edge->counter;
+      }
+    }
+  }
+}
+
+/**
+ * @brief Checks whether the Rule of an Edge was applicable in the latest
+ * _mark_applicable_edges pass.
+ */
+static inline bool _edge_applicable(const RuleHyperGraph *const hypergraph,
+                                    const Edge *const edge) {
+  return (edge->stamp == hypergraph->applicability_stamp) &&
+         (edge->counter == edge->number_of_vertices);
+}
+
+/**
+ * @brief Checks whether the bit of the given Vertex id is set in a bitmap.
+ */
+static inline bool _bitmap_test(const uint64_t *const bitmap,
+                                const unsigned int id) {
+  return (bitmap[id >> 6] >> (id & 63)) & 1;
+}
+
+/**
+ * @brief Sets the bit of the given Vertex id in a bitmap.
+ */
+static inline void _bitmap_set(uint64_t *const bitmap, const unsigned int id) {
+  bitmap[id >> 6] |= (uint64_t)1 << (id & 63);
+}
+
+/**
+ * @brief Clears the bit of the given Vertex id in a bitmap.
+ */
+static inline void _bitmap_clear(uint64_t *const bitmap,
+                                 const unsigned int id) {
+  bitmap[id >> 6] &= ~((uint64_t)1 << (id & 63));
+}
+
+/**
+ * @brief Makes sure that the Vertices to check of rule_hypergraph_update_rules
+ * can hold the given number of Vertices, doubling their capacity if not.
+ *
+ * @return The (possibly moved) Vertices to check.
+ */
+static Vertex **_reserve_vertices_to_check(RuleHyperGraph *const hypergraph,
+                                           const size_t size) {
+  if (size > hypergraph->vertices_to_check_capacity) {
+    hypergraph->vertices_to_check_capacity = size << 1;
+    hypergraph->vertices_to_check = (Vertex **)realloc(
+        hypergraph->vertices_to_check,
+        hypergraph->vertices_to_check_capacity * sizeof(Vertex *));
+  }
+  return hypergraph->vertices_to_check;
+}
+
+/**
+ * @brief Makes sure that the scratch space of the RuleHyperGraph can hold all
+ * of its Vertices. The bitmaps are kept cleared between uses.
+ */
+static void _reserve_scratch(RuleHyperGraph *const hypergraph) {
+  if (hypergraph->scratch_capacity >= hypergraph->number_of_vertices) {
+    return;
+  }
+
+  const size_t old_words = (hypergraph->scratch_capacity + 63) >> 6;
+  size_t capacity = hypergraph->scratch_capacity ? hypergraph->scratch_capacity
+                                                 : VERTEX_INDEX_INITIAL_CAPACITY;
+  while (capacity < hypergraph->number_of_vertices) {
+    capacity <<= 1;
+  }
+  const size_t words = (capacity + 63) >> 6;
+
+  hypergraph->visited =
+      (uint64_t *)realloc(hypergraph->visited, words * sizeof(uint64_t));
+  hypergraph->inferred_only =
+      (uint64_t *)realloc(hypergraph->inferred_only, words * sizeof(uint64_t));
+  memset(hypergraph->visited + old_words, 0,
+         (words - old_words) * sizeof(uint64_t));
+  memset(hypergraph->inferred_only + old_words, 0,
+         (words - old_words) * sizeof(uint64_t));
+  hypergraph->traversal = (TraversalEntry *)realloc(
+      hypergraph->traversal, capacity * sizeof(TraversalEntry));
+  hypergraph->scratch_capacity = capacity;
+}
+
+/**
+ * @brief Sets or clears the inferred_only bit of each Vertex of the given
+ * Scene's Literals.
+ */
+static void _mark_scene(RuleHyperGraph *const hypergraph,
+                        const Scene *const scene, const bool set) {
+  Vertex *vertex;
+  unsigned int i;
+  for (i = 0; i < scene->size; ++i) {
+    vertex = _vertex_index_find(hypergraph, scene->literals[i]);
+    if (vertex) {
+      if (set) {
+        _bitmap_set(hypergraph->inferred_only, vertex->id);
+      } else {
+        _bitmap_clear(hypergraph->inferred_only, vertex->id);
+      }
+    }
+  }
+}
+
+/**
+ * @brief Compares the addresses of two Vertices, to group the same Vertices
+ * together when sorted.
+ */
+static int _compare_vertex_pointers(const void *vertex1, const void *vertex2) {
+  const Vertex *v1 = *(const Vertex *const *)vertex1,
+               *v2 = *(const Vertex *const *)vertex2;
+  return (v1 > v2) - (v1 < v2);
+}
+
+/**
+ * @brief Makes sure that the columns found for each atom belong to the given
+ * header. The header is compared by its contents (not its address), as a
+ * different header may be allocated at the same address. If it differs from
+ * the previous one, the columns found so far are discarded and a copy of the
+ * header is kept.
+ */
+static void _atom_columns_header(RuleHyperGraph *const hypergraph,
+                                 char **header, const size_t header_size) {
+  size_t i;
+  if (hypergraph->columns_header_size == header_size) {
+    for (i = 0; (i < header_size) &&
+                (strcmp(hypergraph->columns_header[i], header[i]) == 0);
+         ++i)
+      ;
+    if (i == header_size) {
+      return;
+    }
+  }
+
+  for (i = 0; i < hypergraph->atom_columns_capacity; ++i) {
+    safe_free(hypergraph->atom_columns[i].columns);
+    hypergraph->atom_columns[i].size = 0;
+    hypergraph->atom_columns[i].resolved = false;
+  }
+  for (i = 0; i < hypergraph->columns_header_size; ++i) {
+    free(hypergraph->columns_header[i]);
+  }
+  safe_free(hypergraph->columns_header);
+  if (header_size > 0) {
+    hypergraph->columns_header = (char **)malloc(header_size * sizeof(char *));
+  }
+  for (i = 0; i < header_size; ++i) {
+    hypergraph->columns_header[i] = strdup(header[i]);
+  }
+  hypergraph->columns_header_size = header_size;
+}
+
+/**
+ * @brief Gives the header columns whose name is found in the atom of the given
+ * Literal. They are found once per atom, for the header given to
+ * _atom_columns_header.
+ */
+static const AtomColumns *_atom_columns(RuleHyperGraph *const hypergraph,
+                                        const Literal *const literal) {
+  size_t i;
+  if (literal->id >= hypergraph->atom_columns_capacity) {
+    size_t capacity = literal_total_atoms();
+    if (capacity <= literal->id) {
+      capacity = literal->id + 1;
+    }
+    hypergraph->atom_columns = (AtomColumns *)realloc(
+        hypergraph->atom_columns, capacity * sizeof(AtomColumns));
+    memset(hypergraph->atom_columns + hypergraph->atom_columns_capacity, 0,
+           (capacity - hypergraph->atom_columns_capacity) *
+               sizeof(AtomColumns));
+    hypergraph->atom_columns_capacity = capacity;
+  }
+
+  AtomColumns *const atom_columns = hypergraph->atom_columns + literal->id;
+  if (!atom_columns->resolved) {
+    for (i = 0; i < hypergraph->columns_header_size; ++i) {
+      if (strstr(literal->atom, hypergraph->columns_header[i])) {
+        atom_columns->columns = (unsigned int *)realloc(
+            atom_columns->columns,
+            (atom_columns->size + 1) * sizeof(unsigned int));
+        atom_columns->columns[atom_columns->size++] = i;
+      }
+    }
+    atom_columns->resolved = true;
+  }
+  return atom_columns;
+}
+
+/**
+ * @brief Compares two LiteralColumns by their column, and then by their
+ * Literal.
+ */
+static int _compare_literal_columns(const void *a, const void *b) {
+  const LiteralColumn *const first = (const LiteralColumn *)a,
+                             *const second = (const LiteralColumn *)b;
+  if (first->column != second->column) {
+    return (first->column < second->column) ? -1 : 1;
   }
+  return (first->i > second->i) - (first->i < second->i);
 }
 
 /**
@@ -431,7 +1022,10 @@ void rule_hypergraph_get_inactive_rules(
  * chaining demotion should be increasing or not. It only works if and only if
  * backward chaining demotion is enabled.
  * @param header (Optional) A char ** containing the header of a file to compare
- * attributes. The rest two optional parameters should be given together.
+ * attributes. The rest two optional parameters should be given together. An
+ * observed Literal belongs to each column whose name is found in its atom. The
+ * columns of each atom are only searched the first time, as long as the same
+ * header (char **) is given.
  * @param header_size (Optional) The size_t of the header.
  * @param incompatibilities (Optional) A Scene ** containing the incompatible
  * literals corresponding to each header. It should have the same size, even if
@@ -449,53 +1043,103 @@ void rule_hypergraph_update_rules(
         ((!header) && (header_size == 0) && (!incompatibilities))))
     return;
 
+  knowledge_base_mark_changed(knowledge_base);
+
   unsigned int i, j, k;
-  Vertex *vertex_to_find, *current_vertex;
-  Scene *observed_and_inferred, *observed_diff_inferred,
-      *opposing_literals = scene_constructor(true);
+  Vertex *current_vertex;
+  RuleHyperGraph *const hypergraph = knowledge_base->hypergraph;
+  Scene *const observed_and_inferred = hypergraph->observed_and_inferred;
+  Scene *const observed_diff_inferred = hypergraph->observed_diff_inferred;
+  Scene *const opposing_literals = hypergraph->opposing_literals;
   Rule *current_rule;
 
-  scene_union(observation, inference, &observed_and_inferred);
-  scene_difference(observation, inference, &observed_diff_inferred);
-  for (i = 0; i < header_size; ++i) {
-    for (j = 0; j < observed_diff_inferred->size; ++j) {
-      if (strstr(observed_diff_inferred->literals[j]->atom, header[i]))
-        for (k = 0; k < incompatibilities[i]->size; ++k) {
-          Literal *current_literal = incompatibilities[i]->literals[k], *copy;
-
-          if (literal_equals(current_literal,
-                             observed_diff_inferred->literals[j]) == 0) {
-            literal_copy(&copy, current_literal);
-            scene_add_literal(opposing_literals, &copy);
-          }
-        }
+  scene_clear(observed_diff_inferred);
+  for (i = 0; i < observation->size; ++i) {
+    if (scene_literal_index(inference, observation->literals[i]) == -1) {
+      scene_add_literal(observed_diff_inferred, &(observation->literals[i]));
+    }
+  }
+  // The incompatible Literals of the columns of each observed (but not
+  // inferred) Literal oppose it. They are gathered column by column.
+  size_t number_of_literal_columns = 0;
+  const AtomColumns *atom_columns;
+  _atom_columns_header(knowledge_base->hypergraph, header, header_size);
+  for (j = 0; j < observed_diff_inferred->size; ++j) {
+    atom_columns = _atom_columns(knowledge_base->hypergraph,
+                                 observed_diff_inferred->literals[j]);
+    if (number_of_literal_columns + atom_columns->size >
+        knowledge_base->hypergraph->literal_columns_capacity) {
+      knowledge_base->hypergraph->literal_columns_capacity =
+          (number_of_literal_columns + atom_columns->size) << 1;
+      knowledge_base->hypergraph->literal_columns = (LiteralColumn *)realloc(
+          knowledge_base->hypergraph->literal_columns,
+          knowledge_base->hypergraph->literal_columns_capacity *
+              sizeof(LiteralColumn));
+    }
+    for (k = 0; k < atom_columns->size; ++k) {
+      knowledge_base->hypergraph->literal_columns[number_of_literal_columns++] =
+          (LiteralColumn){.column = atom_columns->columns[k], .i = j};
     }
   }
+  LiteralColumn *const literal_columns =
+      knowledge_base->hypergraph->literal_columns;
+  if (number_of_literal_columns > 1) {
+    qsort(literal_columns, number_of_literal_columns, sizeof(LiteralColumn),
+          _compare_literal_columns);
+  }
+
+  scene_clear(opposing_literals);
+  for (i = 0; i < number_of_literal_columns; ++i) {
+    const Scene *const incompatible =
+        incompatibilities[literal_columns[i].column];
+    for (k = 0; k < incompatible->size; ++k) {
+      if (literal_equals(
+              incompatible->literals[k],
+              observed_diff_inferred->literals[literal_columns[i].i]) == 0) {
+        scene_add_literal(opposing_literals, &(incompatible->literals[k]));
+      }
+    }
+  }
+  Literal *negation;
   for (i = 0; i < observed_diff_inferred->size; ++i) {
-    Literal *copy;
-    literal_copy(&copy, observed_diff_inferred->literals[i]);
-    literal_negate(copy);
-    scene_add_literal(opposing_literals, &copy);
+    literal_copy(&negation, observed_diff_inferred->literals[i]);
+    literal_negate(&negation);
+    scene_add_literal(opposing_literals, &negation);
+  }
+
+  // (observation ∪ inference) ∖ opposing_literals, in the same order.
+  scene_clear(observed_and_inferred);
+  for (i = 0; i < observation->size; ++i) {
+    if (scene_literal_index(opposing_literals, observation->literals[i]) ==
+        -1) {
+      scene_add_literal(observed_and_inferred, &(observation->literals[i]));
+    }
+  }
+  for (i = 0; i < inference->size; ++i) {
+    if (scene_literal_index(opposing_literals, inference->literals[i]) == -1) {
+      scene_add_literal(observed_and_inferred, &(inference->literals[i]));
+    }
+  }
+  _mark_applicable_edges(knowledge_base->hypergraph, observed_and_inferred);
+  if (knowledge_base->hypergraph->use_backward_chaining) {
+    _reserve_scratch(knowledge_base->hypergraph);
+    _mark_scene(knowledge_base->hypergraph, inference, true);
+    _mark_scene(knowledge_base->hypergraph, observation, false);
   }
-  Scene *temp = observed_and_inferred;
-  scene_difference(temp, opposing_literals, &observed_and_inferred);
-  scene_destructor(&temp);
-  scene_destructor(&observed_diff_inferred);
 
   // Finds all the Rules that concur by finding the observed Literal in the
-  // RB-tree.
+  // Vertex index.
   for (i = 0; i < observation->size; ++i) {
-    vertex_to_find = vertex_constructor(observation->literals[i]);
-    current_vertex =
-        prb_find(knowledge_base->hypergraph->literal_tree, vertex_to_find);
-    vertex_destructor(&vertex_to_find, false);
+    current_vertex = _vertex_index_find(knowledge_base->hypergraph,
+                                        observation->literals[i]);
 
     if (current_vertex && (current_vertex->number_of_edges != 0)) {
       for (j = 0; j < current_vertex->number_of_edges; ++j) {
         current_rule = current_vertex->edges[j]->rule;
         // Checks if the Rule is applicable given the union of observed and
         // inferred Literals.
-        if (rule_applicable(current_rule, observed_and_inferred)) {
+        if (_edge_applicable(knowledge_base->hypergraph,
+                             current_vertex->edges[j])) {
           bool is_inactive =
               current_rule->weight < knowledge_base->activation_threshold;
           current_rule->weight += promotion_rate;
@@ -508,12 +1152,11 @@ void rule_hypergraph_update_rules(
     }
   }
 
-  prb_table *vertices_to_check = prb_create(compare_literals, NULL, NULL);
+  Vertex **vertices_to_check = hypergraph->vertices_to_check;
+  size_t number_of_vertices_to_check = 0;
   for (i = 0; i < opposing_literals->size; ++i) {
-    vertex_to_find = vertex_constructor(opposing_literals->literals[i]);
-    current_vertex =
-        prb_find(knowledge_base->hypergraph->literal_tree, vertex_to_find);
-    vertex_destructor(&vertex_to_find, false);
+    current_vertex = _vertex_index_find(knowledge_base->hypergraph,
+                                        opposing_literals->literals[i]);
 
     if (current_vertex && (current_vertex->number_of_edges != 0)) {
       if (!knowledge_base->hypergraph->use_backward_chaining) {
@@ -521,76 +1164,78 @@ void rule_hypergraph_update_rules(
           current_rule = current_vertex->edges[j]->rule;
           // Checks if the Rule is applicable given the inferred and observed
           // Literals.
-          if (rule_applicable(current_rule, observed_and_inferred))
+          if (_edge_applicable(knowledge_base->hypergraph,
+                               current_vertex->edges[j]))
             current_rule->weight -= demotion_rate;
         }
-        prb_insert(vertices_to_check, current_vertex);
+        vertices_to_check = _reserve_vertices_to_check(
+            hypergraph, number_of_vertices_to_check + 1);
+        vertices_to_check[number_of_vertices_to_check++] = current_vertex;
         goto finished;
       }
 
-      Queue *_depths, *_parent_vertex, *_vertices_to_check;
-      queue_constructor(&_depths, sizeof(int), NULL);
-      queue_constructor(&_parent_vertex, sizeof(Vertex *), NULL);
-      queue_constructor(&_vertices_to_check, sizeof(Vertex *), NULL);
-      queue_push_back(_depths, (void *)1);
-      queue_push_back(_parent_vertex, NULL);
-      queue_push_back(_vertices_to_check, (void *)current_vertex);
-      QueueElement *current_vertices_element = _vertices_to_check->front,
-                   *current_depths_element = _depths->front,
-                   *current_parent_vertex_element = _parent_vertex->front;
-
-      do {
-        current_vertex = (Vertex *)current_vertices_element->data;
+      // Breadth-first traversal from the opposing Vertex, towards the bodies
+      // of the demoted active Rules. Each Vertex is visited at most once (at
+      // its shortest depth), so cycles cannot make the traversal grow.
+      _reserve_scratch(hypergraph);
+      TraversalEntry *const traversal = hypergraph->traversal;
+      size_t front = 0, back = 0;
+      traversal[back].vertex = current_vertex;
+      traversal[back++].depth = 1;
+      _bitmap_set(hypergraph->visited, current_vertex->id);
+
+      while (front < back) {
+        current_vertex = traversal[front].vertex;
+        const unsigned int depth = traversal[front++].depth;
         for (j = 0; j < current_vertex->number_of_edges; ++j) {
           current_rule = current_vertex->edges[j]->rule;
-          if (rule_applicable(current_rule, observed_and_inferred)) {
+          if (_edge_applicable(hypergraph, current_vertex->edges[j])) {
             current_rule->weight -=
                 demotion_rate *
-                (increasing_demotion
-                     ? (int)(long)current_depths_element->data
-                     : 1.0 / (int)(long)current_depths_element->data);
+                (increasing_demotion ? (int)depth : 1.0 / (int)depth);
 
             if (rule_queue_find(knowledge_base->active, current_rule) > -1) {
               Vertex *potential_vertex;
               for (k = 0; k < current_vertex->edges[j]->number_of_vertices;
                    ++k) {
                 potential_vertex = current_vertex->edges[j]->from[k];
-                if ((scene_literal_index(inference,
-                                         potential_vertex->literal) >= 0) &&
-                    (scene_literal_index(observation,
-                                         potential_vertex->literal) == -1) &&
-                    (potential_vertex !=
-                     (Vertex *)current_parent_vertex_element->data)) {
-                  queue_push_back(_depths,
-                                  (void *)((long)current_depths_element->data) +
-                                      1);
-                  queue_push_back(_vertices_to_check, (void *)potential_vertex);
-                  queue_push_back(_parent_vertex, (void *)current_vertex);
+                if (_bitmap_test(hypergraph->inferred_only,
+                                 potential_vertex->id) &&
+                    !_bitmap_test(hypergraph->visited, potential_vertex->id)) {
+                  _bitmap_set(hypergraph->visited, potential_vertex->id);
+                  traversal[back].vertex = potential_vertex;
+                  traversal[back++].depth = depth + 1;
                 }
               }
             }
           }
         }
-      } while ((current_vertices_element = current_vertices_element->next) &&
-               (current_depths_element = current_depths_element->next) &&
-               (current_parent_vertex_element =
-                    current_parent_vertex_element->next));
-
-      queue_destructor(&_depths);
-      queue_destructor(&_parent_vertex);
-
-      current_vertices_element = _vertices_to_check->front;
-      do {
-        prb_insert(vertices_to_check, current_vertices_element->data);
-      } while ((current_vertices_element = current_vertices_element->next));
-      queue_destructor(&_vertices_to_check);
+      }
+
+      vertices_to_check = _reserve_vertices_to_check(
+          hypergraph, number_of_vertices_to_check + back);
+      for (front = 0; front < back; ++front) {
+        _bitmap_clear(hypergraph->visited, traversal[front].vertex->id);
+        vertices_to_check[number_of_vertices_to_check++] =
+            traversal[front].vertex;
+      }
     }
   finished:
   }
 
-  struct prb_traverser vertex_traverser;
-  current_vertex = prb_t_first(&vertex_traverser, vertices_to_check);
-  while (current_vertex) {
+  // The same Vertex might have been reached more than once, so each distinct
+  // Vertex is only checked once.
+  if (number_of_vertices_to_check > 1) {
+    qsort(vertices_to_check, number_of_vertices_to_check, sizeof(Vertex *),
+          _compare_vertex_pointers);
+  }
+  size_t v;
+  for (v = 0; v < number_of_vertices_to_check; ++v) {
+    current_vertex = vertices_to_check[v];
+    if ((v > 0) && (current_vertex == vertices_to_check[v - 1])) {
+      continue;
+    }
+
     for (j = 0; j < current_vertex->number_of_edges; ++j) {
       current_rule = current_vertex->edges[j]->rule;
 
@@ -600,16 +1245,16 @@ void rule_hypergraph_update_rules(
             rule_queue_find(knowledge_base->active, current_rule), NULL);
 
       if (current_rule->weight <= 0) {
+        _fingerprint_set_remove(knowledge_base->hypergraph,
+                                current_rule->fingerprint);
         vertex_remove_edge(current_vertex, j);
         --j;
       }
     }
-    current_vertex = prb_t_next(&vertex_traverser);
   }
-  prb_destroy(vertices_to_check, NULL);
-
-  scene_destructor(&observed_and_inferred);
-  scene_destructor(&opposing_literals);
+  if (knowledge_base->hypergraph->use_backward_chaining) {
+    _mark_scene(knowledge_base->hypergraph, inference, false);
+  }
 }
 
 #if (RULE_HYPERGRAPH_TEST_FUNCTIONS == 1) || (RULE_HYPERGRAPH_TEST == 1)
@@ -633,7 +1278,7 @@ void rule_hypergraph_update_rules(
     ck_assert_ptr_nonnull(_v1);                                                \
     ck_assert_ptr_nonnull(_v2);                                                \
     ck_assert_ptr_ne(_v1, _v2);                                                \
-    ck_assert_ptr_ne(_v1->literal, _v2->literal);                              \
+    ck_assert_ptr_eq(_v1->literal, _v2->literal);                              \
     ck_assert_literal_eq(_v1->literal, _v2->literal);                          \
     ck_assert_int_eq(_v1->number_of_edges, _v2->number_of_edges);              \
     if (_v1->number_of_edges > 0) {                                            \
@@ -661,12 +1306,12 @@ void rule_hypergraph_update_rules(
     ck_assert_ptr_ne(_e1, _e2);                                                \
     ck_assert_ptr_ne(_e1->rule, _e2->rule);                                    \
     ck_assert_rule_eq(_e1->rule, _e2->rule);                                   \
-    ck_assert_ptr_ne(_e1->rule->head, _e2->rule->head);                        \
-    ck_assert_ptr_ne(_e1->rule->body, _e2->rule->body);                        \
+    ck_assert_ptr_eq(_e1->rule->head, _e2->rule->head);                        \
+    ck_assert_ptr_ne(_e1->rule->body.literals, _e2->rule->body.literals);      \
     unsigned int i;                                                            \
-    for (i = 0; i < _e1->rule->body->size; ++i) {                              \
-      ck_assert_ptr_ne(_e1->rule->body->literals[i],                           \
-                       _e2->rule->body->literals[i]);                          \
+    for (i = 0; i < _e1->rule->body.size; ++i) {                              \
+      ck_assert_ptr_eq(_e1->rule->body.literals[i],                           \
+                       _e2->rule->body.literals[i]);                          \
     }                                                                          \
     ck_assert_int_eq(_e1->number_of_vertices, _e2->number_of_vertices);        \
     ck_assert_ptr_ne(_e1->from, _e2->from);                                    \
@@ -683,34 +1328,30 @@ void rule_hypergraph_update_rules(
     ck_assert_ptr_nonnull(_h1);                                                \
     ck_assert_ptr_nonnull(_h2);                                                \
     ck_assert_ptr_ne(_h1, _h2);                                                \
-    ck_assert_ptr_nonnull(_h1->literal_tree);                                  \
-    ck_assert_ptr_nonnull(_h2->literal_tree);                                  \
-    ck_assert_ptr_ne(_h1->literal_tree, _h2->literal_tree);                    \
-    struct prb_traverser _h1_traverser, _h2_traverser;                         \
-    ck_assert_int_eq(_h1->literal_tree->prb_count,                             \
-                     _h2->literal_tree->prb_count);                            \
-    Vertex *_h1_current_vertex =                                               \
-               (Vertex *)prb_t_first(&_h1_traverser, _h1->literal_tree),       \
-           *_h2_current_vertex =                                               \
-               (Vertex *)prb_t_first(&_h2_traverser, _h2->literal_tree);       \
-    unsigned int i;                                                            \
-    while (_h1_current_vertex) {                                               \
-      ck_assert_vertex_eq(_h1_current_vertex, _h2_current_vertex);             \
-      for (i = 0; i < _h1_current_vertex->number_of_edges; ++i) {              \
-        ck_assert_edge_eq(_h1_current_vertex->edges[i],                        \
-                          _h2_current_vertex->edges[i]);                       \
+    ck_assert_ptr_nonnull(_h1->vertices);                                      \
+    ck_assert_ptr_nonnull(_h2->vertices);                                      \
+    ck_assert_ptr_ne(_h1->vertices, _h2->vertices);                            \
+    ck_assert_int_eq(_h1->number_of_vertices, _h2->number_of_vertices);        \
+    Vertex **_h1_vertices = _vertex_index_ordered(_h1),                        \
+           **_h2_vertices = _vertex_index_ordered(_h2);                        \
+    unsigned int i, j;                                                         \
+    for (j = 0; j < _h1->number_of_vertices; ++j) {                            \
+      ck_assert_vertex_eq(_h1_vertices[j], _h2_vertices[j]);                   \
+      for (i = 0; i < _h1_vertices[j]->number_of_edges; ++i) {                 \
+        ck_assert_edge_eq(_h1_vertices[j]->edges[i],                           \
+                          _h2_vertices[j]->edges[i]);                          \
       }                                                                        \
-      _h1_current_vertex = (Vertex *)prb_t_next(&_h1_traverser);               \
-      _h2_current_vertex = (Vertex *)prb_t_next(&_h2_traverser);               \
     }                                                                          \
+    free(_h1_vertices);                                                        \
+    free(_h2_vertices);                                                        \
   } while (0)
 
 #define _ck_assert_rule_hypergraph_empty(X, OP)                                \
   do {                                                                         \
     const RuleHyperGraph *const _h = (X);                                      \
     ck_assert_ptr_nonnull(_h);                                                 \
-    ck_assert_ptr_nonnull(_h->literal_tree);                                   \
-    _ck_assert_int(_h->literal_tree->prb_count, OP, 0);                        \
+    ck_assert_ptr_nonnull(_h->vertices);                                       \
+    _ck_assert_int(_h->number_of_vertices, OP, 0);                             \
   } while (0)
 
 #endif
@@ -725,10 +1366,9 @@ START_TEST(construct_destruct_hypergraph_test) {
   RuleHyperGraph *hypergraph = rule_hypergraph_empty_constructor(true);
 
   ck_assert_ptr_nonnull(hypergraph);
-  ck_assert_int_eq(hypergraph->literal_tree->prb_count, 0);
-  ck_assert_ptr_null(hypergraph->literal_tree->prb_param);
-  ck_assert_ptr_null(hypergraph->literal_tree->prb_root);
-  ck_assert_ptr_eq(hypergraph->literal_tree->prb_compare, compare_literals);
+  ck_assert_ptr_nonnull(hypergraph->vertices);
+  ck_assert_int_eq(hypergraph->number_of_vertices, 0);
+  ck_assert_int_eq(hypergraph->capacity, VERTEX_INDEX_INITIAL_CAPACITY);
   ck_assert_rule_hypergraph_empty(hypergraph);
 
   rule_hypergraph_destructor(&hypergraph);
@@ -783,15 +1423,15 @@ START_TEST(construct_destruct_edge_test) {
        *r3 = rule_constructor(1, &c2, &c1, 0, false);
   RuleHyperGraph *hypergraph = rule_hypergraph_empty_constructor(true);
 
-  prb_insert(hypergraph->literal_tree, v1);
-  prb_insert(hypergraph->literal_tree, v2);
-  prb_insert(hypergraph->literal_tree, v3);
+  _vertex_index_insert(hypergraph, v1);
+  _vertex_index_insert(hypergraph, v2);
+  _vertex_index_insert(hypergraph, v3);
 
   Edge *edge1 = edge_constructor(hypergraph, &r1, v2);
   ck_assert_ptr_nonnull(r1);
   ck_assert_ptr_eq(edge1->rule, r1);
   ck_assert_ptr_eq(edge1->rule->head, v2->literal);
-  ck_assert_ptr_eq(edge1->rule->body->literals[0], v1->literal);
+  ck_assert_ptr_eq(edge1->rule->body.literals[0], v1->literal);
   ck_assert_ptr_nonnull(edge1->from);
   ck_assert_int_eq(edge1->number_of_vertices, 1);
   ck_assert_ptr_eq(edge1->from[0], v1);
@@ -800,8 +1440,8 @@ START_TEST(construct_destruct_edge_test) {
   ck_assert_ptr_nonnull(r2);
   ck_assert_ptr_eq(edge2->rule, r2);
   ck_assert_ptr_eq(edge2->rule->head, v2->literal);
-  ck_assert_ptr_eq(edge2->rule->body->literals[0], v1->literal);
-  ck_assert_ptr_eq(edge2->rule->body->literals[1], v3->literal);
+  ck_assert_ptr_eq(edge2->rule->body.literals[0], v1->literal);
+  ck_assert_ptr_eq(edge2->rule->body.literals[1], v3->literal);
   ck_assert_ptr_nonnull(edge2->from);
   ck_assert_int_eq(edge2->number_of_vertices, 2);
   unsigned int i;
@@ -810,27 +1450,27 @@ START_TEST(construct_destruct_edge_test) {
   }
 
   ck_assert_ptr_ne(r3->head, v2->literal);
-  ck_assert_ptr_ne(r3->body->literals[0], v1->literal);
+  ck_assert_ptr_ne(r3->body.literals[0], v1->literal);
   Edge *edge3 = edge_constructor(hypergraph, &r3, v1);
   ck_assert_ptr_nonnull(r3);
   ck_assert_ptr_eq(edge3->rule, r3);
   ck_assert_ptr_eq(edge3->rule->head, v1->literal);
-  ck_assert_ptr_eq(edge3->rule->body->literals[0], v2->literal);
+  ck_assert_ptr_eq(edge3->rule->body.literals[0], v2->literal);
   ck_assert_ptr_nonnull(edge3->from);
   ck_assert_int_eq(edge3->number_of_vertices, 1);
   ck_assert_ptr_eq(edge3->from[0], v2);
 
   Rule *r4 = rule_constructor(1, &c3, &c2, 0.0, true), *r4_ptr = r4;
-  ck_assert_ptr_ne(r4->head, v2->literal);
-  ck_assert_ptr_ne(r4->body->literals[0], v3->literal);
+  ck_assert_ptr_eq(r4->head, v2->literal);
+  ck_assert_ptr_eq(r4->body.literals[0], v3->literal);
   ck_assert_ptr_eq(r4->head, r4_ptr->head);
-  ck_assert_ptr_eq(r4->body->literals[0], r4_ptr->body->literals[0]);
+  ck_assert_ptr_eq(r4->body.literals[0], r4_ptr->body.literals[0]);
   Edge *edge4 = edge_constructor(hypergraph, &r4, v2);
   ck_assert_ptr_nonnull(r4);
   ck_assert_ptr_eq(edge4->rule, r4);
   ck_assert_ptr_ne(r4, r4_ptr);
   ck_assert_ptr_eq(edge4->rule->head, v2->literal);
-  ck_assert_ptr_eq(edge4->rule->body->literals[0], v3->literal);
+  ck_assert_ptr_eq(edge4->rule->body.literals[0], v3->literal);
   ck_assert_ptr_nonnull(edge4->from);
   ck_assert_int_eq(edge4->number_of_vertices, 1);
   ck_assert_ptr_eq(edge4->from[0], v3);
@@ -856,8 +1496,8 @@ START_TEST(adding_edges_test) {
        *r2 = rule_constructor(1, &l1, &l3, 0, false),
        *r3 = rule_constructor(2, l_array, &l2, 0, false);
 
-  prb_insert(hypergraph->literal_tree, v2);
-  prb_insert(hypergraph->literal_tree, v3);
+  _vertex_index_insert(hypergraph, v2);
+  _vertex_index_insert(hypergraph, v3);
 
   Edge *e1 = edge_constructor(hypergraph, &r1, v2),
        *e2 = edge_constructor(hypergraph, &r2, v3);
@@ -896,6 +1536,21 @@ START_TEST(adding_edges_test) {
   ck_assert_literal_eq(v2->edges[1]->from[0]->literal, l1);
   ck_assert_literal_eq(v2->edges[1]->from[1]->literal, l3);
 
+  Vertex *v1 = v2->edges[0]->from[0];
+  ck_assert_int_eq(v1->number_of_body_edges, 3);
+  ck_assert_ptr_eq(v1->body_edges[0], v2->edges[0]);
+  ck_assert_ptr_eq(v1->body_edges[1], v3->edges[0]);
+  ck_assert_ptr_eq(v1->body_edges[2], v2->edges[1]);
+  ck_assert_int_eq(v3->number_of_body_edges, 1);
+  ck_assert_ptr_eq(v3->body_edges[0], v2->edges[1]);
+  ck_assert_int_eq(v2->number_of_body_edges, 0);
+
+  vertex_remove_edge(v2, 0);
+  ck_assert_int_eq(v1->number_of_body_edges, 2);
+  ck_assert_ptr_eq(v1->body_edges[0], v2->edges[0]);
+  ck_assert_ptr_eq(v1->body_edges[1], v3->edges[0]);
+  ck_assert_int_eq(v3->number_of_body_edges, 1);
+
   rule_hypergraph_destructor(&hypergraph);
 }
 END_TEST
@@ -927,7 +1582,7 @@ START_TEST(adding_rules_test) {
   ck_assert_int_eq(rule_hypergraph_add_rule(hypergraph, &r1), 1);
   ck_assert_rule_hypergraph_notempty(hypergraph);
   ck_assert_ptr_nonnull(r1);
-  current_v1 = prb_find(hypergraph->literal_tree, v2);
+  current_v1 = _vertex_index_find(hypergraph, v2->literal);
 
   ck_assert_int_eq(current_v1->number_of_edges, 1);
   ck_assert_literal_eq(current_v1->literal, l2);
@@ -956,7 +1611,7 @@ START_TEST(adding_rules_test) {
   ck_assert_ptr_nonnull(r4);
   ck_assert_int_eq(rule_hypergraph_add_rule(hypergraph, &r4), 1);
   ck_assert_ptr_nonnull(r4);
-  current_v1 = prb_find(hypergraph->literal_tree, v3);
+  current_v1 = _vertex_index_find(hypergraph, v3->literal);
   ck_assert_literal_eq(current_v1->literal, l3);
   ck_assert_int_eq(current_v1->number_of_edges, 1);
   ck_assert_ptr_eq(current_v1->edges[0]->rule, r4);
@@ -966,7 +1621,7 @@ START_TEST(adding_rules_test) {
   ck_assert_ptr_nonnull(r2);
   ck_assert_int_eq(rule_hypergraph_add_rule(hypergraph, &r2), 1);
   ck_assert_ptr_nonnull(r2);
-  current_v1 = prb_find(hypergraph->literal_tree, v4);
+  current_v1 = _vertex_index_find(hypergraph, v4->literal);
   ck_assert_literal_eq(current_v1->literal, l4);
   ck_assert_int_eq(current_v1->number_of_edges, 1);
   ck_assert_ptr_eq(current_v1->edges[0]->rule, r2);
@@ -976,7 +1631,7 @@ START_TEST(adding_rules_test) {
   ck_assert_ptr_nonnull(r5);
   ck_assert_int_eq(rule_hypergraph_add_rule(hypergraph, &r5), 1);
   ck_assert_ptr_nonnull(r5);
-  current_v1 = prb_find(hypergraph->literal_tree, v1);
+  current_v1 = _vertex_index_find(hypergraph, v1->literal);
   ck_assert_literal_eq(current_v1->literal, l1);
   ck_assert_int_eq(current_v1->number_of_edges, 2);
 
@@ -1003,7 +1658,7 @@ START_TEST(adding_rules_test) {
   ck_assert_ptr_nonnull(r6);
   ck_assert_int_eq(rule_hypergraph_add_rule(hypergraph, &r6), 1);
   ck_assert_ptr_nonnull(r6);
-  current_v1 = prb_find(hypergraph->literal_tree, v2);
+  current_v1 = _vertex_index_find(hypergraph, v2->literal);
   ck_assert_literal_eq(current_v1->literal, l2);
   ck_assert_int_eq(current_v1->number_of_edges, 2);
 
@@ -1037,7 +1692,7 @@ START_TEST(adding_rules_test) {
   rule_hypergraph_add_rule(hypergraph, &r7);
   ck_assert_ptr_nonnull(r7);
   ck_assert_ptr_ne(r7, r7_ptr);
-  current_v1 = prb_find(hypergraph->literal_tree, v1);
+  current_v1 = _vertex_index_find(hypergraph, v1->literal);
   ck_assert_int_eq(current_v1->number_of_edges, 3);
   ck_assert_ptr_eq(current_v1->edges[2]->rule, r7);
   ck_assert_ptr_ne(current_v1->edges[2]->rule, r7_ptr);
@@ -1061,7 +1716,7 @@ START_TEST(adding_rules_test) {
   rule_hypergraph_add_rule(hypergraph, &r8);
   ck_assert_ptr_nonnull(r8);
   ck_assert_ptr_ne(r8, r8_ptr);
-  current_v2 = prb_find(hypergraph->literal_tree, v6);
+  current_v2 = _vertex_index_find(hypergraph, v6->literal);
   ck_assert_int_eq(current_v2->number_of_edges, 1);
   ck_assert_ptr_eq(current_v2->edges[0]->rule, r8);
   ck_assert_ptr_ne(current_v2->edges[0]->rule, r8_ptr);
@@ -1114,7 +1769,7 @@ START_TEST(removing_rules_test) {
   rule_hypergraph_add_rule(hypergraph, &r5);
   rule_hypergraph_add_rule(hypergraph, &r6);
 
-  current_v1 = prb_find(hypergraph->literal_tree, v3);
+  current_v1 = _vertex_index_find(hypergraph, v3->literal);
   ck_assert_literal_eq(current_v1->literal, l3);
   ck_assert_int_eq(current_v1->number_of_edges, 1);
   ck_assert_ptr_eq(current_v1->edges[0]->rule, r4);
@@ -1128,7 +1783,7 @@ START_TEST(removing_rules_test) {
   rule_hypergraph_remove_rule(hypergraph, copy);
   rule_destructor(&copy);
 
-  current_v1 = prb_find(hypergraph->literal_tree, v4);
+  current_v1 = _vertex_index_find(hypergraph, v4->literal);
   ck_assert_int_eq(current_v1->number_of_edges, 3);
   ck_assert_ptr_eq(current_v1->edges[0]->rule, r2);
   ck_assert_ptr_eq(current_v1->edges[1]->rule, r3);
@@ -1143,7 +1798,7 @@ START_TEST(removing_rules_test) {
   ck_assert_int_eq(current_v1->number_of_edges, 1);
   ck_assert_ptr_eq(current_v1->edges[0]->rule, r5);
 
-  current_v2 = prb_find(hypergraph->literal_tree, v2);
+  current_v2 = _vertex_index_find(hypergraph, v2->literal);
   ck_assert_int_eq(current_v2->number_of_edges, 2);
   ck_assert_ptr_eq(current_v2->edges[0]->rule, r1);
   ck_assert_ptr_eq(current_v2->edges[1]->rule, r6);
@@ -1261,20 +1916,21 @@ START_TEST(hypergraph_copy_test) {
   kb2 = (KnowledgeBase *)malloc(sizeof(KnowledgeBase));
   kb2->activation_threshold = kb1->activation_threshold;
   kb2->active = rule_queue_constructor(false);
+  kb2->scratch = NULL;
   rule_hypergraph_copy(&kb2, kb1);
   ck_assert_ptr_nonnull(kb2->hypergraph);
   ck_assert_ptr_ne(kb1->hypergraph, kb2->hypergraph);
-  ck_assert_ptr_ne(kb1->hypergraph->literal_tree,
-                   kb2->hypergraph->literal_tree);
-
-  struct prb_traverser h1_traverser, h2_traverser;
+  ck_assert_ptr_ne(kb1->hypergraph->vertices, kb2->hypergraph->vertices);
 
-  Vertex *h1_vertex = prb_t_first(&h1_traverser, kb1->hypergraph->literal_tree),
-         *h2_vertex = prb_t_first(&h2_traverser, kb2->hypergraph->literal_tree);
+  Vertex **h1_vertices = _vertex_index_ordered(kb1->hypergraph),
+         **h2_vertices = _vertex_index_ordered(kb2->hypergraph), *h1_vertex,
+         *h2_vertex;
 
   unsigned int i;
-  size_t total_vertices = 0, total_edges = 0;
-  while (h1_vertex && h2_vertex) {
+  size_t v, total_vertices = 0, total_edges = 0;
+  for (v = 0; v < kb1->hypergraph->number_of_vertices; ++v) {
+    h1_vertex = h1_vertices[v];
+    h2_vertex = h2_vertices[v];
     ++total_vertices;
     ck_assert_vertex_eq(h1_vertex, h2_vertex);
 
@@ -1282,24 +1938,23 @@ START_TEST(hypergraph_copy_test) {
     for (i = 0; i < h1_vertex->number_of_edges; ++i) {
       ck_assert_edge_eq(h1_vertex->edges[i], h2_vertex->edges[i]);
     }
-
-    h1_vertex = prb_t_next(&h1_traverser);
-    h2_vertex = prb_t_next(&h2_traverser);
   }
+  free(h1_vertices);
+  free(h2_vertices);
   ck_assert_rule_hypergraph_eq(kb1->hypergraph, kb2->hypergraph);
 
   knowledge_base_destructor(&kb1);
   ck_assert_ptr_null(kb1);
   ck_assert_ptr_nonnull(kb2);
 
-  h2_vertex = prb_t_first(&h2_traverser, kb2->hypergraph->literal_tree);
   size_t copy_total_vertices = 0, copy_total_edges = 0;
-  while (h2_vertex) {
-    ++copy_total_vertices;
-
-    copy_total_edges += h2_vertex->number_of_edges;
+  for (v = 0; v < kb2->hypergraph->capacity; ++v) {
+    h2_vertex = kb2->hypergraph->vertices[v];
+    if (h2_vertex) {
+      ++copy_total_vertices;
 
-    h2_vertex = prb_t_next(&h2_traverser);
+      copy_total_edges += h2_vertex->number_of_edges;
+    }
   }
 
   ck_assert_int_eq(total_vertices, copy_total_vertices);
@@ -1657,10 +2312,10 @@ START_TEST(update_rules_test) {
   rule_hypergraph_update_rules(knowledge_base, observation, inference, 0.5, 1,
                                false, NULL, 0, NULL);
   ck_assert_float_eq_tol(bird_fly->weight, 4, 0.000001);
-  ck_assert_float_eq_tol(penguin_bird->weight, 4, 0.000001);
+  ck_assert_float_eq_tol(penguin_bird->weight, 4.5, 0.000001);
   ck_assert_float_eq_tol(feathers_bird->weight, 5, 0.000001);
-  ck_assert_float_eq_tol(wings_bird->weight, 4, 0.000001);
-  ck_assert_float_eq_tol(penguin_wings->weight, 4.333333, 0.000001);
+  ck_assert_float_eq_tol(wings_bird->weight, 4.5, 0.000001);
+  ck_assert_float_eq_tol(penguin_wings->weight, 4.666667, 0.000001);
   ck_assert_float_eq_tol(antarctica_bird_fly->weight, 4, 0.000001);
   ck_assert_float_eq_tol(penguin_antarctica->weight, 4.5, 0.000001);
 
@@ -1669,10 +2324,10 @@ START_TEST(update_rules_test) {
   rule_hypergraph_update_rules(knowledge_base, observation, inference, 0.5, 1,
                                false, NULL, 0, NULL);
   ck_assert_float_eq_tol(bird_fly->weight, 4, 0.000001);
-  ck_assert_float_eq_tol(penguin_bird->weight, 4, 0.000001);
+  ck_assert_float_eq_tol(penguin_bird->weight, 4.5, 0.000001);
   ck_assert_float_eq_tol(feathers_bird->weight, 5, 0.000001);
-  ck_assert_float_eq_tol(wings_bird->weight, 4, 0.000001);
-  ck_assert_float_eq_tol(penguin_wings->weight, 4.333333, 0.000001);
+  ck_assert_float_eq_tol(wings_bird->weight, 4.5, 0.000001);
+  ck_assert_float_eq_tol(penguin_wings->weight, 4.666667, 0.000001);
   ck_assert_float_eq_tol(antarctica_bird_fly->weight, 4, 0.000001);
   ck_assert_float_eq_tol(penguin_antarctica->weight, 5.5, 0.000001);
 
@@ -1685,10 +2340,10 @@ START_TEST(update_rules_test) {
   rule_hypergraph_update_rules(knowledge_base, observation, inference, 0.5, 1,
                                false, NULL, 0, NULL);
   ck_assert_float_eq_tol(bird_fly->weight, 4, 0.000001);
-  ck_assert_float_eq_tol(penguin_bird->weight, 4, 0.000001);
+  ck_assert_float_eq_tol(penguin_bird->weight, 4.5, 0.000001);
   ck_assert_float_eq_tol(feathers_bird->weight, 5, 0.000001);
-  ck_assert_float_eq_tol(wings_bird->weight, 4, 0.000001);
-  ck_assert_float_eq_tol(penguin_wings->weight, 4.333333, 0.000001);
+  ck_assert_float_eq_tol(wings_bird->weight, 4.5, 0.000001);
+  ck_assert_float_eq_tol(penguin_wings->weight, 4.666667, 0.000001);
   ck_assert_float_eq_tol(antarctica_bird_fly->weight, 4, 0.000001);
   ck_assert_float_eq_tol(antarctica_penguin->weight, 5.5, 0.000001);
   ck_assert_float_eq_tol(penguin_antarctica->weight, 4.5, 0.000001);
@@ -1713,10 +2368,10 @@ START_TEST(update_rules_test) {
   rule_hypergraph_update_rules(knowledge_base, observation, inference, 0.5, 1,
                                false, NULL, 0, NULL);
   ck_assert_float_eq_tol(bird_fly->weight, 4, 0.000001);
-  ck_assert_float_eq_tol(penguin_bird->weight, 4, 0.000001);
-  ck_assert_float_eq_tol(feathers_bird->weight, 4, 0.000001);
-  ck_assert_float_eq_tol(wings_bird->weight, 4, 0.000001);
-  ck_assert_float_eq_tol(penguin_wings->weight, 4.333333, 0.000001);
+  ck_assert_float_eq_tol(penguin_bird->weight, 4.5, 0.000001);
+  ck_assert_float_eq_tol(feathers_bird->weight, 4.5, 0.000001);
+  ck_assert_float_eq_tol(wings_bird->weight, 4.5, 0.000001);
+  ck_assert_float_eq_tol(penguin_wings->weight, 4.666667, 0.000001);
   ck_assert_float_eq_tol(antarctica_bird_fly->weight, 4, 0.000001);
   ck_assert_float_eq_tol(antarctica_penguin->weight, 5.5, 0.000001);
   ck_assert_float_eq_tol(penguin_antarctica->weight, 4.5, 0.000001);
@@ -1783,17 +2438,17 @@ START_TEST(update_rules_test) {
   rule_hypergraph_update_rules(knowledge_base, observation, inference, 0.5, 1,
                                false, NULL, 0, NULL);
   ck_assert_float_eq_tol(bird_fly->weight, 4, 0.000001);
-  ck_assert_float_eq_tol(penguin_bird->weight, 4, 0.000001);
+  ck_assert_float_eq_tol(penguin_bird->weight, 4.5, 0.000001);
   ck_assert_float_eq_tol(feathers_bird->weight, 5, 0.000001);
-  ck_assert_float_eq_tol(wings_bird->weight, 4, 0.000001);
-  ck_assert_float_eq_tol(penguin_wings->weight, 4.333333, 0.000001);
+  ck_assert_float_eq_tol(wings_bird->weight, 4.5, 0.000001);
+  ck_assert_float_eq_tol(penguin_wings->weight, 4.666667, 0.000001);
   ck_assert_float_eq_tol(antarctica_bird_fly->weight, 4, 0.000001);
   ck_assert_float_eq_tol(antarctica_penguin->weight, 5.5, 0.000001);
   ck_assert_float_eq_tol(penguin_antarctica->weight, 5.5, 0.000001);
   ck_assert_float_eq_tol(wings_fly->weight, 0.5, 0.000001);
   ck_assert_float_eq_tol(wings_feathers->weight, 5, 0.000001);
   ck_assert_float_eq_tol(fly_eagle->weight, 1, 0.000001);
-  ck_assert_float_eq_tol(bird_wings->weight, 4.333333, 0.000001);
+  ck_assert_float_eq_tol(bird_wings->weight, 4.666667, 0.000001);
 
   reset_active_rules_weight(knowledge_base, 5);
   initial_total_active_rules = knowledge_base->active->length;
@@ -1805,10 +2460,12 @@ START_TEST(update_rules_test) {
   ck_assert_int_lt(knowledge_base->active->length, initial_total_active_rules);
   ck_assert_int_eq(knowledge_base->active->length, 4);
   rule_hypergraph_get_inactive_rules(knowledge_base, &inactive_rules);
-  ck_assert_int_lt(inactive_rules->length, initial_total_inactive_rules);
-  ck_assert_int_eq(inactive_rules->length, 1);
+  ck_assert_int_gt(inactive_rules->length, initial_total_inactive_rules);
+  ck_assert_int_eq(inactive_rules->length, 3);
   rule_queue_destructor(&inactive_rules);
   ck_assert_float_eq_tol(feathers_bird->weight, 5, 0.000001);
+  ck_assert_float_eq_tol(penguin_wings->weight, 1.666667, 0.000001);
+  ck_assert_float_eq_tol(bird_wings->weight, 1.666667, 0.000001);
   ck_assert_float_eq_tol(antarctica_penguin->weight, 5.5, 0.000001);
   ck_assert_float_eq_tol(penguin_antarctica->weight, 5.5, 0.000001);
   ck_assert_float_eq_tol(wings_feathers->weight, 5, 0.000001);
@@ -2017,6 +2674,40 @@ START_TEST(update_rules_test) {
 }
 END_TEST
 
+START_TEST(atom_columns_test) {
+  RuleHyperGraph *hypergraph = rule_hypergraph_empty_constructor(false);
+  char name1[] = "wings", name2[] = "birds", *header[2] = {name1, name2};
+  Literal *wings = literal_constructor("wings_yes", true),
+          *birds = literal_constructor("birds_eagle", true);
+
+  _atom_columns_header(hypergraph, header, 2);
+  const AtomColumns *atom_columns = _atom_columns(hypergraph, wings);
+  ck_assert_int_eq(atom_columns->size, 1);
+  ck_assert_int_eq(atom_columns->columns[0], 0);
+  atom_columns = _atom_columns(hypergraph, birds);
+  ck_assert_int_eq(atom_columns->size, 1);
+  ck_assert_int_eq(atom_columns->columns[0], 1);
+
+  // A different header at the same address, with the same size.
+  memcpy(name1, "birds", sizeof(name1));
+  memcpy(name2, "wings", sizeof(name2));
+  _atom_columns_header(hypergraph, header, 2);
+  atom_columns = _atom_columns(hypergraph, wings);
+  ck_assert_int_eq(atom_columns->size, 1);
+  ck_assert_int_eq(atom_columns->columns[0], 1);
+  atom_columns = _atom_columns(hypergraph, birds);
+  ck_assert_int_eq(atom_columns->size, 1);
+  ck_assert_int_eq(atom_columns->columns[0], 0);
+
+  _atom_columns_header(hypergraph, NULL, 0);
+  ck_assert_int_eq(_atom_columns(hypergraph, wings)->size, 0);
+
+  literal_destructor(&wings);
+  literal_destructor(&birds);
+  rule_hypergraph_destructor(&hypergraph);
+}
+END_TEST
+
 Suite *rule_hypergraph_suite() {
   Suite *suite;
   TCase *create_case, *add_edges_case, *adding_and_removing_case,
@@ -2048,6 +2739,7 @@ Suite *rule_hypergraph_suite() {
 
   rule_update_case = tcase_create("Rule Update");
   tcase_add_test(rule_update_case, update_rules_test);
+  tcase_add_test(rule_update_case, atom_columns_test);
   suite_add_tcase(suite, rule_update_case);
 
   return suite;
@@ -61,6 +61,10 @@ void rule_hypergraph_remove_rule(RuleHyperGraph *const rule_hypergraph,
 void rule_hypergraph_get_inactive_rules(
     const struct KnowledgeBase *const knowledge_base,
     RuleQueue **const inactive_rules);
+void rule_hypergraph_for_each_rule(const RuleHyperGraph *const rule_hypergraph,
+                                   void (*visit)(const Rule *rule,
+                                                 void *argument),
+                                   void *argument);
 void rule_hypergraph_update_rules(
     struct KnowledgeBase *const knowledge_base, const Scene *const observations,
     const Scene *const inferences, const float promotion_rate,
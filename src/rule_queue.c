@@ -5,7 +5,8 @@
 
 typedef struct _RuleQueue {
   RuleQueue rule_queue;
-  bool ownership;
+  size_t capacity;
+  bool ownership, indexed;
 } _RuleQueue;
 
 /**
@@ -21,10 +22,31 @@ RuleQueue *rule_queue_constructor(const bool take_ownership) {
   _RuleQueue *queue = (_RuleQueue *)malloc(sizeof(_RuleQueue));
   queue->rule_queue.length = 0;
   queue->rule_queue.rules = NULL;
+  queue->capacity = 0;
   queue->ownership = take_ownership;
+  queue->indexed = false;
   return &(queue->rule_queue);
 }
 
+/**
+ * @brief Constructs an indexed RuleQueue. An indexed RuleQueue keeps each Rule
+ * at most once and stores the position of each Rule in the Rule itself
+ * (Rule.queue_index), so finding a Rule does not require searching. As a
+ * result, a Rule can only belong to one indexed RuleQueue at a time, and Rules
+ * are found by reference (not by comparing their contents).
+ *
+ * @param take_ownership Indicates whether the RuleQueue should take onwership
+ * of the Rules that will be added or just keep their reference. If true is
+ * given it will take their ownership, otherwise it will not.
+ *
+ * @return A new RuleQueue *. Use rule_queue_destructor to deallocate.
+ */
+RuleQueue *rule_queue_indexed_constructor(const bool take_ownership) {
+  RuleQueue *rule_queue = rule_queue_constructor(take_ownership);
+  ((_RuleQueue *)rule_queue)->indexed = true;
+  return rule_queue;
+}
+
 /**
  * @brief Destructs a RuleQueue.
  *
@@ -40,6 +62,10 @@ void rule_queue_destructor(RuleQueue **const rule_queue) {
             rule_destructor(&((*rule_queue)->rules[i]));
           }
         }
+      } else if (((_RuleQueue *)*rule_queue)->indexed) {
+        for (i = 0; i < (*rule_queue)->length; ++i) {
+          (*rule_queue)->rules[i]->queue_index = -1;
+        }
       }
 
       safe_free((*rule_queue)->rules);
@@ -55,7 +81,8 @@ void rule_queue_destructor(RuleQueue **const rule_queue) {
  * @param destination The RuleQueue to save the copy. It should be a reference
  * to the struct's pointer (to a RuleQueue *).
  * @param source The RuleQueue to be copied. If the RuleQueue is NULL, the
- * contents of the destination will not be changed.
+ * contents of the destination will not be changed. The copy is never indexed,
+ * even if the source is.
  */
 void rule_queue_copy(RuleQueue **const destination,
                      const RuleQueue *const source) {
@@ -71,6 +98,7 @@ void rule_queue_copy(RuleQueue **const destination,
 
     (*destination)->length = source->length;
     (*destination)->rules = (Rule **)malloc(source->length * sizeof(Rule *));
+    ((_RuleQueue *)*destination)->capacity = source->length;
 
     unsigned int i;
     if (_source->ownership) {
@@ -108,15 +136,27 @@ int rule_queue_is_taking_ownership(const RuleQueue *const rule_queue) {
  * @param rule The Rule to be enqueued. It should be reference to a Rule * (Rule
  * ** - a pointer to a Rule *). If the given rule_queue was constructed to take
  * ownership, this parameter will become NULL. If not, it will not become NULL.
- * If NULL is given, the queue will remain the same.
+ * If NULL is given, or if the rule_queue is indexed and already contains the
+ * Rule, the queue will remain the same.
  */
 void rule_queue_enqueue(RuleQueue *const rule_queue, Rule **const rule) {
   if (rule_queue && rule && (*rule)) {
-    ++rule_queue->length;
-    rule_queue->rules = (Rule **)realloc(rule_queue->rules,
-                                         rule_queue->length * sizeof(Rule *));
-    rule_queue->rules[rule_queue->length - 1] = *rule;
-    if (((_RuleQueue *)rule_queue)->ownership) {
+    _RuleQueue *_rule_queue = (_RuleQueue *)rule_queue;
+    if (_rule_queue->indexed) {
+      if (rule_queue_find(rule_queue, *rule) != -1) {
+        return;
+      }
+      (*rule)->queue_index = rule_queue->length;
+    }
+
+    if (rule_queue->length == _rule_queue->capacity) {
+      _rule_queue->capacity =
+          (_rule_queue->capacity == 0) ? 4 : (_rule_queue->capacity << 1);
+      rule_queue->rules = (Rule **)realloc(
+          rule_queue->rules, _rule_queue->capacity * sizeof(Rule *));
+    }
+    rule_queue->rules[rule_queue->length++] = *rule;
+    if (_rule_queue->ownership) {
       *rule = NULL;
     }
   }
@@ -133,29 +173,7 @@ void rule_queue_enqueue(RuleQueue *const rule_queue, Rule **const rule) {
  */
 void rule_queue_dequeue(RuleQueue *const rule_queue,
                         Rule **const dequeued_rule) {
-  if (rule_queue) {
-    if (rule_queue->rules) {
-      --rule_queue->length;
-      if (dequeued_rule) {
-        *dequeued_rule = rule_queue->rules[0];
-      } else if (((_RuleQueue *)rule_queue)->ownership) {
-        rule_destructor(&(rule_queue->rules[0]));
-      }
-
-      if (rule_queue->length == 0) {
-        safe_free(rule_queue->rules);
-      } else {
-        Rule **rules = rule_queue->rules;
-        rule_queue->rules =
-            (Rule **)malloc(rule_queue->length * sizeof(Rule *));
-
-        memcpy(rule_queue->rules, (rules + 1),
-               rule_queue->length * sizeof(Rule *));
-
-        free(rules);
-      }
-    }
-  }
+  rule_queue_remove_rule(rule_queue, 0, dequeued_rule);
 }
 
 /**
@@ -165,10 +183,20 @@ void rule_queue_dequeue(RuleQueue *const rule_queue,
  * @param rule The Rule to be found.
  *
  * @return index where the Rule is or -1 if it does not exist or either the Rule
- * or the RuleQueue are NULL.
+ * or the RuleQueue are NULL. If the RuleQueue is indexed, the Rule is found by
+ * reference in constant time.
  */
 int rule_queue_find(const RuleQueue *const rule_queue, const Rule *const rule) {
   if (rule_queue && rule) {
+    if (((_RuleQueue *)rule_queue)->indexed) {
+      if ((rule->queue_index >= 0) &&
+          ((size_t)rule->queue_index < rule_queue->length) &&
+          (rule_queue->rules[rule->queue_index] == rule)) {
+        return rule->queue_index;
+      }
+      return -1;
+    }
+
     unsigned int i;
     for (i = 0; i < rule_queue->length; ++i) {
       if (rule_equals(rule_queue->rules[i], rule)) {
@@ -195,33 +223,32 @@ void rule_queue_remove_rule(RuleQueue *const rule_queue, const int rule_index,
   if (rule_queue && (rule_index >= 0)) {
     const unsigned int u_rule_index = rule_index;
     if (rule_queue->rules && (u_rule_index < rule_queue->length)) {
+      _RuleQueue *_rule_queue = (_RuleQueue *)rule_queue;
       --rule_queue->length;
+      if (_rule_queue->indexed) {
+        rule_queue->rules[u_rule_index]->queue_index = -1;
+      }
+
       if (removed_rule) {
         *removed_rule = rule_queue->rules[u_rule_index];
-      } else if (((_RuleQueue *)rule_queue)->ownership) {
+      } else if (_rule_queue->ownership) {
         rule_destructor(&(rule_queue->rules[u_rule_index]));
       }
 
       if (rule_queue->length == 0) {
         safe_free(rule_queue->rules);
+        _rule_queue->capacity = 0;
       } else {
-        Rule **rules = rule_queue->rules;
-
-        rule_queue->rules =
-            (Rule **)malloc(rule_queue->length * sizeof(Rule *));
+        memmove(rule_queue->rules + u_rule_index,
+                rule_queue->rules + u_rule_index + 1,
+                (rule_queue->length - u_rule_index) * sizeof(Rule *));
 
-        if (u_rule_index == 0) {
-          memcpy(rule_queue->rules, rules + 1,
-                 rule_queue->length * sizeof(Rule *));
-        } else if (u_rule_index == (rule_queue->length + 1)) {
-          memcpy(rule_queue->rules, rules, rule_queue->length * sizeof(Rule *));
-        } else {
-          memcpy(rule_queue->rules, rules, (u_rule_index) * sizeof(Rule *));
-          memcpy(rule_queue->rules + u_rule_index, rules + u_rule_index + 1,
-                 (rule_queue->length - u_rule_index) * sizeof(Rule *));
+        if (_rule_queue->indexed) {
+          unsigned int i;
+          for (i = u_rule_index; i < rule_queue->length; ++i) {
+            rule_queue->rules[i]->queue_index = i;
+          }
         }
-
-        free(rules);
       }
     }
   }
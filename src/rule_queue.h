@@ -14,6 +14,7 @@ typedef struct RuleQueue {
 } RuleQueue;
 
 RuleQueue *rule_queue_constructor(const bool take_ownership);
+RuleQueue *rule_queue_indexed_constructor(const bool take_ownership);
 void rule_queue_destructor(RuleQueue **const rule_queue);
 void rule_queue_copy(RuleQueue **const destination,
                      const RuleQueue *const source);
@@ -4,11 +4,219 @@
 #include "nerd_utils.h"
 #include "scene.h"
 
+#define SCENE_INLINE_CAPACITY 4
+
+/**
+ * @brief An entry of the sorted index of a Scene. The key identifies the
+ * Literal (its atom id and sign) and the index is its position in the Scene.
+ */
+typedef struct SceneEntry {
+  unsigned int key, index;
+} SceneEntry;
+
+/**
+ * @brief The private part of a Scene. The Literals and the sorted index are
+ * kept in the inline arrays, until the Scene needs more than
+ * SCENE_INLINE_CAPACITY of them. Then they are moved to the heap, where their
+ * capacity grows geometrically. storage is the array of the Literals, and
+ * scene.literals points to it only while the Scene is not empty.
+ */
 typedef struct _Scene {
   Scene scene;
   bool ownership;
+  size_t capacity;
+  Literal **storage;
+  SceneEntry *entries;
+  Literal *inline_literals[SCENE_INLINE_CAPACITY];
+  SceneEntry inline_entries[SCENE_INLINE_CAPACITY];
 } _Scene;
 
+/**
+ * @brief Gives the key of a Literal, which orders the sorted index of a Scene.
+ */
+static inline unsigned int _literal_key(const Literal *const literal) {
+  return (literal->id << 1) | literal->sign;
+}
+
+/**
+ * @brief Finds the position of the first entry of the sorted index whose key is
+ * not less than the given key.
+ */
+static size_t _scene_lower_bound(const _Scene *const scene,
+                                 const unsigned int key) {
+  size_t low = 0, high = scene->scene.size, middle;
+  while (low < high) {
+    middle = low + ((high - low) >> 1);
+    if (scene->entries[middle].key < key) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  return low;
+}
+
+/**
+ * @brief Finds the position of the Literal with the given key in the Scene.
+ *
+ * @return The index of the Literal in the Scene, or -1 if it does not exist.
+ */
+static int _scene_find(const _Scene *const scene, const unsigned int key) {
+  const size_t position = _scene_lower_bound(scene, key);
+  if ((position < scene->scene.size) && (scene->entries[position].key == key)) {
+    return scene->entries[position].index;
+  }
+  return -1;
+}
+
+/**
+ * @brief Makes sure that the Scene can hold the given number of Literals,
+ * doubling its capacity as many times as needed. The Literals and the sorted
+ * index are moved from the inline arrays to the heap, when they do not fit.
+ */
+static void _scene_reserve(_Scene *const scene, const size_t capacity) {
+  if (capacity <= scene->capacity) {
+    return;
+  }
+
+  size_t new_capacity = scene->capacity << 1;
+  while (new_capacity < capacity) {
+    new_capacity <<= 1;
+  }
+
+  if (scene->storage == scene->inline_literals) {
+    scene->storage = (Literal **)malloc(new_capacity * sizeof(Literal *));
+    scene->entries = (SceneEntry *)malloc(new_capacity * sizeof(SceneEntry));
+    memcpy(scene->storage, scene->inline_literals,
+           scene->scene.size * sizeof(Literal *));
+    memcpy(scene->entries, scene->inline_entries,
+           scene->scene.size * sizeof(SceneEntry));
+  } else {
+    scene->storage =
+        (Literal **)realloc(scene->storage, new_capacity * sizeof(Literal *));
+    scene->entries = (SceneEntry *)realloc(scene->entries,
+                                           new_capacity * sizeof(SceneEntry));
+  }
+  scene->capacity = new_capacity;
+  if (scene->scene.size != 0) {
+    scene->scene.literals = scene->storage;
+  }
+}
+
+/**
+ * @brief Deallocates a _Scene and its storage, but not its Literals.
+ */
+static void _scene_release(_Scene *const scene) {
+  if (scene->storage != scene->inline_literals) {
+    free(scene->storage);
+    free(scene->entries);
+  }
+  free(scene);
+}
+
+/**
+ * @brief Appends a Literal to the end of the Scene and inserts it into the
+ * sorted index. The Literal must not already exist in the Scene.
+ */
+static void _scene_append(_Scene *const scene, Literal *const literal) {
+  const unsigned int key = _literal_key(literal);
+  const size_t position = _scene_lower_bound(scene, key);
+
+  _scene_reserve(scene, scene->scene.size + 1);
+  scene->storage[scene->scene.size++] = literal;
+  scene->scene.literals = scene->storage;
+
+  memmove(scene->entries + position + 1, scene->entries + position,
+          (scene->scene.size - 1 - position) * sizeof(SceneEntry));
+  scene->entries[position].key = key;
+  scene->entries[position].index = scene->scene.size - 1;
+}
+
+/**
+ * @brief Marks which Literals of scene1 also exist in scene2, by merging their
+ * sorted indices.
+ *
+ * @param found An array of scene1->size booleans. found[i] will be set to true
+ * if the i-th Literal of scene1 exists in scene2, false otherwise.
+ */
+static void _scene_match(const _Scene *const restrict scene1,
+                         const _Scene *const restrict scene2,
+                         bool *const found) {
+  size_t i = 0, j = 0;
+  while (i < scene1->scene.size) {
+    if ((j == scene2->scene.size) ||
+        (scene1->entries[i].key < scene2->entries[j].key)) {
+      found[scene1->entries[i++].index] = false;
+    } else if (scene1->entries[i].key > scene2->entries[j].key) {
+      ++j;
+    } else {
+      found[scene1->entries[i++].index] = true;
+      ++j;
+    }
+  }
+}
+
+/**
+ * @brief Constructs a Scene with the Literals of the source whose found flag
+ * equals to the given keep value, in the same order as the source.
+ *
+ * @param source The Scene to select the Literals from.
+ * @param found The flags of each Literal of the source (see _scene_match).
+ * @param keep The value of the flag that a Literal needs to be selected.
+ * @param take_ownership Whether the result should take ownership. If true, the
+ * selected Literals will be copied.
+ *
+ * @return A new Scene *. Use scene_destructor to deallocate.
+ */
+static Scene *_scene_select(const _Scene *const source,
+                            const bool *const found, const bool keep,
+                            const bool take_ownership) {
+  _Scene *result = (_Scene *)scene_constructor(take_ownership);
+  const size_t size = source->scene.size;
+  if (size == 0) {
+    return &(result->scene);
+  }
+
+  unsigned int *new_index =
+      (unsigned int *)malloc(size * sizeof(unsigned int));
+  size_t i, selected = 0;
+  for (i = 0; i < size; ++i) {
+    new_index[i] = selected;
+    if (found[i] == keep) {
+      ++selected;
+    }
+  }
+
+  if (selected != 0) {
+    _scene_reserve(result, selected);
+    result->scene.literals = result->storage;
+    for (i = 0; i < size; ++i) {
+      if (found[i] == keep) {
+        if (take_ownership) {
+          literal_copy(&(result->scene.literals[result->scene.size]),
+                       source->scene.literals[i]);
+        } else {
+          result->scene.literals[result->scene.size] =
+              source->scene.literals[i];
+        }
+        ++result->scene.size;
+      }
+    }
+
+    selected = 0;
+    for (i = 0; i < size; ++i) {
+      if (found[source->entries[i].index] == keep) {
+        result->entries[selected].key = source->entries[i].key;
+        result->entries[selected++].index =
+            new_index[source->entries[i].index];
+      }
+    }
+  }
+
+  free(new_index);
+  return &(result->scene);
+}
+
 /**
  * @brief Constructs a Scene.
  *
@@ -23,6 +231,9 @@ Scene *scene_constructor(const bool take_ownership) {
   scene->scene.literals = NULL;
   scene->scene.size = 0;
   scene->ownership = take_ownership;
+  scene->capacity = SCENE_INLINE_CAPACITY;
+  scene->storage = scene->inline_literals;
+  scene->entries = scene->inline_entries;
   return &(scene->scene);
 }
 
@@ -35,18 +246,13 @@ Scene *scene_constructor(const bool take_ownership) {
 void scene_destructor(Scene **const scene) {
   if (scene && (*scene)) {
     _Scene *_scene = (_Scene *)*scene;
-    if ((*scene)->literals) {
-      if (_scene->ownership) {
-        unsigned int i = 0;
-        for (i = 0; i < (*scene)->size; ++i) {
-          literal_destructor(&((*scene)->literals[i]));
-        }
+    if (_scene->ownership) {
+      unsigned int i = 0;
+      for (i = 0; i < (*scene)->size; ++i) {
+        literal_destructor(&((*scene)->literals[i]));
       }
-
-      safe_free((*scene)->literals);
-      (*scene)->size = 0;
     }
-    safe_free(_scene);
+    _scene_release(_scene);
     *scene = NULL;
   }
 }
@@ -68,9 +274,10 @@ void scene_copy(Scene **const destination, const Scene *const restrict source) {
       return;
     }
 
+    _Scene *_destination = (_Scene *)*destination;
+    _scene_reserve(_destination, source->size);
     (*destination)->size = source->size;
-    (*destination)->literals =
-        (Literal **)malloc(source->size * sizeof(Literal *));
+    (*destination)->literals = _destination->storage;
 
     unsigned int i;
     if (_source->ownership) {
@@ -82,6 +289,9 @@ void scene_copy(Scene **const destination, const Scene *const restrict source) {
         (*destination)->literals[i] = source->literals[i];
       }
     }
+
+    memcpy(_destination->entries, _source->entries,
+           source->size * sizeof(SceneEntry));
   }
 }
 
@@ -103,14 +313,18 @@ void _scene_copy(Scene **const destination,
       return;
     }
 
+    _Scene *_destination = (_Scene *)*destination;
+    _scene_reserve(_destination, source->size);
     (*destination)->size = source->size;
-    (*destination)->literals =
-        (Literal **)malloc(source->size * sizeof(Literal *));
+    (*destination)->literals = _destination->storage;
 
     unsigned int i;
     for (i = 0; i < source->size; ++i) {
       literal_copy(&((*destination)->literals[i]), source->literals[i]);
     }
+
+    memcpy(_destination->entries, ((_Scene *)source)->entries,
+           source->size * sizeof(SceneEntry));
   }
 }
 
@@ -141,12 +355,10 @@ int scene_is_taking_ownership(const Scene *const scene) {
  */
 void scene_add_literal(Scene *const scene, Literal **const literal_to_add) {
   if (scene && literal_to_add && (*literal_to_add)) {
-    if (scene_literal_index(scene, *literal_to_add) == -1) {
-      ++scene->size;
-      scene->literals =
-          (Literal **)realloc(scene->literals, scene->size * sizeof(Literal *));
-      scene->literals[scene->size - 1] = *literal_to_add;
-      if (((_Scene *)scene)->ownership) {
+    _Scene *_scene = (_Scene *)scene;
+    if (_scene_find(_scene, _literal_key(*literal_to_add)) == -1) {
+      _scene_append(_scene, *literal_to_add);
+      if (_scene->ownership) {
         *literal_to_add = NULL;
       }
     }
@@ -155,23 +367,90 @@ void scene_add_literal(Scene *const scene, Literal **const literal_to_add) {
 
 /**
  * @brief Adds a copy of the given Literal to the Scene. Should be used for set
- * operations and opposed.
+ * operations and opposed. As with scene_add_literal, nothing is added if the
+ * Literal already exists in the Scene.
  *
  * @param scene The Scene to be expanded.
  * @param literal_to_add The Literal * to be copied.
  */
 void _scene_add_literal_copy(Scene *const scene,
                              Literal **const literal_to_add) {
-  if (scene && literal_to_add) {
-    ++scene->size;
-    scene->literals =
-        (Literal **)realloc(scene->literals, scene->size * sizeof(Literal *));
-    literal_copy(&(scene->literals[scene->size - 1]), *literal_to_add);
+  if (scene && literal_to_add && (*literal_to_add)) {
+    _Scene *_scene = (_Scene *)scene;
+    if (_scene_find(_scene, _literal_key(*literal_to_add)) == -1) {
+      Literal *copy;
+      literal_copy(&copy, *literal_to_add);
+      _scene_append(_scene, copy);
+    }
+  }
+}
+
+/**
+ * @brief Adds many Literals to the Scene at once, in the given order. It is the
+ * same as adding each one of them with scene_add_literal, but the Scene grows
+ * only once.
+ *
+ * @param scene The Scene to be expanded.
+ * @param size The number of the Literals to be added.
+ * @param literals_to_add An array of Literal *. If the given scene was
+ * constructed to take ownership, the added Literals will become NULL. NULL
+ * Literals and Literals that already exist in the Scene are skipped.
+ */
+void scene_add_literals(Scene *const scene, const size_t size,
+                        Literal **const literals_to_add) {
+  if (scene && literals_to_add) {
+    _Scene *_scene = (_Scene *)scene;
+    _scene_reserve(_scene, scene->size + size);
+    size_t i;
+    for (i = 0; i < size; ++i) {
+      scene_add_literal(scene, &(literals_to_add[i]));
+    }
+  }
+}
+
+/**
+ * @brief Removes all the Literals of a Scene, but keeps its capacity, so that
+ * it can be filled again without allocating. If the Scene was constructed to
+ * take ownership, its Literals will be destroyed.
+ *
+ * @param scene The Scene to be cleared.
+ */
+void scene_clear(Scene *const scene) {
+  if (scene) {
+    if (((_Scene *)scene)->ownership) {
+      size_t i;
+      for (i = 0; i < scene->size; ++i) {
+        literal_destructor(&(scene->literals[i]));
+      }
+    }
+    scene->size = 0;
+    scene->literals = NULL;
   }
 }
 
 /**
- * @brief Removes a Literal from a Scene.
+ * @brief Removes the entry of the Literal at the given index from the sorted
+ * index of the Scene, and gives the removed Literal to removed_literal (or
+ * destroys it if the Scene has its ownership).
+ */
+static void _scene_remove_entry(_Scene *const scene,
+                                const unsigned int literal_index,
+                                Literal **const removed_literal) {
+  const size_t position = _scene_lower_bound(
+      scene, _literal_key(scene->storage[literal_index]));
+  memmove(scene->entries + position, scene->entries + position + 1,
+          (scene->scene.size - 1 - position) * sizeof(SceneEntry));
+
+  if (removed_literal) {
+    *removed_literal = scene->storage[literal_index];
+  } else if (scene->ownership) {
+    literal_destructor(&(scene->storage[literal_index]));
+  }
+}
+
+/**
+ * @brief Removes a Literal from a Scene, keeping the order of the remaining
+ * Literals.
  *
  * @param scene The Scene to be reduced.
  * @param literal_index The index of the Literal to be removed.
@@ -185,29 +464,57 @@ void scene_remove_literal(Scene *const scene, const unsigned int literal_index,
                           Literal **const removed_literal) {
   if (scene) {
     if (literal_index < scene->size) {
-      if (removed_literal) {
-        *removed_literal = scene->literals[literal_index];
-      } else if (((_Scene *)scene)->ownership) {
-        literal_destructor(&(scene->literals[literal_index]));
-      }
+      _Scene *_scene = (_Scene *)scene;
+      _scene_remove_entry(_scene, literal_index, removed_literal);
       --scene->size;
+
+      size_t i;
+      for (i = 0; i < scene->size; ++i) {
+        if (_scene->entries[i].index > literal_index) {
+          --_scene->entries[i].index;
+        }
+      }
+      memmove(_scene->storage + literal_index,
+              _scene->storage + literal_index + 1,
+              (scene->size - literal_index) * sizeof(Literal *));
       if (scene->size == 0) {
-        safe_free(scene->literals);
-        return;
+        scene->literals = NULL;
       }
+    }
+  }
+}
 
-      Literal **literals = scene->literals;
-      scene->literals = (Literal **)malloc(scene->size * sizeof(Literal *));
-      if (literal_index == 0) {
-        memcpy(scene->literals, literals + 1, scene->size * sizeof(Literal *));
-      } else if (literal_index == (scene->size + 1)) {
-        memcpy(scene->literals, literals, scene->size * sizeof(Literal *));
-      } else {
-        memcpy(scene->literals, literals, literal_index * sizeof(Literal *));
-        memcpy(scene->literals + literal_index, literals + literal_index + 1,
-               (scene->size - literal_index) * sizeof(Literal *));
+/**
+ * @brief Removes a Literal from a Scene by moving the last Literal in its
+ * place. It is faster than scene_remove_literal, but it does not keep the order
+ * of the remaining Literals.
+ *
+ * @param scene The Scene to be reduced.
+ * @param literal_index The index of the Literal to be removed.
+ * @param removed_literal A place to save the Literal that will be removed. It
+ * should be a reference to the struct's pointer (to a Literal *). If NULL is
+ * given and the scene was constructed to take ownership, the Literal will be
+ * destroyed. If it was constructed to keep references, it will not be
+ * destroyed.
+ */
+void scene_swap_remove_literal(Scene *const scene,
+                               const unsigned int literal_index,
+                               Literal **const removed_literal) {
+  if (scene) {
+    if (literal_index < scene->size) {
+      _Scene *_scene = (_Scene *)scene;
+      _scene_remove_entry(_scene, literal_index, removed_literal);
+      const size_t last = --scene->size;
+
+      if (literal_index != last) {
+        _scene->storage[literal_index] = _scene->storage[last];
+        _scene->entries[_scene_lower_bound(
+                            _scene, _literal_key(_scene->storage[last]))]
+            .index = literal_index;
+      }
+      if (scene->size == 0) {
+        scene->literals = NULL;
       }
-      free(literals);
     }
   }
 }
@@ -224,13 +531,7 @@ void scene_remove_literal(Scene *const scene, const unsigned int literal_index,
 int scene_literal_index(const Scene *const scene,
                         const Literal *const literal) {
   if (scene && literal) {
-    unsigned int i;
-    for (i = 0; i < scene->size; ++i) {
-      if (literal_equals(literal, scene->literals[i])) {
-        return i;
-      }
-    }
-    return -1;
+    return _scene_find((const _Scene *)scene, _literal_key(literal));
   }
   return -2;
 }
@@ -258,27 +559,59 @@ void scene_union(const Scene *const restrict scene1,
         _Scene *_scene1 = (_Scene *)scene1;
         _Scene *_scene2 = (_Scene *)scene2;
 
-        if (_scene2->ownership) {
-          _scene_copy(result, scene1);
-        } else {
-          scene_copy(result, scene1);
+        bool *found = (bool *)malloc(scene2->size * sizeof(bool));
+        _scene_match(_scene2, _scene1, found);
+
+        size_t i;
+        for (i = 0; (i < scene2->size) && found[i]; ++i)
+          ;
+        if (i == scene2->size) {
+          free(found);
+          if (_scene2->ownership) {
+            _scene_copy(result, scene1);
+          } else {
+            scene_copy(result, scene1);
+          }
+          return;
         }
-        void (*add_literal)(Scene *const scene, Literal **const literal) =
-            (_scene1->ownership || _scene2->ownership) ? _scene_add_literal_copy
-                                                       : scene_add_literal;
 
-        unsigned int i, j;
-        for (i = 0; i < scene2->size; ++i) {
-          for (j = 0; j < scene1->size; ++j) {
-            if (literal_equals(scene2->literals[i], scene1->literals[j])) {
-              break;
-            }
-          }
+        Scene *difference = _scene_select(
+            _scene2, found, false, _scene1->ownership || _scene2->ownership);
+        free(found);
+
+        _Scene *_difference = (_Scene *)difference;
+        _Scene *_result = (_Scene *)scene_constructor(_scene1->ownership ||
+                                                      _scene2->ownership);
+        const size_t size = scene1->size + difference->size;
+        _scene_reserve(_result, size);
+        _result->scene.size = size;
+        _result->scene.literals = _result->storage;
 
-          if (j == scene1->size) {
-            add_literal(*result, &(scene2->literals[i]));
+        for (i = 0; i < scene1->size; ++i) {
+          if (_result->ownership) {
+            literal_copy(&(_result->scene.literals[i]), scene1->literals[i]);
+          } else {
+            _result->scene.literals[i] = scene1->literals[i];
           }
         }
+        memcpy(_result->scene.literals + scene1->size, difference->literals,
+               difference->size * sizeof(Literal *));
+
+        size_t j = 0, k = 0;
+        for (i = 0; i < size; ++i) {
+          if ((k == difference->size) ||
+              ((j < scene1->size) &&
+               (_scene1->entries[j].key < _difference->entries[k].key))) {
+            _result->entries[i] = _scene1->entries[j++];
+          } else {
+            _result->entries[i].key = _difference->entries[k].key;
+            _result->entries[i].index =
+                _difference->entries[k++].index + scene1->size;
+          }
+        }
+
+        _scene_release(_difference);
+        *result = &(_result->scene);
       } else {
         scene_copy(result, scene1);
       }
@@ -311,23 +644,11 @@ void scene_difference(const Scene *const restrict scene1,
         _Scene *_scene1 = (_Scene *)scene1;
         _Scene *_scene2 = (_Scene *)scene2;
 
-        *result = scene_constructor(_scene1->ownership || _scene2->ownership);
-        void (*add_literal)(Scene *const scene, Literal **const literal) =
-            (_scene1->ownership || _scene2->ownership) ? _scene_add_literal_copy
-                                                       : scene_add_literal;
-
-        unsigned int i, j;
-        for (i = 0; i < scene1->size; ++i) {
-          for (j = 0; j < scene2->size; ++j) {
-            if (literal_equals(scene2->literals[j], scene1->literals[i])) {
-              break;
-            }
-          }
-
-          if (j == scene2->size) {
-            add_literal(*result, &(scene1->literals[i]));
-          }
-        }
+        bool *found = (bool *)malloc((scene1->size + 1) * sizeof(bool));
+        _scene_match(_scene1, _scene2, found);
+        *result = _scene_select(_scene1, found, false,
+                                _scene1->ownership || _scene2->ownership);
+        free(found);
       } else {
         scene_copy(result, scene1);
       }
@@ -360,20 +681,11 @@ void scene_intersect(const Scene *const restrict scene1,
         _Scene *_scene1 = (_Scene *)scene1;
         _Scene *_scene2 = (_Scene *)scene2;
 
-        *result = scene_constructor(_scene1->ownership || _scene2->ownership);
-        void (*add_literal)(Scene *const scene, Literal **const literal) =
-            (_scene1->ownership || _scene2->ownership) ? _scene_add_literal_copy
-                                                       : scene_add_literal;
-
-        unsigned int i, j;
-        for (i = 0; i < scene1->size; ++i) {
-          for (j = 0; j < scene2->size; ++j) {
-            if (literal_equals(scene1->literals[i], scene2->literals[j])) {
-              add_literal(*result, &(scene1->literals[i]));
-              break;
-            }
-          }
-        }
+        bool *found = (bool *)malloc((scene1->size + 1) * sizeof(bool));
+        _scene_match(_scene1, _scene2, found);
+        *result = _scene_select(_scene1, found, true,
+                                _scene1->ownership || _scene2->ownership);
+        free(found);
       } else {
         *result = scene_constructor(((_Scene *)scene1)->ownership);
       }
@@ -395,17 +707,47 @@ void scene_intersect(const Scene *const restrict scene1,
 int scene_is_subset(const Scene *const restrict scene1,
                     const Scene *const restrict scene2) {
   if (scene1 && scene2) {
-    bool found = false;
-    unsigned int i, j;
+    const _Scene *_scene1 = (const _Scene *)scene1,
+                 *_scene2 = (const _Scene *)scene2;
+    size_t i, j = 0;
     for (i = 0; i < scene1->size; ++i) {
-      for (j = 0; j < scene2->size; ++j) {
-        if (literal_equals(scene1->literals[i], scene2->literals[j])) {
-          found = true;
-          break;
-        }
-        found = false;
+      while ((j < scene2->size) &&
+             (_scene2->entries[j].key < _scene1->entries[i].key)) {
+        ++j;
+      }
+      if ((j == scene2->size) ||
+          (_scene2->entries[j].key != _scene1->entries[i].key)) {
+        return 0;
+      }
+    }
+    return 1;
+  }
+  return -1;
+}
+
+/**
+ * @brief Checks whether a Scene contains all the Literals with the given keys
+ * ((id << 1) | sign), such as the body keys of a Rule. It is the same as a
+ * subset check, without needing the Literals in a Scene.
+ *
+ * @param scene The Scene to be checked.
+ * @param size The number of the keys.
+ * @param keys The keys of the Literals, in ascending order and without
+ * duplicates.
+ *
+ * @return 1 if the Scene contains all the keys, 0 if it does not, or -1 if the
+ * Scene or the keys are NULL.
+ */
+int scene_contains_keys(const Scene *const scene, const size_t size,
+                        const unsigned int *const keys) {
+  if (scene && keys) {
+    const _Scene *_scene = (const _Scene *)scene;
+    size_t i, j = 0;
+    for (i = 0; i < size; ++i) {
+      while ((j < scene->size) && (_scene->entries[j].key < keys[i])) {
+        ++j;
       }
-      if (!found) {
+      if ((j == scene->size) || (_scene->entries[j].key != keys[i])) {
         return 0;
       }
     }
@@ -421,13 +763,19 @@ int scene_number_of_similar_literals(const Scene *const restrict scene1,
     return -1;
   }
 
-  unsigned int i, j, total_equals = 0;
-  for (i = 0; i < scene1->size; ++i) {
-    for (j = 0; j < scene2->size; ++j) {
-      if (literal_equals(scene1->literals[i], scene2->literals[j]) == 1) {
-        ++total_equals;
-        break;
-      }
+  const _Scene *_scene1 = (const _Scene *)scene1,
+               *_scene2 = (const _Scene *)scene2;
+  size_t i = 0, j = 0;
+  unsigned int total_equals = 0;
+  while ((i < scene1->size) && (j < scene2->size)) {
+    if (_scene1->entries[i].key < _scene2->entries[j].key) {
+      ++i;
+    } else if (_scene1->entries[i].key > _scene2->entries[j].key) {
+      ++j;
+    } else {
+      ++total_equals;
+      ++i;
+      ++j;
     }
   }
 
@@ -441,13 +789,11 @@ int scene_number_of_opposed_literals(const Scene *const restrict scene1,
     return -1;
   }
 
-  unsigned int i, j, total_opposed = 0;
+  const _Scene *_scene2 = (const _Scene *)scene2;
+  unsigned int i, total_opposed = 0;
   for (i = 0; i < scene1->size; ++i) {
-    for (j = 0; j < scene2->size; ++j) {
-      if (literal_opposed(scene1->literals[i], scene2->literals[j]) == 1) {
-        ++total_opposed;
-        break;
-      }
+    if (_scene_find(_scene2, _literal_key(scene1->literals[i]) ^ 1) != -1) {
+      ++total_opposed;
     }
   }
   return total_opposed;
@@ -488,17 +834,15 @@ void scene_opposed_literals(const Scene *const restrict scene1,
             (_scene1->ownership || _scene2->ownership) ? _scene_add_literal_copy
                                                        : scene_add_literal;
 
-        unsigned int i, j;
+        unsigned int i, key;
+        int equal_index, opposed_index;
         for (i = 0; i < scene1->size; ++i) {
-          for (j = 0; j < scene2->size; ++j) {
-            if (!literal_equals(scene1->literals[i], scene2->literals[j])) {
-              if (strcmp(scene1->literals[i]->atom,
-                         scene2->literals[j]->atom) == 0) {
-                add_literal(*result, &(scene2->literals[j]));
-                break;
-              }
-            } else {
-              break;
+          key = _literal_key(scene1->literals[i]);
+          opposed_index = _scene_find(_scene2, key ^ 1);
+          if (opposed_index != -1) {
+            equal_index = _scene_find(_scene2, key);
+            if ((equal_index == -1) || (opposed_index < equal_index)) {
+              add_literal(*result, &(scene2->literals[opposed_index]));
             }
           }
         }
@@ -16,8 +16,14 @@ void scene_destructor(Scene **const scene);
 void scene_copy(Scene **const destination, const Scene *const restrict source);
 int scene_is_taking_ownership(const Scene *const scene);
 void scene_add_literal(Scene *const scene, Literal **const literal_to_add);
+void scene_add_literals(Scene *const scene, const size_t size,
+                        Literal **const literals_to_add);
+void scene_clear(Scene *const scene);
 void scene_remove_literal(Scene *const scene, const unsigned int literal_index,
                           Literal **const removed_literal);
+void scene_swap_remove_literal(Scene *const scene,
+                               const unsigned int literal_index,
+                               Literal **const removed_literal);
 int scene_literal_index(const Scene *const scene, const Literal *const literal);
 void scene_union(const Scene *const restrict scene1,
                  const Scene *const restrict const2,
@@ -30,6 +36,8 @@ void scene_intersect(const Scene *const restrict scene1,
                      Scene **const restrict result);
 int scene_is_subset(const Scene *const restrict scene1,
                     const Scene *const restrict scene2);
+int scene_contains_keys(const Scene *const scene, const size_t size,
+                        const unsigned int *const keys);
 int scene_number_of_similar_literals(const Scene *const restrict scene1,
                                      const Scene *const restrict scene2);
 void scene_opposed_literals(const Scene *const restrict scene1,
@@ -1,14 +1,394 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include <ctype.h>
+#include <fcntl.h>
+#include <math.h>
 #include <pcg_variants.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <time.h>
+#include <unistd.h>
 
 #include "nerd_utils.h"
 #include "sensor.h"
 
+#define SENSOR_INDEX_MAGIC "NERDIDX"
+#define SENSOR_ENCODING_MAGIC "NERDENC"
+
+/**
+ * @brief The memory mapped file of a Sensor and its line-offset index. The i-th
+ * observation spans [offsets[i], offsets[i + 1]), including its '\n', and next
+ * is the index of the observation that sensor_get_next_scene will give. The
+ * scratch buffer is reused to build each atom, so that no string is allocated
+ * per token. If the Sensor is cached, the literals of the i-th observation are
+ * cache_literals[cache_offsets[i]] to cache_literals[cache_offsets[i + 1]],
+ * each encoded as (id << 1) | sign. An encoded file is always cached, it has no
+ * line-offset index, and its labels are kept the same way. atom_columns gives
+ * the header column that each atom id was observed in (or UINT32_MAX).
+ */
+struct SensorEnvironment {
+  char *data;
+  size_t size, next, number_of_observations;
+  uint64_t *offsets;
+  int64_t modification_seconds, modification_nanoseconds;
+  bool index_loaded, encoded;
+  uint32_t *cache_literals, *labels;
+  size_t *cache_offsets, number_of_labels;
+  uint32_t *atom_columns;
+  size_t atom_columns_size;
+  size_t *header_sizes;
+  char *scratch;
+  size_t scratch_size;
+};
+
+/**
+ * @brief The header of a line-offset index file (SENSOR_INDEX_EXTENSION). It is
+ * followed by the number_of_observations + 1 offsets. The size and the
+ * modification time of the indexed file tell whether the index is up to date.
+ */
+typedef struct SensorIndexHeader {
+  char magic[8];
+  uint64_t file_size, number_of_observations;
+  int64_t modification_seconds, modification_nanoseconds;
+} SensorIndexHeader;
+
+/**
+ * @brief The header of an encoded file (SENSOR_ENCODED_EXTENSION). It is
+ * followed by:
+ * - the number_of_observations + 1 offsets (uint64_t) of the observations in
+ * the literal stream,
+ * - the number_of_literals literals of the observations (uint32_t),
+ * - the number_of_labels labels (uint32_t),
+ * - the header column of each atom of the vocabulary (uint32_t, or UINT32_MAX
+ * if it was not observed in a column), and
+ * - the strings_size bytes of the header_size column names and of the
+ * vocabulary_size atoms, each terminated by '\0'.
+ * A literal is encoded as (index << 1) | sign, where index is the index of its
+ * atom in the vocabulary.
+ */
+typedef struct SensorEncodingHeader {
+  char magic[8];
+  uint64_t header_size, vocabulary_size, number_of_labels,
+      number_of_observations, number_of_literals, strings_size;
+} SensorEncodingHeader;
+
+// The data of an empty file, which cannot be mapped.
+static char _empty_data[1] = "";
+
 /**
- * @brief Constructs a Sensor from a file.
+ * @brief Gives the path of the line-offset index file of the Sensor's file.
+ *
+ * @return A new char *. Deallocate it using free.
+ */
+static char *_sensor_index_path(const Sensor *const sensor) {
+  char *index_path = (char *)malloc(
+      (strlen(sensor->filepath) + strlen(SENSOR_INDEX_EXTENSION) + 1) *
+      sizeof(char));
+  sprintf(index_path, "%s%s", sensor->filepath, SENSOR_INDEX_EXTENSION);
+  return index_path;
+}
+
+/**
+ * @brief Loads the line-offset index of the Sensor's file from its index file,
+ * if there is an up to date one.
+ *
+ * @return true if it was loaded, false otherwise.
+ */
+static bool _sensor_load_index(const Sensor *const sensor, const size_t start) {
+  SensorEnvironment *const environment = sensor->environment;
+  char *index_path = _sensor_index_path(sensor);
+  FILE *file = fopen(index_path, "rb");
+  free(index_path);
+  if (!file) {
+    return false;
+  }
+
+  SensorIndexHeader header;
+  if ((fread(&header, sizeof(SensorIndexHeader), 1, file) != 1) ||
+      (memcmp(header.magic, SENSOR_INDEX_MAGIC, sizeof(header.magic)) != 0) ||
+      (header.file_size != environment->size) ||
+      (header.modification_seconds != environment->modification_seconds) ||
+      (header.modification_nanoseconds !=
+       environment->modification_nanoseconds) ||
+      (header.number_of_observations > environment->size)) {
+    fclose(file);
+    return false;
+  }
+
+  const size_t total_offsets = header.number_of_observations + 1;
+  uint64_t *offsets = (uint64_t *)malloc(total_offsets * sizeof(uint64_t));
+  bool valid = (fread(offsets, sizeof(uint64_t), total_offsets, file) ==
+                total_offsets) &&
+               (offsets[0] == start) &&
+               (offsets[total_offsets - 1] == environment->size);
+  fclose(file);
+
+  size_t i;
+  for (i = 1; valid && (i < total_offsets); ++i) {
+    valid = offsets[i - 1] < offsets[i];
+  }
+  if (!valid) {
+    free(offsets);
+    return false;
+  }
+
+  environment->offsets = offsets;
+  environment->number_of_observations = header.number_of_observations;
+  return true;
+}
+
+/**
+ * @brief Builds the line-offset index of the Sensor's file, starting from the
+ * given offset (after the header). A last line without a '\n' is also an
+ * observation.
+ */
+static void _sensor_build_index(SensorEnvironment *const environment,
+                                const size_t start) {
+  const char *const end = environment->data + environment->size;
+  const char *current;
+  size_t number_of_observations = 0;
+  for (current = environment->data + start;
+       (current < end) &&
+       (current = (const char *)memchr(current, '\n', end - current));
+       ++current) {
+    ++number_of_observations;
+  }
+  if ((environment->size > start) && (end[-1] != '\n')) {
+    ++number_of_observations;
+  }
+
+  environment->number_of_observations = number_of_observations;
+  environment->offsets =
+      (uint64_t *)malloc((number_of_observations + 1) * sizeof(uint64_t));
+  environment->offsets[0] = start;
+
+  size_t i = 1;
+  for (current = environment->data + start;
+       (current < end) &&
+       (current = (const char *)memchr(current, '\n', end - current));
+       ++current) {
+    environment->offsets[i++] = current - environment->data + 1;
+  }
+  environment->offsets[number_of_observations] = environment->size;
+}
+
+/**
+ * @brief Records the header column that the given atom id was observed in. Only
+ * the first column of an atom is kept.
+ */
+static void _sensor_set_atom_column(SensorEnvironment *const environment,
+                                    const unsigned int id,
+                                    const uint32_t column) {
+  if (id >= environment->atom_columns_size) {
+    size_t size = literal_total_atoms();
+    if (size <= id) {
+      size = id + 1;
+    }
+    environment->atom_columns = (uint32_t *)realloc(
+        environment->atom_columns, size * sizeof(uint32_t));
+    memset(environment->atom_columns + environment->atom_columns_size, 0xff,
+           (size - environment->atom_columns_size) * sizeof(uint32_t));
+    environment->atom_columns_size = size;
+  }
+  if (environment->atom_columns[id] == UINT32_MAX) {
+    environment->atom_columns[id] = column;
+  }
+}
+
+/**
+ * @brief Gives the sections of an encoded file, after its header.
+ */
+static inline void _sensor_encoding_sections(const char *const data,
+                                             const uint64_t **const offsets,
+                                             const uint32_t **const literals,
+                                             const uint32_t **const labels,
+                                             const uint32_t **const columns,
+                                             const char **const strings) {
+  const SensorEncodingHeader *const header = (const SensorEncodingHeader *)data;
+  *offsets = (const uint64_t *)(data + sizeof(SensorEncodingHeader));
+  *literals = (const uint32_t *)(*offsets + header->number_of_observations + 1);
+  *labels = *literals + header->number_of_literals;
+  *columns = *labels + header->number_of_labels;
+  *strings = (const char *)(*columns + header->vocabulary_size);
+}
+
+/**
+ * @brief Loads the Sensor's encoded file. Its atoms are interned, and its
+ * observations and labels are translated to the interned ids of their atoms.
+ *
+ * @return true if it was loaded, false if the file is not a valid encoded file.
+ */
+static bool _sensor_load_encoding(Sensor *const sensor) {
+  SensorEnvironment *const environment = sensor->environment;
+  const SensorEncodingHeader *const header =
+      (const SensorEncodingHeader *)environment->data;
+  const size_t size = environment->size;
+  if ((header->number_of_observations >= size) ||
+      (header->number_of_literals >= size) ||
+      (header->number_of_labels >= size) || (header->strings_size > size) ||
+      (header->header_size > header->strings_size) ||
+      (header->vocabulary_size > header->strings_size) ||
+      (sizeof(SensorEncodingHeader) +
+           (header->number_of_observations + 1) * sizeof(uint64_t) +
+           (header->number_of_literals + header->number_of_labels +
+            header->vocabulary_size) *
+               sizeof(uint32_t) +
+           header->strings_size !=
+       size)) {
+    return false;
+  }
+
+  const uint64_t *offsets;
+  const uint32_t *literals, *labels, *columns;
+  const char *strings;
+  _sensor_encoding_sections(environment->data, &offsets, &literals, &labels,
+                            &columns, &strings);
+
+  const char *const strings_end = strings + header->strings_size;
+  const char *current = strings, *string_end;
+  const size_t total_strings = header->header_size + header->vocabulary_size;
+  unsigned int *ids =
+      (unsigned int *)malloc((header->vocabulary_size + 1) * sizeof(unsigned int));
+  size_t i;
+  for (i = 0; i < total_strings; ++i) {
+    if (!(string_end = (const char *)memchr(current, '\0',
+                                             strings_end - current))) {
+      free(ids);
+      return false;
+    }
+    if (i < header->header_size) {
+      sensor->header = (char **)realloc(
+          sensor->header, (sensor->header_size + 1) * sizeof(char *));
+      environment->header_sizes = (size_t *)realloc(
+          environment->header_sizes, (sensor->header_size + 1) * sizeof(size_t));
+      sensor->header[sensor->header_size] = strdup(current);
+      environment->header_sizes[sensor->header_size] = string_end - current;
+      ++sensor->header_size;
+    } else {
+      ids[i - header->header_size] = literal_intern_atom(current);
+    }
+    current = string_end + 1;
+  }
+
+  bool valid = (current == strings_end) && (offsets[0] == 0) &&
+               (offsets[header->number_of_observations] ==
+                header->number_of_literals);
+  for (i = 1; valid && (i <= header->number_of_observations); ++i) {
+    valid = offsets[i - 1] <= offsets[i];
+  }
+  for (i = 0; valid && (i < header->number_of_literals); ++i) {
+    valid = (literals[i] >> 1) < header->vocabulary_size;
+  }
+  for (i = 0; valid && (i < header->number_of_labels); ++i) {
+    valid = (labels[i] >> 1) < header->vocabulary_size;
+  }
+  for (i = 0; valid && (i < header->vocabulary_size); ++i) {
+    valid = (columns[i] == UINT32_MAX) || (columns[i] < header->header_size);
+  }
+  if (!valid) {
+    free(ids);
+    return false;
+  }
+
+  environment->number_of_observations = header->number_of_observations;
+  environment->cache_offsets = (size_t *)malloc(
+      (header->number_of_observations + 1) * sizeof(size_t));
+  for (i = 0; i <= header->number_of_observations; ++i) {
+    environment->cache_offsets[i] = offsets[i];
+  }
+  environment->cache_literals = (uint32_t *)malloc(
+      (header->number_of_literals + 1) * sizeof(uint32_t));
+  for (i = 0; i < header->number_of_literals; ++i) {
+    environment->cache_literals[i] =
+        (ids[literals[i] >> 1] << 1) | (literals[i] & 1);
+  }
+  environment->number_of_labels = header->number_of_labels;
+  environment->labels =
+      (uint32_t *)malloc((header->number_of_labels + 1) * sizeof(uint32_t));
+  for (i = 0; i < header->number_of_labels; ++i) {
+    environment->labels[i] = (ids[labels[i] >> 1] << 1) | (labels[i] & 1);
+  }
+  for (i = 0; i < header->vocabulary_size; ++i) {
+    if (columns[i] != UINT32_MAX) {
+      _sensor_set_atom_column(environment, ids[i], columns[i]);
+    }
+  }
+  free(ids);
+
+  environment->encoded = true;
+  environment->index_loaded = true;
+  return true;
+}
+
+/**
+ * @brief Resolves a token of an observation to an interned Literal and adds it
+ * to the given Scene. If the Sensor has a header, the atom is prefixed with
+ * 'header_' of the token's column. The atom is trimmed and converted to
+ * lowercase, and a leading dash (-) negates it, as in
+ * literal_constructor_from_string.
+ */
+static void _sensor_add_literal(const Sensor *const sensor, Scene *const scene,
+                                const size_t column, const char *const token,
+                                const size_t token_size) {
+  SensorEnvironment *const environment = sensor->environment;
+  size_t prefix_size = 0;
+  if (sensor->header && (column < sensor->header_size)) {
+    prefix_size = environment->header_sizes[column] + 1;
+  }
+
+  if (prefix_size + token_size + 1 > environment->scratch_size) {
+    environment->scratch_size = (prefix_size + token_size + 1) << 1;
+    environment->scratch =
+        (char *)realloc(environment->scratch, environment->scratch_size);
+  }
+
+  char *first = environment->scratch, *last = first + prefix_size + token_size;
+  if (prefix_size) {
+    memcpy(first, sensor->header[column], prefix_size - 1);
+    first[prefix_size - 1] = '_';
+  }
+  memcpy(first + prefix_size, token, token_size);
+
+  while ((first < last) && isspace((unsigned char)*first)) {
+    ++first;
+  }
+  while ((last > first) && isspace((unsigned char)last[-1])) {
+    --last;
+  }
+
+  bool sign = true;
+  if ((first < last) && (*first == '-')) {
+    sign = false;
+    ++first;
+    while ((first < last) && isspace((unsigned char)*first)) {
+      ++first;
+    }
+  }
+  if (first == last) {
+    return;
+  }
+
+  char *c;
+  for (c = first; c < last; ++c) {
+    *c = tolower((unsigned char)*c);
+  }
+  *last = '\0';
+
+  const unsigned int id = literal_intern_atom(first);
+  if (prefix_size) {
+    _sensor_set_atom_column(environment, id, column);
+  }
+  Literal *literal = literal_constructor_from_id(id, sign);
+  scene_add_literal(scene, &literal);
+  literal_destructor(&literal);
+}
+
+/**
+ * @brief Constructs a Sensor from a file. The file is memory mapped, and it is
+ * tokenized in place.
  *
  * @param filepath The path to the file. If NULL is given, the sensor will not
  * be constructed.
@@ -20,67 +400,110 @@
  * @param header Indicates whether the file contains a header or no. Use true (>
  * 0) for yes, and false (0) for no.
  *
- * @return A new Sensor *, or NULL if filepath is NULL or does not exist. Use
- * sensor_destructor to deallocate.
+ * If the file is an encoded file (see sensor_encode), it is loaded as is, and
+ * the delimiter and header are ignored.
+ *
+ * @return A new Sensor *, or NULL if filepath is NULL, does not exist or is an
+ * invalid encoded file. Use sensor_destructor to deallocate.
  */
 Sensor *sensor_constructor_from_file(const char *const filepath,
                                      const char delimiter, const bool reuse,
                                      const bool header) {
-  if (filepath) {
-    FILE *environment = fopen(filepath, "rb");
-    if (environment != NULL) {
-      Sensor *sensor = (Sensor *)malloc(sizeof(Sensor));
-      sensor->environment = environment;
-      sensor->filepath = strdup(filepath);
-      sensor->delimiter = delimiter;
-      sensor->reuse = reuse;
-      sensor->header = NULL;
-      sensor->header_size = 0;
-
-      if (header) {
-        size_t buffer_size = BUFFER_SIZE;
-        char *buffer = (char *)malloc(buffer_size * sizeof(char));
-        memset(buffer, 0, buffer_size);
-        unsigned int i = 0;
-        int c = fgetc(sensor->environment);
-        bool end_of_line = false;
-
-        while (!end_of_line) {
-          if (c != sensor->delimiter) {
-            if ((i + 1) == buffer_size) {
-              buffer_size <<= 1;
-              buffer = (char *)realloc(buffer, buffer_size);
-              memset(buffer + (buffer_size >> 1), 0, buffer_size >> 1);
-            }
-
-            buffer[i++] = (char)c;
-          } else {
-          save_header:
-            sensor->header = (char **)realloc(
-                sensor->header, ++sensor->header_size * sizeof(char *));
-            sensor->header[sensor->header_size - 1] = strdup(buffer);
-            memset(buffer, 0, strlen(buffer));
-            i = 0;
-
-            if (end_of_line) {
-              goto end_header_loop;
-            }
-          }
-          c = fgetc(sensor->environment);
-
-          if ((c == EOF) || (c == '\n')) {
-            end_of_line = true;
-            goto save_header;
-          }
-        end_header_loop:
-        }
+  if (!filepath) {
+    return NULL;
+  }
+
+  const int file_descriptor = open(filepath, O_RDONLY);
+  if (file_descriptor == -1) {
+    return NULL;
+  }
+
+  struct stat file_status;
+  char *data = _empty_data;
+  if (fstat(file_descriptor, &file_status) != 0) {
+    close(file_descriptor);
+    return NULL;
+  }
+  if (file_status.st_size > 0) {
+    data = (char *)mmap(NULL, file_status.st_size, PROT_READ, MAP_PRIVATE,
+                        file_descriptor, 0);
+    if (data == MAP_FAILED) {
+      close(file_descriptor);
+      return NULL;
+    }
+    posix_madvise(data, file_status.st_size, POSIX_MADV_SEQUENTIAL);
+  }
+  close(file_descriptor);
 
-        free(buffer);
+  SensorEnvironment *environment =
+      (SensorEnvironment *)malloc(sizeof(SensorEnvironment));
+  environment->data = data;
+  environment->size = file_status.st_size;
+  environment->next = 0;
+  environment->modification_seconds = file_status.st_mtim.tv_sec;
+  environment->modification_nanoseconds = file_status.st_mtim.tv_nsec;
+  environment->number_of_observations = 0;
+  environment->offsets = NULL;
+  environment->index_loaded = false;
+  environment->encoded = false;
+  environment->cache_literals = NULL;
+  environment->cache_offsets = NULL;
+  environment->labels = NULL;
+  environment->number_of_labels = 0;
+  environment->atom_columns = NULL;
+  environment->atom_columns_size = 0;
+  environment->header_sizes = NULL;
+  environment->scratch_size = BUFFER_SIZE;
+  environment->scratch = (char *)malloc(environment->scratch_size);
+
+  Sensor *sensor = (Sensor *)malloc(sizeof(Sensor));
+  sensor->environment = environment;
+  sensor->filepath = strdup(filepath);
+  sensor->delimiter = delimiter;
+  sensor->reuse = reuse;
+  sensor->header = NULL;
+  sensor->header_size = 0;
+
+  if ((environment->size >= sizeof(SensorEncodingHeader)) &&
+      (memcmp(data, SENSOR_ENCODING_MAGIC, sizeof(SENSOR_ENCODING_MAGIC)) ==
+       0)) {
+    if (!_sensor_load_encoding(sensor)) {
+      sensor_destructor(&sensor);
+    }
+    return sensor;
+  }
+
+  size_t start = 0;
+  if (header) {
+    const char *const header_end =
+        (const char *)memchr(data, '\n', environment->size);
+    const size_t line_end =
+        header_end ? (size_t)(header_end - data) : environment->size;
+    size_t i, token_start = 0;
+    for (i = 0; i <= line_end; ++i) {
+      if ((i == line_end) || (data[i] == delimiter)) {
+        sensor->header = (char **)realloc(
+            sensor->header, (sensor->header_size + 1) * sizeof(char *));
+        environment->header_sizes = (size_t *)realloc(
+            environment->header_sizes,
+            (sensor->header_size + 1) * sizeof(size_t));
+        sensor->header[sensor->header_size] =
+            strndup(data + token_start, i - token_start);
+        environment->header_sizes[sensor->header_size] =
+            strlen(sensor->header[sensor->header_size]);
+        ++sensor->header_size;
+        token_start = i + 1;
       }
-      return sensor;
     }
+    start = header_end ? line_end + 1 : environment->size;
   }
-  return NULL;
+
+  environment->index_loaded = _sensor_load_index(sensor, start);
+  if (!environment->index_loaded) {
+    _sensor_build_index(environment, start);
+  }
+
+  return sensor;
 }
 
 /**
@@ -91,8 +514,18 @@ Sensor *sensor_constructor_from_file(const char *const filepath,
 void sensor_destructor(Sensor **const sensor) {
   if (sensor && (*sensor)) {
     if ((*sensor)->environment) {
-      fclose((*sensor)->environment);
-      (*sensor)->environment = NULL;
+      SensorEnvironment *environment = (*sensor)->environment;
+      if (environment->size > 0) {
+        munmap(environment->data, environment->size);
+      }
+      free(environment->offsets);
+      free(environment->cache_literals);
+      free(environment->cache_offsets);
+      free(environment->labels);
+      free(environment->atom_columns);
+      free(environment->header_sizes);
+      free(environment->scratch);
+      safe_free((*sensor)->environment);
       safe_free((*sensor)->filepath);
       (*sensor)->delimiter = '\0';
       (*sensor)->reuse = false;
@@ -108,37 +541,402 @@ void sensor_destructor(Sensor **const sensor) {
 }
 
 /**
- * @brief Finds the total literals in the environment.
+ * @brief Saves the line-offset index of the Sensor's file next to it (the
+ * filepath followed by SENSOR_INDEX_EXTENSION), so that the next Sensors of the
+ * same file will not have to scan it. Nothing is written if the index was
+ * loaded from an up to date index file.
  *
- * @param sensor The sensor to get the total literals from.
+ * @param sensor The Sensor whose index will be saved.
  *
- * @return The number of total literals, or -1 if the sensor is NULL.
+ * @return 0 if the index was saved (or it was already up to date), -1 if the
+ * index file could not be written, and -2 if the sensor is NULL.
  */
-size_t sensor_get_total_observations(const Sensor *const sensor) {
-  if (sensor && sensor->environment) {
-    fpos_t current_possition;
-    fgetpos(sensor->environment, &current_possition);
-    fseek(sensor->environment, 0, SEEK_SET);
-
-    size_t total_observations = 0;
-    char c;
-    for (c = getc(sensor->environment); c != EOF;
-         c = getc(sensor->environment)) {
-      if (c == '\n') {
-        ++total_observations;
+int sensor_save_index(const Sensor *const sensor) {
+  if (!(sensor && sensor->environment)) {
+    return -2;
+  }
+
+  SensorEnvironment *const environment = sensor->environment;
+  if (environment->index_loaded) {
+    return 0;
+  }
+
+  char *index_path = _sensor_index_path(sensor);
+  FILE *file = fopen(index_path, "wb");
+  free(index_path);
+  if (!file) {
+    return -1;
+  }
+
+  SensorIndexHeader header;
+  memset(&header, 0, sizeof(SensorIndexHeader));
+  memcpy(header.magic, SENSOR_INDEX_MAGIC, sizeof(header.magic));
+  header.file_size = environment->size;
+  header.number_of_observations = environment->number_of_observations;
+  header.modification_seconds = environment->modification_seconds;
+  header.modification_nanoseconds = environment->modification_nanoseconds;
+
+  fwrite(&header, sizeof(SensorIndexHeader), 1, file);
+  fwrite(environment->offsets, sizeof(uint64_t),
+         environment->number_of_observations + 1, file);
+  if (fclose(file) != 0) {
+    return -1;
+  }
+  environment->index_loaded = true;
+  return 0;
+}
+
+/**
+ * @brief Parses every observation of the Sensor once and keeps their Literals
+ * as arrays of atom ids, so that the Scenes given afterwards are built from
+ * them without tokenizing the file again. The cache takes 4 bytes per Literal,
+ * and it is useful when the same observations are read many times (e.g. over
+ * many training iterations). Caching an already cached Sensor does nothing.
+ *
+ * @param sensor The Sensor to be cached.
+ *
+ * @return 0 if the Sensor was cached, or -2 if the sensor is NULL.
+ */
+int sensor_cache(const Sensor *const sensor) {
+  if (!(sensor && sensor->environment)) {
+    return -2;
+  }
+
+  SensorEnvironment *const environment = sensor->environment;
+  if (environment->cache_offsets) {
+    return 0;
+  }
+
+  const size_t number_of_observations = environment->number_of_observations;
+  size_t *cache_offsets =
+      (size_t *)malloc((number_of_observations + 1) * sizeof(size_t));
+  uint32_t *cache_literals = NULL;
+  size_t capacity = 0, size = 0, i, j;
+  Scene *observation = NULL;
+
+  for (i = 0; i < number_of_observations; ++i) {
+    cache_offsets[i] = size;
+    sensor_get_scene_at(sensor, i, &observation);
+    if (size + observation->size > capacity) {
+      capacity = (size + observation->size) << 1;
+      cache_literals =
+          (uint32_t *)realloc(cache_literals, capacity * sizeof(uint32_t));
+    }
+    for (j = 0; j < observation->size; ++j) {
+      cache_literals[size++] = (observation->literals[j]->id << 1) |
+                               observation->literals[j]->sign;
+    }
+    scene_destructor(&observation);
+  }
+  cache_offsets[number_of_observations] = size;
+
+  if (size < capacity) {
+    cache_literals = (uint32_t *)realloc(cache_literals, size * sizeof(uint32_t));
+  }
+  environment->cache_literals = cache_literals;
+  environment->cache_offsets = cache_offsets;
+  return 0;
+}
+
+/**
+ * @brief Gives the index of the atom of the given Literal in an encoded file's
+ * vocabulary, and adds it to the vocabulary if it is not already there.
+ */
+static uint32_t _sensor_vocabulary_index(const Literal *const literal,
+                                         uint32_t **const indices,
+                                         size_t *const indices_size,
+                                         unsigned int **const vocabulary,
+                                         size_t *const vocabulary_size) {
+  if (literal->id >= *indices_size) {
+    const size_t previous_size = *indices_size;
+    *indices_size = literal_total_atoms();
+    *indices = (uint32_t *)realloc(*indices, *indices_size * sizeof(uint32_t));
+    memset(*indices + previous_size, 0xff,
+           (*indices_size - previous_size) * sizeof(uint32_t));
+  }
+  if ((*indices)[literal->id] == UINT32_MAX) {
+    (*indices)[literal->id] = *vocabulary_size;
+    *vocabulary = (unsigned int *)realloc(
+        *vocabulary, (*vocabulary_size + 1) * sizeof(unsigned int));
+    (*vocabulary)[(*vocabulary_size)++] = literal->id;
+  }
+  return ((*indices)[literal->id] << 1) | literal->sign;
+}
+
+/**
+ * @brief Encodes the observations of a Sensor and the given labels to an
+ * encoded file. The Sensors of an encoded file read its observations without
+ * tokenizing them, and they give the same Scenes as the Sensor it was encoded
+ * from.
+ *
+ * @param sensor The Sensor to be encoded. Its header (if any) is kept, so that
+ * the Sensors of the encoded file have the same header.
+ * @param labels The labels to be kept in the encoded file. If NULL, it will not
+ * have any labels.
+ * @param filepath The path of the encoded file. It should have the
+ * SENSOR_ENCODED_EXTENSION.
+ *
+ * @return 0 if the file was written, -1 if it could not be written, and -2 if
+ * the sensor or the filepath are NULL.
+ */
+int sensor_encode(const Sensor *const sensor, const Scene *const labels,
+                  const char *const filepath) {
+  if (!(sensor && sensor->environment && filepath)) {
+    return -2;
+  }
+
+  SensorEncodingHeader header;
+  memset(&header, 0, sizeof(SensorEncodingHeader));
+  memcpy(header.magic, SENSOR_ENCODING_MAGIC, sizeof(header.magic));
+  header.header_size = sensor->header_size;
+  header.number_of_observations = sensor->environment->number_of_observations;
+
+  uint32_t *indices = NULL, *literals = NULL, *encoded_labels = NULL;
+  unsigned int *vocabulary = NULL;
+  size_t indices_size = 0, vocabulary_size = 0, capacity = 0, i, j;
+  uint64_t *offsets = (uint64_t *)malloc(
+      (header.number_of_observations + 1) * sizeof(uint64_t));
+  Scene *observation = NULL;
+
+  if (labels) {
+    header.number_of_labels = labels->size;
+    encoded_labels = (uint32_t *)malloc((labels->size + 1) * sizeof(uint32_t));
+    for (i = 0; i < labels->size; ++i) {
+      encoded_labels[i] =
+          _sensor_vocabulary_index(labels->literals[i], &indices, &indices_size,
+                                   &vocabulary, &vocabulary_size);
+    }
+  }
+
+  for (i = 0; i < header.number_of_observations; ++i) {
+    offsets[i] = header.number_of_literals;
+    sensor_get_scene_at(sensor, i, &observation);
+    if (header.number_of_literals + observation->size > capacity) {
+      capacity = (header.number_of_literals + observation->size) << 1;
+      literals = (uint32_t *)realloc(literals, capacity * sizeof(uint32_t));
+    }
+    for (j = 0; j < observation->size; ++j) {
+      literals[header.number_of_literals++] = _sensor_vocabulary_index(
+          observation->literals[j], &indices, &indices_size, &vocabulary,
+          &vocabulary_size);
+    }
+    scene_destructor(&observation);
+  }
+  offsets[header.number_of_observations] = header.number_of_literals;
+  header.vocabulary_size = vocabulary_size;
+
+  for (i = 0; i < sensor->header_size; ++i) {
+    header.strings_size += strlen(sensor->header[i]) + 1;
+  }
+  for (i = 0; i < vocabulary_size; ++i) {
+    header.strings_size += strlen(literal_atom_from_id(vocabulary[i])) + 1;
+  }
+
+  int error_code = -1;
+  FILE *file = fopen(filepath, "wb");
+  if (file) {
+    fwrite(&header, sizeof(SensorEncodingHeader), 1, file);
+    fwrite(offsets, sizeof(uint64_t), header.number_of_observations + 1, file);
+    fwrite(literals, sizeof(uint32_t), header.number_of_literals, file);
+    fwrite(encoded_labels, sizeof(uint32_t), header.number_of_labels, file);
+    uint32_t column;
+    for (i = 0; i < vocabulary_size; ++i) {
+      column = UINT32_MAX;
+      if (vocabulary[i] < sensor->environment->atom_columns_size) {
+        column = sensor->environment->atom_columns[vocabulary[i]];
       }
+      fwrite(&column, sizeof(uint32_t), 1, file);
     }
-    fsetpos(sensor->environment, &current_possition);
+    for (i = 0; i < sensor->header_size; ++i) {
+      fwrite(sensor->header[i], sizeof(char), strlen(sensor->header[i]) + 1,
+             file);
+    }
+    const char *atom;
+    for (i = 0; i < vocabulary_size; ++i) {
+      atom = literal_atom_from_id(vocabulary[i]);
+      fwrite(atom, sizeof(char), strlen(atom) + 1, file);
+    }
+    error_code = (fclose(file) == 0) ? 0 : -1;
+  }
 
-    if (sensor->header) {
-      --total_observations;
+  free(indices);
+  free(literals);
+  free(encoded_labels);
+  free(vocabulary);
+  free(offsets);
+  return error_code;
+}
+
+/**
+ * @brief Checks whether the given file is an encoded file (see sensor_encode).
+ *
+ * @param filepath The path to the file.
+ *
+ * @return true if it is an encoded file, false otherwise or if the filepath is
+ * NULL.
+ */
+bool sensor_is_encoded(const char *const filepath) {
+  if (!filepath) {
+    return false;
+  }
+
+  FILE *file = fopen(filepath, "rb");
+  if (!file) {
+    return false;
+  }
+  char magic[sizeof(SENSOR_ENCODING_MAGIC)];
+  const bool encoded =
+      (fread(magic, sizeof(magic), 1, file) == 1) &&
+      (memcmp(magic, SENSOR_ENCODING_MAGIC, sizeof(SENSOR_ENCODING_MAGIC)) == 0);
+  fclose(file);
+  return encoded;
+}
+
+/**
+ * @brief Gets the labels of a Sensor's encoded file.
+ *
+ * @param sensor The Sensor to get the labels from. If NULL, or if its file is
+ * not an encoded file, nothing will happen.
+ * @param output The labels will be saved here as a new Scene. If NULL, nothing
+ * will happen.
+ */
+void sensor_get_labels(const Sensor *const sensor,
+                       Scene **const restrict output) {
+  if (!(sensor && sensor->environment && sensor->environment->encoded &&
+        output)) {
+    return;
+  }
+
+  const SensorEnvironment *const environment = sensor->environment;
+  *output = scene_constructor(true);
+  Literal *literal;
+  size_t i;
+  for (i = 0; i < environment->number_of_labels; ++i) {
+    literal = literal_constructor_from_id(environment->labels[i] >> 1,
+                                          environment->labels[i] & 1);
+    scene_add_literal(*output, &literal);
+    literal_destructor(&literal);
+  }
+}
+
+/**
+ * @brief Reads the labels of a labels file. The labels of an encoded file (see
+ * sensor_encode) are the ones it was encoded with. Otherwise, the labels are
+ * Literals separated by the delimiter or new lines, which are read as the
+ * observations of a Sensor without a header, so empty labels are skipped and
+ * the last label does not need a trailing delimiter.
+ *
+ * @param filepath The path to the labels file.
+ * @param delimiter The delimiter which separates the labels.
+ * @param output The labels will be saved here as a new Scene, or NULL if the
+ * file cannot be read. If NULL, nothing will happen.
+ */
+void sensor_read_labels(const char *const filepath, const char delimiter,
+                        Scene **const restrict output) {
+  if (!output) {
+    return;
+  }
+
+  *output = NULL;
+  Sensor *sensor = sensor_constructor_from_file(filepath, delimiter, false,
+                                                false);
+  if (!sensor) {
+    return;
+  }
+  if (sensor->environment->encoded) {
+    sensor_get_labels(sensor, output);
+    sensor_destructor(&sensor);
+    return;
+  }
+
+  *output = scene_constructor(true);
+  const size_t total_observations = sensor_get_total_observations(sensor);
+  Scene *observation = NULL;
+  Literal *literal;
+  size_t i;
+  unsigned int j;
+  for (i = 0; i < total_observations; ++i) {
+    sensor_get_scene_at(sensor, i, &observation);
+    for (j = 0; j < observation->size; ++j) {
+      literal_copy(&literal, observation->literals[j]);
+      scene_add_literal(*output, &literal);
     }
-    return total_observations;
+    scene_destructor(&observation);
+  }
+  sensor_destructor(&sensor);
+}
+
+/**
+ * @brief Finds the total observations in the environment. It is answered from
+ * the Sensor's line-offset index, without reading the file.
+ *
+ * @param sensor The sensor to get the total observations from.
+ *
+ * @return The number of total observations, or -1 if the sensor is NULL.
+ */
+size_t sensor_get_total_observations(const Sensor *const sensor) {
+  if (sensor && sensor->environment) {
+    return sensor->environment->number_of_observations;
   }
 
   return -1;
 }
 
+/**
+ * @brief Gets the Scene of the observation with the given index from a Sensor.
+ * It does not affect the Scenes given by sensor_get_next_scene. If the Sensor
+ * is cached, the Scene is built from its cache.
+ *
+ * @param sensor The Sensor to extract the Scene. If NULL, nothing will happen.
+ * @param index The index of the observation, starting from 0 (after the
+ * header). If it is not less than sensor_get_total_observations, nothing will
+ * happen.
+ * @param output The Scene that will be extracted will be saved here. If NULL,
+ * nothing will happen.
+ */
+void sensor_get_scene_at(const Sensor *const sensor, const size_t index,
+                         Scene **const restrict output) {
+  if (!(sensor && sensor->environment && output) ||
+      (index >= sensor->environment->number_of_observations)) {
+    return;
+  }
+
+  const SensorEnvironment *const environment = sensor->environment;
+  *output = scene_constructor(true);
+
+  size_t i;
+  Literal *literal;
+  if (environment->cache_offsets) {
+    for (i = environment->cache_offsets[index];
+         i < environment->cache_offsets[index + 1]; ++i) {
+      literal = literal_constructor_from_id(environment->cache_literals[i] >> 1,
+                                            environment->cache_literals[i] & 1);
+      scene_add_literal(*output, &literal);
+      literal_destructor(&literal);
+    }
+    return;
+  }
+
+  const char *const data = environment->data;
+  const size_t line_start = environment->offsets[index];
+  size_t line_end = environment->offsets[index + 1];
+  if (data[line_end - 1] == '\n') {
+    --line_end;
+  }
+
+  size_t token_start = line_start, column = 0;
+  for (i = line_start; i <= line_end; ++i) {
+    if ((i == line_end) || (data[i] == sensor->delimiter)) {
+      if (i > token_start) {
+        _sensor_add_literal(sensor, *output, column, data + token_start,
+                            i - token_start);
+      }
+      token_start = i + 1;
+      ++column;
+    }
+  }
+}
+
 /**
  * @brief Gets the next Scene from a Sensor.
  *
@@ -150,77 +948,216 @@ size_t sensor_get_total_observations(const Sensor *const sensor) {
 void sensor_get_next_scene(const Sensor *const sensor,
                            Scene **const restrict output) {
   if (sensor && output) {
-    if (sensor->environment) {
-      int c = fgetc(sensor->environment);
-
-      if (c == EOF) {
-        if (sensor->reuse) {
-          fseek(sensor->environment, 0, SEEK_SET);
-          if (sensor->header) {
-            while ((c = fgetc(sensor->environment)) != '\n')
-              ;
-          }
-          c = fgetc(sensor->environment);
+    SensorEnvironment *const environment = sensor->environment;
+    if (environment) {
+      if (environment->next >= environment->number_of_observations) {
+        if (sensor->reuse && (environment->number_of_observations > 0)) {
+          environment->next = 0;
         } else {
           return;
         }
       }
 
-      *output = scene_constructor(true);
-
-      size_t buffer_size = BUFFER_SIZE;
-      char *buffer = (char *)malloc(buffer_size * sizeof(char));
-      memset(buffer, 0, buffer_size);
-      unsigned int i = 0, read_literals = 0;
-      Literal *literal = NULL;
-      bool end_of_line = false;
+      sensor_get_scene_at(sensor, environment->next++, output);
+    }
+  }
+}
 
-      while (!end_of_line) {
-        if (c != sensor->delimiter) {
-          if (i + 1 == buffer_size) {
-            buffer_size *= 2;
-            buffer = (char *)realloc(buffer, buffer_size);
-          }
+/**
+ * @brief Gets the Literals observed in each header column of a Sensor, in the
+ * order they were first observed. The column of each Literal is the one it was
+ * parsed from, so the observations are read once and no string is compared.
+ *
+ * @param sensor The Sensor to get the columns' Literals from. If NULL, or if it
+ * does not have a header, nothing will happen.
+ * @param output The header_size Scenes of the columns will be saved here, as a
+ * new Scene **. Deallocate each Scene using scene_destructor and the array
+ * using free. If NULL, nothing will happen.
+ */
+void sensor_get_column_values(const Sensor *const sensor,
+                              Scene ***const output) {
+  if (!(sensor && sensor->environment && sensor->header && output)) {
+    return;
+  }
 
-          buffer[i++] = (char)c;
-        } else {
-        save_literal:
-          if (strlen(buffer) != 0) {
-            if (sensor->header) {
-              size_t header_size = strlen(sensor->header[read_literals]);
-              if (i + header_size + 1 >= buffer_size) {
-                buffer_size *= 2;
-                buffer = (char *)realloc(buffer, buffer_size);
-              }
-
-              memcpy((buffer + header_size + 1), buffer, strlen(buffer));
-              memcpy(buffer, sensor->header[read_literals], header_size);
-              memcpy(buffer + header_size, "_", 1);
-            }
-
-            literal = literal_constructor_from_string(buffer);
-            scene_add_literal(*output, &literal);
-            memset(buffer, 0, buffer_size);
-            i = 0;
-          }
-
-          if (end_of_line) {
-            goto end_literal_loop;
-          }
-
-          ++read_literals;
-        }
+  const SensorEnvironment *const environment = sensor->environment;
+  *output = (Scene **)malloc(sensor->header_size * sizeof(Scene *));
+  size_t i, j;
+  for (i = 0; i < sensor->header_size; ++i) {
+    (*output)[i] = scene_constructor(true);
+  }
 
-        c = fgetc(sensor->environment);
+  Scene *observation = NULL;
+  Literal *copy;
+  unsigned int id;
+  for (i = 0; i < environment->number_of_observations; ++i) {
+    sensor_get_scene_at(sensor, i, &observation);
+    for (j = 0; j < observation->size; ++j) {
+      id = observation->literals[j]->id;
+      if ((id < environment->atom_columns_size) &&
+          (environment->atom_columns[id] != UINT32_MAX)) {
+        literal_copy(&copy, observation->literals[j]);
+        scene_add_literal((*output)[environment->atom_columns[id]], &copy);
+        literal_destructor(&copy);
+      }
+    }
+    scene_destructor(&observation);
+  }
+}
 
-        if ((c == EOF) || (c == '\n')) {
-          end_of_line = true;
-          goto save_literal;
-        }
-      end_literal_loop:
+/**
+ * @brief Writes the observations with the given indices to the given file, in
+ * the format of the Sensor's file. A text file keeps its header, and an
+ * encoded file keeps its labels, vocabulary and columns.
+ */
+static void _sensor_write_observations(const Sensor *const sensor,
+                                       const unsigned int *const indices,
+                                       const size_t total_indices,
+                                       FILE *const file) {
+  const SensorEnvironment *const environment = sensor->environment;
+  size_t i;
+  if (!environment->encoded) {
+    if (sensor->header) {
+      fwrite(environment->data, sizeof(char), environment->offsets[0], file);
+    }
+    size_t line_start, line_end;
+    for (i = 0; i < total_indices; ++i) {
+      line_start = environment->offsets[indices[i]];
+      line_end = environment->offsets[indices[i] + 1];
+      fwrite(environment->data + line_start, sizeof(char),
+             line_end - line_start, file);
+      if (environment->data[line_end - 1] != '\n') {
+        fputc('\n', file);
       }
+    }
+    return;
+  }
+
+  const uint64_t *offsets;
+  const uint32_t *literals, *labels, *columns;
+  const char *strings;
+  _sensor_encoding_sections(environment->data, &offsets, &literals, &labels,
+                            &columns, &strings);
+
+  SensorEncodingHeader header;
+  memcpy(&header, environment->data, sizeof(SensorEncodingHeader));
+  header.number_of_observations = total_indices;
+  header.number_of_literals = 0;
+  for (i = 0; i < total_indices; ++i) {
+    header.number_of_literals +=
+        offsets[indices[i] + 1] - offsets[indices[i]];
+  }
+  fwrite(&header, sizeof(SensorEncodingHeader), 1, file);
+
+  uint64_t offset = 0;
+  fwrite(&offset, sizeof(uint64_t), 1, file);
+  for (i = 0; i < total_indices; ++i) {
+    offset += offsets[indices[i] + 1] - offsets[indices[i]];
+    fwrite(&offset, sizeof(uint64_t), 1, file);
+  }
+  for (i = 0; i < total_indices; ++i) {
+    fwrite(literals + offsets[indices[i]], sizeof(uint32_t),
+           offsets[indices[i] + 1] - offsets[indices[i]], file);
+  }
+  fwrite(labels, sizeof(char),
+         environment->data + environment->size - (const char *)labels, file);
+}
+
+/**
+ * @brief Splits the given dataset into a train and a test streams. The
+ * observations are copied using the Sensor's line-offset index, so the dataset
+ * is not scanned again.
+ *
+ * @param dataset The Sensor of the initial dataset. If it has a header, it is
+ * written in both splits. If it is an encoded file, both splits are encoded
+ * files too.
+ * @param test_ratio A float indicating the ratio of the testing dataset, given
+ * the dataset's size.
+ * @param generator A pcg32_random_t pointer to an RNG.
+ * @param train_path A string containing the filename location to save the
+ * training dataset. If NULL, the train will contain a tmpfile.
+ * @param test_path A string containing the filename location to save the
+ * testing dataset. If NULL, the test parameter will contain a tmpfile.
+ * @param train A double pointer - reference to a FILE * - &(FILE *) - to save
+ * the training dataset. If NULL, the training split will not be saved.
+ * @param test A double pointer - reference to a FILE * - &(FILE *) - to save
+ * the testing dataset. If NULL, the testing split will not be saved.
+ *
+ * @return 0 if the process was successful, -1 if the given train_path was
+ * incorrect and the train dataset was saved in a tmpfile, -2 if the given
+ * test_path was incorrect and the test dataset was saved in a tmpfile, -3 if
+ * both were incorrect, or -4 if the dataset or the generator is NULL.
+ */
+int train_test_split(const Sensor *const dataset, const float test_ratio,
+                     pcg32_random_t *generator, const char *const train_path,
+                     const char *const test_path, FILE **train, FILE **test) {
+  if (!(dataset && dataset->environment && generator)) {
+    return -4;
+  }
+
+  FILE *train_ = NULL, *test_ = NULL;
+  int error_code = 0;
+
+  if (train_path) {
+    train_ = fopen(train_path, "wb+");
+    if (!train_) {
+      error_code = -1;
+      train_ = tmpfile();
+    }
+  } else {
+    train_ = tmpfile();
+  }
 
-      free(buffer);
+  if (test_path) {
+    test_ = fopen(test_path, "wb+");
+    if (!test_) {
+      error_code += -2;
+      test_ = tmpfile();
     }
+  } else {
+    test_ = tmpfile();
   }
+
+  const size_t dataset_size = dataset->environment->number_of_observations,
+               test_size = roundf(dataset_size * test_ratio);
+  unsigned int *possible_indices =
+      (unsigned int *)malloc(dataset_size * sizeof(int));
+  unsigned int *chosen_indices =
+      (unsigned int *)malloc(dataset_size * sizeof(int));
+
+  unsigned int i;
+  for (i = 0; i < dataset_size; ++i) {
+    possible_indices[i] = i;
+  }
+
+  // The first test_size chosen observations are the test split, and the rest
+  // are the train split.
+  int chosen_index;
+  size_t remaining = dataset_size;
+  for (i = 0; i < dataset_size; ++i) {
+    chosen_index = pcg32_random_r(generator) % remaining--;
+    chosen_indices[i] = possible_indices[chosen_index];
+    possible_indices[chosen_index] = possible_indices[remaining];
+  }
+
+  _sensor_write_observations(dataset, chosen_indices, test_size, test_);
+  _sensor_write_observations(dataset, chosen_indices + test_size,
+                             dataset_size - test_size, train_);
+
+  free(chosen_indices);
+  free(possible_indices);
+
+  if (train) {
+    *train = train_;
+  } else {
+    fclose(train_);
+  }
+
+  if (test) {
+    *test = test_;
+  } else {
+    fclose(test_);
+  }
+
+  return error_code;
 }
@@ -1,3 +1,4 @@
+#include <pcg_variants.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -8,9 +9,13 @@
 #define SENSOR_H
 
 #define BUFFER_SIZE 256
+#define SENSOR_INDEX_EXTENSION ".idx"
+#define SENSOR_ENCODED_EXTENSION ".nde"
+
+typedef struct SensorEnvironment SensorEnvironment;
 
 typedef struct Sensor {
-  FILE *environment;
+  SensorEnvironment *environment;
   char *filepath, **header;
   char delimiter;
   bool reuse;
@@ -21,8 +26,24 @@ Sensor *sensor_constructor_from_file(const char *const filepath,
                                      const char delimiter, const bool reuse,
                                      const bool header);
 void sensor_destructor(Sensor **const sensor);
+int sensor_save_index(const Sensor *const sensor);
+int sensor_cache(const Sensor *const sensor);
+int sensor_encode(const Sensor *const sensor, const Scene *const labels,
+                  const char *const filepath);
+bool sensor_is_encoded(const char *const filepath);
+void sensor_get_labels(const Sensor *const sensor,
+                       Scene **const restrict output);
+void sensor_read_labels(const char *const filepath, const char delimiter,
+                        Scene **const restrict output);
 size_t sensor_get_total_observations(const Sensor *const sensor);
+void sensor_get_scene_at(const Sensor *const sensor, const size_t index,
+                         Scene **const restrict output);
 void sensor_get_next_scene(const Sensor *const sensor,
                            Scene **const restrict output);
+void sensor_get_column_values(const Sensor *const sensor,
+                              Scene ***const output);
+int train_test_split(const Sensor *const dataset, const float test_ratio,
+                     pcg32_random_t *generator, const char *const train_path,
+                     const char *const test_path, FILE **train, FILE **test);
 
 #endif
@@ -0,0 +1,263 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "nerd_utils.h"
+#include "snapshot_writer.h"
+
+#define FNV_OFFSET_BASIS 14695981039346656037ULL
+#define FNV_PRIME 1099511628211ULL
+
+/**
+ * @brief A snapshot waiting to be written.
+ */
+typedef struct SnapshotJob {
+  NerdSnapshot *snapshot;
+  char *filepath;
+  bool binary;
+} SnapshotJob;
+
+/**
+ * @brief Writes the submitted snapshots in a background thread. The jobs are
+ * kept in a bounded ring buffer; submitting to a full one blocks until the
+ * thread catches up.
+ */
+struct SnapshotWriter {
+  pthread_t thread;
+  pthread_mutex_t mutex;
+  pthread_cond_t not_empty, not_full;
+  SnapshotJob *jobs;
+  size_t capacity, head, size, total_failed;
+  bool stopping;
+};
+
+/**
+ * @brief Constructs a SnapshotCadence.
+ *
+ * @param type One of SNAPSHOT_CADENCE_INSTANCES, SNAPSHOT_CADENCE_ITERATION or
+ * SNAPSHOT_CADENCE_ACTIVE_CHANGE.
+ * @param instances The number of instances between two snapshots. It is only
+ * used with SNAPSHOT_CADENCE_INSTANCES and it should be > 0.
+ *
+ * @return A new SnapshotCadence *, or NULL if the type is unknown or instances
+ * is 0 with SNAPSHOT_CADENCE_INSTANCES. Use snapshot_cadence_destructor to
+ * deallocate.
+ */
+SnapshotCadence *snapshot_cadence_constructor(const unsigned int type,
+                                              const size_t instances) {
+  if ((type > SNAPSHOT_CADENCE_ACTIVE_CHANGE) ||
+      ((type == SNAPSHOT_CADENCE_INSTANCES) && (instances == 0))) {
+    return NULL;
+  }
+
+  SnapshotCadence *cadence =
+      (SnapshotCadence *)malloc(sizeof(SnapshotCadence));
+  cadence->type = type;
+  cadence->instances = instances;
+  cadence->active_hash = 0;
+  cadence->has_active_hash = false;
+  return cadence;
+}
+
+/**
+ * @brief Destructs a SnapshotCadence.
+ *
+ * @param cadence The SnapshotCadence to be destructed. It should be a reference
+ * to the struct's pointer (to a SnapshotCadence *).
+ */
+void snapshot_cadence_destructor(SnapshotCadence **const cadence) {
+  if (cadence) {
+    safe_free(*cadence);
+  }
+}
+
+/**
+ * @brief Checks whether a snapshot is due after the given instance has been
+ * learnt. With SNAPSHOT_CADENCE_ACTIVE_CHANGE the first call is always due.
+ *
+ * @param cadence The SnapshotCadence to be used.
+ * @param nerd The Nerd that has learnt the instance.
+ * @param instance The instance of the current iteration, starting from 1.
+ * @param total_instances The total number of instances of an iteration.
+ *
+ * @return true if a snapshot should be saved, false otherwise or if one of the
+ * pointers is NULL.
+ */
+bool snapshot_cadence_is_due(SnapshotCadence *const cadence,
+                             const Nerd *const nerd, const size_t instance,
+                             const size_t total_instances) {
+  if (!(cadence && nerd)) {
+    return false;
+  }
+
+  switch (cadence->type) {
+  case SNAPSHOT_CADENCE_INSTANCES:
+    return (instance % cadence->instances) == 0;
+  case SNAPSHOT_CADENCE_ITERATION:
+    return instance == total_instances;
+  }
+
+  const RuleQueue *const active = nerd->knowledge_base->active;
+  uint64_t hash = FNV_OFFSET_BASIS ^ active->length;
+  unsigned int i;
+  for (i = 0; i < active->length; ++i) {
+    hash = (hash ^ active->rules[i]->fingerprint) * FNV_PRIME;
+  }
+
+  if (cadence->has_active_hash && (hash == cadence->active_hash)) {
+    return false;
+  }
+  cadence->active_hash = hash;
+  cadence->has_active_hash = true;
+  return true;
+}
+
+/**
+ * @brief The body of the writer's thread. It writes the jobs in the order they
+ * were submitted, until the writer is stopped and there are no jobs left.
+ */
+static void *_snapshot_writer_run(void *argument) {
+  SnapshotWriter *const writer = (SnapshotWriter *)argument;
+  SnapshotJob job;
+
+  while (true) {
+    pthread_mutex_lock(&(writer->mutex));
+    while ((writer->size == 0) && !writer->stopping) {
+      pthread_cond_wait(&(writer->not_empty), &(writer->mutex));
+    }
+    if (writer->size == 0) {
+      pthread_mutex_unlock(&(writer->mutex));
+      break;
+    }
+    job = writer->jobs[writer->head];
+    writer->head = (writer->head + 1) % writer->capacity;
+    --(writer->size);
+    pthread_cond_signal(&(writer->not_full));
+    pthread_mutex_unlock(&(writer->mutex));
+
+    const int error_code =
+        job.binary ? nerd_snapshot_to_binary_file(job.snapshot, job.filepath)
+                   : nerd_snapshot_to_file(job.snapshot, job.filepath);
+    nerd_snapshot_destructor(&(job.snapshot));
+    free(job.filepath);
+
+    if (error_code != 0) {
+      pthread_mutex_lock(&(writer->mutex));
+      ++(writer->total_failed);
+      pthread_mutex_unlock(&(writer->mutex));
+    }
+  }
+
+  return NULL;
+}
+
+/**
+ * @brief Constructs a SnapshotWriter and starts its thread.
+ *
+ * @param capacity The maximum number of snapshots that can wait to be written.
+ * It should be > 0.
+ *
+ * @return A new SnapshotWriter *, or NULL if the capacity is 0 or the thread
+ * could not be started. Use snapshot_writer_destructor to deallocate.
+ */
+SnapshotWriter *snapshot_writer_constructor(const size_t capacity) {
+  if (capacity == 0) {
+    return NULL;
+  }
+
+  SnapshotWriter *writer = (SnapshotWriter *)malloc(sizeof(SnapshotWriter));
+  writer->jobs = (SnapshotJob *)malloc(capacity * sizeof(SnapshotJob));
+  writer->capacity = capacity;
+  writer->head = 0;
+  writer->size = 0;
+  writer->total_failed = 0;
+  writer->stopping = false;
+  pthread_mutex_init(&(writer->mutex), NULL);
+  pthread_cond_init(&(writer->not_empty), NULL);
+  pthread_cond_init(&(writer->not_full), NULL);
+
+  if (pthread_create(&(writer->thread), NULL, _snapshot_writer_run, writer) !=
+      0) {
+    pthread_cond_destroy(&(writer->not_full));
+    pthread_cond_destroy(&(writer->not_empty));
+    pthread_mutex_destroy(&(writer->mutex));
+    free(writer->jobs);
+    free(writer);
+    return NULL;
+  }
+
+  return writer;
+}
+
+/**
+ * @brief Destructs a SnapshotWriter. It waits until every submitted snapshot
+ * has been written.
+ *
+ * @param writer The SnapshotWriter to be destructed. It should be a reference
+ * to the struct's pointer (to a SnapshotWriter *).
+ *
+ * @return 0 if every snapshot was written, -1 if at least one could not be
+ * written and -2 if the writer is NULL.
+ */
+int snapshot_writer_destructor(SnapshotWriter **const writer) {
+  if (!(writer && (*writer))) {
+    return -2;
+  }
+
+  pthread_mutex_lock(&((*writer)->mutex));
+  (*writer)->stopping = true;
+  pthread_cond_signal(&((*writer)->not_empty));
+  pthread_mutex_unlock(&((*writer)->mutex));
+  pthread_join((*writer)->thread, NULL);
+
+  const int error_code = ((*writer)->total_failed == 0) ? 0 : -1;
+  pthread_cond_destroy(&((*writer)->not_full));
+  pthread_cond_destroy(&((*writer)->not_empty));
+  pthread_mutex_destroy(&((*writer)->mutex));
+  free((*writer)->jobs);
+  safe_free(*writer);
+  return error_code;
+}
+
+/**
+ * @brief Hands a NerdSnapshot to the writer's thread. If the writer already
+ * holds 'capacity' snapshots, it blocks until one of them has been written.
+ *
+ * @param writer The SnapshotWriter to write the snapshot.
+ * @param snapshot The NerdSnapshot to be written. It should be a reference to
+ * the struct's pointer (to a NerdSnapshot *). The writer takes its ownership,
+ * and it will be set to NULL.
+ * @param filepath The path and name of the file to save it.
+ * @param binary Whether the snapshot should be saved in the binary format
+ * (.ndb) instead of the text one (.nd).
+ *
+ * @return 0 if the snapshot was submitted, or -2 if one of the arguments is
+ * NULL.
+ */
+int snapshot_writer_submit(SnapshotWriter *const writer,
+                           NerdSnapshot **const snapshot,
+                           const char *const filepath, const bool binary) {
+  if (!(writer && snapshot && (*snapshot) && filepath)) {
+    return -2;
+  }
+
+  char *const filepath_copy = strdup(filepath);
+
+  pthread_mutex_lock(&(writer->mutex));
+  while (writer->size == writer->capacity) {
+    pthread_cond_wait(&(writer->not_full), &(writer->mutex));
+  }
+  SnapshotJob *const job =
+      &(writer->jobs[(writer->head + writer->size) % writer->capacity]);
+  job->snapshot = *snapshot;
+  job->filepath = filepath_copy;
+  job->binary = binary;
+  ++(writer->size);
+  pthread_cond_signal(&(writer->not_empty));
+  pthread_mutex_unlock(&(writer->mutex));
+
+  *snapshot = NULL;
+  return 0;
+}
@@ -0,0 +1,45 @@
+#ifndef SNAPSHOT_WRITER_H
+#define SNAPSHOT_WRITER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "nerd.h"
+
+#define SNAPSHOT_WRITER_DEFAULT_CAPACITY 8
+
+#define SNAPSHOT_CADENCE_INSTANCES 0
+#define SNAPSHOT_CADENCE_ITERATION 1
+#define SNAPSHOT_CADENCE_ACTIVE_CHANGE 2
+
+typedef struct SnapshotWriter SnapshotWriter;
+
+/**
+ * @brief Decides when the learnt Nerd should be saved. With
+ * SNAPSHOT_CADENCE_INSTANCES it is due every 'instances' instances of an
+ * iteration, with SNAPSHOT_CADENCE_ITERATION at the last instance of each
+ * iteration, and with SNAPSHOT_CADENCE_ACTIVE_CHANGE whenever the active Rules
+ * (or their priority order) differ from the ones of the last due snapshot.
+ */
+typedef struct SnapshotCadence {
+  unsigned int type;
+  size_t instances;
+  uint64_t active_hash;
+  bool has_active_hash;
+} SnapshotCadence;
+
+SnapshotCadence *snapshot_cadence_constructor(const unsigned int type,
+                                              const size_t instances);
+void snapshot_cadence_destructor(SnapshotCadence **const cadence);
+bool snapshot_cadence_is_due(SnapshotCadence *const cadence,
+                             const Nerd *const nerd, const size_t instance,
+                             const size_t total_instances);
+
+SnapshotWriter *snapshot_writer_constructor(const size_t capacity);
+int snapshot_writer_destructor(SnapshotWriter **const writer);
+int snapshot_writer_submit(SnapshotWriter *const writer,
+                           NerdSnapshot **const snapshot,
+                           const char *const filepath, const bool binary);
+
+#endif
@@ -19,7 +19,11 @@
     const Rule *const _r2 = (Y);                                               \
     ck_assert_ptr_nonnull(_r1);                                                \
     ck_assert_ptr_nonnull(_r2);                                                \
-    ck_assert_scene_eq(_r1->body, _r2->body);                                  \
+    unsigned int i;                                                            \
+    ck_assert_int_eq(_r1->body.size, _r2->body.size);                          \
+    for (i = 0; i < _r1->body.size; ++i) {                                     \
+      ck_assert_literal_eq(_r1->body.literals[i], _r2->body.literals[i]);      \
+    }                                                                          \
     ck_assert_literal_eq(_r1->head, _r2->head);                                \
     ck_assert_float_eq_tol(_r1->weight, _r2->weight, 0.000001);                \
   } while (0)
@@ -28,7 +32,7 @@
   do {                                                                         \
     const Rule *const _r = (X);                                                \
     ck_assert_ptr_nonnull(_r);                                                 \
-    _ck_assert_scene_empty(_r->body, OP);                                      \
+    _ck_assert_int(_r->body.size, OP, 0);                                      \
     _ck_assert_literal_empty(_r->head, OP);                                    \
     _ck_assert_floating(_r->weight, OP, INFINITY, float, "");                  \
   } while (0)
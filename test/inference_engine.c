@@ -0,0 +1,333 @@
+#include <check.h>
+#include <stdlib.h>
+
+#include "../src/context.h"
+#include "../src/inference_engine.h"
+#include "../src/knowledge_base.h"
+
+#define CONSTRAINTS "../test/data/inference_constraints.txt"
+
+/**
+ * @brief Adds the Rule 'body_atom implies head' to the KnowledgeBase. The
+ * Rules will be active in the order that they are added.
+ */
+void add_rule(KnowledgeBase *const knowledge_base, const char *const body_atom,
+              const char *const head_string) {
+  Literal *body = literal_constructor_from_string(body_atom),
+          *head = literal_constructor_from_string(head_string);
+  Rule *rule = rule_constructor(1, &body, &head, 1.0, true);
+  knowledge_base_add_rule(knowledge_base, &rule);
+}
+
+/**
+ * @brief Constructs a Context from the given Literal strings.
+ */
+Context *create_context(const unsigned int size, const char *literals[]) {
+  Context *context = context_constructor(true);
+  Literal *literal;
+  unsigned int i;
+  for (i = 0; i < size; ++i) {
+    literal = literal_constructor_from_string(literals[i]);
+    context_add_literal(context, &literal);
+  }
+  return context;
+}
+
+START_TEST(settings_test) {
+  ck_assert_int_eq(native_settings_destructor(), 1);
+  ck_assert_int_eq(native_settings_constructor(NULL), 0);
+  ck_assert_ptr_nonnull(global_native_settings);
+  ck_assert_int_eq(native_settings_constructor(CONSTRAINTS), 0);
+  ck_assert_int_eq(native_settings_constructor("filethatdoesntexist.txt"), 2);
+  ck_assert_int_eq(native_settings_destructor(), 0);
+  ck_assert_ptr_null(global_native_settings);
+}
+END_TEST
+
+START_TEST(inference_test) {
+  KnowledgeBase *knowledge_base = knowledge_base_constructor(0.0, true);
+  const char *observation1[] = {"wings"}, *observation2[] = {"wings", "penguin"},
+             *observation3[] = {"bird", "-fly"};
+  Context *context = create_context(1, observation1);
+  Scene *inference = NULL;
+
+  native_inference(knowledge_base, context, &inference);
+  ck_assert_int_eq(inference->size, 0);
+  scene_destructor(&inference);
+
+  add_rule(knowledge_base, "penguin", "-fly");
+  add_rule(knowledge_base, "bird", "fly");
+  add_rule(knowledge_base, "wings", "bird");
+
+  native_inference(knowledge_base, context, &inference);
+  ck_assert_int_eq(inference->size, 2);
+  ck_assert_str_eq(inference->literals[0]->atom, "bird");
+  ck_assert_str_eq(inference->literals[1]->atom, "fly");
+  ck_assert_int_eq(inference->literals[1]->sign, true);
+  scene_destructor(&inference);
+  context_destructor(&context);
+
+  context = create_context(2, observation2);
+  native_inference(knowledge_base, context, &inference);
+  ck_assert_int_eq(inference->size, 2);
+  ck_assert_str_eq(inference->literals[0]->atom, "bird");
+  ck_assert_str_eq(inference->literals[1]->atom, "fly");
+  ck_assert_int_eq(inference->literals[1]->sign, false);
+  scene_destructor(&inference);
+  context_destructor(&context);
+
+  context = create_context(2, observation3);
+  native_inference(knowledge_base, context, &inference);
+  ck_assert_int_eq(inference->size, 0);
+  scene_destructor(&inference);
+  context_destructor(&context);
+  knowledge_base_destructor(&knowledge_base);
+
+  knowledge_base = knowledge_base_constructor(0.0, true);
+  add_rule(knowledge_base, "bird", "fly");
+  add_rule(knowledge_base, "penguin", "-fly");
+  context = create_context(2, (const char *[]){"bird", "penguin"});
+  native_inference(knowledge_base, context, &inference);
+  ck_assert_int_eq(inference->size, 1);
+  ck_assert_str_eq(inference->literals[0]->atom, "fly");
+  ck_assert_int_eq(inference->literals[0]->sign, true);
+  scene_destructor(&inference);
+
+  native_inference(NULL, context, &inference);
+  ck_assert_ptr_null(inference);
+  native_inference(knowledge_base, NULL, &inference);
+  ck_assert_ptr_null(inference);
+  native_inference(knowledge_base, context, NULL);
+
+  context_destructor(&context);
+  knowledge_base_destructor(&knowledge_base);
+}
+END_TEST
+
+START_TEST(constraints_test) {
+  KnowledgeBase *knowledge_base = knowledge_base_constructor(0.0, true);
+  add_rule(knowledge_base, "bird", "fly");
+  add_rule(knowledge_base, "fish", "swim");
+  Context *context = create_context(2, (const char *[]){"bird", "fish"});
+  Scene *inference = NULL;
+
+  native_inference(knowledge_base, context, &inference);
+  ck_assert_int_eq(inference->size, 2);
+  scene_destructor(&inference);
+
+  native_settings_constructor(CONSTRAINTS);
+  native_inference(knowledge_base, context, &inference);
+  ck_assert_int_eq(inference->size, 1);
+  ck_assert_str_eq(inference->literals[0]->atom, "fly");
+  scene_destructor(&inference);
+  context_destructor(&context);
+
+  add_rule(knowledge_base, "wings", "-bird");
+  context = create_context(1, (const char *[]){"wings"});
+  native_inference(knowledge_base, context, &inference);
+  ck_assert_int_eq(inference->size, 0);
+  scene_destructor(&inference);
+  native_settings_destructor();
+
+  native_inference(knowledge_base, context, &inference);
+  ck_assert_int_eq(inference->size, 1);
+  ck_assert_str_eq(inference->literals[0]->atom, "bird");
+  ck_assert_int_eq(inference->literals[0]->sign, false);
+  scene_destructor(&inference);
+
+  context_destructor(&context);
+  knowledge_base_destructor(&knowledge_base);
+}
+END_TEST
+
+START_TEST(inference_batch_test) {
+  KnowledgeBase *knowledge_base = knowledge_base_constructor(0.0, true);
+  add_rule(knowledge_base, "penguin", "-fly");
+  add_rule(knowledge_base, "bird", "fly");
+  add_rule(knowledge_base, "wings", "bird");
+
+  Scene *observations[3] = {create_context(1, (const char *[]){"wings"}),
+                            create_context(2,
+                                           (const char *[]){"wings", "penguin"}),
+                            context_constructor(true)},
+        **inferences = NULL;
+  char *rules = NULL;
+
+  ck_assert_int_eq(native_inference_batch(knowledge_base, 0, observations,
+                                          &inferences, NULL),
+                   3);
+  ck_assert_int_eq(
+      native_inference_batch(knowledge_base, 3, NULL, &inferences, NULL), 4);
+  ck_assert_int_eq(
+      native_inference_batch(NULL, 3, observations, &inferences, NULL), 5);
+
+  ck_assert_int_eq(native_inference_batch(knowledge_base, 3, observations,
+                                          &inferences, &rules),
+                   0);
+  ck_assert_int_eq(inferences[0]->size, 2);
+  ck_assert_int_eq(inferences[1]->size, 2);
+  ck_assert_int_eq(inferences[2]->size, 0);
+  ck_assert_str_eq(rules, "2: {\nwings: []\nbird: [Rule2 :: wings implies "
+                          "bird;]\nfly: [Rule1 :: bird implies fly;]\n}\n\n"
+                          "3: {\nwings: []\npenguin: []\nbird: [Rule2 :: wings "
+                          "implies bird;]\n-fly: [Rule0 :: penguin implies "
+                          "-fly;]\n}\n\n4: {}");
+
+  unsigned int i;
+  for (i = 0; i < 3; ++i) {
+    scene_destructor(&(inferences[i]));
+    scene_destructor(&(observations[i]));
+  }
+  free(inferences);
+  free(rules);
+  knowledge_base_destructor(&knowledge_base);
+}
+END_TEST
+
+/**
+ * @brief Checks that the incremental inference of the observations with the
+ * KnowledgeBase gives the same results as native_inference_batch, and that the
+ * expected number of observations has been re-inferred.
+ */
+void check_cached_inference(const KnowledgeBase *const knowledge_base,
+                            NativeInferenceCache *const cache,
+                            const size_t size, Scene **observations,
+                            const size_t expected_reinferred) {
+  Scene **inferences = NULL, **expected = NULL;
+  char *rules = NULL, *expected_rules = NULL;
+  size_t reinferred, i;
+
+  ck_assert_int_eq(
+      native_inference_cache_update(cache, knowledge_base, size), 0);
+  ck_assert_int_eq(native_inference_batch(knowledge_base, size, observations,
+                                          &expected, &expected_rules),
+                   0);
+  ck_assert_int_eq(native_inference_batch_cached(knowledge_base, cache, 0,
+                                                 size, observations,
+                                                 &inferences, &rules,
+                                                 &reinferred),
+                   0);
+  ck_assert_int_eq(reinferred, expected_reinferred);
+  ck_assert_str_eq(rules, expected_rules);
+  for (i = 0; i < size; ++i) {
+    ck_assert_int_eq(scene_number_of_similar_literals(inferences[i],
+                                                      expected[i]),
+                     expected[i]->size);
+    ck_assert_int_eq(inferences[i]->size, expected[i]->size);
+    scene_destructor(&(inferences[i]));
+    scene_destructor(&(expected[i]));
+  }
+  free(inferences);
+  free(expected);
+  free(rules);
+  free(expected_rules);
+}
+
+START_TEST(inference_cached_test) {
+  KnowledgeBase *knowledge_bases[4];
+  unsigned int i;
+  for (i = 0; i < 4; ++i) {
+    knowledge_bases[i] = knowledge_base_constructor(0.0, true);
+  }
+  add_rule(knowledge_bases[0], "penguin", "-fly");
+  add_rule(knowledge_bases[0], "bird", "fly");
+  add_rule(knowledge_bases[0], "wings", "bird");
+
+  add_rule(knowledge_bases[1], "penguin", "-fly");
+  add_rule(knowledge_bases[1], "bird", "fly");
+  add_rule(knowledge_bases[1], "wings", "bird");
+  add_rule(knowledge_bases[1], "stone", "-wings");
+
+  add_rule(knowledge_bases[2], "bird", "fly");
+  add_rule(knowledge_bases[2], "wings", "bird");
+  add_rule(knowledge_bases[2], "stone", "-wings");
+
+  add_rule(knowledge_bases[3], "wings", "bird");
+  add_rule(knowledge_bases[3], "bird", "fly");
+  add_rule(knowledge_bases[3], "stone", "-wings");
+
+  Scene *observations[4] = {
+      create_context(1, (const char *[]){"wings"}),
+      create_context(2, (const char *[]){"wings", "penguin"}),
+      create_context(1, (const char *[]){"stone"}), context_constructor(true)},
+        **inferences = NULL;
+  NativeInferenceCache *cache = native_inference_cache_constructor();
+  ck_assert_ptr_nonnull(cache);
+
+  ck_assert_int_eq(native_inference_batch_cached(knowledge_bases[0], cache, 0,
+                                                 4, observations, &inferences,
+                                                 NULL, NULL),
+                   6);
+  // All the observations are inferred the first time.
+  check_cached_inference(knowledge_bases[0], cache, 4, observations, 4);
+  check_cached_inference(knowledge_bases[0], cache, 4, observations, 0);
+  // Only the observation with stone can use the added Rule.
+  check_cached_inference(knowledge_bases[1], cache, 4, observations, 1);
+  // Only the observation with penguin used the removed Rule, the rest have
+  // their Rule indices updated.
+  check_cached_inference(knowledge_bases[2], cache, 4, observations, 1);
+  // The priorities of the Rules used by the first two observations changed.
+  check_cached_inference(knowledge_bases[3], cache, 4, observations, 2);
+  // A different number of observations discards the cached inferences.
+  check_cached_inference(knowledge_bases[3], cache, 3, observations, 3);
+
+  ck_assert_int_eq(native_inference_batch_cached(knowledge_bases[3], cache, 2,
+                                                 2, observations, &inferences,
+                                                 NULL, NULL),
+                   6);
+  ck_assert_int_eq(native_inference_batch_cached(knowledge_bases[3], NULL, 0,
+                                                 2, observations, &inferences,
+                                                 NULL, NULL),
+                   6);
+  ck_assert_int_eq(native_inference_batch_cached(NULL, cache, 0, 2,
+                                                 observations, &inferences,
+                                                 NULL, NULL),
+                   5);
+  ck_assert_int_eq(native_inference_cache_update(NULL, knowledge_bases[3], 3),
+                   -1);
+  ck_assert_int_eq(native_inference_cache_update(cache, NULL, 3), -1);
+
+  native_inference_cache_destructor(&cache);
+  ck_assert_ptr_null(cache);
+  native_inference_cache_destructor(&cache);
+  native_inference_cache_destructor(NULL);
+
+  for (i = 0; i < 4; ++i) {
+    scene_destructor(&(observations[i]));
+    knowledge_base_destructor(&(knowledge_bases[i]));
+  }
+}
+END_TEST
+
+Suite *inference_engine_suite() {
+  Suite *suite;
+  TCase *settings_case, *inference_case;
+
+  suite = suite_create("Inference Engine");
+  settings_case = tcase_create("Settings");
+  tcase_add_test(settings_case, settings_test);
+  suite_add_tcase(suite, settings_case);
+
+  inference_case = tcase_create("Inference");
+  tcase_add_test(inference_case, inference_test);
+  tcase_add_test(inference_case, constraints_test);
+  tcase_add_test(inference_case, inference_batch_test);
+  tcase_add_test(inference_case, inference_cached_test);
+  suite_add_tcase(suite, inference_case);
+
+  return suite;
+}
+
+int main() {
+  Suite *suite = inference_engine_suite();
+  SRunner *s_runner;
+
+  s_runner = srunner_create(suite);
+  srunner_set_fork_status(s_runner, CK_NOFORK);
+
+  srunner_run_all(s_runner, CK_ENV);
+  int number_failed = srunner_ntests_failed(s_runner);
+  srunner_free(s_runner);
+
+  return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -16,6 +16,14 @@ START_TEST(construct_destruct_test) {
 
   ck_assert_float_eq_tol(knowledge_base->activation_threshold, 5.0, 0.00001);
   ck_assert_knowledge_base_empty(knowledge_base);
+
+  KnowledgeBase *other = knowledge_base_constructor(5.0, true);
+  ck_assert_uint_ne(knowledge_base->version, other->version);
+  const uint64_t version = other->version;
+  knowledge_base_mark_changed(other);
+  ck_assert_uint_ne(other->version, version);
+  knowledge_base_mark_changed(NULL);
+  knowledge_base_destructor(&other);
   ck_assert_rule_queue_empty(knowledge_base->active);
   ck_assert_rule_hypergraph_empty(knowledge_base->hypergraph);
 
@@ -39,11 +47,16 @@ START_TEST(add_rule_test) {
     rule_queue_enqueue(rule_queue3, &rule);
   }
 
+  uint64_t version;
   for (i = 0; i < rule_queue1->length; ++i) {
+    version = knowledge_base->version;
     ck_assert_int_eq(
         knowledge_base_add_rule(knowledge_base, &(rule_queue1->rules[i])), 1);
+    ck_assert_uint_ne(knowledge_base->version, version);
+    version = knowledge_base->version;
     ck_assert_int_eq(
         knowledge_base_add_rule(knowledge_base, &(rule_queue3->rules[i])), 0);
+    ck_assert_uint_eq(knowledge_base->version, version);
   }
   rule_queue_copy(&rule_queue2, rule_queue1);
   rule_queue_destructor(&rule_queue1);
@@ -204,8 +217,8 @@ START_TEST(create_new_rules_test) {
     total_labeled_head +=
         literal_equals(result->rules[i]->head, labels->literals[0]);
 
-    for (j = 0; j < result->rules[i]->body->size; ++j) {
-      ck_assert_literal_ne(result->rules[i]->body->literals[j],
+    for (j = 0; j < result->rules[i]->body.size; ++j) {
+      ck_assert_literal_ne(result->rules[i]->body.literals[j],
                            labels->literals[0]);
     }
   }
@@ -234,8 +247,8 @@ START_TEST(create_new_rules_test) {
     total_labeled_head +=
         literal_equals(result->rules[i]->head, labels->literals[0]);
 
-    for (j = 0; j < result->rules[i]->body->size; ++j) {
-      ck_assert_literal_ne(result->rules[i]->body->literals[j],
+    for (j = 0; j < result->rules[i]->body.size; ++j) {
+      ck_assert_literal_ne(result->rules[i]->body.literals[j],
                            labels->literals[0]);
     }
   }
@@ -1,4 +1,6 @@
 #include <check.h>
+#include <pthread.h>
+#include <stdio.h>
 #include <stdlib.h>
 
 #include "../src/literal.h"
@@ -132,7 +134,7 @@ START_TEST(copy_test) {
 
   literal_copy(&literal2, literal1);
 
-  ck_assert_ptr_ne(literal1, literal2);
+  ck_assert_ptr_eq(literal1, literal2);
   ck_assert_literal_eq(literal1, literal2);
 
   literal_destructor(&literal1);
@@ -151,31 +153,119 @@ START_TEST(copy_test) {
 }
 END_TEST
 
+START_TEST(intern_test) {
+  const size_t total_atoms = literal_total_atoms();
+  Literal *literal1 = literal_constructor(" Albatross", 1),
+          *literal2 = literal_constructor_from_string("-albatross"),
+          *literal3 = literal_constructor("Seagull", 1), *literal4 = NULL;
+
+  ck_assert_int_eq(literal_total_atoms(), total_atoms + 2);
+  ck_assert_int_eq(literal1->id, literal2->id);
+  ck_assert_ptr_eq(literal1->atom, literal2->atom);
+  ck_assert_int_ne(literal1->id, literal3->id);
+  ck_assert_str_eq(literal_atom_from_id(literal1->id), "albatross");
+  ck_assert_str_eq(literal_atom_from_id(literal3->id), "seagull");
+  ck_assert_ptr_null(literal_atom_from_id(literal_total_atoms()));
+  ck_assert_int_eq(literal_intern_atom("seagull"), literal3->id);
+
+  literal_copy(&literal4, literal3);
+  ck_assert_ptr_eq(literal3->atom, literal4->atom);
+  ck_assert_int_eq(literal_total_atoms(), total_atoms + 2);
+  literal_destructor(&literal4);
+
+  literal4 = literal_constructor_from_id(literal1->id, false);
+  ck_assert_int_eq(literal_equals(literal4, literal2), 1);
+  ck_assert_ptr_eq(literal4->atom, literal1->atom);
+  ck_assert_ptr_null(literal_constructor_from_id(literal_total_atoms(), true));
+
+  literal_destructor(&literal1);
+  ck_assert_str_eq(literal2->atom, "albatross");
+
+  literal_destructor(&literal2);
+  literal_destructor(&literal3);
+  literal_destructor(&literal4);
+}
+END_TEST
+
+#define CONCURRENT_INTERN_THREADS 4
+#define CONCURRENT_INTERN_ATOMS 5000
+
+/**
+ * @brief Interns every concurrent test atom, starting from a different one in
+ * each thread, and saves their ids.
+ */
+static void *_intern_atoms(void *argument) {
+  unsigned int *ids = (unsigned int *)argument, i, atom;
+  const unsigned int start = ids[0];
+  char buffer[32];
+  for (i = 0; i < CONCURRENT_INTERN_ATOMS; ++i) {
+    atom = (start + i) % CONCURRENT_INTERN_ATOMS;
+    snprintf(buffer, sizeof(buffer), "concurrent_%u", atom);
+    ids[atom] = literal_intern_atom(buffer);
+  }
+  return NULL;
+}
+
+START_TEST(concurrent_intern_test) {
+  const size_t total_atoms = literal_total_atoms();
+  unsigned int ids[CONCURRENT_INTERN_THREADS][CONCURRENT_INTERN_ATOMS], i, j;
+  pthread_t threads[CONCURRENT_INTERN_THREADS];
+  for (i = 0; i < CONCURRENT_INTERN_THREADS; ++i) {
+    ids[i][0] = i * (CONCURRENT_INTERN_ATOMS / CONCURRENT_INTERN_THREADS);
+    ck_assert_int_eq(pthread_create(&(threads[i]), NULL, _intern_atoms, ids[i]),
+                     0);
+  }
+  for (i = 0; i < CONCURRENT_INTERN_THREADS; ++i) {
+    pthread_join(threads[i], NULL);
+  }
+
+  ck_assert_int_eq(literal_total_atoms(),
+                   total_atoms + CONCURRENT_INTERN_ATOMS);
+  char buffer[32];
+  Literal *literal;
+  for (j = 0; j < CONCURRENT_INTERN_ATOMS; ++j) {
+    for (i = 1; i < CONCURRENT_INTERN_THREADS; ++i) {
+      ck_assert_int_eq(ids[i][j], ids[0][j]);
+    }
+    snprintf(buffer, sizeof(buffer), "concurrent_%u", j);
+    ck_assert_str_eq(literal_atom_from_id(ids[0][j]), buffer);
+    literal = literal_constructor_from_id(ids[0][j], true);
+    ck_assert_int_eq(literal->id, ids[0][j]);
+    ck_assert_str_eq(literal->atom, buffer);
+  }
+}
+END_TEST
+
 START_TEST(negate_test) {
-  Literal *literal = NULL;
+  Literal *literal = NULL, *positive;
   literal = literal_constructor("Penguin", 1);
+  positive = literal;
 
   ck_assert_int_eq(literal->sign, 1);
   char *literal_string = literal_to_string(literal);
   ck_assert_str_eq(literal_string, "penguin");
   free(literal_string);
 
-  literal_negate(literal);
+  literal_negate(&literal);
 
   ck_assert_int_eq(literal->sign, 0);
+  ck_assert_int_eq(positive->sign, 1);
+  ck_assert_int_eq(literal->id, positive->id);
   literal_string = literal_to_string(literal);
   ck_assert_str_eq(literal_string, "-penguin");
   free(literal_string);
 
-  literal_negate(literal);
+  literal_negate(&literal);
 
+  ck_assert_ptr_eq(literal, positive);
   ck_assert_int_eq(literal->sign, 1);
   literal_string = literal_to_string(literal);
   ck_assert_str_eq(literal_string, "penguin");
   free(literal_string);
   literal_destructor(&literal);
 
-  literal_negate(literal);
+  literal_negate(&literal);
+  literal_negate(NULL);
 
   ck_assert_ptr_null(literal);
 }
@@ -307,6 +397,8 @@ Suite *literal_suite() {
 
   copy_case = tcase_create("Copy");
   tcase_add_test(copy_case, copy_test);
+  tcase_add_test(copy_case, intern_test);
+  tcase_add_test(copy_case, concurrent_intern_test);
   suite_add_tcase(suite, copy_case);
 
   negate_case = tcase_create("Negate");
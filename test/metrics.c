@@ -1,6 +1,7 @@
 #include <check.h>
 
 #include "../src/context.h"
+#include "../src/inference_engine.h"
 #include "../src/knowledge_base.h"
 #include "../src/metrics.h"
 #include "../src/nerd.h"
@@ -8,6 +9,9 @@
 
 #define DATASET1 "../test/data/sensor_test1.txt"
 #define DATASET2 "../test/data/sensor_test3.txt"
+#define THREADS_DATASET "../bin/metrics_threads_test.csv"
+#define THREADS_DATASET_COPIES 50
+#define HEADER_DATASET "../bin/metrics_header_test.csv"
 
 START_TEST(all_literals_evaluation_test) {
   Nerd *nerd = nerd_constructor(15.0, 5, 3, 50, 1.5, 4.5, true, true);
@@ -32,10 +36,10 @@ START_TEST(all_literals_evaluation_test) {
 
   size_t total_hidden, total_recovered, total_incorrectly_recovered,
       total_not_recovered;
-  ck_assert_int_eq(evaluate_all_literals(nerd, prudensjs_inference, sensor,
-                                         &total_hidden, &total_recovered,
-                                         &total_incorrectly_recovered,
-                                         &total_not_recovered),
+  ck_assert_int_eq(evaluate_all_literals(
+                       nerd, prudensjs_inference_batch, sensor, 1,
+                       &total_hidden, &total_recovered,
+                       &total_incorrectly_recovered, &total_not_recovered),
                    0);
   ck_assert_int_ne(total_hidden, 0);
   ck_assert_int_eq(total_hidden, total_read_attributes);
@@ -45,53 +49,120 @@ START_TEST(all_literals_evaluation_test) {
 
   knowledge_base_add_rule(nerd->knowledge_base, &r1);
   knowledge_base_add_rule(nerd->knowledge_base, &r2);
-  ck_assert_int_eq(evaluate_all_literals(nerd, prudensjs_inference, sensor,
-                                         &total_hidden, &total_recovered,
-                                         &total_incorrectly_recovered,
-                                         &total_not_recovered),
+  ck_assert_int_eq(evaluate_all_literals(
+                       nerd, prudensjs_inference_batch, sensor, 1,
+                       &total_hidden, &total_recovered,
+                       &total_incorrectly_recovered, &total_not_recovered),
                    0);
   ck_assert_int_eq(total_hidden, total_read_attributes);
   ck_assert_int_gt(total_recovered, 0);
   ck_assert_int_ge(total_incorrectly_recovered, 0);
   ck_assert_int_lt(total_not_recovered, total_hidden);
 
-  size_t old_hidden = total_hidden, old_recovered = total_recovered;
-  ck_assert_int_eq(evaluate_all_literals(nerd, prudensjs_inference, sensor,
-                                         &total_hidden, &total_recovered, NULL,
-                                         NULL),
+  size_t old_hidden = total_hidden, old_recovered = total_recovered,
+         old_incorrectly_recovered = total_incorrectly_recovered,
+         old_not_recovered = total_not_recovered;
+  ck_assert_int_eq(evaluate_all_literals(nerd, prudensjs_inference_batch,
+                                         sensor, 1, &total_hidden,
+                                         &total_recovered, NULL, NULL),
                    0);
   ck_assert_int_eq(old_hidden, total_hidden);
   ck_assert_int_eq(old_recovered, total_recovered);
 
-  ck_assert_int_eq(evaluate_all_literals(NULL, prudensjs_inference, sensor,
-                                         &total_hidden, &total_recovered, NULL,
-                                         NULL),
+  unsigned int threads;
+  for (threads = 0; threads <= 4; ++threads) {
+    ck_assert_int_eq(evaluate_all_literals(nerd, native_inference_batch, sensor,
+                                           threads, &total_hidden,
+                                           &total_recovered,
+                                           &total_incorrectly_recovered,
+                                           &total_not_recovered),
+                     0);
+    ck_assert_int_eq(old_hidden, total_hidden);
+    ck_assert_int_eq(old_recovered, total_recovered);
+    ck_assert_int_eq(old_incorrectly_recovered, total_incorrectly_recovered);
+    ck_assert_int_eq(old_not_recovered, total_not_recovered);
+  }
+
+  ck_assert_int_eq(evaluate_all_literals(NULL, prudensjs_inference_batch,
+                                         sensor, 1, &total_hidden,
+                                         &total_recovered, NULL, NULL),
                    -1);
-  ck_assert_int_eq(evaluate_all_literals(nerd, prudensjs_inference, NULL,
-                                         &total_hidden, &total_recovered, NULL,
-                                         NULL),
+  ck_assert_int_eq(evaluate_all_literals(nerd, prudensjs_inference_batch, NULL,
+                                         1, &total_hidden, &total_recovered,
+                                         NULL, NULL),
                    -1);
-  ck_assert_int_eq(evaluate_all_literals(nerd, prudensjs_inference, sensor,
-                                         NULL, &total_recovered, NULL, NULL),
+  ck_assert_int_eq(evaluate_all_literals(nerd, prudensjs_inference_batch,
+                                         sensor, 1, NULL, &total_recovered,
+                                         NULL, NULL),
                    -1);
-  ck_assert_int_eq(evaluate_all_literals(nerd, prudensjs_inference, sensor,
-                                         &total_hidden, NULL, NULL, NULL),
+  ck_assert_int_eq(evaluate_all_literals(nerd, prudensjs_inference_batch,
+                                         sensor, 1, &total_hidden, NULL, NULL,
+                                         NULL),
                    -1);
 
   sensor_destructor(&sensor);
-  ck_assert_int_eq(evaluate_all_literals(nerd, prudensjs_inference, sensor,
-                                         &total_hidden, &total_recovered, NULL,
-                                         NULL),
+  ck_assert_int_eq(evaluate_all_literals(nerd, prudensjs_inference_batch,
+                                         sensor, 1, &total_hidden,
+                                         &total_recovered, NULL, NULL),
                    -1);
 
   nerd_destructor(&nerd);
-  ck_assert_int_eq(evaluate_all_literals(nerd, prudensjs_inference, sensor,
-                                         &total_hidden, &total_recovered, NULL,
-                                         NULL),
+  ck_assert_int_eq(evaluate_all_literals(nerd, prudensjs_inference_batch,
+                                         sensor, 1, &total_hidden,
+                                         &total_recovered, NULL, NULL),
                    -1);
 }
 END_TEST
 
+START_TEST(header_all_literals_evaluation_test) {
+  // The dash makes the Literals of the flies column negative.
+  FILE *file = fopen(HEADER_DATASET, "w");
+  fputs("animal,-flies,class\npenguin,yes,bird\n", file);
+  fclose(file);
+
+  Nerd *nerd = nerd_constructor(15.0, 5, 3, 50, 1.5, 4.5, true, true);
+  Literal *l1 = literal_constructor("animal_penguin", true),
+          *l2 = literal_constructor("class_bird", true);
+  Rule *r1 = rule_constructor(1, &l1, &l2, 15.0, false);
+  knowledge_base_add_rule(nerd->knowledge_base, &r1);
+
+  Sensor *sensor = sensor_constructor_from_file(HEADER_DATASET, ',', true,
+                                                true);
+
+  // The class_bird inferred when -flies_yes is hidden is of another column, so
+  // it does not recover -flies_yes incorrectly.
+  size_t total_hidden, total_recovered, total_incorrectly_recovered,
+      total_not_recovered;
+  ck_assert_int_eq(evaluate_all_literals(
+                       nerd, native_inference_batch, sensor, 1,
+                       &total_hidden, &total_recovered,
+                       &total_incorrectly_recovered, &total_not_recovered),
+                   0);
+  ck_assert_int_eq(total_hidden, 3);
+  ck_assert_int_eq(total_recovered, 1);
+  ck_assert_int_eq(total_incorrectly_recovered, 0);
+  ck_assert_int_eq(total_not_recovered, 2);
+
+  l1 = literal_constructor("animal_penguin", true);
+  l2 = literal_constructor("flies_no", true);
+  r1 = rule_constructor(1, &l1, &l2, 16.0, false);
+  knowledge_base_add_rule(nerd->knowledge_base, &r1);
+  ck_assert_int_eq(evaluate_all_literals(
+                       nerd, native_inference_batch, sensor, 1,
+                       &total_hidden, &total_recovered,
+                       &total_incorrectly_recovered, &total_not_recovered),
+                   0);
+  ck_assert_int_eq(total_hidden, 3);
+  ck_assert_int_eq(total_recovered, 1);
+  ck_assert_int_eq(total_incorrectly_recovered, 1);
+  ck_assert_int_eq(total_not_recovered, 1);
+
+  sensor_destructor(&sensor);
+  nerd_destructor(&nerd);
+  remove(HEADER_DATASET);
+}
+END_TEST
+
 START_TEST(random_literals_evaluation_test) {
   Nerd *nerd = nerd_constructor(15.0, 5, 3, 50, 1.5, 4.5, true, true);
   Literal *l1 = literal_constructor("class_bird", true),
@@ -106,10 +177,11 @@ START_TEST(random_literals_evaluation_test) {
 
   size_t total_hidden, total_recovered, total_incorrectly_recovered,
       total_not_recovered;
-  ck_assert_int_eq(evaluate_random_literals(
-                       nerd, prudensjs_inference, sensor, ratio, &total_hidden,
-                       &total_recovered, &total_incorrectly_recovered,
-                       &total_not_recovered),
+  ck_assert_int_eq(evaluate_random_literals(nerd, prudensjs_inference_batch,
+                                            sensor, 1, ratio, &total_hidden,
+                                            &total_recovered,
+                                            &total_incorrectly_recovered,
+                                            &total_not_recovered),
                    0);
   ck_assert_int_ne(total_hidden, 0);
   ck_assert_int_eq(total_recovered, 0);
@@ -118,67 +190,70 @@ START_TEST(random_literals_evaluation_test) {
 
   knowledge_base_add_rule(nerd->knowledge_base, &r1);
   knowledge_base_add_rule(nerd->knowledge_base, &r2);
-  ck_assert_int_eq(evaluate_random_literals(
-                       nerd, prudensjs_inference, sensor, ratio, &total_hidden,
-                       &total_recovered, &total_incorrectly_recovered,
-                       &total_not_recovered),
+  ck_assert_int_eq(evaluate_random_literals(nerd, prudensjs_inference_batch,
+                                            sensor, 1, ratio, &total_hidden,
+                                            &total_recovered,
+                                            &total_incorrectly_recovered,
+                                            &total_not_recovered),
                    0);
   ck_assert_int_ne(total_hidden, 0);
   ck_assert_int_ge(total_recovered, 0);
   ck_assert_int_ge(total_incorrectly_recovered, 0);
   ck_assert_int_le(total_not_recovered, total_hidden);
 
-  ck_assert_int_eq(evaluate_random_literals(
-                       nerd, prudensjs_inference, sensor, ratio, &total_hidden,
-                       &total_recovered, &total_incorrectly_recovered, NULL),
+  ck_assert_int_eq(evaluate_random_literals(nerd, prudensjs_inference_batch,
+                                            sensor, 1, ratio, &total_hidden,
+                                            &total_recovered,
+                                            &total_incorrectly_recovered, NULL),
                    0);
-  ck_assert_int_eq(evaluate_random_literals(
-                       nerd, prudensjs_inference, sensor, ratio, &total_hidden,
-                       &total_recovered, NULL, &total_not_recovered),
+  ck_assert_int_eq(evaluate_random_literals(nerd, prudensjs_inference_batch,
+                                            sensor, 1, ratio, &total_hidden,
+                                            &total_recovered, NULL,
+                                            &total_not_recovered),
                    0);
-  ck_assert_int_eq(evaluate_random_literals(nerd, prudensjs_inference, sensor,
-                                            ratio, &total_hidden,
+  ck_assert_int_eq(evaluate_random_literals(nerd, prudensjs_inference_batch,
+                                            sensor, 1, ratio, &total_hidden,
                                             &total_recovered, NULL, NULL),
                    0);
 
-  ck_assert_int_eq(evaluate_random_literals(NULL, prudensjs_inference, sensor,
-                                            ratio, &total_hidden,
+  ck_assert_int_eq(evaluate_random_literals(NULL, prudensjs_inference_batch,
+                                            sensor, 1, ratio, &total_hidden,
                                             &total_recovered, NULL, NULL),
                    -1);
-  ck_assert_int_eq(evaluate_random_literals(nerd, prudensjs_inference, NULL,
-                                            ratio, &total_hidden,
+  ck_assert_int_eq(evaluate_random_literals(nerd, prudensjs_inference_batch,
+                                            NULL, 1, ratio, &total_hidden,
                                             &total_recovered, NULL, NULL),
                    -1);
-  ck_assert_int_eq(evaluate_random_literals(nerd, prudensjs_inference, sensor,
-                                            0, &total_hidden, &total_recovered,
-                                            NULL, NULL),
+  ck_assert_int_eq(evaluate_random_literals(nerd, prudensjs_inference_batch,
+                                            sensor, 1, 0, &total_hidden,
+                                            &total_recovered, NULL, NULL),
                    -1);
-  ck_assert_int_eq(evaluate_random_literals(nerd, prudensjs_inference, sensor,
-                                            1.01, &total_hidden,
+  ck_assert_int_eq(evaluate_random_literals(nerd, prudensjs_inference_batch,
+                                            sensor, 1, 1.01, &total_hidden,
                                             &total_recovered, NULL, NULL),
                    -1);
-  ck_assert_int_eq(evaluate_random_literals(nerd, prudensjs_inference, sensor,
-                                            -0.01, &total_hidden,
+  ck_assert_int_eq(evaluate_random_literals(nerd, prudensjs_inference_batch,
+                                            sensor, 1, -0.01, &total_hidden,
                                             &total_recovered, NULL, NULL),
                    -1);
-  ck_assert_int_eq(evaluate_random_literals(nerd, prudensjs_inference, sensor,
-                                            ratio, NULL, &total_recovered, NULL,
-                                            NULL),
+  ck_assert_int_eq(evaluate_random_literals(nerd, prudensjs_inference_batch,
+                                            sensor, 1, ratio, NULL,
+                                            &total_recovered, NULL, NULL),
                    -1);
-  ck_assert_int_eq(evaluate_random_literals(nerd, prudensjs_inference, sensor,
-                                            ratio, &total_hidden, NULL, NULL,
-                                            NULL),
+  ck_assert_int_eq(evaluate_random_literals(nerd, prudensjs_inference_batch,
+                                            sensor, 1, ratio, &total_hidden,
+                                            NULL, NULL, NULL),
                    -1);
 
   sensor_destructor(&sensor);
-  ck_assert_int_eq(evaluate_random_literals(nerd, prudensjs_inference, sensor,
-                                            ratio, &total_hidden,
+  ck_assert_int_eq(evaluate_random_literals(nerd, prudensjs_inference_batch,
+                                            sensor, 1, ratio, &total_hidden,
                                             &total_recovered, NULL, NULL),
                    -1);
 
   nerd_destructor(&nerd);
-  ck_assert_int_eq(evaluate_random_literals(nerd, prudensjs_inference, sensor,
-                                            ratio, &total_hidden,
+  ck_assert_int_eq(evaluate_random_literals(nerd, prudensjs_inference_batch,
+                                            sensor, 1, ratio, &total_hidden,
                                             &total_recovered, NULL, NULL),
                    -1);
 }
@@ -198,14 +273,14 @@ START_TEST(one_specific_literal_evaluation_test) {
   Sensor *sensor = sensor_constructor_from_file(DATASET2, ',', true, true);
 
   float accuracy, abstain_ratio;
-  ck_assert_int_eq(evaluate_labels(nerd, prudensjs_inference_batch, sensor,
+  ck_assert_int_eq(evaluate_labels(nerd, prudensjs_inference_batch, sensor, 1,
                                    literals_to_evaluate, &accuracy,
                                    &abstain_ratio, NULL, NULL, NULL, NULL,
                                    false),
                    1);
 
   context_add_literal(literals_to_evaluate, &l4);
-  ck_assert_int_eq(evaluate_labels(nerd, prudensjs_inference_batch, sensor,
+  ck_assert_int_eq(evaluate_labels(nerd, prudensjs_inference_batch, sensor, 1,
                                    literals_to_evaluate, &accuracy,
                                    &abstain_ratio, NULL, NULL, NULL, NULL,
                                    false),
@@ -215,7 +290,7 @@ START_TEST(one_specific_literal_evaluation_test) {
 
   knowledge_base_add_rule(nerd->knowledge_base, &r1);
   knowledge_base_add_rule(nerd->knowledge_base, &r2);
-  ck_assert_int_eq(evaluate_labels(nerd, prudensjs_inference_batch, sensor,
+  ck_assert_int_eq(evaluate_labels(nerd, prudensjs_inference_batch, sensor, 1,
                                    literals_to_evaluate, &accuracy,
                                    &abstain_ratio, NULL, NULL, NULL, NULL,
                                    false),
@@ -223,27 +298,27 @@ START_TEST(one_specific_literal_evaluation_test) {
   ck_assert_float_eq(accuracy, 0.5);
   ck_assert_float_eq(abstain_ratio, 0.5);
 
-  ck_assert_int_eq(evaluate_labels(nerd, prudensjs_inference_batch, sensor,
+  ck_assert_int_eq(evaluate_labels(nerd, prudensjs_inference_batch, sensor, 1,
                                    literals_to_evaluate, &accuracy, NULL, NULL,
                                    NULL, NULL, NULL, false),
                    0);
   accuracy = 0;
   abstain_ratio = 0;
-  ck_assert_int_eq(evaluate_labels(nerd, prudensjs_inference_batch, sensor,
+  ck_assert_int_eq(evaluate_labels(nerd, prudensjs_inference_batch, sensor, 1,
                                    literals_to_evaluate, &accuracy,
                                    &abstain_ratio, NULL, NULL, NULL, NULL,
                                    false),
                    0);
   ck_assert_float_eq(accuracy, 0.5);
   ck_assert_float_eq(abstain_ratio, 0.5);
-  ck_assert_int_eq(evaluate_labels(nerd, prudensjs_inference_batch, sensor,
+  ck_assert_int_eq(evaluate_labels(nerd, prudensjs_inference_batch, sensor, 1,
                                    literals_to_evaluate, NULL, NULL, NULL, NULL,
                                    NULL, NULL, false),
                    0);
 
   size_t total_observations;
   Scene **inferences = NULL;
-  ck_assert_int_eq(evaluate_labels(nerd, prudensjs_inference_batch, sensor,
+  ck_assert_int_eq(evaluate_labels(nerd, prudensjs_inference_batch, sensor, 1,
                                    literals_to_evaluate, NULL, NULL,
                                    &total_observations, NULL, &inferences, NULL,
                                    false),
@@ -259,40 +334,40 @@ START_TEST(one_specific_literal_evaluation_test) {
 
   const size_t old_observations = total_observations;
   total_observations = 0;
-  ck_assert_int_eq(evaluate_labels(nerd, prudensjs_inference_batch, sensor,
+  ck_assert_int_eq(evaluate_labels(nerd, prudensjs_inference_batch, sensor, 1,
                                    literals_to_evaluate, NULL, NULL, NULL, NULL,
                                    &inferences, NULL, false),
                    -2);
 
-  ck_assert_int_eq(evaluate_labels(nerd, prudensjs_inference_batch, sensor,
+  ck_assert_int_eq(evaluate_labels(nerd, prudensjs_inference_batch, sensor, 1,
                                    literals_to_evaluate, NULL, NULL,
                                    &total_observations, NULL, NULL, NULL,
                                    false),
                    0);
   ck_assert_int_eq(old_observations, total_observations);
 
-  ck_assert_int_eq(evaluate_labels(NULL, prudensjs_inference_batch, sensor,
+  ck_assert_int_eq(evaluate_labels(NULL, prudensjs_inference_batch, sensor, 1,
                                    literals_to_evaluate, &accuracy, NULL, NULL,
                                    NULL, NULL, NULL, false),
                    -1);
-  ck_assert_int_eq(evaluate_labels(nerd, prudensjs_inference_batch, NULL,
+  ck_assert_int_eq(evaluate_labels(nerd, prudensjs_inference_batch, NULL, 1,
                                    literals_to_evaluate, &accuracy, NULL, NULL,
                                    NULL, NULL, NULL, false),
                    -1);
-  ck_assert_int_eq(evaluate_labels(nerd, prudensjs_inference_batch, sensor,
+  ck_assert_int_eq(evaluate_labels(nerd, prudensjs_inference_batch, sensor, 1,
                                    NULL, &accuracy, NULL, NULL, NULL, NULL,
                                    NULL, false),
                    -1);
 
   sensor_destructor(&sensor);
-  ck_assert_int_eq(evaluate_labels(nerd, prudensjs_inference_batch, sensor,
+  ck_assert_int_eq(evaluate_labels(nerd, prudensjs_inference_batch, sensor, 1,
                                    literals_to_evaluate, &accuracy,
                                    &abstain_ratio, NULL, NULL, NULL, NULL,
                                    false),
                    -1);
 
   nerd_destructor(&nerd);
-  ck_assert_int_eq(evaluate_labels(nerd, prudensjs_inference_batch, sensor,
+  ck_assert_int_eq(evaluate_labels(nerd, prudensjs_inference_batch, sensor, 1,
                                    literals_to_evaluate, &accuracy, NULL, NULL,
                                    NULL, NULL, NULL, false),
                    -1);
@@ -301,6 +376,168 @@ START_TEST(one_specific_literal_evaluation_test) {
 }
 END_TEST
 
+START_TEST(threads_evaluation_test) {
+  FILE *source = fopen(DATASET2, "r"), *destination;
+  if (!source) {
+    ck_abort_msg("%s does not exist.", DATASET2);
+  }
+  char header[BUFFER_SIZE], rows[BUFFER_SIZE * 4];
+  ck_assert_ptr_nonnull(fgets(header, BUFFER_SIZE, source));
+  size_t rows_size = fread(rows, sizeof(char), BUFFER_SIZE * 4, source);
+  fclose(source);
+
+  destination = fopen(THREADS_DATASET, "w");
+  fputs(header, destination);
+  unsigned int i;
+  for (i = 0; i < THREADS_DATASET_COPIES; ++i) {
+    fwrite(rows, sizeof(char), rows_size, destination);
+  }
+  fclose(destination);
+
+  Nerd *nerd = nerd_constructor(5.0, 5, 3, 50, 1.5, 4.5, true, true);
+  Literal *l1 = literal_constructor("animal_bat", true),
+          *l2 = literal_constructor("flies?_yes", true),
+          *l3 = literal_constructor("class_mammal", true),
+          *l4 = literal_constructor("flies?_no", true),
+          *l5 = literal_constructor("class_bird", true);
+  Rule *r1 = rule_constructor(1, &l1, &l2, 16, false),
+       *r2 = rule_constructor(1, &l3, &l4, 15, false),
+       *r3 = rule_constructor(1, &l5, &l2, 14, false);
+  knowledge_base_add_rule(nerd->knowledge_base, &r1);
+  knowledge_base_add_rule(nerd->knowledge_base, &r2);
+  knowledge_base_add_rule(nerd->knowledge_base, &r3);
+  Context *labels = context_constructor(true);
+  l2 = literal_constructor("flies?_yes", true);
+  l4 = literal_constructor("flies?_no", true);
+  context_add_literal(labels, &l2);
+  context_add_literal(labels, &l4);
+
+  Sensor *sensor = sensor_constructor_from_file(THREADS_DATASET, ',', true,
+                                                true);
+
+  // The observations span several chunks, so every thread count below
+  // splits them between more than one thread.
+  const unsigned int threads[] = {2, 3, 4, 8};
+  size_t totals[2][4], total_observations;
+  unsigned int t;
+  ck_assert_int_eq(evaluate_all_literals(nerd, native_inference_batch, sensor,
+                                         1, &(totals[0][0]), &(totals[0][1]),
+                                         &(totals[0][2]), &(totals[0][3])),
+                   0);
+  ck_assert_int_eq(totals[0][0], THREADS_DATASET_COPIES * 4 * 3);
+  for (t = 0; t < sizeof(threads) / sizeof(threads[0]); ++t) {
+    ck_assert_int_eq(evaluate_all_literals(
+                         nerd, native_inference_batch, sensor, threads[t],
+                         &(totals[1][0]), &(totals[1][1]), &(totals[1][2]),
+                         &(totals[1][3])),
+                     0);
+    for (i = 0; i < 4; ++i) {
+      ck_assert_int_eq(totals[0][i], totals[1][i]);
+    }
+  }
+
+  pcg32_random_t rng;
+  global_rng = &rng;
+  pcg32_srandom_r(&rng, 42, 1);
+  ck_assert_int_eq(evaluate_random_literals(
+                       nerd, native_inference_batch, sensor, 1, 0.5,
+                       &(totals[0][0]), &(totals[0][1]), &(totals[0][2]),
+                       &(totals[0][3])),
+                   0);
+  for (t = 0; t < sizeof(threads) / sizeof(threads[0]); ++t) {
+    pcg32_srandom_r(&rng, 42, 1);
+    ck_assert_int_eq(evaluate_random_literals(
+                         nerd, native_inference_batch, sensor, threads[t], 0.5,
+                         &(totals[1][0]), &(totals[1][1]), &(totals[1][2]),
+                         &(totals[1][3])),
+                     0);
+    for (i = 0; i < 4; ++i) {
+      ck_assert_int_eq(totals[0][i], totals[1][i]);
+    }
+  }
+  global_rng = NULL;
+
+  float accuracy[2], abstain_ratio[2];
+  Scene **inferences[2];
+  char *rules[2];
+  ck_assert_int_eq(evaluate_labels(nerd, native_inference_batch, sensor, 1,
+                                   labels, &(accuracy[0]), &(abstain_ratio[0]),
+                                   &total_observations, NULL, &(inferences[0]),
+                                   &(rules[0]), false),
+                   0);
+  ck_assert_int_eq(evaluate_labels(nerd, native_inference_batch, sensor, 4,
+                                   labels, &(accuracy[1]), &(abstain_ratio[1]),
+                                   &total_observations, NULL, &(inferences[1]),
+                                   &(rules[1]), false),
+                   0);
+  ck_assert_float_eq(accuracy[0], accuracy[1]);
+  ck_assert_float_eq(abstain_ratio[0], abstain_ratio[1]);
+  ck_assert_str_eq(rules[0], rules[1]);
+  char *str[2];
+  for (i = 0; i < total_observations; ++i) {
+    str[0] = scene_to_string(inferences[0][i]);
+    str[1] = scene_to_string(inferences[1][i]);
+    ck_assert_str_eq(str[0], str[1]);
+    free(str[0]);
+    free(str[1]);
+    scene_destructor(&(inferences[0][i]));
+    scene_destructor(&(inferences[1][i]));
+  }
+  free(inferences[0]);
+  free(inferences[1]);
+  free(rules[1]);
+
+  // The incremental evaluation gives the same results, and after a Rule is
+  // added, it only re-infers the observations that can use it.
+  NativeInferenceCache *cache = native_inference_cache_constructor();
+  size_t reinferred;
+  ck_assert_int_eq(evaluate_labels_incremental(nerd, NULL, sensor, 4, labels,
+                                               NULL, NULL, NULL, NULL, NULL,
+                                               NULL, false, &reinferred),
+                   -1);
+  ck_assert_int_eq(evaluate_labels_incremental(nerd, cache, sensor, 4, labels,
+                                               &(accuracy[1]),
+                                               &(abstain_ratio[1]),
+                                               &total_observations, NULL, NULL,
+                                               &(rules[1]), false, &reinferred),
+                   0);
+  ck_assert_int_eq(reinferred, total_observations);
+  ck_assert_float_eq(accuracy[0], accuracy[1]);
+  ck_assert_float_eq(abstain_ratio[0], abstain_ratio[1]);
+  ck_assert_str_eq(rules[0], rules[1]);
+  free(rules[0]);
+  free(rules[1]);
+
+  l1 = literal_constructor("animal_penguin", true);
+  l3 = literal_constructor("class_flightless", true);
+  r1 = rule_constructor(1, &l1, &l3, 13, false);
+  knowledge_base_add_rule(nerd->knowledge_base, &r1);
+  ck_assert_int_eq(evaluate_labels(nerd, native_inference_batch, sensor, 1,
+                                   labels, &(accuracy[0]), &(abstain_ratio[0]),
+                                   &total_observations, NULL, NULL, &(rules[0]),
+                                   false),
+                   0);
+  ck_assert_int_eq(evaluate_labels_incremental(nerd, cache, sensor, 1, labels,
+                                               &(accuracy[1]),
+                                               &(abstain_ratio[1]),
+                                               &total_observations, NULL, NULL,
+                                               &(rules[1]), false, &reinferred),
+                   0);
+  ck_assert_int_eq(reinferred, THREADS_DATASET_COPIES);
+  ck_assert_float_eq(accuracy[0], accuracy[1]);
+  ck_assert_float_eq(abstain_ratio[0], abstain_ratio[1]);
+  ck_assert_str_eq(rules[0], rules[1]);
+  free(rules[0]);
+  free(rules[1]);
+  native_inference_cache_destructor(&cache);
+
+  sensor_destructor(&sensor);
+  context_destructor(&labels);
+  nerd_destructor(&nerd);
+  remove(THREADS_DATASET);
+}
+END_TEST
+
 Suite *metrics_suite() {
   Suite *suite;
   TCase *evaluation_case;
@@ -308,15 +545,17 @@ Suite *metrics_suite() {
   suite = suite_create("Metrics");
   evaluation_case = tcase_create("Evaluation Case");
   tcase_add_test(evaluation_case, all_literals_evaluation_test);
+  tcase_add_test(evaluation_case, header_all_literals_evaluation_test);
   tcase_add_test(evaluation_case, random_literals_evaluation_test);
   tcase_add_test(evaluation_case, one_specific_literal_evaluation_test);
+  tcase_add_test(evaluation_case, threads_evaluation_test);
   suite_add_tcase(suite, evaluation_case);
 
   return suite;
 }
 
 int main(int argc, char *argv[]) {
-  prudensjs_settings_constructor(argv[0], NULL, NULL, NULL);
+  prudensjs_settings_constructor(argv[0], NULL);
   Suite *suite = metrics_suite();
   SRunner *s_runner;
 
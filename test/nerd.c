@@ -1,6 +1,7 @@
 #include <check.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "../src/nerd.h"
 #include "../src/nerd_helper.h"
@@ -311,7 +312,7 @@ START_TEST(to_file_test) {
   free(current);
   free(previous);
   ck_assert_int_ge(nerd_time_taken, 0);
-  ck_assert_int_gt(ie_time_taken, 0);
+  ck_assert_int_ge(ie_time_taken, 0);
 
   scene_destructor(&labels);
   scene_destructor(&observation);
@@ -326,6 +327,120 @@ START_TEST(to_file_test) {
 }
 END_TEST
 
+START_TEST(to_binary_file_test) {
+  Nerd *nerd = nerd_constructor_from_file("../test/data/nerd_input2.txt", true),
+       *loaded = NULL;
+  nerd_to_file(nerd, "../bin/nerd_output4.txt");
+  ck_assert_int_eq(nerd_to_binary_file(nerd, "../bin/nerd_output4.ndb"), 0);
+
+  loaded = nerd_constructor_from_file("../bin/nerd_output4.ndb", true);
+  ck_assert_ptr_nonnull(loaded);
+  ck_assert_int_eq(loaded->max_rules_per_instance, nerd->max_rules_per_instance);
+  ck_assert_int_eq(loaded->breadth, nerd->breadth);
+  ck_assert_int_eq(loaded->depth, nerd->depth);
+  ck_assert_float_eq(loaded->promotion_weight, nerd->promotion_weight);
+  ck_assert_float_eq(loaded->demotion_weight, nerd->demotion_weight);
+  ck_assert_int_eq(loaded->increasing_demotion, nerd->increasing_demotion);
+  ck_assert_knowledge_base_eq(loaded->knowledge_base, nerd->knowledge_base);
+  nerd_to_file(loaded, "../bin/nerd_output5.txt");
+  ck_assert_int_eq(
+      compare_files("../bin/nerd_output4.txt", "../bin/nerd_output5.txt"), 0);
+  nerd_destructor(&loaded);
+  nerd_destructor(&nerd);
+
+  nerd = nerd_constructor(15.0, 5, 3, 50, 1.5, 4.5, true, true);
+  ck_assert_int_eq(nerd_to_binary_file(nerd, "../bin/nerd_output4.ndb"), 0);
+  loaded = nerd_constructor_from_file("../bin/nerd_output4.ndb", true);
+  ck_assert_ptr_nonnull(loaded);
+  ck_assert_knowledge_base_empty(loaded->knowledge_base);
+  nerd_destructor(&loaded);
+
+  ck_assert_int_eq(nerd_to_binary_file(nerd, NULL), -2);
+  ck_assert_int_eq(nerd_to_binary_file(NULL, "../bin/nerd_output4.ndb"), -2);
+  ck_assert_int_eq(nerd_to_binary_file(nerd, "../directory/that/does/not/exist"),
+                   -1);
+  nerd_destructor(&nerd);
+
+  FILE *file = fopen("../bin/nerd_output4.ndb", "wb");
+  fwrite("NERDBIN", sizeof(char), 8, file);
+  fclose(file);
+  ck_assert_ptr_null(nerd_constructor_from_file("../bin/nerd_output4.ndb", true));
+
+  // A file that holds the same Rule twice is not valid.
+  nerd = nerd_constructor(15.0, 5, 3, 50, 1.5, 4.5, true, true);
+  Literal *head = literal_constructor("bird", true),
+          *body = literal_constructor("wings", true);
+  Rule *rule = rule_constructor(1, &body, &head, 16.0, true);
+  knowledge_base_add_rule(nerd->knowledge_base, &rule);
+  NerdSnapshot *snapshot = nerd_snapshot_constructor(nerd);
+  snapshot->number_of_rules = 2;
+  snapshot->literals =
+      (Literal *)realloc(snapshot->literals, 4 * sizeof(Literal));
+  memcpy(snapshot->literals + 2, snapshot->literals, 2 * sizeof(Literal));
+  snapshot->weights = (float *)realloc(snapshot->weights, 2 * sizeof(float));
+  snapshot->weights[1] = snapshot->weights[0];
+  snapshot->offsets = (size_t *)realloc(snapshot->offsets, 3 * sizeof(size_t));
+  snapshot->offsets[2] = 4;
+  ck_assert_int_eq(
+      nerd_snapshot_to_binary_file(snapshot, "../bin/nerd_output4.ndb"), 0);
+  ck_assert_ptr_null(
+      nerd_constructor_from_file("../bin/nerd_output4.ndb", true));
+  nerd_snapshot_destructor(&snapshot);
+  nerd_destructor(&nerd);
+}
+END_TEST
+
+START_TEST(snapshot_test) {
+  Nerd *nerd = nerd_constructor_from_file("../test/data/nerd_input2.txt", true);
+  NerdSnapshot *snapshot = nerd_snapshot_constructor(nerd);
+  ck_assert_ptr_nonnull(snapshot);
+  RuleQueue *inactive_rules;
+  rule_hypergraph_get_inactive_rules(nerd->knowledge_base, &inactive_rules);
+  ck_assert_int_eq(snapshot->number_of_rules,
+                   nerd->knowledge_base->active->length +
+                       inactive_rules->length);
+  rule_queue_destructor(&inactive_rules);
+  ck_assert_int_eq(snapshot->max_rules_per_instance,
+                   nerd->max_rules_per_instance);
+  ck_assert_float_eq(snapshot->activation_threshold,
+                     nerd->knowledge_base->activation_threshold);
+  unsigned int i;
+  for (i = 0; i < nerd->knowledge_base->active->length; ++i) {
+    ck_assert_float_eq(snapshot->weights[i],
+                       nerd->knowledge_base->active->rules[i]->weight);
+    ck_assert_int_eq(snapshot->offsets[i + 1] - snapshot->offsets[i],
+                     nerd->knowledge_base->active->rules[i]->body.size + 1);
+  }
+
+  nerd_to_file(nerd, "../bin/nerd_output6.txt");
+  nerd_to_binary_file(nerd, "../bin/nerd_output6.ndb");
+  nerd_destructor(&nerd);
+
+  ck_assert_int_eq(nerd_snapshot_to_file(snapshot, "../bin/nerd_output7.txt"),
+                   0);
+  ck_assert_int_eq(
+      compare_files("../bin/nerd_output6.txt", "../bin/nerd_output7.txt"), 0);
+  ck_assert_int_eq(
+      nerd_snapshot_to_binary_file(snapshot, "../bin/nerd_output7.ndb"), 0);
+  ck_assert_int_eq(
+      compare_files("../bin/nerd_output6.ndb", "../bin/nerd_output7.ndb"), 0);
+
+  ck_assert_int_eq(nerd_snapshot_to_file(snapshot, NULL), -2);
+  ck_assert_int_eq(nerd_snapshot_to_file(NULL, "../bin/nerd_output7.txt"), -2);
+  ck_assert_int_eq(
+      nerd_snapshot_to_file(snapshot, "../directory/that/does/not/exist"), -1);
+  ck_assert_int_eq(nerd_snapshot_to_binary_file(snapshot, NULL), -2);
+  ck_assert_int_eq(
+      nerd_snapshot_to_binary_file(NULL, "../bin/nerd_output7.ndb"), -2);
+
+  nerd_snapshot_destructor(&snapshot);
+  ck_assert_ptr_null(snapshot);
+  nerd_snapshot_destructor(&snapshot);
+  nerd_snapshot_destructor(NULL);
+  ck_assert_ptr_null(nerd_snapshot_constructor(NULL));
+}
+END_TEST
+
 Suite *nerd_suite() {
   Suite *suite = suite_create("Nerd");
   TCase *create_case, *convert_case, *train_case;
@@ -341,13 +456,15 @@ Suite *nerd_suite() {
 
   convert_case = tcase_create("Convert");
   tcase_add_test(convert_case, to_file_test);
+  tcase_add_test(convert_case, to_binary_file_test);
+  tcase_add_test(convert_case, snapshot_test);
   suite_add_tcase(suite, convert_case);
 
   return suite;
 }
 
 int main(int argc, char *argv[]) {
-  prudensjs_settings_constructor(argv[0], NULL, NULL, NULL);
+  prudensjs_settings_constructor(argv[0], NULL);
   Suite *suite = nerd_suite();
   SRunner *s_runner;
 
@@ -0,0 +1,199 @@
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../src/inference_engine.h"
+#include "../src/nerd_journal.h"
+#include "helper/rule_queue.h"
+
+#define JOURNAL_PATH "../bin/journal_test.ndj"
+#define NUMBER_OF_INSTANCES 12
+
+/**
+ * @brief Check that the Nerd materialized from the journal at the given
+ * iteration and instance has the same KnowledgeBase as the expected one.
+ *
+ * @param X The expected KnowledgeBase.
+ * @param ACTIVE The expected active Rules, in their priority order.
+ * @param ITERATION The journaled iteration.
+ * @param INSTANCE The journaled instance.
+ */
+#define ck_assert_journaled_knowledge_base_eq(X, ACTIVE, ITERATION, INSTANCE)  \
+  do {                                                                         \
+    const KnowledgeBase *const _expected = (X);                                \
+    Nerd *_nerd = nerd_constructor_from_journal(JOURNAL_PATH, (ITERATION),     \
+                                                (INSTANCE), true);             \
+    ck_assert_ptr_nonnull(_nerd);                                              \
+    ck_assert_float_eq_tol(_nerd->knowledge_base->activation_threshold,        \
+                           _expected->activation_threshold, 0.000001);         \
+    ck_assert_rule_queue_eq(_nerd->knowledge_base->active, (ACTIVE));          \
+    RuleQueue *_inactive1, *_inactive2;                                        \
+    rule_hypergraph_get_inactive_rules(_nerd->knowledge_base, &_inactive1);    \
+    rule_hypergraph_get_inactive_rules(_expected, &_inactive2);                \
+    ck_assert_int_eq(_inactive1->length, _inactive2->length);                  \
+    unsigned int _i;                                                           \
+    int _index;                                                                \
+    for (_i = 0; _i < _inactive2->length; ++_i) {                              \
+      _index = rule_queue_find(_inactive1, _inactive2->rules[_i]);             \
+      ck_assert_int_ge(_index, 0);                                             \
+      ck_assert_float_eq(_inactive1->rules[_index]->weight,                    \
+                         _inactive2->rules[_i]->weight);                       \
+    }                                                                          \
+    rule_queue_destructor(&_inactive1);                                        \
+    rule_queue_destructor(&_inactive2);                                        \
+    nerd_destructor(&_nerd);                                                   \
+  } while (0)
+
+/**
+ * @brief Constructs a Scene from the given Literal strings.
+ */
+Scene *create_scene(const unsigned int size, const char *literals[]) {
+  Scene *scene = scene_constructor(true);
+  Literal *literal;
+  unsigned int i;
+  for (i = 0; i < size; ++i) {
+    literal = literal_constructor_from_string(literals[i]);
+    scene_add_literal(scene, &literal);
+  }
+  return scene;
+}
+
+/**
+ * @brief Copies the active Rules of a KnowledgeBase in their priority order.
+ * The copies do not change as the KnowledgeBase keeps learning, unlike the
+ * Rules of a (non-owning) rule_queue_copy.
+ */
+RuleQueue *copy_active_rules(const KnowledgeBase *const knowledge_base) {
+  RuleQueue *active = rule_queue_constructor(true);
+  Rule *copy;
+  unsigned int i;
+  for (i = 0; i < knowledge_base->active->length; ++i) {
+    rule_copy(&copy, knowledge_base->active->rules[i]);
+    rule_queue_enqueue(active, &copy);
+  }
+  return active;
+}
+
+START_TEST(construct_destruct_test) {
+  Nerd *nerd = nerd_constructor(3, 2, 2, 1, 1, 1.5, true, false);
+  NerdJournal *journal = nerd_journal_constructor(JOURNAL_PATH, nerd);
+  ck_assert_ptr_nonnull(journal);
+  ck_assert_int_eq(nerd_journal_destructor(&journal), 0);
+  ck_assert_ptr_null(journal);
+  ck_assert_int_eq(nerd_journal_destructor(&journal), -2);
+  ck_assert_int_eq(nerd_journal_destructor(NULL), -2);
+
+  Nerd *base = nerd_constructor_from_journal(JOURNAL_PATH, 0, 0, true);
+  ck_assert_ptr_nonnull(base);
+  ck_assert_int_eq(base->max_rules_per_instance, 2);
+  ck_assert_int_eq(base->breadth, 2);
+  ck_assert_int_eq(base->depth, 1);
+  ck_assert_float_eq(base->promotion_weight, 1);
+  ck_assert_float_eq(base->demotion_weight, 1.5);
+  ck_assert_int_eq(base->increasing_demotion, false);
+  ck_assert_float_eq(base->knowledge_base->activation_threshold, 3);
+  ck_assert_int_eq(base->knowledge_base->active->length, 0);
+  nerd_destructor(&base);
+  ck_assert_ptr_null(nerd_constructor_from_journal(JOURNAL_PATH, 1, 1, true));
+
+  ck_assert_ptr_null(nerd_journal_constructor(NULL, nerd));
+  ck_assert_ptr_null(nerd_journal_constructor(JOURNAL_PATH, NULL));
+  ck_assert_ptr_null(
+      nerd_journal_constructor("../directory/that/does/not/exist", nerd));
+  ck_assert_ptr_null(nerd_journal_reader_constructor(NULL));
+  ck_assert_ptr_null(
+      nerd_journal_reader_constructor("../test/data/nerd_input2.txt"));
+  ck_assert_ptr_null(nerd_journal_reader_constructor("../file-that-does-not-exist"));
+  nerd_destructor(&nerd);
+}
+END_TEST
+
+START_TEST(record_test) {
+  Nerd *nerd = nerd_constructor(3, 2, 2, 1, 1, 1.5, true, false);
+  Scene *observations[2] = {
+      create_scene(3, (const char *[]){"bird", "wings", "fly"}),
+      create_scene(4, (const char *[]){"penguin", "bird", "wings", "-fly"})};
+  Scene *labels = create_scene(2, (const char *[]){"fly", "-fly"});
+  KnowledgeBase *expected[NUMBER_OF_INSTANCES];
+  RuleQueue *expected_active[NUMBER_OF_INSTANCES];
+  pcg32_random_t rng;
+  global_rng = &rng;
+  pcg32_srandom_r(&rng, 42, 1);
+
+  NerdJournal *journal = nerd_journal_constructor(JOURNAL_PATH, nerd);
+  ck_assert_int_eq(nerd_journal_record(NULL, nerd, 1, 1), -2);
+  ck_assert_int_eq(nerd_journal_record(journal, NULL, 1, 1), -2);
+
+  unsigned int i;
+  for (i = 0; i < NUMBER_OF_INSTANCES; ++i) {
+    nerd_train(nerd, native_inference, observations[(i % 5) != 0], labels,
+               true, NULL, NULL, NULL, 0, NULL);
+    ck_assert_int_eq(nerd_journal_record(journal, nerd, 1, i + 1), 0);
+    knowledge_base_copy(&(expected[i]), nerd->knowledge_base);
+    expected_active[i] = copy_active_rules(nerd->knowledge_base);
+  }
+  global_rng = NULL;
+  ck_assert_int_eq(nerd_journal_destructor(&journal), 0);
+
+  for (i = 0; i < NUMBER_OF_INSTANCES; ++i) {
+    ck_assert_journaled_knowledge_base_eq(expected[i], expected_active[i], 1,
+                                          i + 1);
+    knowledge_base_destructor(&(expected[i]));
+    rule_queue_destructor(&(expected_active[i]));
+  }
+
+  NerdJournalReader *reader = nerd_journal_reader_constructor(JOURNAL_PATH);
+  ck_assert_ptr_nonnull(reader);
+  ck_assert_int_eq(nerd_journal_reader_next(reader), 0);
+  ck_assert_int_eq(reader->iteration, 0);
+  ck_assert_int_eq(reader->instance, 0);
+  for (i = 0; i < NUMBER_OF_INSTANCES; ++i) {
+    ck_assert_int_eq(nerd_journal_reader_next(reader), 0);
+    ck_assert_int_eq(reader->iteration, 1);
+    ck_assert_int_eq(reader->instance, i + 1);
+  }
+  ck_assert_int_eq(nerd_journal_reader_next(reader), 1);
+  ck_assert_int_eq(nerd_journal_reader_next(NULL), -2);
+  ck_assert_ptr_null(nerd_journal_reader_to_nerd(NULL, true));
+  nerd_journal_reader_destructor(&reader);
+  ck_assert_ptr_null(reader);
+
+  ck_assert_ptr_null(nerd_constructor_from_journal(
+      JOURNAL_PATH, 1, NUMBER_OF_INSTANCES + 1, true));
+
+  scene_destructor(&(observations[0]));
+  scene_destructor(&(observations[1]));
+  scene_destructor(&labels);
+  nerd_destructor(&nerd);
+}
+END_TEST
+
+Suite *nerd_journal_suite() {
+  Suite *suite;
+  TCase *create_case, *record_case;
+
+  suite = suite_create("Nerd Journal");
+  create_case = tcase_create("Create");
+  tcase_add_test(create_case, construct_destruct_test);
+  suite_add_tcase(suite, create_case);
+
+  record_case = tcase_create("Record");
+  tcase_add_test(record_case, record_test);
+  suite_add_tcase(suite, record_case);
+
+  return suite;
+}
+
+int main() {
+  Suite *suite = nerd_journal_suite();
+  SRunner *s_runner;
+
+  s_runner = srunner_create(suite);
+  srunner_set_fork_status(s_runner, CK_NOFORK);
+
+  srunner_run_all(s_runner, CK_ENV);
+  int number_failed = srunner_ntests_failed(s_runner);
+  srunner_free(s_runner);
+
+  return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
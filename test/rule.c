@@ -25,12 +25,12 @@ START_TEST(construct_destruct_test) {
 
   Rule *rule = rule_constructor(BODY_SIZE, body, &head, starting_weight, true);
 
-  ck_assert_int_eq(rule->body->size, BODY_SIZE);
+  ck_assert_int_eq(rule->body.size, BODY_SIZE);
   ck_assert_literal_eq(rule->head, head_copy);
   ck_assert_ptr_null(head);
   for (i = 0; i < BODY_SIZE; ++i) {
     ck_assert_ptr_null(body[i]);
-    ck_assert_literal_eq(rule->body->literals[i], body_copy[i]);
+    ck_assert_literal_eq(rule->body.literals[i], body_copy[i]);
   }
   ck_assert_float_eq(rule->weight, starting_weight);
 
@@ -57,14 +57,14 @@ START_TEST(construct_destruct_test) {
   rule = rule_constructor(BODY_SIZE, body_copy, &head_copy, starting_weight,
                           false);
 
-  ck_assert_int_eq(rule->body->size, BODY_SIZE);
+  ck_assert_int_eq(rule->body.size, BODY_SIZE);
   ck_assert_literal_eq(rule->head, head_copy);
   ck_assert_ptr_eq(rule->head, head_copy);
   ck_assert_ptr_nonnull(head_copy);
   for (i = 0; i < BODY_SIZE; ++i) {
     ck_assert_ptr_nonnull(body_copy[i]);
-    ck_assert_literal_eq(rule->body->literals[i], body_copy[i]);
-    ck_assert_ptr_eq(rule->body->literals[i], body_copy[i]);
+    ck_assert_literal_eq(rule->body.literals[i], body_copy[i]);
+    ck_assert_ptr_eq(rule->body.literals[i], body_copy[i]);
   }
   ck_assert_float_eq(rule->weight, starting_weight);
 
@@ -131,10 +131,10 @@ START_TEST(copy_test) {
 
   ck_assert_rule_eq(rule1, rule2);
   ck_assert_ptr_ne(rule1, rule2);
-  ck_assert_ptr_ne(rule1->body, rule2->body);
-  ck_assert_ptr_ne(rule1->head, rule2->head);
-  for (i = 0; i < rule1->body->size; ++i) {
-    ck_assert_ptr_ne(rule1->body->literals[i], rule2->body->literals[i]);
+  ck_assert_ptr_ne(rule1->body.literals, rule2->body.literals);
+  ck_assert_ptr_eq(rule1->head, rule2->head);
+  for (i = 0; i < rule1->body.size; ++i) {
+    ck_assert_ptr_eq(rule1->body.literals[i], rule2->body.literals[i]);
   }
   rule_destructor(&rule1);
   ck_assert_ptr_null(rule1);
@@ -150,10 +150,10 @@ START_TEST(copy_test) {
 
   ck_assert_rule_eq(rule1, rule2);
   ck_assert_ptr_ne(rule1, rule2);
-  ck_assert_ptr_ne(rule1->body, rule2->body);
+  ck_assert_ptr_ne(rule1->body.literals, rule2->body.literals);
   ck_assert_ptr_eq(rule1->head, rule2->head);
-  for (i = 0; i < rule1->body->size; ++i) {
-    ck_assert_ptr_eq(rule1->body->literals[i], rule2->body->literals[i]);
+  for (i = 0; i < rule1->body.size; ++i) {
+    ck_assert_ptr_eq(rule1->body.literals[i], rule2->body.literals[i]);
     literal_destructor(&(body_copy[i]));
   }
   literal_destructor(&head_copy);
@@ -367,6 +367,14 @@ START_TEST(equality_checK_test) {
   ck_assert_int_eq(rule_equals(NULL, rule1), -1);
   ck_assert_int_eq(rule_equals(NULL, NULL), -1);
 
+  ck_assert_uint_eq(rule1->fingerprint, rule6->fingerprint);
+  ck_assert_uint_eq(rule1->fingerprint, rule2->fingerprint);
+  ck_assert_uint_eq(rule1->fingerprint, rule3->fingerprint);
+  ck_assert_uint_ne(rule1->fingerprint, rule4->fingerprint);
+  ck_assert_uint_ne(rule1->fingerprint, rule5->fingerprint);
+  ck_assert_uint_ne(rule1->fingerprint, rule7->fingerprint);
+  ck_assert_uint_ne(rule4->fingerprint, rule5->fingerprint);
+
   rule_destructor(&rule1);
   rule_destructor(&rule2);
   rule_destructor(&rule3);
@@ -412,7 +420,7 @@ START_TEST(to_string_test) {
   free(rule_string);
 
   rule_copy(&copy, rule);
-  context_destructor(&(copy->body));
+  copy->body.size = 0;
   rule_string = rule_to_string(copy);
   ck_assert_pstr_eq(rule_string, NULL);
 
@@ -491,7 +499,7 @@ START_TEST(to_prudensjs_test) {
 
   rule_copy(&copy, rule);
 
-  context_destructor(&(copy->body));
+  copy->body.size = 0;
   rule_prudensjs_string = rule_to_prudensjs(copy, 2);
   ck_assert_pstr_eq(rule_prudensjs_string, NULL);
 
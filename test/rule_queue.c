@@ -389,6 +389,60 @@ START_TEST(remove_indexed_rule_test) {
 }
 END_TEST
 
+START_TEST(indexed_test) {
+  RuleQueue *rule_queue = rule_queue_indexed_constructor(false);
+  Rule *rule = NULL, **rules = create_rules();
+
+  ck_assert_int_eq(rule_queue_is_taking_ownership(rule_queue), false);
+  ck_assert_rule_queue_empty(rule_queue);
+
+  unsigned int i;
+  for (i = 0; i < RULES_TO_CREATE; ++i) {
+    ck_assert_int_eq(rules[i]->queue_index, -1);
+    ck_assert_int_eq(rule_queue_find(rule_queue, rules[i]), -1);
+    rule_queue_enqueue(rule_queue, &(rules[i]));
+    ck_assert_ptr_nonnull(rules[i]);
+    ck_assert_int_eq(rules[i]->queue_index, i);
+    ck_assert_int_eq(rule_queue_find(rule_queue, rules[i]), i);
+  }
+
+  rule_queue_enqueue(rule_queue, &(rules[1]));
+  ck_assert_int_eq(rule_queue->length, RULES_TO_CREATE);
+
+  rule_copy(&rule, rules[1]);
+  ck_assert_int_eq(rule->queue_index, -1);
+  ck_assert_int_eq(rule_queue_find(rule_queue, rule), -1);
+  rule_destructor(&rule);
+
+  rule_queue_remove_rule(rule_queue, 0, &rule);
+  ck_assert_ptr_eq(rule, rules[0]);
+  ck_assert_int_eq(rules[0]->queue_index, -1);
+  ck_assert_int_eq(rule_queue_find(rule_queue, rules[0]), -1);
+  ck_assert_int_eq(rule_queue->length, RULES_TO_CREATE - 1);
+  for (i = 0; i < rule_queue->length; ++i) {
+    ck_assert_ptr_eq(rule_queue->rules[i], rules[i + 1]);
+    ck_assert_int_eq(rule_queue_find(rule_queue, rules[i + 1]), i);
+  }
+
+  rule_queue_enqueue(rule_queue, &rule);
+  ck_assert_ptr_eq(rule_queue->rules[2], rules[0]);
+  ck_assert_int_eq(rule_queue_find(rule_queue, rules[0]), 2);
+
+  rule_queue_dequeue(rule_queue, &rule);
+  ck_assert_ptr_eq(rule, rules[1]);
+  ck_assert_int_eq(rule_queue_find(rule_queue, rules[1]), -1);
+  ck_assert_int_eq(rule_queue_find(rule_queue, rules[2]), 0);
+  ck_assert_int_eq(rule_queue_find(rule_queue, rules[0]), 1);
+
+  rule_queue_destructor(&rule_queue);
+  for (i = 0; i < RULES_TO_CREATE; ++i) {
+    ck_assert_int_eq(rules[i]->queue_index, -1);
+  }
+
+  destruct_rules(rules);
+}
+END_TEST
+
 START_TEST(find_applicable_rules_test) {
   RuleQueue *rule_queue = rule_queue_constructor(true);
   Context *context = context_constructor(true);
@@ -491,6 +545,7 @@ Suite *rule_queue_suite() {
   tcase_add_test(operations_case, dequeue_test);
   tcase_add_test(operations_case, retrieve_index_text);
   tcase_add_test(operations_case, remove_indexed_rule_test);
+  tcase_add_test(operations_case, indexed_test);
   tcase_add_test(operations_case, find_applicable_rules_test);
   tcase_add_test(operations_case, find_concurring_rules_test);
   suite_add_tcase(suite, operations_case);
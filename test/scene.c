@@ -157,6 +157,12 @@ START_TEST(index_retrieval_test) {
   ck_assert_int_eq(scene_literal_index(scene, NULL), -2);
   ck_assert_int_eq(scene_literal_index(NULL, c2), -2);
 
+  scene_remove_literal(scene, 1, NULL);
+  ck_assert_int_eq(scene_literal_index(scene, c1), 0);
+  ck_assert_int_eq(scene_literal_index(scene, c2), -1);
+  ck_assert_int_eq(scene_literal_index(scene, c3), 1);
+  ck_assert_int_eq(scene_literal_index(scene, c4), 2);
+
   scene_destructor(&scene);
   literal_destructor(&c1);
   literal_destructor(&c2);
@@ -277,6 +283,136 @@ START_TEST(delete_test) {
 }
 END_TEST
 
+START_TEST(add_many_test) {
+  Scene *scene1 = scene_constructor(true), *scene2 = scene_constructor(false);
+  const char *atoms[] = {"Penguin", "Antarctica", "Bird", "Fly",  "Wings",
+                         "Feathers", "Beak",      "Eggs", "Swim", "Ice"};
+  Literal *literals1[12], *literals2[12];
+  unsigned int i;
+  for (i = 0; i < 10; ++i) {
+    literals1[i] = literal_constructor(atoms[i], 1);
+    literals2[i] = literals1[i];
+  }
+  literals1[10] = literal_constructor("Bird", 1);
+  literals2[10] = literals1[10];
+  literals1[11] = NULL;
+  literals2[11] = NULL;
+
+  scene_add_literals(scene1, 12, literals1);
+  scene_add_literals(scene2, 12, literals2);
+  ck_assert_int_eq(scene1->size, 10);
+  ck_assert_int_eq(scene2->size, 10);
+  for (i = 0; i < 10; ++i) {
+    ck_assert_ptr_null(literals1[i]);
+    ck_assert_ptr_eq(scene1->literals[i], literals2[i]);
+    ck_assert_ptr_eq(scene2->literals[i], literals2[i]);
+    ck_assert_int_eq(scene_literal_index(scene1, literals2[i]), i);
+  }
+  ck_assert_ptr_nonnull(literals1[10]);
+  ck_assert_int_eq(scene_literal_index(scene2, literals2[10]), 2);
+
+  scene_add_literals(NULL, 12, literals1);
+  scene_add_literals(scene1, 12, NULL);
+  ck_assert_int_eq(scene1->size, 10);
+
+  scene_destructor(&scene2);
+  scene_destructor(&scene1);
+  literal_destructor(&(literals1[10]));
+}
+END_TEST
+
+START_TEST(swap_delete_test) {
+  Scene *scene1 = scene_constructor(true), *scene2 = scene_constructor(false);
+  const char *atoms[] = {"Penguin", "Antarctica", "Bird", "Fly", "Wings",
+                         "Feathers"};
+  Literal *literals[6], *literal, *removed_literal;
+  unsigned int i;
+  for (i = 0; i < 6; ++i) {
+    literals[i] = literal_constructor(atoms[i], 1);
+    scene_add_literal(scene2, &(literals[i]));
+    literal_copy(&literal, literals[i]);
+    scene_add_literal(scene1, &literal);
+  }
+
+  scene_swap_remove_literal(scene1, 1, NULL);
+  ck_assert_int_eq(scene1->size, 5);
+  ck_assert_literal_eq(scene1->literals[1], literals[5]);
+  ck_assert_int_eq(scene_literal_index(scene1, literals[1]), -1);
+  ck_assert_int_eq(scene_literal_index(scene1, literals[5]), 1);
+
+  scene_swap_remove_literal(scene2, 0, &removed_literal);
+  ck_assert_ptr_eq(removed_literal, literals[0]);
+  ck_assert_int_eq(scene2->size, 5);
+  ck_assert_ptr_eq(scene2->literals[0], literals[5]);
+  ck_assert_int_eq(scene_literal_index(scene2, literals[0]), -1);
+  ck_assert_int_eq(scene_literal_index(scene2, literals[5]), 0);
+
+  scene_swap_remove_literal(scene2, 4, &removed_literal);
+  ck_assert_ptr_eq(removed_literal, literals[4]);
+  ck_assert_int_eq(scene2->size, 4);
+  for (i = 0; i < scene2->size; ++i) {
+    ck_assert_int_eq(scene_literal_index(scene2, scene2->literals[i]), i);
+  }
+
+  scene_swap_remove_literal(scene1, 9, NULL);
+  ck_assert_int_eq(scene1->size, 5);
+  scene_swap_remove_literal(NULL, 0, NULL);
+
+  while (scene1->size > 0) {
+    scene_swap_remove_literal(scene1, 0, NULL);
+  }
+  ck_assert_scene_empty(scene1);
+
+  scene_destructor(&scene1);
+  scene_destructor(&scene2);
+  for (i = 0; i < 6; ++i) {
+    literal_destructor(&(literals[i]));
+  }
+}
+END_TEST
+
+START_TEST(clear_test) {
+  Scene *scene1 = scene_constructor(true), *scene2 = scene_constructor(false);
+  const char *atoms[] = {"Penguin", "Antarctica", "Bird", "Fly", "Wings",
+                         "Feathers"};
+  Literal *literals[6], *literal;
+  unsigned int i;
+  for (i = 0; i < 6; ++i) {
+    literals[i] = literal_constructor(atoms[i], 1);
+    scene_add_literal(scene2, &(literals[i]));
+    literal_copy(&literal, literals[i]);
+    scene_add_literal(scene1, &literal);
+  }
+
+  scene_clear(scene1);
+  ck_assert_scene_empty(scene1);
+  ck_assert_int_eq(scene_literal_index(scene1, literals[0]), -1);
+
+  scene_clear(scene2);
+  ck_assert_scene_empty(scene2);
+  for (i = 0; i < 6; ++i) {
+    ck_assert_int_eq(scene_literal_index(scene2, literals[i]), -1);
+  }
+
+  for (i = 6; i > 0; --i) {
+    scene_add_literal(scene2, &(literals[i - 1]));
+  }
+  ck_assert_int_eq(scene2->size, 6);
+  for (i = 0; i < 6; ++i) {
+    ck_assert_ptr_eq(scene2->literals[i], literals[5 - i]);
+    ck_assert_int_eq(scene_literal_index(scene2, literals[i]), 5 - i);
+  }
+
+  scene_clear(NULL);
+
+  scene_destructor(&scene1);
+  scene_destructor(&scene2);
+  for (i = 0; i < 6; ++i) {
+    literal_destructor(&(literals[i]));
+  }
+}
+END_TEST
+
 START_TEST(copy_test) {
   Scene *scene1 = scene_constructor(true), *scene2 = NULL;
   Literal *l1 = literal_constructor("Penguin", 1),
@@ -303,7 +439,7 @@ START_TEST(copy_test) {
   unsigned int i = 0;
   for (i = 0; i < scene1->size; ++i) {
     ck_assert_literal_eq(scene1->literals[i], scene2->literals[i]);
-    ck_assert_ptr_ne(scene1->literals[i], scene2->literals[i]);
+    ck_assert_ptr_eq(scene1->literals[i], scene2->literals[i]);
   }
 
   scene_destructor(&scene1);
@@ -886,10 +1022,27 @@ START_TEST(subset_check_test) {
   ck_assert_int_eq(scene_is_subset(scene1_copy, scene1), 1);
   ck_assert_int_eq(scene_is_subset(scene1, scene1_copy), 1);
 
+  unsigned int keys[2] = {(l1->id << 1) | l1->sign, (l4->id << 1) | l4->sign},
+               opposed_key = (opposed_l2->id << 1) | opposed_l2->sign;
+  if (keys[0] > keys[1]) {
+    const unsigned int temp = keys[0];
+    keys[0] = keys[1];
+    keys[1] = temp;
+  }
+  ck_assert_int_eq(scene_contains_keys(scene1, 2, keys), 1);
+  ck_assert_int_eq(scene_contains_keys(scene3, 2, keys), 1);
+  ck_assert_int_eq(scene_contains_keys(scene2, 2, keys), 0);
+  ck_assert_int_eq(scene_contains_keys(scene4, 2, keys), 0);
+  ck_assert_int_eq(scene_contains_keys(scene1, 1, &opposed_key), 0);
+  ck_assert_int_eq(scene_contains_keys(scene5, 1, &opposed_key), 1);
+  ck_assert_int_eq(scene_contains_keys(scene5, 0, keys), 1);
+  ck_assert_int_eq(scene_contains_keys(scene1, 2, NULL), -1);
+
   scene_destructor(&scene1);
 
   ck_assert_int_eq(scene_is_subset(scene2, scene1), -1);
   ck_assert_int_eq(scene_is_subset(scene1, scene2), -1);
+  ck_assert_int_eq(scene_contains_keys(scene1, 2, keys), -1);
 
   scene_destructor(&scene2);
   scene_destructor(&scene3);
@@ -1087,6 +1240,22 @@ START_TEST(opposed_literals_test) {
   scene_destructor(&expected1);
   scene_opposed_literals(scene1, scene2, &result, oppositions);
   ck_assert_scene_empty(result);
+  scene_destructor(&result);
+
+  scene_destructor(&scene1);
+  scene_destructor(&scene2);
+  scene1 = scene_constructor(true);
+  scene2 = scene_constructor(true);
+  literal_copy(&l3, c3);
+  scene_add_literal(scene1, &l3);
+  literal_copy(&l4, c4);
+  scene_add_literal(scene2, &l4);
+  expected1 = scene_constructor(false);
+  scene_add_literal(expected1, &c4);
+  scene_opposed_literals(scene1, scene2, &result, oppositions);
+  ck_assert_scene_eq(expected1, result);
+  ck_assert_int_eq(scene_literal_index(result, c4), 0);
+  scene_destructor(&expected1);
 
   scene_destructor(&scene1);
   scene_destructor(&scene2);
@@ -1117,6 +1286,9 @@ Suite *scene_suite() {
   tcase_add_test(manipulation_case, add_test);
   tcase_add_test(manipulation_case, index_retrieval_test);
   tcase_add_test(manipulation_case, delete_test);
+  tcase_add_test(manipulation_case, add_many_test);
+  tcase_add_test(manipulation_case, swap_delete_test);
+  tcase_add_test(manipulation_case, clear_test);
   tcase_add_test(manipulation_case, combine_test);
   tcase_add_test(manipulation_case, difference_test);
   tcase_add_test(manipulation_case, intersect_test);
@@ -1,12 +1,16 @@
 #include <check.h>
 #include <math.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "../src/sensor.h"
 
 #define SENSOR_TEST_DATA1 "../test/data/sensor_test1.txt"
 #define SENSOR_TEST_DATA2 "../test/data/sensor_test2.txt"
 #define SENSOR_TEST_DATA3 "../test/data/sensor_test3.txt"
+#define SENSOR_TEST_DATA4 "../test/data/sensor_test4.txt"
+#define SENSOR_ENCODED_PATH "../bin/sensor_test.nde"
+#define SENSOR_LABELS_PATH "../bin/sensor_labels_test.csv"
 
 START_TEST(construct_destruct_test) {
   Sensor *sensor = sensor_constructor_from_file(SENSOR_TEST_DATA1, ' ', 0, 0);
@@ -282,6 +286,443 @@ START_TEST(get_scene_test) {
 }
 END_TEST
 
+START_TEST(tokenize_test) {
+  Sensor *sensor =
+      sensor_constructor_from_file(SENSOR_TEST_DATA4, ',', false, false);
+  Scene *scene = NULL;
+  char *string;
+  unsigned int i, j;
+
+  ck_assert_int_eq(sensor_get_total_observations(sensor), 3);
+
+  const char *expected[3] = {"penguin", "-fly", "bird"};
+  sensor_get_next_scene(sensor, &scene);
+  ck_assert_int_eq(scene->size, 3);
+  for (i = 0; i < scene->size; ++i) {
+    string = literal_to_string(scene->literals[i]);
+    ck_assert_str_eq(string, expected[i]);
+    free(string);
+  }
+  scene_destructor(&scene);
+
+  sensor_get_next_scene(sensor, &scene);
+  ck_assert_int_eq(scene->size, 1);
+  string = literal_to_string(scene->literals[0]);
+  ck_assert_str_eq(string, "bird");
+  free(string);
+  scene_destructor(&scene);
+
+  sensor_get_next_scene(sensor, &scene);
+  ck_assert_int_eq(scene->size, 1);
+  string = literal_to_string(scene->literals[0]);
+  ck_assert_str_eq(string, "eagle");
+  free(string);
+  scene_destructor(&scene);
+
+  sensor_get_next_scene(sensor, &scene);
+  ck_assert_ptr_null(scene);
+  sensor_destructor(&sensor);
+
+  sensor = sensor_constructor_from_file(SENSOR_TEST_DATA4, ',', true, true);
+  ck_assert_int_eq(sensor->header_size, 4);
+  ck_assert_str_eq(sensor->header[1], " -Fly ");
+  ck_assert_int_eq(sensor_get_total_observations(sensor), 2);
+
+  const char *expected_with_header[3] = {"penguin _bird", "-fly _bird",
+                                         "_ bird"};
+  for (i = 0; i < 2; ++i) {
+    sensor_get_next_scene(sensor, &scene);
+    ck_assert_int_eq(scene->size, 3);
+    for (j = 0; j < scene->size; ++j) {
+      string = literal_to_string(scene->literals[j]);
+      ck_assert_str_eq(string, expected_with_header[j]);
+      free(string);
+    }
+    scene_destructor(&scene);
+
+    sensor_get_next_scene(sensor, &scene);
+    ck_assert_int_eq(scene->size, 1);
+    string = literal_to_string(scene->literals[0]);
+    ck_assert_str_eq(string, "penguin _eagle");
+    free(string);
+    scene_destructor(&scene);
+  }
+  sensor_destructor(&sensor);
+}
+END_TEST
+
+START_TEST(get_scene_at_test) {
+  Sensor *sensor =
+      sensor_constructor_from_file(SENSOR_TEST_DATA3, ',', false, true);
+  Scene *scene = NULL, *expected = NULL;
+  const size_t total_observations = sensor_get_total_observations(sensor);
+  ck_assert_int_eq(total_observations, 4);
+
+  char *string;
+  size_t i;
+  for (i = total_observations; i > 0; --i) {
+    sensor_get_scene_at(sensor, i - 1, &scene);
+    ck_assert_ptr_nonnull(scene);
+    ck_assert_int_eq(scene->size, 3);
+    scene_destructor(&scene);
+  }
+  sensor_get_scene_at(sensor, 1, &scene);
+  string = literal_to_string(scene->literals[0]);
+  ck_assert_str_eq(string, "animal_imperial eagle");
+  free(string);
+  scene_destructor(&scene);
+
+  for (i = 0; i < total_observations; ++i) {
+    sensor_get_next_scene(sensor, &expected);
+    sensor_get_scene_at(sensor, i, &scene);
+    ck_assert_int_eq(scene->size, expected->size);
+    ck_assert_int_eq(scene_is_subset(scene, expected), 1);
+    scene_destructor(&scene);
+    scene_destructor(&expected);
+  }
+
+  sensor_get_scene_at(sensor, total_observations, &scene);
+  ck_assert_ptr_null(scene);
+  sensor_get_scene_at(NULL, 0, &scene);
+  ck_assert_ptr_null(scene);
+  sensor_get_scene_at(sensor, 0, NULL);
+  sensor_destructor(&sensor);
+}
+END_TEST
+
+START_TEST(index_test) {
+  const char *const dataset = "../bin/sensor_index_test.txt",
+                    *const index =
+                        "../bin/sensor_index_test.txt" SENSOR_INDEX_EXTENSION;
+  FILE *file = fopen(dataset, "wb");
+  fputs("a b\nc d\ne f\n", file);
+  fclose(file);
+  remove(index);
+
+  Sensor *sensor = sensor_constructor_from_file(dataset, ' ', false, false);
+  ck_assert_int_eq(sensor_save_index(sensor), 0);
+  sensor_destructor(&sensor);
+  ck_assert_ptr_nonnull((file = fopen(index, "rb")));
+  fclose(file);
+
+  sensor = sensor_constructor_from_file(dataset, ' ', false, false);
+  ck_assert_int_eq(sensor_get_total_observations(sensor), 3);
+  Scene *scene = NULL;
+  sensor_get_scene_at(sensor, 2, &scene);
+  char *string = literal_to_string(scene->literals[1]);
+  ck_assert_str_eq(string, "f");
+  free(string);
+  scene_destructor(&scene);
+  sensor_destructor(&sensor);
+
+  // A stale index is ignored.
+  file = fopen(dataset, "wb");
+  fputs("a b\nc d\ne f\ng h\n", file);
+  fclose(file);
+  sensor = sensor_constructor_from_file(dataset, ' ', false, false);
+  ck_assert_int_eq(sensor_get_total_observations(sensor), 4);
+  sensor_destructor(&sensor);
+
+  ck_assert_int_eq(sensor_save_index(NULL), -2);
+  remove(index);
+}
+END_TEST
+
+START_TEST(train_test_split_test) {
+  Sensor *sensor =
+      sensor_constructor_from_file(SENSOR_TEST_DATA3, ',', false, true);
+  pcg32_random_t generator;
+  pcg32_srandom_r(&generator, 42u, 54u);
+  FILE *train = NULL, *test = NULL;
+
+  ck_assert_int_eq(train_test_split(sensor, 0.25, &generator, NULL, NULL,
+                                    &train, &test),
+                   0);
+  sensor_destructor(&sensor);
+
+  Sensor *splits[2];
+  FILE *files[2] = {train, test};
+  const char *paths[2] = {"../bin/sensor_train_split.txt",
+                          "../bin/sensor_test_split.txt"};
+  int c;
+  unsigned int i;
+  for (i = 0; i < 2; ++i) {
+    FILE *copy = fopen(paths[i], "wb");
+    rewind(files[i]);
+    while ((c = fgetc(files[i])) != EOF) {
+      fputc(c, copy);
+    }
+    fclose(copy);
+    fclose(files[i]);
+    splits[i] = sensor_constructor_from_file(paths[i], ',', false, true);
+    ck_assert_int_eq(splits[i]->header_size, 3);
+    ck_assert_str_eq(splits[i]->header[2], "flies?");
+  }
+  ck_assert_int_eq(sensor_get_total_observations(splits[0]), 3);
+  ck_assert_int_eq(sensor_get_total_observations(splits[1]), 1);
+  sensor_destructor(&(splits[0]));
+  sensor_destructor(&(splits[1]));
+
+  ck_assert_int_eq(
+      train_test_split(NULL, 0.25, &generator, NULL, NULL, NULL, NULL), -4);
+}
+END_TEST
+
+START_TEST(cache_test) {
+  const char *paths[4] = {SENSOR_TEST_DATA1, SENSOR_TEST_DATA2,
+                          SENSOR_TEST_DATA3, SENSOR_TEST_DATA4};
+  const char delimiters[4] = {' ', ',', ',', ','};
+  Sensor *sensor, *cached;
+  Scene *scene = NULL, *expected = NULL;
+  size_t i, j, k, total_observations;
+  bool header;
+
+  for (i = 0; i < 8; ++i) {
+    header = i >= 4;
+    sensor = sensor_constructor_from_file(paths[i % 4], delimiters[i % 4],
+                                          true, header);
+    cached = sensor_constructor_from_file(paths[i % 4], delimiters[i % 4],
+                                          true, header);
+    ck_assert_int_eq(sensor_cache(cached), 0);
+    ck_assert_int_eq(sensor_cache(cached), 0);
+    total_observations = sensor_get_total_observations(sensor);
+    ck_assert_int_eq(sensor_get_total_observations(cached), total_observations);
+
+    for (j = 0; j < 2 * total_observations; ++j) {
+      sensor_get_next_scene(sensor, &expected);
+      sensor_get_next_scene(cached, &scene);
+      ck_assert_int_eq(scene->size, expected->size);
+      for (k = 0; k < scene->size; ++k) {
+        ck_assert_int_eq(
+            literal_equals(scene->literals[k], expected->literals[k]), 1);
+      }
+      scene_destructor(&scene);
+      scene_destructor(&expected);
+    }
+    sensor_destructor(&sensor);
+    sensor_destructor(&cached);
+  }
+
+  ck_assert_int_eq(sensor_cache(NULL), -2);
+}
+END_TEST
+
+START_TEST(encode_test) {
+  Sensor *sensor =
+      sensor_constructor_from_file(SENSOR_TEST_DATA3, ',', false, true);
+  Scene *labels = scene_constructor(true), *scene = NULL, *expected = NULL;
+  Literal *literal = literal_constructor_from_string("-class_bird");
+  scene_add_literal(labels, &literal);
+  literal = literal_constructor_from_string("class_mammal");
+  scene_add_literal(labels, &literal);
+
+  ck_assert_int_eq(sensor_encode(sensor, labels, SENSOR_ENCODED_PATH), 0);
+  ck_assert_int_eq(sensor_encode(NULL, labels, SENSOR_ENCODED_PATH), -2);
+  ck_assert_int_eq(sensor_encode(sensor, labels, NULL), -2);
+  ck_assert_int_eq(
+      sensor_encode(sensor, labels, "../directory/that/does/not/exist"), -1);
+  ck_assert_int_eq(sensor_is_encoded(SENSOR_ENCODED_PATH), true);
+  ck_assert_int_eq(sensor_is_encoded(SENSOR_TEST_DATA3), false);
+  ck_assert_int_eq(sensor_is_encoded(NULL), false);
+
+  Sensor *encoded =
+      sensor_constructor_from_file(SENSOR_ENCODED_PATH, ' ', true, false);
+  ck_assert_ptr_nonnull(encoded);
+  ck_assert_int_eq(encoded->header_size, sensor->header_size);
+  size_t i, j;
+  for (i = 0; i < sensor->header_size; ++i) {
+    ck_assert_str_eq(encoded->header[i], sensor->header[i]);
+  }
+
+  const size_t total_observations = sensor_get_total_observations(sensor);
+  ck_assert_int_eq(sensor_get_total_observations(encoded), total_observations);
+  for (i = 0; i < total_observations; ++i) {
+    sensor_get_next_scene(sensor, &expected);
+    sensor_get_next_scene(encoded, &scene);
+    ck_assert_int_eq(scene->size, expected->size);
+    for (j = 0; j < scene->size; ++j) {
+      ck_assert_int_eq(
+          literal_equals(scene->literals[j], expected->literals[j]), 1);
+    }
+    scene_destructor(&scene);
+    scene_destructor(&expected);
+  }
+  sensor_get_next_scene(encoded, &scene);
+  ck_assert_ptr_nonnull(scene);
+  scene_destructor(&scene);
+
+  sensor_get_labels(encoded, &scene);
+  ck_assert_int_eq(scene->size, labels->size);
+  for (i = 0; i < labels->size; ++i) {
+    ck_assert_int_eq(literal_equals(scene->literals[i], labels->literals[i]),
+                     1);
+  }
+  scene_destructor(&scene);
+  sensor_get_labels(sensor, &scene);
+  ck_assert_ptr_null(scene);
+  sensor_get_labels(NULL, &scene);
+  ck_assert_ptr_null(scene);
+
+  // The splits of an encoded file are encoded files with the same Scenes.
+  pcg32_random_t generator;
+  FILE *train, *test;
+  Sensor *splits[2], *encoded_splits[2];
+  pcg32_srandom_r(&generator, 42, 54);
+  train_test_split(sensor, 0.25, &generator, "../bin/sensor_split_train.txt",
+                   "../bin/sensor_split_test.txt", NULL, NULL);
+  pcg32_srandom_r(&generator, 42, 54);
+  ck_assert_int_eq(train_test_split(encoded, 0.25, &generator, NULL, NULL,
+                                    &train, &test),
+                   0);
+  fclose(train);
+  fclose(test);
+  pcg32_srandom_r(&generator, 42, 54);
+  train_test_split(encoded, 0.25, &generator, "../bin/sensor_split_train.nde",
+                   "../bin/sensor_split_test.nde", NULL, NULL);
+  splits[0] = sensor_constructor_from_file("../bin/sensor_split_train.txt",
+                                           ',', false, true);
+  splits[1] = sensor_constructor_from_file("../bin/sensor_split_test.txt", ',',
+                                           false, true);
+  encoded_splits[0] = sensor_constructor_from_file(
+      "../bin/sensor_split_train.nde", ',', false, true);
+  encoded_splits[1] = sensor_constructor_from_file(
+      "../bin/sensor_split_test.nde", ',', false, true);
+  unsigned int k;
+  for (k = 0; k < 2; ++k) {
+    ck_assert_ptr_nonnull(encoded_splits[k]);
+    ck_assert_int_eq(sensor_get_total_observations(encoded_splits[k]),
+                     sensor_get_total_observations(splits[k]));
+    for (i = 0; i < sensor_get_total_observations(splits[k]); ++i) {
+      sensor_get_scene_at(splits[k], i, &expected);
+      sensor_get_scene_at(encoded_splits[k], i, &scene);
+      ck_assert_int_eq(scene->size, expected->size);
+      for (j = 0; j < scene->size; ++j) {
+        ck_assert_int_eq(
+            literal_equals(scene->literals[j], expected->literals[j]), 1);
+      }
+      scene_destructor(&scene);
+      scene_destructor(&expected);
+    }
+    sensor_get_labels(encoded_splits[k], &scene);
+    ck_assert_int_eq(scene->size, labels->size);
+    scene_destructor(&scene);
+    sensor_destructor(&(splits[k]));
+    sensor_destructor(&(encoded_splits[k]));
+  }
+  sensor_destructor(&encoded);
+
+  // A truncated encoded file is not valid.
+  FILE *file = fopen(SENSOR_ENCODED_PATH, "rb");
+  fseek(file, 0, SEEK_END);
+  const long size = ftell(file);
+  char *data = (char *)malloc(size);
+  rewind(file);
+  ck_assert_int_eq(fread(data, sizeof(char), size, file), size);
+  fclose(file);
+  file = fopen(SENSOR_ENCODED_PATH, "wb");
+  fwrite(data, sizeof(char), size - 1, file);
+  fclose(file);
+  free(data);
+  ck_assert_ptr_null(
+      sensor_constructor_from_file(SENSOR_ENCODED_PATH, ' ', false, false));
+
+  scene_destructor(&labels);
+  sensor_destructor(&sensor);
+}
+END_TEST
+
+START_TEST(column_values_test) {
+  const char *expected[3][4] = {
+      {"animal_penguin", "animal_imperial eagle", "animal_bat", "animal_human"},
+      {"class_bird", "class_mammal"},
+      {"flies?_no", "flies?_yes"}};
+  const size_t expected_sizes[3] = {4, 2, 2};
+  Sensor *sensors[3] = {
+      sensor_constructor_from_file(SENSOR_TEST_DATA3, ',', false, true),
+      sensor_constructor_from_file(SENSOR_TEST_DATA3, ',', false, true), NULL};
+  sensor_cache(sensors[1]);
+  sensor_encode(sensors[0], NULL, SENSOR_ENCODED_PATH);
+  sensors[2] = sensor_constructor_from_file(SENSOR_ENCODED_PATH, ' ', false,
+                                            false);
+  Scene **columns = NULL;
+  char *string;
+  size_t i, j, k;
+  for (k = 0; k < 3; ++k) {
+    sensor_get_column_values(sensors[k], &columns);
+    ck_assert_ptr_nonnull(columns);
+    for (i = 0; i < 3; ++i) {
+      ck_assert_int_eq(columns[i]->size, expected_sizes[i]);
+      for (j = 0; j < expected_sizes[i]; ++j) {
+        string = literal_to_string(columns[i]->literals[j]);
+        ck_assert_str_eq(string, expected[i][j]);
+        free(string);
+      }
+      scene_destructor(&(columns[i]));
+    }
+    free(columns);
+    columns = NULL;
+    sensor_destructor(&(sensors[k]));
+  }
+
+  Sensor *sensor =
+      sensor_constructor_from_file(SENSOR_TEST_DATA3, ',', false, false);
+  sensor_get_column_values(sensor, &columns);
+  ck_assert_ptr_null(columns);
+  sensor_get_column_values(NULL, &columns);
+  ck_assert_ptr_null(columns);
+  sensor_get_column_values(sensor, NULL);
+  sensor_destructor(&sensor);
+}
+END_TEST
+
+START_TEST(read_labels_test) {
+  // A label longer than BUFFER_SIZE, an empty label and no trailing new line.
+  char long_label[BUFFER_SIZE * 2 + 1];
+  memset(long_label, 'a', BUFFER_SIZE * 2);
+  long_label[BUFFER_SIZE * 2] = '\0';
+  FILE *file = fopen(SENSOR_LABELS_PATH, "w");
+  fprintf(file, "Class_Bird,-class_mammal,\n%s,flies_yes", long_label);
+  fclose(file);
+
+  const char *expected[4] = {"class_bird", "-class_mammal", long_label,
+                             "flies_yes"};
+  Scene *labels = NULL;
+  char *string;
+  size_t i;
+  sensor_read_labels(SENSOR_LABELS_PATH, ',', &labels);
+  ck_assert_ptr_nonnull(labels);
+  ck_assert_int_eq(labels->size, 4);
+  for (i = 0; i < 4; ++i) {
+    string = literal_to_string(labels->literals[i]);
+    ck_assert_str_eq(string, expected[i]);
+    free(string);
+  }
+
+  // An encoded file gives the labels it was encoded with.
+  Sensor *sensor =
+      sensor_constructor_from_file(SENSOR_TEST_DATA3, ',', false, true);
+  sensor_encode(sensor, labels, SENSOR_ENCODED_PATH);
+  sensor_destructor(&sensor);
+  scene_destructor(&labels);
+  sensor_read_labels(SENSOR_ENCODED_PATH, ',', &labels);
+  ck_assert_ptr_nonnull(labels);
+  ck_assert_int_eq(labels->size, 4);
+  for (i = 0; i < 4; ++i) {
+    string = literal_to_string(labels->literals[i]);
+    ck_assert_str_eq(string, expected[i]);
+    free(string);
+  }
+  scene_destructor(&labels);
+
+  sensor_read_labels("../file/that/does/not/exist", ',', &labels);
+  ck_assert_ptr_null(labels);
+  sensor_read_labels(NULL, ',', &labels);
+  ck_assert_ptr_null(labels);
+  sensor_read_labels(SENSOR_LABELS_PATH, ',', NULL);
+  remove(SENSOR_LABELS_PATH);
+}
+END_TEST
+
 Suite *sensor_suite() {
   Suite *suite;
   TCase *create_case, *get_total_observations_case, *get_scene_case;
@@ -296,6 +737,14 @@ Suite *sensor_suite() {
 
   get_scene_case = tcase_create("Get Scene");
   tcase_add_test(get_scene_case, get_scene_test);
+  tcase_add_test(get_scene_case, tokenize_test);
+  tcase_add_test(get_scene_case, get_scene_at_test);
+  tcase_add_test(get_scene_case, index_test);
+  tcase_add_test(get_scene_case, train_test_split_test);
+  tcase_add_test(get_scene_case, cache_test);
+  tcase_add_test(get_scene_case, encode_test);
+  tcase_add_test(get_scene_case, column_values_test);
+  tcase_add_test(get_scene_case, read_labels_test);
   suite_add_tcase(suite, get_scene_case);
 
   return suite;
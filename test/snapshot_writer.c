@@ -0,0 +1,215 @@
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../src/inference_engine.h"
+#include "../src/snapshot_writer.h"
+
+#define NUMBER_OF_INSTANCES 12
+#define OUTPUT_PATH "../bin/snapshot_writer_%u.%s"
+#define EXPECTED_PATH "../bin/snapshot_writer_expected_%u.%s"
+
+/**
+ * @brief Compares two files.
+ *
+ * @returns 0 if the files are identical, -1 if they are not or if one of them
+ * does not exist.
+ *
+ * @param filepath1 Path to the first file.
+ * @param filepath2 Path to the second file.
+ */
+int compare_files(const char *const filepath1, const char *const filepath2) {
+  FILE *file1 = fopen(filepath1, "rb"), *file2 = fopen(filepath2, "rb");
+  int result = -1;
+
+  if (file1 && file2) {
+    int file1_char, file2_char;
+    do {
+      file1_char = fgetc(file1);
+      file2_char = fgetc(file2);
+    } while ((file1_char == file2_char) && (file1_char != EOF));
+    result = (file1_char == file2_char) ? 0 : -1;
+  }
+
+  if (file1) {
+    fclose(file1);
+  }
+  if (file2) {
+    fclose(file2);
+  }
+  return result;
+}
+
+/**
+ * @brief Constructs a Scene from the given Literal strings.
+ */
+Scene *create_scene(const unsigned int size, const char *literals[]) {
+  Scene *scene = scene_constructor(true);
+  Literal *literal;
+  unsigned int i;
+  for (i = 0; i < size; ++i) {
+    literal = literal_constructor_from_string(literals[i]);
+    scene_add_literal(scene, &literal);
+  }
+  return scene;
+}
+
+/**
+ * @brief Adds the Rule (body => head) with the given weight to the Nerd.
+ */
+void add_rule(Nerd *const nerd, const char *const body, const char *const head,
+              const float weight) {
+  Literal *body_literal = literal_constructor_from_string(body),
+          *head_literal = literal_constructor_from_string(head);
+  Rule *rule = rule_constructor(1, &body_literal, &head_literal, weight, true);
+  knowledge_base_add_rule(nerd->knowledge_base, &rule);
+}
+
+START_TEST(cadence_test) {
+  ck_assert_ptr_null(snapshot_cadence_constructor(SNAPSHOT_CADENCE_INSTANCES, 0));
+  ck_assert_ptr_null(
+      snapshot_cadence_constructor(SNAPSHOT_CADENCE_ACTIVE_CHANGE + 1, 1));
+
+  Nerd *nerd = nerd_constructor(3, 2, 2, 1, 1, 1.5, true, false);
+  SnapshotCadence *cadence =
+      snapshot_cadence_constructor(SNAPSHOT_CADENCE_INSTANCES, 3);
+  ck_assert_ptr_nonnull(cadence);
+  unsigned int i;
+  for (i = 1; i <= 7; ++i) {
+    ck_assert_int_eq(snapshot_cadence_is_due(cadence, nerd, i, 7),
+                     (i % 3) == 0);
+  }
+  ck_assert_int_eq(snapshot_cadence_is_due(NULL, nerd, 3, 7), false);
+  ck_assert_int_eq(snapshot_cadence_is_due(cadence, NULL, 3, 7), false);
+  snapshot_cadence_destructor(&cadence);
+  ck_assert_ptr_null(cadence);
+  snapshot_cadence_destructor(&cadence);
+  snapshot_cadence_destructor(NULL);
+
+  cadence = snapshot_cadence_constructor(SNAPSHOT_CADENCE_ITERATION, 0);
+  ck_assert_ptr_nonnull(cadence);
+  for (i = 1; i <= 7; ++i) {
+    ck_assert_int_eq(snapshot_cadence_is_due(cadence, nerd, i, 7), i == 7);
+  }
+  snapshot_cadence_destructor(&cadence);
+
+  cadence = snapshot_cadence_constructor(SNAPSHOT_CADENCE_ACTIVE_CHANGE, 0);
+  ck_assert_ptr_nonnull(cadence);
+  ck_assert_int_eq(snapshot_cadence_is_due(cadence, nerd, 1, 7), true);
+  ck_assert_int_eq(snapshot_cadence_is_due(cadence, nerd, 2, 7), false);
+  add_rule(nerd, "bird", "fly", 1);
+  ck_assert_int_eq(snapshot_cadence_is_due(cadence, nerd, 3, 7), false);
+  add_rule(nerd, "penguin", "-fly", 3);
+  ck_assert_int_eq(snapshot_cadence_is_due(cadence, nerd, 4, 7), true);
+  ck_assert_int_eq(snapshot_cadence_is_due(cadence, nerd, 5, 7), false);
+  add_rule(nerd, "wings", "fly", 4);
+  ck_assert_int_eq(snapshot_cadence_is_due(cadence, nerd, 6, 7), true);
+  snapshot_cadence_destructor(&cadence);
+
+  nerd_destructor(&nerd);
+}
+END_TEST
+
+START_TEST(construct_destruct_test) {
+  ck_assert_ptr_null(snapshot_writer_constructor(0));
+
+  SnapshotWriter *writer = snapshot_writer_constructor(1);
+  ck_assert_ptr_nonnull(writer);
+  ck_assert_int_eq(snapshot_writer_destructor(&writer), 0);
+  ck_assert_ptr_null(writer);
+  ck_assert_int_eq(snapshot_writer_destructor(&writer), -2);
+  ck_assert_int_eq(snapshot_writer_destructor(NULL), -2);
+}
+END_TEST
+
+START_TEST(submit_test) {
+  Nerd *nerd = nerd_constructor(3, 2, 2, 1, 1, 1.5, true, false);
+  Scene *observations[2] = {
+      create_scene(3, (const char *[]){"bird", "wings", "fly"}),
+      create_scene(4, (const char *[]){"penguin", "bird", "wings", "-fly"})};
+  Scene *labels = create_scene(2, (const char *[]){"fly", "-fly"});
+  char output[64], expected[64];
+
+  // A capacity of 1 makes every submission wait for the previous one.
+  SnapshotWriter *writer = snapshot_writer_constructor(1);
+  NerdSnapshot *snapshot = nerd_snapshot_constructor(nerd);
+  ck_assert_int_eq(snapshot_writer_submit(NULL, &snapshot, "path", false), -2);
+  ck_assert_int_eq(snapshot_writer_submit(writer, NULL, "path", false), -2);
+  ck_assert_int_eq(snapshot_writer_submit(writer, &snapshot, NULL, false), -2);
+  nerd_snapshot_destructor(&snapshot);
+  ck_assert_int_eq(snapshot_writer_submit(writer, &snapshot, "path", false),
+                   -2);
+
+  unsigned int i;
+  for (i = 0; i < NUMBER_OF_INSTANCES; ++i) {
+    nerd_train(nerd, native_inference, observations[(i % 5) != 0], labels,
+               true, NULL, NULL, NULL, 0, NULL);
+    sprintf(output, OUTPUT_PATH, i, (i % 2) ? "ndb" : "nd");
+    sprintf(expected, EXPECTED_PATH, i, (i % 2) ? "ndb" : "nd");
+
+    snapshot = nerd_snapshot_constructor(nerd);
+    ck_assert_int_eq(snapshot_writer_submit(writer, &snapshot, output, i % 2),
+                     0);
+    ck_assert_ptr_null(snapshot);
+    if (i % 2) {
+      nerd_to_binary_file(nerd, expected);
+    } else {
+      nerd_to_file(nerd, expected);
+    }
+  }
+  ck_assert_int_eq(snapshot_writer_destructor(&writer), 0);
+
+  for (i = 0; i < NUMBER_OF_INSTANCES; ++i) {
+    sprintf(output, OUTPUT_PATH, i, (i % 2) ? "ndb" : "nd");
+    sprintf(expected, EXPECTED_PATH, i, (i % 2) ? "ndb" : "nd");
+    ck_assert_int_eq(compare_files(output, expected), 0);
+  }
+
+  writer = snapshot_writer_constructor(SNAPSHOT_WRITER_DEFAULT_CAPACITY);
+  snapshot = nerd_snapshot_constructor(nerd);
+  ck_assert_int_eq(snapshot_writer_submit(writer, &snapshot,
+                                          "../directory/that/does/not/exist",
+                                          false),
+                   0);
+  ck_assert_int_eq(snapshot_writer_destructor(&writer), -1);
+
+  scene_destructor(&(observations[0]));
+  scene_destructor(&(observations[1]));
+  scene_destructor(&labels);
+  nerd_destructor(&nerd);
+}
+END_TEST
+
+Suite *snapshot_writer_suite() {
+  Suite *suite;
+  TCase *cadence_case, *create_case, *submit_case;
+
+  suite = suite_create("Snapshot Writer");
+  cadence_case = tcase_create("Cadence");
+  tcase_add_test(cadence_case, cadence_test);
+  suite_add_tcase(suite, cadence_case);
+
+  create_case = tcase_create("Create");
+  tcase_add_test(create_case, construct_destruct_test);
+  suite_add_tcase(suite, create_case);
+
+  submit_case = tcase_create("Submit");
+  tcase_add_test(submit_case, submit_test);
+  suite_add_tcase(suite, submit_case);
+
+  return suite;
+}
+
+int main() {
+  Suite *suite = snapshot_writer_suite();
+  SRunner *s_runner;
+
+  s_runner = srunner_create(suite);
+  srunner_set_fork_status(s_runner, CK_NOFORK);
+
+  srunner_run_all(s_runner, CK_ENV);
+  int number_failed = srunner_ntests_failed(s_runner);
+  srunner_free(s_runner);
+
+  return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}